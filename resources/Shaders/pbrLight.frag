@@ -3,11 +3,15 @@
 // Shader: pbrLight.frag
 // Purpose: Physically-based rendering with Cook-Torrance BRDF, cascaded shadow
 // mapping, and image-based lighting
+// Variants: COMPACT_GBUFFER reads GBufferLayout::kCompact, rebuilding world
+//           position from depth
+// Point lights: binned into view-space clusters on the CPU (LightClusters);
+//               each pixel shades only its own cluster's lights
 // =============================================================================
 precision highp float;
 precision highp sampler2DArrayShadow;
+precision highp usampler2D;
 
-#define NR_POINT_LIGHTS 10
 #define NUM_CASCADES 4
 
 // ============================================================
@@ -15,10 +19,18 @@ precision highp sampler2DArrayShadow;
 // ============================================================
 
 // G-Buffer inputs (from Geometry Pass)
+#ifdef COMPACT_GBUFFER
+uniform sampler2D gNormalRough; // RG: octahedral normal, B: roughness
+uniform sampler2D gAlbedoMetal; // RGB: albedo, A: metallic
+uniform sampler2D gOcclusion;   // R: ambient occlusion
+uniform sampler2D gEmissive;    // RGB: emissive color
+uniform sampler2D gBufferDepth; // Depth, for world position (nearest filter)
+#else
 uniform sampler2D gPositionAo;      // RGB: world position, A: ambient occlusion
 uniform sampler2D gNormalMetal;     // RGB: world normal, A: metallic
 uniform sampler2D gAlbedoSpecRough; // RGB: albedo, A: roughness
 uniform sampler2D gEmissive;        // RGB: emissive color, A: unused
+#endif
 
 // Shadow mapping
 uniform sampler2DArrayShadow depthMapArray; // CSM shadow map array (4 cascades)
@@ -28,6 +40,11 @@ uniform samplerCube irradianceMap; // Diffuse irradiance cubemap
 uniform samplerCube prefilterMap; // Specular pre-filtered environment map (5 mip levels)
 uniform sampler2D brdfLUT; // BRDF integration lookup table
 
+// Clustered point lights (data textures, nearest filter, read by texelFetch)
+uniform highp sampler2D pointLights; // 2 texels per light: position, color
+uniform usampler2D lightClusters;    // Per tile and slice: offset lo/hi, count
+uniform usampler2D lightIndices;     // Every cluster's light indices, packed
+
 // ============================================================
 // UNIFORM BUFFER OBJECTS
 // ============================================================
@@ -39,6 +56,7 @@ layout(std140) uniform CameraData
   mat4 projMatrix;
   mat4 viewProjMatrix;
   vec4 cameraPosition; // xyz = camPos, w = unused
+  mat4 invViewProjMatrix;
 };
 
 // Cascade data UBO (binding point 0)
@@ -49,21 +67,21 @@ layout(std140) uniform CascadeData
   ivec4 config;       // x: numCascades, y: shadowMapSize
 };
 
-// Point light data structure (matches C++ PointLightData, 48 bytes)
+// Point light data structure (matches C++ PointLightData, 32 bytes)
 struct PointLightData
 {
   vec4 positionRadius;   // xyz = position, w = radius
   vec4 colorIntensity;   // xyz = color, w = unused
-  vec4 attenuation;      // x = constant, y = linear, z = quadratic, w = unused
 };
 
 // Lighting UBO (binding point 2)
 layout(std140) uniform LightingData
 {
-  vec4 dirLightDirection;              // xyz = direction, w = unused
-  vec4 dirLightColor;                  // xyz = color, w = intensity
-  PointLightData pointLights[NR_POINT_LIGHTS]; // 480 bytes (10 * 48)
-  ivec4 lightConfig;                   // x = numPointLights, y = debugView, zw = unused
+  vec4 dirLightDirection; // xyz = direction, w = unused
+  vec4 dirLightColor;     // xyz = color, w = intensity
+  ivec4 lightConfig;      // x = numPointLights, y = debugView, zw = unused
+  ivec4 clusterGrid;      // xyz = tiles x, tiles y, slices, w = unused
+  vec4 clusterScale;      // xy = tiles per pixel, z = slice scale, w = bias
 };
 
 in vec2 texCoords;
@@ -291,10 +309,50 @@ CalcDirectionalLightPBR(vec3 fragPos,
   return (kD * albedo / PI + specular) * radiance * NdotL * shadowFactor;
 }
 
+// ============================================================
+// SECTION: Clustered Point Lights
+// ============================================================
+
+// Light range of the cluster holding this pixel at a view-space depth
+// Returns: x = first entry in lightIndices, y = light count
+ivec2
+FindCluster(float viewDepth)
+{
+  ivec2 tile = ivec2(gl_FragCoord.xy * clusterScale.xy);
+  tile = clamp(tile, ivec2(0), clusterGrid.xy - 1);
+  int slice =
+    int(log(max(viewDepth, EPSILON)) * clusterScale.z + clusterScale.w);
+  slice = clamp(slice, 0, clusterGrid.z - 1);
+
+  uvec4 range =
+    texelFetch(lightClusters, ivec2(tile.x + tile.y * clusterGrid.x, slice), 0);
+  return ivec2(int(range.x | (range.y << 16u)), int(range.z));
+}
+
+// Light index stored at `entry` of the packed lightIndices texture
+int
+FetchLightIndex(int entry)
+{
+  int width = textureSize(lightIndices, 0).x;
+  ivec2 texel = ivec2(entry % width, entry / width);
+  return int(texelFetch(lightIndices, texel, 0).r);
+}
+
+PointLightData
+FetchPointLight(int index)
+{
+  int perRow = textureSize(pointLights, 0).x / 2;
+  ivec2 texel = ivec2((index % perRow) * 2, index / perRow);
+  PointLightData light;
+  light.positionRadius = texelFetch(pointLights, texel, 0);
+  light.colorIntensity = texelFetch(pointLights, texel + ivec2(1, 0), 0);
+  return light;
+}
+
 // Calculate PBR lighting contribution from point light
 // Applies Cook-Torrance BRDF with inverse-square attenuation
 // No shadows for point lights (only directional light has CSM)
-// Params: light (PointLightData from UBO), fragPos, viewDir, normal, roughness,
+// Params: light (from FetchPointLight), fragPos, viewDir, normal, roughness,
 // metallic, specularColor, albedo
 // Returns: RGB lighting contribution
 vec3
@@ -334,9 +392,60 @@ CalcPointLightPBR(PointLightData light,
   return (kD * albedo / PI + specular) * radiance * NdotL;
 }
 
+#ifdef COMPACT_GBUFFER
+// ============================================================
+// SECTION: G-Buffer Unpacking
+// ============================================================
+
+// Inverse of encodeNormal() in pbrMesh.frag
+// Params: e (octahedral normal in [0-1]²)
+// Returns: Unit world-space normal
+vec3
+decodeNormal(vec2 e)
+{
+  vec2 f = e * 2.0 - 1.0;
+  vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+  float t = clamp(-n.z, 0.0, 1.0);
+  n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+  return normalize(n);
+}
+
+// World position of the surface seen at texCoords
+// Params: depth (window-space depth [0-1] from gBufferDepth)
+// Returns: World-space position
+vec3
+reconstructPosition(float depth)
+{
+  vec4 ndc = vec4(vec3(texCoords, depth) * 2.0 - 1.0, 1.0);
+  vec4 world = invViewProjMatrix * ndc;
+  return world.xyz / world.w;
+}
+#endif
+
 void
 main()
 {
+#ifdef COMPACT_GBUFFER
+  // Skip pixels with no geometry (depth still at the clear value)
+  // This prevents cubemap IBL from bleeding through where nothing was rendered
+  float depth = texture(gBufferDepth, texCoords).r;
+  if (depth >= 1.0) {
+    FragColor = vec4(0.0, 0.0, 0.0, 0.0);
+    return;
+  }
+
+  vec4 normalRough = texture(gNormalRough, texCoords);
+  vec4 albedoMetal = texture(gAlbedoMetal, texCoords);
+
+  vec3 fragPos = reconstructPosition(depth);
+  vec3 normal = decodeNormal(normalRough.rg);
+
+  vec3 albedo = pow(albedoMetal.rgb, vec3(2.2)); // sRGB to linear
+  vec3 emissive = texture(gEmissive, texCoords).rgb;
+  float ao = texture(gOcclusion, texCoords).r;
+  float metallic = albedoMetal.a;
+  float roughness = normalRough.b;
+#else
   // Cache G-buffer samples (single vec4 read instead of separate RGB and A
   // reads)
   vec4 positionAo = texture(gPositionAo, texCoords);
@@ -361,6 +470,7 @@ main()
   float ao = positionAo.a;
   float metallic = normalMetal.a;
   float roughness = albedoSpecRough.a;
+#endif
 
   vec3 viewDir = normalize(cameraPosition.xyz - fragPos);
   vec3 reflection = reflect(-viewDir, normal);
@@ -378,12 +488,17 @@ main()
                                     specularColor,
                                     albedo);
 
-  int numPointLights = lightConfig.x;
-  for (int i = 0; i < numPointLights; i++) {
+  // Only the lights binned into this pixel's cluster can reach it
+  ivec2 cluster = ivec2(0);
+  if (lightConfig.x > 0) {
+    cluster = FindCluster(-(viewMatrix * vec4(fragPos, 1.0)).z);
+  }
+  for (int i = 0; i < cluster.y; i++) {
+    PointLightData light = FetchPointLight(FetchLightIndex(cluster.x + i));
     // calculate distance between light source and current fragment
-    float distance = length(pointLights[i].positionRadius.xyz - fragPos);
-    if (distance < pointLights[i].positionRadius.w) { // w = radius
-      Lo += CalcPointLightPBR(pointLights[i],
+    float distance = length(light.positionRadius.xyz - fragPos);
+    if (distance < light.positionRadius.w) { // w = radius
+      Lo += CalcPointLightPBR(light,
                               fragPos,
                               viewDir,
                               normal,
@@ -445,5 +560,12 @@ main()
     }
 
     FragColor = vec4(cascadeColor, 1.0);
+  } else if (debugView == 8) {
+    // Lights in the pixel's cluster: black = none, blue to red = 1 to 32+
+    float heat = clamp(float(cluster.y) / 32.0, 0.0, 1.0);
+    FragColor = vec4(heat, 1.0 - abs(heat * 2.0 - 1.0), 1.0 - heat, 1.0);
+    if (cluster.y == 0) {
+      FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+    }
   }
 }
@@ -2,6 +2,8 @@
 // =============================================================================
 // Shader: pbrMesh.frag
 // Purpose: Fill G-buffer with PBR material properties
+// Variants: COMPACT_GBUFFER writes GBufferLayout::kCompact (no position,
+//           octahedral normals, 8-10 bit material channels)
 // =============================================================================
 precision highp float;
 
@@ -39,10 +41,19 @@ layout(std140) uniform MaterialData
 // G-BUFFER OUTPUTS
 // ============================================================
 
+#ifdef COMPACT_GBUFFER
+// Position is rebuilt from the depth buffer by pbrLight.frag
+// Formats: RGB10A2, RGBA8, R8, R11G11B10F
+layout(location = 0) out vec4 gNormalRough; // RG: octahedral normal, B: rough
+layout(location = 1) out vec4 gAlbedoMetal; // RGB: albedo, A: metallic
+layout(location = 2) out float gOcclusion;  // R: AO
+layout(location = 3) out vec3 gEmissive;    // RGB: emissive
+#else
 layout(location = 0) out vec4 gPositionAo;  // RGB: position, A: AO
 layout(location = 1) out vec4 gNormalMetal; // RGB: normal, A: metallic
 layout(location = 2) out vec4 gAlbedoRough; // RGB: albedo, A: roughness
 layout(location = 3) out vec4 gEmissive;    // RGB: emissive, A: unused
+#endif
 
 // Bayer 4×4 dithering matrix for ordered dithering (alpha blending)
 // Values 1-16 normalized to [0-1] range by dividing by 16
@@ -109,6 +120,27 @@ getNormal()
   return normalize(mat3(t, b, ng) * tangentNormal);
 }
 
+#ifdef COMPACT_GBUFFER
+// ============================================================
+// NORMAL PACKING
+// ============================================================
+
+// Octahedral encoding: projects the unit sphere onto an octahedron and
+// unfolds it into a square, spreading precision evenly over all directions
+// Must match decodeNormal() in pbrLight.frag
+// Returns: Normal packed into [0-1]²
+vec2
+encodeNormal(vec3 n)
+{
+  n /= abs(n.x) + abs(n.y) + abs(n.z);
+  if (n.z < 0.0) {
+    vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    n.xy = (1.0 - abs(n.yx)) * signs;
+  }
+  return n.xy * 0.5 + 0.5;
+}
+#endif
+
 void
 main()
 {
@@ -158,8 +190,15 @@ main()
     }
   }
 
+#ifdef COMPACT_GBUFFER
+  gNormalRough = vec4(encodeNormal(getNormal()), baseRough.a, 0.0);
+  gAlbedoMetal = vec4(baseRough.rgb, metal);
+  gOcclusion = ao;
+  gEmissive = emissive.rgb;
+#else
   gNormalMetal = vec4(getNormal(), metal);
   gPositionAo = vec4(pPosition, ao);
   gAlbedoRough = baseRough;
   gEmissive = emissive;
+#endif
 }
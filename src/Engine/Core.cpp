@@ -12,26 +12,10 @@ Core::initialize()
   std::cout << "[core] Initialize" << std::endl;
 
   if (Window::getInstance().start() && Window::getInstance().open()) {
-    // Initialize GraphicsDevice (must be after GL context is created)
-    if (!gfx::GraphicsDevice::getInstance().initialize()) {
-      std::cerr << "Failed to initialize GraphicsDevice" << std::endl;
+    if (!initializeEngine(gfx::BackendType::GLES3)) {
       return false;
     }
 
-    // Initialize RenderResources bridge layer
-    if (!gfx::RenderResources::getInstance().initialize()) {
-      std::cerr << "Failed to initialize RenderResources" << std::endl;
-      return false;
-    }
-
-    m_ECSManager = &ECSManager::getInstance();
-    m_ECSManager->initializeSystems();
-#ifndef NDEBUG
-    m_ECSManager->setProfiler(&m_profiler);
-    static_cast<GraphicsSystem&>(m_ECSManager->getSystem("GRAPHICS"))
-      .setProfiler(&m_profiler);
-#endif
-
     // Initialize UIManager
     m_UIManager = &UIManager::getInstance();
     int width, height;
@@ -46,7 +30,7 @@ Core::initialize()
     m_gameStateManager = &GameStateManager::getInstance();
     m_gameStateManager->initialize();
 
-    m_prevTime = glfwGetTime();
+    m_prevTime = getTime();
   } else {
     return false;
   }
@@ -101,10 +85,67 @@ Core::initialize()
   return true;
 }
 
+bool
+Core::initializeHeadless()
+{
+  std::cout << "[core] Initialize headless" << std::endl;
+
+  m_headless = true;
+  m_startTime = std::chrono::steady_clock::now();
+  if (!initializeEngine(gfx::BackendType::Null)) {
+    return false;
+  }
+
+  // No menu to leave, so start the way the playing state does
+  m_ECSManager->setSimulatePhysics(true);
+  m_ECSManager->setRenderGraphics(true);
+
+  m_prevTime = getTime();
+  return true;
+}
+
+bool
+Core::initializeEngine(gfx::BackendType backend)
+{
+  // Initialize GraphicsDevice (GLES3 must come after the GL context is
+  // created)
+  if (!gfx::GraphicsDevice::getInstance().initialize(backend)) {
+    std::cerr << "Failed to initialize GraphicsDevice" << std::endl;
+    return false;
+  }
+
+  // Initialize RenderResources bridge layer
+  if (!gfx::RenderResources::getInstance().initialize()) {
+    std::cerr << "Failed to initialize RenderResources" << std::endl;
+    return false;
+  }
+
+  m_ECSManager = &ECSManager::getInstance();
+  m_ECSManager->initializeSystems();
+#ifndef NDEBUG
+  m_ECSManager->setProfiler(&m_profiler);
+  static_cast<GraphicsSystem&>(m_ECSManager->getSystem("GRAPHICS"))
+    .setProfiler(&m_profiler);
+#endif
+
+  return true;
+}
+
+double
+Core::getTime() const
+{
+  if (m_headless) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         m_startTime)
+      .count();
+  }
+  return glfwGetTime();
+}
+
 float&
 Core::getDeltaTime()
 {
-  m_currentTime = glfwGetTime();
+  m_currentTime = getTime();
   m_dt = m_currentTime - m_prevTime;
   m_prevTime = m_currentTime;
   return m_dt;
@@ -113,6 +154,11 @@ Core::getDeltaTime()
 void
 Core::update()
 {
+  if (m_headless) {
+    updateHeadless();
+    return;
+  }
+
   glfwPollEvents();
 
   float& dt = getDeltaTime();
@@ -157,8 +203,28 @@ Core::update()
 #endif
 }
 
+void
+Core::updateHeadless()
+{
+  float& dt = getDeltaTime();
+
+#ifndef NDEBUG
+  m_profiler.beginFrame();
+  m_profiler.resetSections();
+  m_profiler.beginPhase(Profiler::kPhaseECS);
+#endif
+  InputManager::getInstance().update(dt);
+  ECSManager::getInstance().update(dt);
+#ifndef NDEBUG
+  m_profiler.endPhase(Profiler::kPhaseECS);
+  m_profiler.endFrame();
+#endif
+}
+
 bool
 Core::open()
 {
-  return !Window::getInstance().closed();
+  // Without a window nothing closes it; the caller decides how many frames
+  // to run
+  return m_headless || !Window::getInstance().closed();
 }
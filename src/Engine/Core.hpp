@@ -9,6 +9,7 @@
 #include <Profiler.hpp>
 #endif
 #include <UIManager.hpp>
+#include <chrono>
 
 class Core : public Singleton<Core>
 {
@@ -19,18 +20,31 @@ public:
   ~Core() = default;
 
   bool initialize();
+  /// Runs the engine without a window: the Null graphics backend stands in
+  /// for the GL context and the UI is left out, so a frame costs only what
+  /// the ECS and the frame graph spend on the CPU
+  bool initializeHeadless();
   void update();
   bool open();
   float& getDeltaTime();
   float getDt() const { return m_dt; }
+  bool isHeadless() const { return m_headless; }
 
 private:
+  bool initializeEngine(gfx::BackendType backend);
+  // Input and ECS only: no events to poll, UI to draw or buffers to swap
+  void updateHeadless();
+  // Seconds since start-up, from GLFW or, without a window, a steady clock
+  double getTime() const;
+
   ECSManager* m_ECSManager = nullptr;
   UIManager* m_UIManager = nullptr;
   GameStateManager* m_gameStateManager = nullptr;
   float m_dt = 0.0f;
   float m_prevTime = 0.0f;
   float m_currentTime = 0.0f;
+  bool m_headless = false;
+  std::chrono::steady_clock::time_point m_startTime;
 
 #ifndef NDEBUG
   GUI m_gui;
@@ -1,8 +1,10 @@
 #ifndef COMPONENTPOOL_H_
 #define COMPONENTPOOL_H_
 
+#include <array>
 #include <cassert>
 #include <limits>
+#include <memory>
 #include <vector>
 
 // A pool for a specific component type
@@ -12,26 +14,98 @@ public:
   virtual ~IComponentPool() = default;
   virtual void entityDestroyed(Entity entity) = 0;
   virtual void clear() = 0;
+  virtual size_t size() const = 0;
+  virtual Entity entityAt(size_t index) const = 0;
+  // Dense index of the entity's component, size() if it has none
+  virtual size_t indexOf(Entity entity) const = 0;
+  // Swaps two dense entries, used by owning groups to keep their prefix packed
+  virtual void swapEntries(size_t a, size_t b) = 0;
+
+  // Change tracking: each dense slot carries the ECSManager change tick at
+  // which it was added or last marked changed. Pools keep the stamps in step
+  // with their dense arrays; ECSManager does the stamping.
+  u32 versionAt(size_t index) const { return m_versions[index]; }
+  void markChangedAt(size_t index, u32 tick) { m_versions[index] = tick; }
+  // True if the slot was written at or after `tick`
+  bool changedSince(size_t index, u32 tick) const
+  {
+    return m_versions[index] >= tick;
+  }
+
+protected:
+  std::vector<u32> m_versions; // Dense index -> change tick
+};
+
+// Entity index -> dense index map shared by the pool types. Split into
+// fixed-size pages that are only allocated once an entity in that range gets
+// the component, so memory follows the number of components rather than the
+// highest entity index.
+class SparseIndex
+{
+  static constexpr u32 PAGE_SIZE = 4096;
+  using Page = std::array<u32, PAGE_SIZE>;
+
+public:
+  static constexpr u32 INVALID = std::numeric_limits<u32>::max();
+
+  // Dense index stored for an entity index, INVALID if absent
+  u32 find(u32 index) const
+  {
+    u32 page = index / PAGE_SIZE;
+    if (page >= m_pages.size() || !m_pages[page])
+      return INVALID;
+    return (*m_pages[page])[index % PAGE_SIZE];
+  }
+
+  // Slot for an entity index, allocating its page on first touch
+  u32& slot(u32 index)
+  {
+    u32 page = index / PAGE_SIZE;
+    if (page >= m_pages.size()) {
+      m_pages.resize(page + 1);
+    }
+    if (!m_pages[page]) {
+      m_pages[page] = std::make_unique<Page>();
+      m_pages[page]->fill(INVALID);
+    }
+    return (*m_pages[page])[index % PAGE_SIZE];
+  }
+
+  // Pages are kept so a reloaded scene does not have to reallocate them
+  void clear()
+  {
+    for (auto& page : m_pages) {
+      if (page) {
+        page->fill(INVALID);
+      }
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<Page>> m_pages;
 };
 
+// Sparse set keyed by entity index (see SparseIndex). The dense side stores
+// full handles, which lets lookups reject stale handles whose generation no
+// longer matches.
 template<typename T>
 class ComponentPool : public IComponentPool
 {
-  static constexpr size_t INVALID = std::numeric_limits<size_t>::max();
+  static constexpr u32 INVALID = SparseIndex::INVALID;
 
 public:
-  ComponentPool() { m_entityToIndex.resize(MAX_ENTITIES, INVALID); }
-
   template<typename... Args>
   T& emplace(Entity entity, Args&&... args)
   {
-    assert(entity < MAX_ENTITIES && "Entity out of range");
-    assert(m_entityToIndex[entity] == INVALID && "Component already exists");
+    u32 index = entityIndex(entity);
+    assert(index < MAX_ENTITIES && "Entity out of range");
+    u32& slot = m_sparse.slot(index);
+    assert(slot == INVALID && "Component already exists");
 
-    size_t newIndex = m_components.size();
+    slot = static_cast<u32>(m_components.size());
     m_components.emplace_back(std::forward<Args>(args)...);
     m_indexToEntity.push_back(entity);
-    m_entityToIndex[entity] = newIndex;
+    m_versions.push_back(0);
 
     return m_components.back();
   }
@@ -39,29 +113,29 @@ public:
   // Swap-and-pop removal: O(1) by moving the last element into the gap
   void remove(Entity entity)
   {
-    assert(entity < MAX_ENTITIES && "Entity out of range");
-    size_t removedIndex = m_entityToIndex[entity];
+    u32 removedIndex = denseIndex(entity);
     if (removedIndex == INVALID)
       return;
 
-    size_t lastIndex = m_components.size() - 1;
+    u32 lastIndex = static_cast<u32>(m_components.size() - 1);
 
     if (removedIndex != lastIndex) {
       Entity lastEntity = m_indexToEntity[lastIndex];
       m_components[removedIndex] = std::move(m_components[lastIndex]);
       m_indexToEntity[removedIndex] = lastEntity;
-      m_entityToIndex[lastEntity] = removedIndex;
+      m_versions[removedIndex] = m_versions[lastIndex];
+      m_sparse.slot(entityIndex(lastEntity)) = removedIndex;
     }
 
     m_components.pop_back();
     m_indexToEntity.pop_back();
-    m_entityToIndex[entity] = INVALID;
+    m_versions.pop_back();
+    m_sparse.slot(entityIndex(entity)) = INVALID;
   }
 
   T* get(Entity entity)
   {
-    assert(entity < MAX_ENTITIES && "Entity out of range");
-    size_t index = m_entityToIndex[entity];
+    u32 index = denseIndex(entity);
     if (index == INVALID)
       return nullptr;
     return &m_components[index];
@@ -69,37 +143,51 @@ public:
 
   const T* get(Entity entity) const
   {
-    assert(entity < MAX_ENTITIES && "Entity out of range");
-    size_t index = m_entityToIndex[entity];
+    u32 index = denseIndex(entity);
     if (index == INVALID)
       return nullptr;
     return &m_components[index];
   }
 
-  bool has(Entity entity) const
+  bool has(Entity entity) const { return denseIndex(entity) != INVALID; }
+
+  size_t indexOf(Entity entity) const override
   {
-    return entity < MAX_ENTITIES && m_entityToIndex[entity] != INVALID;
+    u32 index = denseIndex(entity);
+    return index == INVALID ? m_components.size() : index;
   }
 
-  void entityDestroyed(Entity entity) override
+  void swapEntries(size_t a, size_t b) override
   {
-    if (entity < MAX_ENTITIES && m_entityToIndex[entity] != INVALID) {
-      remove(entity);
-    }
+    if (a == b)
+      return;
+    std::swap(m_components[a], m_components[b]);
+    std::swap(m_indexToEntity[a], m_indexToEntity[b]);
+    std::swap(m_versions[a], m_versions[b]);
+    m_sparse.slot(entityIndex(m_indexToEntity[a])) = static_cast<u32>(a);
+    m_sparse.slot(entityIndex(m_indexToEntity[b])) = static_cast<u32>(b);
   }
 
+  void entityDestroyed(Entity entity) override { remove(entity); }
+
   void clear() override
   {
     m_components.clear();
     m_indexToEntity.clear();
-    std::fill(m_entityToIndex.begin(), m_entityToIndex.end(), INVALID);
+    m_versions.clear();
+    m_sparse.clear();
   }
 
   // Direct iteration
-  size_t size() const { return m_components.size(); }
+  size_t size() const override { return m_components.size(); }
   T& operator[](size_t index) { return m_components[index]; }
   const T& operator[](size_t index) const { return m_components[index]; }
-  Entity entityAt(size_t index) const { return m_indexToEntity[index]; }
+  // Same as &(*this)[index]; mirrors SoAComponentPool::at for generic code
+  T* at(size_t index) { return &m_components[index]; }
+  Entity entityAt(size_t index) const override
+  {
+    return m_indexToEntity[index];
+  }
 
   T* begin() { return m_components.data(); }
   T* end() { return m_components.data() + m_components.size(); }
@@ -107,10 +195,18 @@ public:
   const T* end() const { return m_components.data() + m_components.size(); }
 
 private:
+  // Dense index for a handle, INVALID if absent or if the handle is stale
+  u32 denseIndex(Entity entity) const
+  {
+    u32 dense = m_sparse.find(entityIndex(entity));
+    if (dense == INVALID || m_indexToEntity[dense] != entity)
+      return INVALID;
+    return dense;
+  }
+
   std::vector<T> m_components;         // Components stored contiguously
-  std::vector<Entity> m_indexToEntity; // Dense index -> entity ID
-  std::vector<size_t>
-    m_entityToIndex; // Entity ID -> dense index (INVALID if absent)
+  std::vector<Entity> m_indexToEntity; // Dense index -> entity handle
+  SparseIndex m_sparse;                // Entity index -> dense index
 };
 
 #endif // COMPONENTPOOL_H_
@@ -0,0 +1,20 @@
+#ifndef COMPONENTSTORAGE_H_
+#define COMPONENTSTORAGE_H_
+
+// How ECSManager lays out the pool for a component type
+enum class StoragePolicy : u8
+{
+  AoS, // ComponentPool<T>: std::vector<T>, get() hands out T*
+  SoA  // SoAComponentPool<T>: one float stream per field, get() hands out a
+       // proxy; requires a SoALayout<T> specialization (see SoALayout.hpp)
+};
+
+// Specialize with `static constexpr StoragePolicy policy = SoA` to opt a
+// component into structure-of-arrays storage
+template<typename T>
+struct ComponentStorage
+{
+  static constexpr StoragePolicy policy = StoragePolicy::AoS;
+};
+
+#endif // COMPONENTSTORAGE_H_
@@ -0,0 +1,26 @@
+#ifndef COMPONENTTYPEID_H_
+#define COMPONENTTYPEID_H_
+
+#include <atomic>
+#include <cassert>
+
+// Counter behind componentTypeID<T>, shared by every component type
+inline std::atomic<u32>&
+nextComponentTypeID()
+{
+  static std::atomic<u32> next{ 0 };
+  return next;
+}
+
+// Dense per-type ID, handed out the first time T is seen and cached in a
+// function-local static, so every later lookup is a single load
+template<typename T>
+u32
+componentTypeID()
+{
+  static const u32 id = nextComponentTypeID().fetch_add(1);
+  assert(id < MAX_COMPONENTS && "Too many component types");
+  return id;
+}
+
+#endif // COMPONENTTYPEID_H_
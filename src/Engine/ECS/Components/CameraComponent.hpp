@@ -1,6 +1,8 @@
 #ifndef CAMERACOMPONENT_H_
 #define CAMERACOMPONENT_H_
 
+#include <Rendering/Frustum.hpp>
+
 struct CameraComponent
 {
   CameraComponent() = default;
@@ -17,6 +19,12 @@ struct CameraComponent
   {
   }
 
+  // Clip planes of the current view and projection matrices
+  [[nodiscard]] Frustum getFrustum() const
+  {
+    return Frustum::fromMatrix(m_ProjectionMatrix * m_viewMatrix);
+  }
+
   glm::mat4 m_viewMatrix{ 1.0f };
   glm::mat4 m_ProjectionMatrix{ 1.0f };
   glm::vec3 m_position{ 0.0f };
@@ -0,0 +1,16 @@
+#ifndef HIERARCHYCOMPONENT_H_
+#define HIERARCHYCOMPONENT_H_
+
+// Places an entity in a parent/child tree. Its PositionComponent is then
+// relative to the parent, and PositionSystem propagates world matrices down
+// the tree. Children are a singly linked list starting at firstChild.
+// Change links through ECSManager::setParent only.
+struct HierarchyComponent
+{
+  Entity parent{ 0 };
+  Entity firstChild{ 0 };
+  Entity nextSibling{ 0 };
+  u32 depth{ 0 }; // 0 for roots; PositionSystem keeps the pool sorted by it
+};
+
+#endif // HIERARCHYCOMPONENT_H_
@@ -1,6 +1,9 @@
 #ifndef POSITIONCOMPONENT_H_
 #define POSITIONCOMPONENT_H_
 
+#include <ECS/ComponentStorage.hpp>
+#include <ECS/SoALayout.hpp>
+
 struct PositionComponent
 {
   glm::vec3 position{ 0.0f };
@@ -14,4 +17,54 @@ struct PositionComponent
   }
 };
 
+// Stored as SoA: PositionSystem composes world matrices straight from the
+// pool's streams. getComponent() hands out a SoARef proxy, so callers copy
+// values out instead of holding &position/&rotation.
+template<>
+struct ComponentStorage<PositionComponent>
+{
+  static constexpr StoragePolicy policy = StoragePolicy::SoA;
+};
+
+// One stream per float, in the order the transform kernels read them
+template<>
+struct SoALayout<PositionComponent>
+{
+  enum Stream : u32
+  {
+    PosX,
+    PosY,
+    PosZ,
+    RotX,
+    RotY,
+    RotZ,
+    RotW,
+    ScaleX,
+    ScaleY,
+    ScaleZ,
+    Count
+  };
+
+  static void store(const PositionComponent& c, float* const* s, size_t i)
+  {
+    s[PosX][i] = c.position.x;
+    s[PosY][i] = c.position.y;
+    s[PosZ][i] = c.position.z;
+    s[RotX][i] = c.rotation.x;
+    s[RotY][i] = c.rotation.y;
+    s[RotZ][i] = c.rotation.z;
+    s[RotW][i] = c.rotation.w;
+    s[ScaleX][i] = c.scale.x;
+    s[ScaleY][i] = c.scale.y;
+    s[ScaleZ][i] = c.scale.z;
+  }
+
+  static void load(PositionComponent& c, const float* const* s, size_t i)
+  {
+    c.position = glm::vec3(s[PosX][i], s[PosY][i], s[PosZ][i]);
+    c.rotation = glm::quat(s[RotW][i], s[RotX][i], s[RotY][i], s[RotZ][i]);
+    c.scale = glm::vec3(s[ScaleX][i], s[ScaleY][i], s[ScaleZ][i]);
+  }
+};
+
 #endif // POSITIONCOMPONENT_H_
@@ -6,6 +6,7 @@
 #include "ECS/Components/AnimationComponent.hpp"
 #include "ECS/Components/AudioSourceComponent.hpp"
 #include "ECS/Components/CameraComponent.hpp"
+#include "ECS/Components/HierarchyComponent.hpp"
 #include "ECS/Components/LightingComponent.hpp"
 #include "ECS/Components/ParticlesComponent.hpp"
 #include "ECS/Components/PhysicsComponent.hpp"
@@ -18,6 +19,7 @@
 #include "Systems/ParticleSystem.hpp"
 #include "Systems/PhysicsSystem.hpp"
 #include "Systems/PositionSystem.hpp"
+#include "Systems/SpatialSystem.hpp"
 #include <algorithm>
 #include <utility>
 
@@ -26,6 +28,7 @@ ECSManager::initializeSystems()
 {
   m_systems["PHYSICS"] = &PhysicsSystem::getInstance();
   m_systems["POSITION"] = &PositionSystem::getInstance();
+  m_systems["SPATIAL"] = &SpatialSystem::getInstance();
   m_systems["PARTICLES"] = &ParticleSystem::getInstance();
   m_systems["ANIMATION"] = &AnimationSystem::getInstance();
   m_systems["GRAPHICS"] = &GraphicsSystem::getInstance();
@@ -33,71 +36,101 @@ ECSManager::initializeSystems()
   m_systems["AUDIO"] = &AudioSystem::getInstance();
 
   // Explicit update order: camera -> particles -> animation -> audio ->
-  // position -> graphics -> physics Audio runs after animation (needs camera
-  // for listener) but before graphics. Physics runs last so that
+  // position -> spatial -> graphics -> physics Audio runs after animation
+  // (needs camera for listener) but before graphics. Spatial refits the scene
+  // BVH from the world matrices position just built. Physics runs last so that
   // forces/velocities set by the game layer (C# via C API) between frames are
   // consumed in the same frame's physics step.
+  // The scheduler keeps this order between systems whose component access
+  // conflicts and runs the others concurrently.
   m_systemUpdateOrder = {
-    m_systems["CAMERA"],  m_systems["PARTICLES"], m_systems["ANIMATION"],
-    m_systems["AUDIO"],   m_systems["POSITION"],  m_systems["GRAPHICS"],
-    m_systems["PHYSICS"],
+    m_systems["CAMERA"],   m_systems["PARTICLES"], m_systems["ANIMATION"],
+    m_systems["AUDIO"],    m_systems["POSITION"],  m_systems["SPATIAL"],
+    m_systems["GRAPHICS"], m_systems["PHYSICS"],
   };
 
   for (auto* system : m_systemUpdateOrder) {
     system->initialize(*this);
   }
+
+  m_scheduler.build(m_systemUpdateOrder);
+  u32 hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  m_scheduler.setWorkerCount(
+    std::min(kDefaultSystemWorkers, hardwareThreads - 1));
+}
+
+void
+ECSManager::setSystemWorkerCount(u32 count)
+{
+  m_scheduler.setWorkerCount(count);
 }
 
 void
 ECSManager::update(float dt)
 {
 #ifndef NDEBUG
-  static constexpr std::string_view kSystemNames[] = { "Camera",    "Particles",
-                                                       "Animation", "Audio",
-                                                       "Position",  "Graphics",
-                                                       "Physics" };
+  static constexpr std::string_view kSystemNames[] = {
+    "Camera",   "Particles", "Animation", "Audio",
+    "Position", "Spatial",   "Graphics",  "Physics"
+  };
 #endif
 
-  for (size_t i = 0; i < m_systemUpdateOrder.size(); ++i) {
-#ifndef NDEBUG
-    // Skip timing Graphics — its internals are covered by render pass sections
-    bool profileThis = m_profiler && kSystemNames[i] != "Graphics";
-    if (profileThis)
-      m_profiler->beginSection(kSystemNames[i], SectionCategory::kSystem);
-#endif
-    m_systemUpdateOrder[i]->update(dt);
+  advanceChangeTick();
+  m_scheduler.run(dt);
+
+  // Sync point: every system is done, apply their deferred structural changes
+  flushCommandBuffer();
+
 #ifndef NDEBUG
-    if (profileThis)
-      m_profiler->endSection();
-#endif
+  // Systems may have overlapped on workers, so their timings are recorded
+  // after the fact rather than with begin/endSection around each update
+  if (m_profiler) {
+    const std::vector<float>& durations = m_scheduler.getDurationsMs();
+    for (size_t i = 0; i < m_systemUpdateOrder.size(); ++i) {
+      // Skip timing Graphics — its internals are covered by render pass
+      // sections
+      if (kSystemNames[i] != "Graphics") {
+        m_profiler->addSection(
+          kSystemNames[i], SectionCategory::kSystem, durations[i]);
+      }
+    }
   }
+#endif
 }
 
 Entity
 ECSManager::createEntity(std::string name)
 {
-  Entity newEntity;
+  u32 index;
 
-  // First try to reuse an available entity ID
-  if (!m_availableEntityIds.empty()) {
-    newEntity = m_availableEntityIds.front();
-    m_availableEntityIds.pop();
+  // First try to reuse an available entity index
+  if (!m_availableEntityIndices.empty()) {
+    index = m_availableEntityIndices.front();
+    m_availableEntityIndices.pop();
   } else {
-    // Check if we've hit the MAX_ENTITIES limit
-    if (m_entityCount >= MAX_ENTITIES) {
+    // Check if we've hit the entity limit
+    if (m_entityGenerations.size() >= m_entityLimit) {
       // Entity creation failed - return invalid entity ID
       return 0;
     }
 
-    // Create new entity ID
-    newEntity = (m_entityCount++);
+    // Grow per-entity storage by one index
+    index = static_cast<u32>(m_entityGenerations.size());
+    m_entityComponentMasks.emplace_back();
+    m_entityGenerations.push_back(0);
+    m_entityAlive.push_back(false);
+    m_entityNames.emplace_back();
+    m_entityDenseIndex.push_back(0);
   }
 
+  Entity newEntity = makeEntity(index, m_entityGenerations[index]);
+  m_entityAlive[index] = true;
+  m_entityDenseIndex[index] = static_cast<u32>(m_entities.size());
   m_entities.push_back(newEntity);
-  m_entityNames[newEntity] = std::move(name);
+  m_entityNames[index] = std::move(name);
 
   // Initialize the component mask for this entity
-  m_entityComponentMasks[newEntity].reset();
+  m_entityComponentMasks[index].reset();
 
   return newEntity;
 }
@@ -171,9 +204,9 @@ ECSManager::setViewport(u32 width, u32 height)
 void
 ECSManager::reset()
 {
-  // Clear all entities
+  // Clear all entities and drop anything still queued
   m_entities.clear();
-  m_entityNames.clear();
+  m_commandBuffer.clear();
 
   // Reset all component pools
   for (auto& pool : m_componentPools) {
@@ -182,52 +215,241 @@ ECSManager::reset()
     }
   }
 
-  // Reset all component masks
-  for (auto& mask : m_entityComponentMasks) {
-    mask.reset();
-  }
+  // Drop per-entity storage back to the reserved invalid index, so IDs
+  // restart from 1 with generation 0
+  m_entityComponentMasks.resize(1);
+  m_entityGenerations.resize(1);
+  m_entityAlive.resize(1);
+  m_entityNames.resize(1);
+  m_entityDenseIndex.resize(1);
+  m_entityLimit = MAX_ENTITIES;
 
-  // Reset entity counter
-  m_entityCount = 1;
+  // Empty cached queries and groups (registrations are kept, they are still
+  // valid)
+  for (auto& [signature, query] : m_queries) {
+    query->clear();
+  }
+  for (auto& group : m_groups) {
+    group->clear();
+  }
 
-  // Clear entity ID reuse queue
-  while (!m_availableEntityIds.empty()) {
-    m_availableEntityIds.pop();
+  // Clear entity index reuse queue
+  while (!m_availableEntityIndices.empty()) {
+    m_availableEntityIndices.pop();
   }
 }
 
 void
 ECSManager::destroyEntity(Entity entity)
 {
-  // Validate entity exists
-  if (entity == 0 || entity >= MAX_ENTITIES) {
-    return; // Invalid entity ID
+  // Rejects the invalid entity and stale handles to a recycled index
+  if (!isAlive(entity)) {
+    return;
   }
 
-  // Check if entity actually exists in our active list
-  auto entityIt = std::ranges::find(m_entities, entity);
-  if (entityIt == m_entities.end()) {
-    return; // Entity doesn't exist
+  u32 index = entityIndex(entity);
+
+  // Children stay alive as roots, and the entity leaves its parent's list
+  if (auto* node = getComponent<HierarchyComponent>(entity)) {
+    Entity child = node->firstChild;
+    while (child != 0) {
+      auto* childNode = getComponent<HierarchyComponent>(child);
+      Entity next = childNode->nextSibling;
+      childNode->parent = 0;
+      childNode->nextSibling = 0;
+      setSubtreeDepth(child, 0);
+      markChanged<PositionComponent>(child);
+      child = next;
+    }
+    unlinkFromParent(entity);
+  }
+
+  // Swap-and-pop out of the active entities list
+  u32 denseIndex = m_entityDenseIndex[index];
+  Entity lastEntity = m_entities.back();
+  m_entities[denseIndex] = lastEntity;
+  m_entityDenseIndex[entityIndex(lastEntity)] = denseIndex;
+  m_entities.pop_back();
+
+  // Only the pools and queries of components the entity actually has
+  Signature& mask = m_entityComponentMasks[index];
+  for (size_t typeID = 0; typeID < MAX_COMPONENTS; ++typeID) {
+    if (mask.test(typeID)) {
+      onComponentRemoved(entity, typeID);
+      m_componentPools[typeID]->entityDestroyed(entity);
+    }
   }
+  mask.reset();
 
-  // Remove the entity from the active entities list
-  m_entities.erase(entityIt);
+  m_entityNames[index].clear();
 
-  // Clear all components for this entity
-  m_entityComponentMasks[entity].reset();
+  // Retire the handle: bump the generation so outstanding copies of it go
+  // stale, then make the index available for reuse
+  m_entityAlive[index] = false;
+  m_entityGenerations[index] =
+    (m_entityGenerations[index] + 1) & ENTITY_GENERATION_MASK;
+  m_availableEntityIndices.push(index);
+}
 
-  // Notify all component pools that the entity was destroyed
-  for (auto& pool : m_componentPools) {
-    if (pool) {
-      pool->entityDestroyed(entity);
+void
+ECSManager::setParent(Entity child, Entity parent)
+{
+  if (!isAlive(child) || child == parent ||
+      (parent != 0 && !isAlive(parent))) {
+    return;
+  }
+  // The new parent must not sit inside the child's subtree
+  for (Entity ancestor = parent; ancestor != 0;) {
+    if (ancestor == child) {
+      return;
+    }
+    auto* node = getComponent<HierarchyComponent>(ancestor);
+    ancestor = node ? node->parent : 0;
+  }
+
+  // Emplace both nodes before taking pointers; emplacing can reallocate
+  if (!hasComponent<HierarchyComponent>(child)) {
+    emplaceComponent<HierarchyComponent>(child);
+  }
+  if (parent != 0 && !hasComponent<HierarchyComponent>(parent)) {
+    emplaceComponent<HierarchyComponent>(parent);
+  }
+  if (getComponent<HierarchyComponent>(child)->parent == parent) {
+    return;
+  }
+
+  unlinkFromParent(child);
+  u32 depth = 0;
+  if (parent != 0) {
+    auto* parentNode = getComponent<HierarchyComponent>(parent);
+    auto* node = getComponent<HierarchyComponent>(child);
+    node->parent = parent;
+    node->nextSibling = parentNode->firstChild;
+    parentNode->firstChild = child;
+    depth = parentNode->depth + 1;
+  }
+  setSubtreeDepth(child, depth);
+
+  markChanged<HierarchyComponent>(child);
+  markChanged<PositionComponent>(child);
+}
+
+void
+ECSManager::unlinkFromParent(Entity entity)
+{
+  auto* node = getComponent<HierarchyComponent>(entity);
+  if (!node || node->parent == 0) {
+    return;
+  }
+  auto* parentNode = getComponent<HierarchyComponent>(node->parent);
+  if (parentNode->firstChild == entity) {
+    parentNode->firstChild = node->nextSibling;
+  } else {
+    Entity sibling = parentNode->firstChild;
+    while (sibling != 0) {
+      auto* siblingNode = getComponent<HierarchyComponent>(sibling);
+      if (siblingNode->nextSibling == entity) {
+        siblingNode->nextSibling = node->nextSibling;
+        break;
+      }
+      sibling = siblingNode->nextSibling;
+    }
+  }
+  node->parent = 0;
+  node->nextSibling = 0;
+}
+
+void
+ECSManager::setSubtreeDepth(Entity root, u32 depth)
+{
+  auto* node = getComponent<HierarchyComponent>(root);
+  node->depth = depth;
+  for (Entity child = node->firstChild; child != 0;) {
+    setSubtreeDepth(child, depth + 1);
+    child = getComponent<HierarchyComponent>(child)->nextSibling;
+  }
+}
+
+EntityQuery*
+ECSManager::findQuery(const Signature& signature)
+{
+  auto it = m_queries.find(signature);
+  return it != m_queries.end() ? it->second.get() : nullptr;
+}
+
+EntityQuery*
+ECSManager::registerQuery(const Signature& signature)
+{
+  auto& query = m_queries[signature];
+  query = std::make_unique<EntityQuery>(signature);
+  for (size_t idx = 0; idx < MAX_COMPONENTS; ++idx) {
+    if (signature.test(idx)) {
+      m_queriesByComponent[idx].push_back(query.get());
+    }
+  }
+  return query.get();
+}
+
+OwningGroup*
+ECSManager::findGroup(const Signature& signature)
+{
+  for (auto& group : m_groups) {
+    if (group->signature() == signature) {
+      return group.get();
+    }
+  }
+  return nullptr;
+}
+
+OwningGroup*
+ECSManager::registerGroup(const Signature& signature,
+                          std::vector<IComponentPool*> pools)
+{
+  IComponentPool* driver = pools[0];
+  auto& group =
+    m_groups.emplace_back(std::make_unique<OwningGroup>(signature, pools));
+  for (size_t idx = 0; idx < MAX_COMPONENTS; ++idx) {
+    if (signature.test(idx)) {
+      assert(!m_groupByComponent[idx] && "Pool already owned by a group");
+      m_groupByComponent[idx] = group.get();
+    }
+  }
+
+  // Pack existing members. Swapping only moves entries before i, which have
+  // already been visited, so a single pass is enough.
+  for (size_t i = 0; i < driver->size(); ++i) {
+    Entity entity = driver->entityAt(i);
+    if (group->matches(m_entityComponentMasks[entityIndex(entity)])) {
+      group->add(entity);
     }
   }
+  return group.get();
+}
 
-  // Remove the entity name
-  m_entityNames.erase(entity);
+void
+ECSManager::onComponentAdded(Entity entity, size_t typeID)
+{
+  const Signature& mask = m_entityComponentMasks[entityIndex(entity)];
+  for (EntityQuery* query : m_queriesByComponent[typeID]) {
+    if (query->matches(mask)) {
+      query->add(entity);
+    }
+  }
+  if (OwningGroup* group = m_groupByComponent[typeID];
+      group && group->matches(mask)) {
+    group->add(entity);
+  }
+}
 
-  // Add the entity ID back to the reuse pool
-  m_availableEntityIds.push(entity);
+void
+ECSManager::onComponentRemoved(Entity entity, size_t typeID)
+{
+  for (EntityQuery* query : m_queriesByComponent[typeID]) {
+    query->remove(entity);
+  }
+  if (OwningGroup* group = m_groupByComponent[typeID]) {
+    group->remove(entity);
+  }
 }
 
 // Api stuff
@@ -240,7 +462,7 @@ extern "C"
 
   void SetRotation(unsigned int entity, float angle)
   {
-    auto p = ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    auto p = ECSManager::getInstance().editComponent<PositionComponent>(entity);
     if (!p)
       return;
     p->rotation = glm::eulerAngleY(angle);
@@ -308,12 +530,13 @@ extern "C"
                             float scale[3],
                             float rot[3])
   {
-    auto& posComp =
-      ECSManager::getInstance().emplaceComponent<PositionComponent>(entity);
+    PositionComponent posComp;
     posComp.position = glm::vec3(pos[0], pos[1], pos[2]);
     posComp.scale = glm::vec3(scale[0], scale[1], scale[2]);
     posComp.rotation =
       glm::vec3(rot[0], rot[1], rot[2]); // TODO is this correct?
+    ECSManager::getInstance().emplaceComponent<PositionComponent>(entity,
+                                                                  posComp);
   }
 
   void AddPhysicsComponent(int entity, float mass, int type)
@@ -560,7 +783,7 @@ extern "C"
   // Transform API
   void GetPosition(unsigned int entity, float* outX, float* outY, float* outZ)
   {
-    auto* p = ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    auto p = ECSManager::getInstance().readComponent<PositionComponent>(entity);
     if (!p) {
       *outX = *outY = *outZ = 0.0f;
       return;
@@ -572,14 +795,15 @@ extern "C"
 
   void SetPosition(unsigned int entity, float x, float y, float z)
   {
-    auto* p = ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    auto p =
+      ECSManager::getInstance().editComponent<PositionComponent>(entity);
     if (p)
       p->position = glm::vec3(x, y, z);
   }
 
   void GetScale(unsigned int entity, float* outX, float* outY, float* outZ)
   {
-    auto* p = ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    auto p = ECSManager::getInstance().readComponent<PositionComponent>(entity);
     if (!p) {
       *outX = *outY = *outZ = 0.0f;
       return;
@@ -591,7 +815,8 @@ extern "C"
 
   void SetScale(unsigned int entity, float x, float y, float z)
   {
-    auto* p = ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    auto p =
+      ECSManager::getInstance().editComponent<PositionComponent>(entity);
     if (p)
       p->scale = glm::vec3(x, y, z);
   }
@@ -602,7 +827,7 @@ extern "C"
                        float* outZ,
                        float* outW)
   {
-    auto* p = ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    auto p = ECSManager::getInstance().readComponent<PositionComponent>(entity);
     if (!p) {
       *outX = *outY = *outZ = *outW = 0.0f;
       return;
@@ -615,11 +840,30 @@ extern "C"
 
   void SetRotationQuat(unsigned int entity, float x, float y, float z, float w)
   {
-    auto* p = ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    auto p =
+      ECSManager::getInstance().editComponent<PositionComponent>(entity);
     if (p)
       p->rotation = glm::quat(w, x, y, z);
   }
 
+  void SetParent(unsigned int child, unsigned int parent)
+  {
+    ECSManager::getInstance().setParent(child, parent);
+  }
+
+  // World position as of the last PositionSystem update, or as the current
+  // transforms give it for entities whose slot moved since
+  void GetWorldPosition(unsigned int entity,
+                        float* outX,
+                        float* outY,
+                        float* outZ)
+  {
+    glm::mat4 world = PositionSystem::getInstance().getWorldMatrix(entity);
+    *outX = world[3].x;
+    *outY = world[3].y;
+    *outZ = world[3].z;
+  }
+
   // Camera API
   void SetCameraFov(unsigned int entity, float fov)
   {
@@ -1,10 +1,16 @@
 #ifndef ECSMANAGER_H_
 #define ECSMANAGER_H_
 
-#include "ComponentPool.hpp"
+#include "ComponentTypeID.hpp"
+#include "EntityCommandBuffer.hpp"
+#include "Group.hpp"
+#include "Query.hpp"
+#include "SoAComponentPool.hpp"
+#include "SystemScheduler.hpp"
 #include "Systems/System.hpp"
 #include <SceneLoader.hpp>
 #include <Types/LightTypes.hpp>
+#include <shared_mutex>
 
 #ifndef NDEBUG
 class Profiler;
@@ -20,31 +26,71 @@ public:
   // Runs through all systems
   void update(float dt);
 
+  // Worker threads used to run non-conflicting systems concurrently; 0 runs
+  // every system serially on the calling thread
+  void setSystemWorkerCount(u32 count);
+  u32 getSystemWorkerCount() const { return m_scheduler.getWorkerCount(); }
+
   // resets ECS
   void reset();
 
-  // Destroys an entity and recycles its ID
+  // Destroys an entity and recycles its index under a new generation. Cost
+  // is proportional to the number of components the entity has.
   void destroyEntity(Entity entity);
 
+  // Deferred structural changes. Systems record into this instead of
+  // creating/destroying entities or components while pools are iterated;
+  // update() plays it back once all systems have finished.
+  EntityCommandBuffer& getCommandBuffer() { return m_commandBuffer; }
+  void flushCommandBuffer() { m_commandBuffer.playback(*this); }
+
+  // True if the handle refers to a live entity (not destroyed or recycled)
+  bool isAlive(Entity entity) const
+  {
+    u32 index = entityIndex(entity);
+    return index != 0 && index < m_entityGenerations.size() &&
+           m_entityGenerations[index] == entityGeneration(entity) &&
+           m_entityAlive[index];
+  }
+
   void updateRenderingSystems(float dt);
 
-  // creates and returns a new entity
+  // creates and returns a new entity, or 0 once every index below the
+  // entity limit is in use
   Entity createEntity(std::string name = "no_name");
 
-  // Emplace a component in-place (preferred)
+  // Lowers the number of entity indices createEntity() hands out, e.g. so
+  // tests can reach the limit cheaply. Clamped to MAX_ENTITIES; reset()
+  // restores MAX_ENTITIES.
+  void setEntityLimit(std::size_t limit)
+  {
+    m_entityLimit = std::min(limit, MAX_ENTITIES);
+  }
+
+  // Emplace a component in-place (preferred). Returns T& for AoS components
+  // and a SoARef<T> proxy for SoA ones (see ComponentStorage).
   template<typename T, typename... Args>
-  T& emplaceComponent(Entity entity, Args&&... args)
+  decltype(auto) emplaceComponent(Entity entity, Args&&... args)
   {
+    assert(isAlive(entity) && "Emplacing component on dead entity");
     u32 index = getComponentTypeID<T>();
     ensurePool<T>(index);
-    T& comp = getPool<T>(index)->emplace(entity, std::forward<Args>(args)...);
-    m_entityComponentMasks[entity].set(index);
-    return comp;
+    PoolFor<T>* pool = getPool<T>(index);
+    pool->emplace(entity, std::forward<Args>(args)...);
+    pool->markChangedAt(pool->indexOf(entity), m_changeTick);
+    m_entityComponentMasks[entityIndex(entity)].set(index);
+    onComponentAdded(entity, index);
+    // Looked up again: joining an owning group may have moved the component
+    if constexpr (ComponentStorage<T>::policy == StoragePolicy::SoA) {
+      return pool->get(entity);
+    } else {
+      return *pool->get(entity);
+    }
   }
 
   // Add a component by move
   template<typename T>
-  T& addComponent(Entity entity, T&& component)
+  decltype(auto) addComponent(Entity entity, T&& component)
   {
     return emplaceComponent<std::decay_t<T>>(entity, std::move(component));
   }
@@ -54,83 +100,182 @@ public:
   bool hasComponent(Entity entity)
   {
     std::size_t idx = getComponentTypeID<T>();
-    return m_entityComponentMasks[entity].test(idx);
+    return isAlive(entity) &&
+           m_entityComponentMasks[entityIndex(entity)].test(idx);
   }
 
+  // Remove a single component, keeping the entity alive
   template<typename T>
-  void removeEntity(Entity entityID);
-  template<typename T>
-  void removeComponent(Entity& entity, T component);
-
-  template<typename T>
-  ComponentType getComponentType()
+  void removeComponent(Entity entity)
   {
-    ComponentType type = typeid(T);
-    if (auto iter = m_componentTypeToIndex.find(type);
-        iter != m_componentTypeToIndex.end()) {
-      // T has already been registered, return it
-    } else {
-      // T has not been registered yet, assign it a new ID and return it
-      u32 next = m_nextComponentTypeID++;
-      m_componentTypeToIndex.insert({ type, next });
+    u32 index = getComponentTypeID<T>();
+    if (!hasComponent<T>(entity)) {
+      return;
     }
-    return type;
+    onComponentRemoved(entity, index);
+    m_entityComponentMasks[entityIndex(entity)].reset(index);
+    getPool<T>(index)->remove(entity);
   }
+
   template<typename T>
-  std::size_t getComponentTypeID()
+  static u32 getComponentTypeID()
   {
-    ComponentType type = getComponentType<T>();
-    return m_componentTypeToIndex[type];
+    return componentTypeID<T>();
   }
 
-  // Create a view of entities with the given component types
+  // Persistent query over entities with all of T... Registered on first use
+  // and maintained incrementally afterwards, so calling this every frame costs
+  // a signature lookup and allocates nothing. Safe to call from systems
+  // running concurrently on scheduler workers.
   template<typename... T>
-  std::vector<Entity> view()
+  QueryView<T...> query()
   {
-    Signature requiredComponents;
-    ((requiredComponents.set(getComponentTypeID<T>()), ...));
+    Signature required;
+    (required.set(getComponentTypeID<T>()), ...);
 
-    std::vector<Entity> matchingEntities;
-    matchingEntities.reserve(m_entities.size() / 2);
+    EntityQuery* q = nullptr;
+    {
+      std::shared_lock lock(m_queryMutex);
+      q = findQuery(required);
+    }
+    if (!q) {
+      std::unique_lock lock(m_queryMutex);
+      (ensurePool<T>(getComponentTypeID<T>()), ...);
+      q = findQuery(required);
+      if (!q) {
+        q = registerQuery(required);
+        populateQuery<T...>(*q);
+      }
+    }
+    return QueryView<T...>(*q, getPool<T>(getComponentTypeID<T>())...);
+  }
 
-    for (Entity entity : m_entities) {
-      if ((m_entityComponentMasks[entity] & requiredComponents) ==
-          requiredComponents) {
-        matchingEntities.push_back(entity);
+  // Owning group over T..., registered on first use. From then on entities
+  // with all of T... sit packed and in the same order at the front of every
+  // T pool, so each() is a linear walk. A pool can belong to one group only.
+  // The first call reorders the owned pools, so make it from the main thread
+  // or an exclusive system.
+  template<typename... T>
+  GroupView<T...> group()
+  {
+    Signature owned;
+    (owned.set(getComponentTypeID<T>()), ...);
+
+    OwningGroup* g = nullptr;
+    {
+      std::shared_lock lock(m_queryMutex);
+      g = findGroup(owned);
+    }
+    if (!g) {
+      std::unique_lock lock(m_queryMutex);
+      (ensurePool<T>(getComponentTypeID<T>()), ...);
+      g = findGroup(owned);
+      if (!g) {
+        g = registerGroup(owned, { getPool<T>(getComponentTypeID<T>())... });
       }
     }
+    return GroupView<T...>(*g, getPool<T>(getComponentTypeID<T>())...);
+  }
 
-    return matchingEntities;
+  // Entities with the given component types (backed by the cached query)
+  template<typename... T>
+  const std::vector<Entity>& view()
+  {
+    return query<T...>().entities();
   }
 
-  // Get the component from the pool, returns nullptr if not found
+  // Get the component from the pool, returns nullptr if not found. SoA
+  // components come back as a SoARef<T> that writes through on destruction.
   template<typename T>
-  T* getComponent(Entity entity)
+  ComponentRef<T> getComponent(Entity entity)
   {
     if (!hasComponent<T>(entity)) {
-      return nullptr;
+      return {};
     }
 
     std::size_t typeID = getComponentTypeID<T>();
 
-    if (typeID >= m_componentPools.size() || !m_componentPools[typeID]) {
-      return nullptr;
+    if (!m_componentPools[typeID]) {
+      return {};
     }
 
     return getPool<T>(typeID)->get(entity);
   }
 
+  // Read-only getComponent: const T* for AoS components, and for SoA ones a
+  // SoARef<const T> that never writes back. Systems that only read T use
+  // it, since the scheduler may run them alongside other readers of T.
+  template<typename T>
+  ConstComponentRef<T> readComponent(Entity entity)
+  {
+    if (!hasComponent<T>(entity)) {
+      return {};
+    }
+
+    std::size_t typeID = getComponentTypeID<T>();
+
+    if (!m_componentPools[typeID]) {
+      return {};
+    }
+
+    return std::as_const(*getPool<T>(typeID)).get(entity);
+  }
+
+  // Same as getComponent, but also marks the component changed. Use it for
+  // writes that consumers of changedSince()/eachChanged() need to see.
+  template<typename T>
+  ComponentRef<T> editComponent(Entity entity)
+  {
+    markChanged<T>(entity);
+    return getComponent<T>(entity);
+  }
+
+  // Stamps the entity's T with the current change tick. For writes made
+  // through references handed out by getComponent, query() or group().
+  template<typename T>
+  void markChanged(Entity entity)
+  {
+    if (!hasComponent<T>(entity)) {
+      return;
+    }
+    PoolFor<T>* pool = getPool<T>(getComponentTypeID<T>());
+    pool->markChangedAt(pool->indexOf(entity), m_changeTick);
+  }
+
+  // True if the entity's T was added or marked changed at or after `tick`
+  template<typename T>
+  bool changedSince(Entity entity, u32 tick)
+  {
+    if (!hasComponent<T>(entity)) {
+      return false;
+    }
+    PoolFor<T>* pool = getPool<T>(getComponentTypeID<T>());
+    return pool->changedSince(pool->indexOf(entity), tick);
+  }
+
+  // Advances once per update(), before systems run. A consumer remembers the
+  // tick it last ran at and asks for changes since then; writes from the
+  // rest of that frame are reported again once, never missed.
+  u32 getChangeTick() const { return m_changeTick; }
+  void advanceChangeTick() { m_changeTick++; }
+
   // Get a typed pool for direct iteration
   template<typename T>
-  ComponentPool<T>* getPool()
+  PoolFor<T>* getPool()
   {
     u32 index = getComponentTypeID<T>();
-    if (index >= m_componentPools.size() || !m_componentPools[index]) {
+    if (!m_componentPools[index]) {
       return nullptr;
     }
     return getPool<T>(index);
   }
 
+  // Makes `parent` the parent of `child`, or detaches `child` with parent 0.
+  // Adds HierarchyComponents as needed. The child's PositionComponent is
+  // read as relative to the parent from then on. Ignored if it would make a
+  // cycle. Destroying a parent leaves its children in place as roots.
+  void setParent(Entity child, Entity parent);
+
   // Create point light
   std::shared_ptr<PointLight> setupPointLight(Entity entity,
                                               glm::vec3 color,
@@ -151,24 +296,26 @@ public:
   const std::vector<Entity>& getEntities() const { return m_entities; }
   std::string_view getEntityName(Entity entity) const
   {
-    auto it = m_entityNames.find(entity);
-    if (it != m_entityNames.end())
-      return it->second;
-    return {};
+    if (!isAlive(entity))
+      return {};
+    return m_entityNames[entityIndex(entity)];
   }
   bool getSimulatePhysics() const { return m_simulatePhysics; }
   bool getRenderGraphics() const { return m_renderGraphics; }
   i32 getDebugView() const { return m_debugView; }
+  bool getCompactGBuffer() const { return m_compactGBuffer; }
 
   // Mutable refs for ImGui widget binding
   bool& refSimulatePhysics() { return m_simulatePhysics; }
   i32& refDebugView() { return m_debugView; }
+  bool& refCompactGBuffer() { return m_compactGBuffer; }
 
   void setViewport(u32 width, u32 height);
   void setPickedEntity(Entity entity) { m_pickedEntity = entity; }
   void setEntitySelected(bool sel) { m_entitySelected = sel; }
   void setSimulatePhysics(bool sim) { m_simulatePhysics = sim; }
   void setRenderGraphics(bool sim) { m_renderGraphics = sim; }
+  void setCompactGBuffer(bool compact) { m_compactGBuffer = compact; }
 
   glm::vec3 dDir;
 
@@ -179,46 +326,99 @@ private:
   template<typename T>
   void ensurePool(u32 index)
   {
-    if (m_componentPools.size() <= index) {
-      m_componentPools.resize(index + 1);
-    }
     if (!m_componentPools[index]) {
-      m_componentPools[index] = std::make_unique<ComponentPool<T>>();
+      m_componentPools[index] = std::make_unique<PoolFor<T>>();
     }
   }
 
   template<typename T>
-  ComponentPool<T>* getPool(u32 index)
+  PoolFor<T>* getPool(u32 index)
   {
-    return static_cast<ComponentPool<T>*>(m_componentPools[index].get());
+    return static_cast<PoolFor<T>*>(m_componentPools[index].get());
+  }
+
+  EntityQuery* findQuery(const Signature& signature);
+  EntityQuery* registerQuery(const Signature& signature);
+  OwningGroup* findGroup(const Signature& signature);
+  OwningGroup* registerGroup(const Signature& signature,
+                             std::vector<IComponentPool*> pools);
+  void unlinkFromParent(Entity entity);
+  void setSubtreeDepth(Entity root, u32 depth);
+  void onComponentAdded(Entity entity, size_t typeID);
+  void onComponentRemoved(Entity entity, size_t typeID);
+
+  // Initial fill of a new query: walk the smallest pool involved and test
+  // masks, instead of scanning every live entity.
+  template<typename... T>
+  void populateQuery(EntityQuery& q)
+  {
+    std::array<IComponentPool*, sizeof...(T)> pools = {
+      getPool<T>(getComponentTypeID<T>())...
+    };
+    std::array<size_t, sizeof...(T)> sizes = {
+      getPool<T>(getComponentTypeID<T>())->size()...
+    };
+    size_t smallest = static_cast<size_t>(
+      std::ranges::min_element(sizes) - sizes.begin());
+
+    IComponentPool* driver = pools[smallest];
+    for (size_t i = 0; i < driver->size(); ++i) {
+      Entity entity = driver->entityAt(i);
+      if (q.matches(m_entityComponentMasks[entityIndex(entity)])) {
+        q.add(entity);
+      }
+    }
   }
 
   // Entities
   std::vector<Entity> m_entities;
-  std::map<Entity, std::string> m_entityNames;
   std::vector<System*> m_systemUpdateOrder;
   std::unordered_map<std::string, System*> m_systems;
+  SystemScheduler m_scheduler;
+  static constexpr u32 kDefaultSystemWorkers = 2;
+
+  // Component pools - one pool per component type. Fixed size so creating a
+  // pool never moves the others while systems are reading them.
+  std::array<std::unique_ptr<IComponentPool>, MAX_COMPONENTS> m_componentPools;
+
+  // Cached queries, keyed by signature, plus the queries each component type
+  // participates in so mask changes only touch the queries that care.
+  // m_queryMutex guards query and group registration against concurrent
+  // lookups.
+  std::unordered_map<Signature, std::unique_ptr<EntityQuery>> m_queries;
+  std::array<std::vector<EntityQuery*>, MAX_COMPONENTS> m_queriesByComponent;
+  std::shared_mutex m_queryMutex;
+
+  // Owning groups, plus the group (if any) that owns each component's pool
+  std::vector<std::unique_ptr<OwningGroup>> m_groups;
+  std::array<OwningGroup*, MAX_COMPONENTS> m_groupByComponent{};
+
+  // Per entity index: component mask, current generation, liveness, name
+  // and position in m_entities (for O(1) removal). Grown on demand in
+  // createEntity; index 0 is reserved as invalid.
+  std::vector<Signature> m_entityComponentMasks{ Signature{} };
+  std::vector<u32> m_entityGenerations{ 0u };
+  std::vector<bool> m_entityAlive{ false };
+  std::vector<std::string> m_entityNames{ std::string{} };
+  std::vector<u32> m_entityDenseIndex{ 0u };
+  std::size_t m_entityLimit{ MAX_ENTITIES };
+
+  EntityCommandBuffer m_commandBuffer;
+
+  // Current change tick, see getChangeTick(). Not reset with the scene so
+  // consumers holding an older tick still see everything loaded after.
+  u32 m_changeTick{ 1 };
 
-  // Component pools - one pool per component type
-  std::vector<std::unique_ptr<IComponentPool>> m_componentPools;
-
-  // Maps component types to their indices
-  std::unordered_map<ComponentType, size_t> m_componentTypeToIndex;
-
-  // Tracks which components each entity has
-  std::array<Signature, MAX_ENTITIES> m_entityComponentMasks;
-
-  size_t m_entityCount{ 1 };
-  size_t m_nextComponentTypeID{ 0 };
   Entity m_pickedEntity{ 0 };
   bool m_entitySelected{ false };
   Entity m_dirLightEntity{ 0 };
   bool m_simulatePhysics{ false };
   bool m_renderGraphics{ false };
   i32 m_debugView{ 0 };
+  bool m_compactGBuffer{ false };
 
-  // Entity ID reuse system
-  std::queue<Entity> m_availableEntityIds;
+  // Free entity indices, reused FIFO with a bumped generation
+  std::queue<u32> m_availableEntityIndices;
 
 #ifndef NDEBUG
   Profiler* m_profiler{ nullptr };
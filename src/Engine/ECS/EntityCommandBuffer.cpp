@@ -0,0 +1,47 @@
+#include "EntityCommandBuffer.hpp"
+#include "ECSManager.hpp"
+
+void
+EntityCommandBuffer::playback(ECSManager& ecs)
+{
+  std::vector<Command> commands;
+  std::vector<std::string> names;
+  {
+    std::lock_guard lock(m_mutex);
+    commands.swap(m_commands);
+    names.swap(m_pendingNames);
+  }
+
+  m_createdEntities.assign(names.size(), 0);
+  for (Command& command : commands) {
+    switch (command.kind) {
+      case Kind::Create:
+        m_createdEntities[command.slot] =
+          ecs.createEntity(std::move(names[command.slot]));
+        break;
+      case Kind::Destroy:
+        ecs.destroyEntity(command.entity);
+        break;
+      case Kind::Apply:
+        // The entity may have been destroyed since the command was recorded
+        if (ecs.isAlive(command.entity)) {
+          command.fn(ecs, command.entity);
+        }
+        break;
+      case Kind::ApplyPending: {
+        Entity entity = m_createdEntities[command.slot];
+        if (ecs.isAlive(entity)) {
+          command.fn(ecs, entity);
+        }
+        break;
+      }
+    }
+  }
+
+  // Hand the (now empty) storage back so recording does not reallocate
+  commands.clear();
+  std::lock_guard lock(m_mutex);
+  if (m_commands.empty()) {
+    m_commands.swap(commands);
+  }
+}
@@ -0,0 +1,124 @@
+#ifndef ENTITYCOMMANDBUFFER_H_
+#define ENTITYCOMMANDBUFFER_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ECSManager;
+
+// Records structural changes (create/destroy entities, add/remove components)
+// so systems can request them while pools are being iterated, possibly from
+// several scheduler workers at once. ECSManager plays the commands back in
+// record order at the end of update(), after every system has finished.
+class EntityCommandBuffer
+{
+public:
+  // Stand-in for an entity that only exists once the buffer is played back.
+  // Components can be queued on it like on a regular entity.
+  struct PendingEntity
+  {
+    u32 slot;
+  };
+
+  PendingEntity createEntity(std::string name = "no_name")
+  {
+    std::lock_guard lock(m_mutex);
+    u32 slot = static_cast<u32>(m_pendingNames.size());
+    m_pendingNames.push_back(std::move(name));
+    m_commands.push_back({ Kind::Create, 0, slot, {} });
+    return { slot };
+  }
+
+  void destroyEntity(Entity entity)
+  {
+    std::lock_guard lock(m_mutex);
+    m_commands.push_back({ Kind::Destroy, entity, 0, {} });
+  }
+
+  // The component is constructed now and moved into its pool at playback
+  template<typename T, typename... Args>
+  void emplaceComponent(Entity entity, Args&&... args)
+  {
+    record(Kind::Apply, entity, 0, makeAdd<T>(std::forward<Args>(args)...));
+  }
+
+  template<typename T, typename... Args>
+  void emplaceComponent(PendingEntity entity, Args&&... args)
+  {
+    record(Kind::ApplyPending,
+           0,
+           entity.slot,
+           makeAdd<T>(std::forward<Args>(args)...));
+  }
+
+  template<typename T>
+  void removeComponent(Entity entity)
+  {
+    record(Kind::Apply, entity, 0, [](auto& ecs, Entity target) {
+      ecs.template removeComponent<T>(target);
+    });
+  }
+
+  bool empty() const
+  {
+    std::lock_guard lock(m_mutex);
+    return m_commands.empty();
+  }
+
+  // Drops all recorded commands without applying them
+  void clear()
+  {
+    std::lock_guard lock(m_mutex);
+    m_commands.clear();
+    m_pendingNames.clear();
+  }
+
+  // Applies and clears all recorded commands. Must not run concurrently with
+  // systems; commands recorded during playback are kept for the next one.
+  void playback(ECSManager& ecs);
+
+private:
+  enum class Kind : u8
+  {
+    Create,
+    Destroy,
+    Apply,       // fn on an existing entity
+    ApplyPending // fn on an entity created earlier in this buffer
+  };
+
+  using Fn = std::function<void(ECSManager&, Entity)>;
+
+  struct Command
+  {
+    Kind kind;
+    Entity entity;
+    u32 slot;
+    Fn fn;
+  };
+
+  template<typename T, typename... Args>
+  static Fn makeAdd(Args&&... args)
+  {
+    // std::function needs a copyable callable, so the component is shared
+    auto component = std::make_shared<T>(std::forward<Args>(args)...);
+    return [component](auto& ecs, Entity target) {
+      ecs.template addComponent<T>(target, std::move(*component));
+    };
+  }
+
+  void record(Kind kind, Entity entity, u32 slot, Fn fn)
+  {
+    std::lock_guard lock(m_mutex);
+    m_commands.push_back({ kind, entity, slot, std::move(fn) });
+  }
+
+  mutable std::mutex m_mutex;
+  std::vector<Command> m_commands;
+  std::vector<std::string> m_pendingNames;
+  std::vector<Entity> m_createdEntities; // Pending slot -> real entity
+};
+
+#endif // ENTITYCOMMANDBUFFER_H_
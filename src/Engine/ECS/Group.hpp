@@ -0,0 +1,116 @@
+#ifndef GROUP_H_
+#define GROUP_H_
+
+#include "SoAComponentPool.hpp"
+#include <tuple>
+#include <vector>
+
+// Owning group: every entity that has all of the group's components is kept
+// at the front of each owned pool, at the same dense index in all of them.
+// Iterating the group is then a linear walk over parallel arrays instead of
+// a sparse lookup per component. A pool can be owned by one group only.
+class OwningGroup
+{
+public:
+  OwningGroup(Signature signature, std::vector<IComponentPool*> pools)
+    : m_signature(signature)
+    , m_pools(std::move(pools))
+  {
+  }
+
+  [[nodiscard]] const Signature& signature() const { return m_signature; }
+  [[nodiscard]] bool matches(const Signature& mask) const
+  {
+    return (mask & m_signature) == m_signature;
+  }
+  [[nodiscard]] size_t size() const { return m_size; }
+
+  [[nodiscard]] bool contains(Entity entity) const
+  {
+    return m_pools[0]->indexOf(entity) < m_size;
+  }
+
+  // Entity just completed the set: swap it to the end of the packed prefix
+  void add(Entity entity)
+  {
+    if (contains(entity))
+      return;
+    for (IComponentPool* pool : m_pools) {
+      pool->swapEntries(pool->indexOf(entity), m_size);
+    }
+    ++m_size;
+  }
+
+  // Entity is about to lose an owned component: swap it out of the prefix.
+  // The pool's swap-and-pop then only moves entries outside the group.
+  void remove(Entity entity)
+  {
+    if (!contains(entity))
+      return;
+    --m_size;
+    for (IComponentPool* pool : m_pools) {
+      pool->swapEntries(pool->indexOf(entity), m_size);
+    }
+  }
+
+  void clear() { m_size = 0; }
+
+private:
+  Signature m_signature;
+  std::vector<IComponentPool*> m_pools;
+  size_t m_size{ 0 };
+};
+
+// Typed handle to an OwningGroup, see QueryView
+template<typename... T>
+class GroupView
+{
+public:
+  GroupView(const OwningGroup& group, PoolFor<T>*... pools)
+    : m_group(&group)
+    , m_pools(pools...)
+  {
+  }
+
+  // Calls fn(Entity, T&...) for every entity in the group. Structural
+  // changes must not be made from inside fn.
+  template<typename Fn>
+  void each(Fn&& fn) const
+  {
+    auto* first = std::get<0>(m_pools);
+    for (size_t i = 0; i < m_group->size(); ++i) {
+      fn(first->entityAt(i), *std::get<PoolFor<T>*>(m_pools)->at(i)...);
+    }
+  }
+
+  // Like each(), restricted to entities where any of T... was added or
+  // marked changed at or after `sinceTick`. Slots are aligned, so this only
+  // reads each pool's version array.
+  template<typename Fn>
+  void eachChanged(u32 sinceTick, Fn&& fn) const
+  {
+    auto* first = std::get<0>(m_pools);
+    for (size_t i = 0; i < m_group->size(); ++i) {
+      if ((std::get<PoolFor<T>*>(m_pools)->changedSince(i, sinceTick) ||
+           ...)) {
+        fn(first->entityAt(i), *std::get<PoolFor<T>*>(m_pools)->at(i)...);
+      }
+    }
+  }
+
+  [[nodiscard]] size_t size() const { return m_group->size(); }
+  [[nodiscard]] bool empty() const { return m_group->size() == 0; }
+
+  // Owned pool for T; its entries past size() are outside the group
+  template<typename U>
+  PoolFor<U>& pool() const
+  {
+    return *std::get<PoolFor<U>*>(m_pools);
+  }
+
+private:
+  const OwningGroup* m_group;
+  std::tuple<PoolFor<T>*...> m_pools;
+};
+
+#endif // GROUP_H_
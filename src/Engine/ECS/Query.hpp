@@ -0,0 +1,135 @@
+#ifndef QUERY_H_
+#define QUERY_H_
+
+#include "SoAComponentPool.hpp"
+#include <limits>
+#include <tuple>
+#include <vector>
+
+// Persistent set of entities matching a component signature. Registered once
+// per component set by ECSManager and kept up to date incrementally whenever
+// an entity's mask changes, so reading it never rescans the entity list.
+class EntityQuery
+{
+  static constexpr u32 INVALID = std::numeric_limits<u32>::max();
+
+public:
+  explicit EntityQuery(Signature signature)
+    : m_signature(signature)
+  {
+  }
+
+  [[nodiscard]] const Signature& signature() const { return m_signature; }
+  [[nodiscard]] bool matches(const Signature& mask) const
+  {
+    return (mask & m_signature) == m_signature;
+  }
+
+  [[nodiscard]] bool contains(Entity entity) const
+  {
+    u32 index = entityIndex(entity);
+    return index < m_entityToIndex.size() &&
+           m_entityToIndex[index] != INVALID &&
+           m_entities[m_entityToIndex[index]] == entity;
+  }
+
+  void add(Entity entity)
+  {
+    if (contains(entity))
+      return;
+    u32 index = entityIndex(entity);
+    if (index >= m_entityToIndex.size()) {
+      m_entityToIndex.resize(index + 1, INVALID);
+    }
+    m_entityToIndex[index] = static_cast<u32>(m_entities.size());
+    m_entities.push_back(entity);
+  }
+
+  // Swap-and-pop removal, same as ComponentPool
+  void remove(Entity entity)
+  {
+    if (!contains(entity))
+      return;
+    u32 removedIndex = m_entityToIndex[entityIndex(entity)];
+    Entity lastEntity = m_entities.back();
+    m_entities[removedIndex] = lastEntity;
+    m_entityToIndex[entityIndex(lastEntity)] = removedIndex;
+    m_entities.pop_back();
+    m_entityToIndex[entityIndex(entity)] = INVALID;
+  }
+
+  // Drops all members but keeps capacity so refilling does not allocate
+  void clear()
+  {
+    m_entities.clear();
+    std::fill(m_entityToIndex.begin(), m_entityToIndex.end(), INVALID);
+  }
+
+  [[nodiscard]] const std::vector<Entity>& entities() const
+  {
+    return m_entities;
+  }
+
+private:
+  Signature m_signature;
+  std::vector<Entity> m_entities;    // Matching entities, densely packed
+  std::vector<u32> m_entityToIndex;  // Entity index -> index in m_entities
+};
+
+// Typed, non-owning handle to an EntityQuery. Cheap to construct every frame:
+// it only holds the query and the pools of T..., so each() hands out component
+// references without going through ECSManager::getComponent per entity.
+template<typename... T>
+class QueryView
+{
+public:
+  QueryView(const EntityQuery& query, PoolFor<T>*... pools)
+    : m_query(&query)
+    , m_pools(pools...)
+  {
+  }
+
+  // Calls fn(Entity, T&...) for every matching entity. Structural changes
+  // (emplace/remove/destroy) must not be made from inside fn.
+  template<typename Fn>
+  void each(Fn&& fn) const
+  {
+    for (Entity entity : m_query->entities()) {
+      fn(entity, *std::get<PoolFor<T>*>(m_pools)->get(entity)...);
+    }
+  }
+
+  // Like each(), restricted to entities where any of T... was added or
+  // marked changed at or after `sinceTick` (see ECSManager::getChangeTick)
+  template<typename Fn>
+  void eachChanged(u32 sinceTick, Fn&& fn) const
+  {
+    for (Entity entity : m_query->entities()) {
+      if (changedSince(entity, sinceTick)) {
+        fn(entity, *std::get<PoolFor<T>*>(m_pools)->get(entity)...);
+      }
+    }
+  }
+
+  [[nodiscard]] const std::vector<Entity>& entities() const
+  {
+    return m_query->entities();
+  }
+  [[nodiscard]] size_t size() const { return m_query->entities().size(); }
+  [[nodiscard]] bool empty() const { return m_query->entities().empty(); }
+  auto begin() const { return m_query->entities().begin(); }
+  auto end() const { return m_query->entities().end(); }
+
+private:
+  bool changedSince(Entity entity, u32 tick) const
+  {
+    return (std::get<PoolFor<T>*>(m_pools)->changedSince(
+              std::get<PoolFor<T>*>(m_pools)->indexOf(entity), tick) ||
+            ...);
+  }
+
+  const EntityQuery* m_query;
+  std::tuple<PoolFor<T>*...> m_pools;
+};
+
+#endif // QUERY_H_
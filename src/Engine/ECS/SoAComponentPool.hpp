@@ -0,0 +1,253 @@
+#ifndef SOACOMPONENTPOOL_H_
+#define SOACOMPONENTPOOL_H_
+
+#include "ComponentPool.hpp"
+#include "ComponentStorage.hpp"
+#include "SoALayout.hpp"
+#include <span>
+#include <type_traits>
+#include <utility>
+
+template<typename T>
+class SoAComponentPool;
+
+// Proxy returned by SoAComponentPool::get. Gathers the component from its
+// streams on construction and scatters it back on destruction, so code
+// written against T* (`comp->position.x = 1`) keeps working. SoARef<const T>,
+// from a const pool, never writes back, so readers running side by side do
+// not store to the streams. Do not hold on to either across structural
+// changes.
+template<typename T>
+class SoARef
+{
+  using Value = std::remove_const_t<T>;
+  using Pool = std::conditional_t<std::is_const_v<T>,
+                                  const SoAComponentPool<Value>,
+                                  SoAComponentPool<Value>>;
+
+public:
+  SoARef() = default;
+  SoARef(Pool* pool, size_t index)
+    : m_pool(pool)
+    , m_index(index)
+  {
+    m_pool->load(m_value, m_index);
+  }
+  ~SoARef()
+  {
+    if constexpr (!std::is_const_v<T>) {
+      if (m_pool) {
+        m_pool->store(m_value, m_index);
+      }
+    }
+  }
+
+  SoARef(SoARef&& other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr))
+    , m_index(other.m_index)
+    , m_value(std::move(other.m_value))
+  {
+  }
+  SoARef(const SoARef&) = delete;
+  SoARef& operator=(const SoARef&) = delete;
+  SoARef& operator=(SoARef&&) = delete;
+
+  explicit operator bool() const { return m_pool != nullptr; }
+  bool operator==(std::nullptr_t) const { return m_pool == nullptr; }
+
+  T* operator->() { return &m_value; }
+  T& operator*() { return m_value; }
+
+private:
+  Pool* m_pool{ nullptr };
+  size_t m_index{ 0 };
+  Value m_value{};
+};
+
+// Structure-of-arrays pool: one AlignedStream per SoALayout<T>::Stream, all
+// indexed by the same dense index. Entity bookkeeping matches ComponentPool.
+// Batch kernels work on stream() spans directly; per-entity access goes
+// through SoARef.
+template<typename T>
+class SoAComponentPool : public IComponentPool
+{
+  using Layout = SoALayout<T>;
+  static constexpr u32 INVALID = SparseIndex::INVALID;
+  static constexpr size_t kStreams = Layout::Count;
+
+public:
+  template<typename... Args>
+  SoARef<T> emplace(Entity entity, Args&&... args)
+  {
+    u32 index = entityIndex(entity);
+    assert(index < MAX_ENTITIES && "Entity out of range");
+    u32& slot = m_sparse.slot(index);
+    assert(slot == INVALID && "Component already exists");
+
+    size_t dense = m_indexToEntity.size();
+    if (dense + 1 > m_streams[0].capacity()) {
+      size_t capacity = std::max<size_t>(AlignedStream::kLaneWidth * 8,
+                                         m_streams[0].capacity() * 2);
+      for (auto& stream : m_streams) {
+        stream.reserve(capacity, dense);
+      }
+    }
+    slot = static_cast<u32>(dense);
+    m_indexToEntity.push_back(entity);
+    m_versions.push_back(0);
+    store(T(std::forward<Args>(args)...), dense);
+
+    return SoARef<T>(this, dense);
+  }
+
+  // Swap-and-pop removal, applied to every stream
+  void remove(Entity entity)
+  {
+    u32 removedIndex = denseIndex(entity);
+    if (removedIndex == INVALID)
+      return;
+
+    u32 lastIndex = static_cast<u32>(m_indexToEntity.size() - 1);
+    if (removedIndex != lastIndex) {
+      Entity lastEntity = m_indexToEntity[lastIndex];
+      for (auto& stream : m_streams) {
+        stream.data()[removedIndex] = stream.data()[lastIndex];
+      }
+      m_indexToEntity[removedIndex] = lastEntity;
+      m_versions[removedIndex] = m_versions[lastIndex];
+      m_sparse.slot(entityIndex(lastEntity)) = removedIndex;
+    }
+    // Keep the padding lanes zeroed
+    for (auto& stream : m_streams) {
+      stream.data()[lastIndex] = 0.0f;
+    }
+
+    m_indexToEntity.pop_back();
+    m_versions.pop_back();
+    m_sparse.slot(entityIndex(entity)) = INVALID;
+  }
+
+  SoARef<T> get(Entity entity)
+  {
+    u32 index = denseIndex(entity);
+    if (index == INVALID)
+      return {};
+    return SoARef<T>(this, index);
+  }
+  SoARef<const T> get(Entity entity) const
+  {
+    u32 index = denseIndex(entity);
+    if (index == INVALID)
+      return {};
+    return SoARef<const T>(this, index);
+  }
+
+  bool has(Entity entity) const { return denseIndex(entity) != INVALID; }
+
+  size_t indexOf(Entity entity) const override
+  {
+    u32 index = denseIndex(entity);
+    return index == INVALID ? m_indexToEntity.size() : index;
+  }
+
+  void swapEntries(size_t a, size_t b) override
+  {
+    if (a == b)
+      return;
+    for (auto& stream : m_streams) {
+      std::swap(stream.data()[a], stream.data()[b]);
+    }
+    std::swap(m_indexToEntity[a], m_indexToEntity[b]);
+    std::swap(m_versions[a], m_versions[b]);
+    m_sparse.slot(entityIndex(m_indexToEntity[a])) = static_cast<u32>(a);
+    m_sparse.slot(entityIndex(m_indexToEntity[b])) = static_cast<u32>(b);
+  }
+
+  void entityDestroyed(Entity entity) override { remove(entity); }
+
+  void clear() override
+  {
+    for (auto& stream : m_streams) {
+      if (stream.data()) {
+        std::memset(stream.data(), 0, stream.capacity() * sizeof(float));
+      }
+    }
+    m_indexToEntity.clear();
+    m_versions.clear();
+    m_sparse.clear();
+  }
+
+  size_t size() const override { return m_indexToEntity.size(); }
+  // size() rounded up to whole SIMD lanes; streams are valid up to here
+  size_t paddedSize() const { return AlignedStream::padded(size()); }
+  Entity entityAt(size_t index) const override
+  {
+    return m_indexToEntity[index];
+  }
+  SoARef<T> at(size_t index) { return SoARef<T>(this, index); }
+  SoARef<T> operator[](size_t index) { return at(index); }
+
+  // Typed span over one field for batch kernels, e.g.
+  // pool.stream(SoALayout<PositionComponent>::PosX)
+  std::span<float> stream(typename Layout::Stream s)
+  {
+    return { m_streams[s].data(), size() };
+  }
+  std::span<const float> stream(typename Layout::Stream s) const
+  {
+    return { m_streams[s].data(), size() };
+  }
+  // Same stream including its padding lanes
+  std::span<float> paddedStream(typename Layout::Stream s)
+  {
+    return { m_streams[s].data(), paddedSize() };
+  }
+
+  void load(T& component, size_t index) const
+  {
+    std::array<const float*, kStreams> streams;
+    for (size_t s = 0; s < kStreams; ++s) {
+      streams[s] = m_streams[s].data();
+    }
+    Layout::load(component, streams.data(), index);
+  }
+
+  void store(const T& component, size_t index)
+  {
+    std::array<float*, kStreams> streams;
+    for (size_t s = 0; s < kStreams; ++s) {
+      streams[s] = m_streams[s].data();
+    }
+    Layout::store(component, streams.data(), index);
+  }
+
+private:
+  u32 denseIndex(Entity entity) const
+  {
+    u32 dense = m_sparse.find(entityIndex(entity));
+    if (dense == INVALID || m_indexToEntity[dense] != entity)
+      return INVALID;
+    return dense;
+  }
+
+  std::array<AlignedStream, kStreams> m_streams;
+  std::vector<Entity> m_indexToEntity; // Dense index -> entity handle
+  SparseIndex m_sparse;                // Entity index -> dense index
+};
+
+// Pool type ECSManager uses for T, chosen by ComponentStorage<T>::policy
+template<typename T>
+using PoolFor = std::conditional_t<ComponentStorage<T>::policy ==
+                                     StoragePolicy::SoA,
+                                   SoAComponentPool<T>,
+                                   ComponentPool<T>>;
+
+// What getComponent<T> hands out: T* for AoS pools, SoARef<T> for SoA
+template<typename T>
+using ComponentRef = decltype(std::declval<PoolFor<T>&>().get(Entity{}));
+// Read-only counterpart: const T* for AoS pools, SoARef<const T> for SoA
+template<typename T>
+using ConstComponentRef =
+  decltype(std::declval<const PoolFor<T>&>().get(Entity{}));
+
+#endif // SOACOMPONENTPOOL_H_
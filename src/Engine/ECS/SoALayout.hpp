@@ -0,0 +1,62 @@
+#ifndef SOALAYOUT_H_
+#define SOALAYOUT_H_
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+// Float stream aligned to, and padded out to, a whole number of SIMD lanes.
+// Padding lanes are kept at zero so kernels can process full lanes past the
+// last element without a scalar tail.
+class AlignedStream
+{
+public:
+  static constexpr size_t kAlignment = 32; // AVX / 2x SSE / 2x WASM SIMD128
+  static constexpr size_t kLaneWidth = kAlignment / sizeof(float);
+
+  static size_t padded(size_t count)
+  {
+    return (count + kLaneWidth - 1) / kLaneWidth * kLaneWidth;
+  }
+
+  float* data() { return m_data.get(); }
+  const float* data() const { return m_data.get(); }
+  size_t capacity() const { return m_capacity; }
+
+  // Reallocates to hold at least `count` floats, preserving the first `keep`
+  void reserve(size_t count, size_t keep)
+  {
+    size_t capacity = padded(count);
+    if (capacity <= m_capacity)
+      return;
+    Storage grown(static_cast<float*>(
+      std::aligned_alloc(kAlignment, capacity * sizeof(float))));
+    std::memset(grown.get(), 0, capacity * sizeof(float));
+    if (keep > 0) {
+      std::memcpy(grown.get(), m_data.get(), keep * sizeof(float));
+    }
+    m_data = std::move(grown);
+    m_capacity = capacity;
+  }
+
+private:
+  struct Free
+  {
+    void operator()(float* ptr) const { std::free(ptr); }
+  };
+  using Storage = std::unique_ptr<float[], Free>;
+
+  Storage m_data;
+  size_t m_capacity{ 0 };
+};
+
+// Describes how a component splits into float streams, for
+// SoAComponentPool<T> and for batch kernels that gather components into
+// AlignedStreams. A specialization provides:
+//   enum Stream : u32 { ..., Count };
+//   static void store(const T& c, float* const* streams, size_t i);
+//   static void load(T& c, const float* const* streams, size_t i);
+template<typename T>
+struct SoALayout;
+
+#endif // SOALAYOUT_H_
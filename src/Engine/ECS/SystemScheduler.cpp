@@ -0,0 +1,165 @@
+#include "SystemScheduler.hpp"
+#include "Systems/System.hpp"
+#include <chrono>
+
+SystemScheduler::~SystemScheduler()
+{
+  stopWorkers();
+}
+
+void
+SystemScheduler::build(const std::vector<System*>& systems)
+{
+  m_nodes.clear();
+  m_nodes.resize(systems.size());
+  m_durationsMs.assign(systems.size(), 0.0f);
+
+  std::vector<SystemAccess> access;
+  access.reserve(systems.size());
+  for (System* system : systems) {
+    access.push_back(system->getAccess());
+  }
+
+  for (u32 i = 0; i < systems.size(); ++i) {
+    m_nodes[i].system = systems[i];
+    m_nodes[i].mainThread = access[i].mainThread;
+    for (u32 j = 0; j < i; ++j) {
+      if (access[i].conflictsWith(access[j])) {
+        m_nodes[j].dependents.push_back(i);
+        m_nodes[i].dependencyCount++;
+      }
+    }
+  }
+}
+
+void
+SystemScheduler::setWorkerCount(u32 count)
+{
+#ifdef EMSCRIPTEN
+  // No pthreads in the web build
+  count = 0;
+#endif
+  if (count == m_workers.size()) {
+    return;
+  }
+
+  stopWorkers();
+  m_stopping = false;
+  m_workers.reserve(count);
+  for (u32 i = 0; i < count; ++i) {
+    m_workers.emplace_back([this] { workerLoop(); });
+  }
+}
+
+void
+SystemScheduler::run(float dt)
+{
+  m_dt = dt;
+  if (m_workers.empty()) {
+    for (u32 i = 0; i < m_nodes.size(); ++i) {
+      runNode(i);
+    }
+    return;
+  }
+
+  std::unique_lock lock(m_mutex);
+  m_remaining = m_nodes.size();
+  for (u32 i = 0; i < m_nodes.size(); ++i) {
+    m_nodes[i].pending = m_nodes[i].dependencyCount;
+    if (m_nodes[i].pending == 0) {
+      enqueue(i);
+    }
+  }
+  m_workReady.notify_all();
+
+  // The caller owns main-thread systems and helps with the rest while waiting
+  while (m_remaining > 0) {
+    std::queue<u32>* source = !m_mainQueue.empty()     ? &m_mainQueue
+                              : !m_workerQueue.empty() ? &m_workerQueue
+                                                       : nullptr;
+    if (!source) {
+      m_progress.wait(lock);
+      continue;
+    }
+    u32 index = source->front();
+    source->pop();
+
+    lock.unlock();
+    runNode(index);
+    lock.lock();
+    complete(index);
+  }
+}
+
+void
+SystemScheduler::runNode(u32 index)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  m_nodes[index].system->update(m_dt);
+  auto end = std::chrono::high_resolution_clock::now();
+  m_durationsMs[index] =
+    std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void
+SystemScheduler::enqueue(u32 index)
+{
+  if (m_nodes[index].mainThread) {
+    m_mainQueue.push(index);
+  } else {
+    m_workerQueue.push(index);
+  }
+}
+
+// Called with m_mutex held
+void
+SystemScheduler::complete(u32 index)
+{
+  bool workQueued = false;
+  for (u32 dependent : m_nodes[index].dependents) {
+    if (--m_nodes[dependent].pending == 0) {
+      enqueue(dependent);
+      workQueued |= !m_nodes[dependent].mainThread;
+    }
+  }
+  m_remaining--;
+
+  if (workQueued) {
+    m_workReady.notify_all();
+  }
+  m_progress.notify_one();
+}
+
+void
+SystemScheduler::workerLoop()
+{
+  std::unique_lock lock(m_mutex);
+  while (true) {
+    m_workReady.wait(lock,
+                     [this] { return m_stopping || !m_workerQueue.empty(); });
+    if (m_stopping) {
+      return;
+    }
+    u32 index = m_workerQueue.front();
+    m_workerQueue.pop();
+
+    lock.unlock();
+    runNode(index);
+    lock.lock();
+    complete(index);
+  }
+}
+
+void
+SystemScheduler::stopWorkers()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_stopping = true;
+  }
+  m_workReady.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+  m_workers.clear();
+}
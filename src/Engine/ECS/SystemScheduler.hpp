@@ -0,0 +1,71 @@
+#ifndef SYSTEMSCHEDULER_H_
+#define SYSTEMSCHEDULER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class System;
+
+// Runs a list of systems once per frame as a task graph. Each system depends
+// on every earlier system in the list whose SystemAccess conflicts with its
+// own, so the result matches running the list serially while independent
+// systems (e.g. particles, animation, audio) overlap on worker threads.
+// Main-thread systems are only ever picked up by the thread calling run().
+class SystemScheduler
+{
+public:
+  SystemScheduler() = default;
+  ~SystemScheduler();
+
+  SystemScheduler(const SystemScheduler&) = delete;
+  SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+  // Builds the dependency graph from the systems' declared access
+  void build(const std::vector<System*>& systems);
+
+  // Number of worker threads; 0 runs every system serially on the caller
+  void setWorkerCount(u32 count);
+  u32 getWorkerCount() const { return static_cast<u32>(m_workers.size()); }
+
+  // Runs every system once and returns when all have finished. Systems must
+  // not create/destroy entities or add/remove components while running.
+  void run(float dt);
+
+  // Wall time of each system's last update, indexed like build()'s list
+  const std::vector<float>& getDurationsMs() const { return m_durationsMs; }
+
+private:
+  struct Node
+  {
+    System* system{ nullptr };
+    bool mainThread{ false };
+    u32 dependencyCount{ 0 };
+    u32 pending{ 0 }; // Unfinished dependencies this frame
+    std::vector<u32> dependents;
+  };
+
+  void runNode(u32 index);
+  void enqueue(u32 index);
+  void complete(u32 index);
+  void workerLoop();
+  void stopWorkers();
+
+  std::vector<Node> m_nodes;
+  std::vector<float> m_durationsMs;
+  std::vector<std::thread> m_workers;
+
+  // Guards everything below
+  std::mutex m_mutex;
+  std::condition_variable m_workReady; // Wakes workers
+  std::condition_variable m_progress;  // Wakes the thread inside run()
+  std::queue<u32> m_workerQueue;       // Ready nodes any thread may take
+  std::queue<u32> m_mainQueue;         // Ready nodes for the caller only
+  size_t m_remaining{ 0 };
+  float m_dt{ 0.0f };
+  bool m_stopping{ false };
+};
+
+#endif // SYSTEMSCHEDULER_H_
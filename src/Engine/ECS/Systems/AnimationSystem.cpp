@@ -1,6 +1,7 @@
 #include "AnimationSystem.hpp"
 #include <ECS/Components/AnimationComponent.hpp>
 #include <ECS/Components/GraphicsComponent.hpp>
+#include <ECS/Components/PositionComponent.hpp>
 #include <ECS/ECSManager.hpp>
 #include <Objects/GraphicsObject.hpp>
 #include <iostream>
@@ -61,6 +62,15 @@ AnimationSystem::blendPose(GraphicsObject* obj, float weight)
   }
 }
 
+SystemAccess
+AnimationSystem::getAccess() const
+{
+  // Poses are written into the GraphicsComponent's object nodes. Position is
+  // only stamped, so posed node matrices reach the instance batches.
+  return SystemAccess{}
+    .write<AnimationComponent, GraphicsComponent, PositionComponent>();
+}
+
 void
 AnimationSystem::update(float dt)
 {
@@ -68,75 +78,81 @@ AnimationSystem::update(float dt)
     return;
   }
 
-  std::vector<Entity> view =
-    m_manager->view<AnimationComponent, GraphicsComponent>();
-
-  for (auto entity : view) {
-    auto animComp = m_manager->getComponent<AnimationComponent>(entity);
-    if (!animComp || !animComp->isPlaying) {
-      continue;
+  auto animate = [&](Entity entity,
+                     AnimationComponent& animComp,
+                     GraphicsComponent& graComp) {
+    if (!animComp.isPlaying || !graComp.m_grapObj) {
+      return;
     }
 
-    auto graComp = m_manager->getComponent<GraphicsComponent>(entity);
-    if (!graComp || !graComp->m_grapObj) {
-      continue;
-    }
-
-    if (graComp->m_grapObj->p_numAnimations == 0) {
-      if (!animComp->loggedNoAnimation) {
+    if (graComp.m_grapObj->p_numAnimations == 0) {
+      if (!animComp.loggedNoAnimation) {
         std::cout << "Entity " << entity << " does not contain animation."
                   << '\n';
-        animComp->loggedNoAnimation = true;
+        animComp.loggedNoAnimation = true;
       }
-      continue;
+      return;
     }
 
-    auto* obj = graComp->m_grapObj.get();
+    auto* obj = graComp.m_grapObj.get();
 
-    if (animComp->blending) {
+    if (animComp.blending) {
       // Advance blend timer
-      animComp->blendElapsed += dt;
-      animComp->blendWeight = std::clamp(
-        animComp->blendElapsed / animComp->blendDuration, 0.0f, 1.0f);
+      animComp.blendElapsed += dt;
+      animComp.blendWeight = std::clamp(
+        animComp.blendElapsed / animComp.blendDuration, 0.0f, 1.0f);
 
       // Advance both animation clocks
-      Animation& fromAnim = obj->p_animations[animComp->blendFromIndex];
-      Animation& toAnim = obj->p_animations[animComp->animationIndex];
+      Animation& fromAnim = obj->p_animations[animComp.blendFromIndex];
+      Animation& toAnim = obj->p_animations[animComp.animationIndex];
 
-      animComp->blendFromTime += dt;
-      if (animComp->blendFromTime > fromAnim.end) {
-        animComp->blendFromTime -= fromAnim.end;
+      animComp.blendFromTime += dt;
+      if (animComp.blendFromTime > fromAnim.end) {
+        animComp.blendFromTime -= fromAnim.end;
       }
 
-      animComp->currentTime += dt;
-      if (animComp->currentTime > toAnim.end) {
-        animComp->currentTime -= toAnim.end;
+      animComp.currentTime += dt;
+      if (animComp.currentTime > toAnim.end) {
+        animComp.currentTime -= toAnim.end;
       }
 
       // Sample source pose, snapshot it, then sample target pose
-      sampleAnimation(obj, fromAnim, animComp->blendFromTime);
+      sampleAnimation(obj, fromAnim, animComp.blendFromTime);
       snapshotPose(obj);
-      sampleAnimation(obj, toAnim, animComp->currentTime);
+      sampleAnimation(obj, toAnim, animComp.currentTime);
 
       // Blend between source (snapshot) and target (current node TRS)
-      blendPose(obj, animComp->blendWeight);
+      blendPose(obj, animComp.blendWeight);
 
       // Complete the blend when duration elapsed
-      if (animComp->blendElapsed >= animComp->blendDuration) {
-        animComp->blending = false;
+      if (animComp.blendElapsed >= animComp.blendDuration) {
+        animComp.blending = false;
       }
     } else {
       // Single animation path
-      Animation& animation = obj->p_animations[animComp->animationIndex];
+      Animation& animation = obj->p_animations[animComp.animationIndex];
 
-      animComp->currentTime += dt;
-      if (animComp->currentTime > animation.end) {
-        animComp->currentTime -= animation.end;
+      animComp.currentTime += dt;
+      if (animComp.currentTime > animation.end) {
+        animComp.currentTime -= animation.end;
       }
 
-      sampleAnimation(obj, animation, animComp->currentTime);
+      sampleAnimation(obj, animation, animComp.currentTime);
     }
 
     obj->resetMatrixCache();
-  }
+    // Skinned draws are streamed every frame anyway. Batched instances bake
+    // the node matrices, so they move like a changed transform; marking the
+    // GraphicsComponent instead would regroup every batch. Entities without
+    // a PositionComponent have no transform to go through.
+    if (!obj->hasSkin()) {
+      if (m_manager->hasComponent<PositionComponent>(entity)) {
+        m_manager->markChanged<PositionComponent>(entity);
+      } else {
+        m_manager->markChanged<GraphicsComponent>(entity);
+      }
+    }
+  };
+
+  m_manager->query<AnimationComponent, GraphicsComponent>().each(animate);
 }
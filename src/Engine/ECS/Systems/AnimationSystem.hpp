@@ -15,6 +15,7 @@ class AnimationSystem final
 
 public:
   void update(float dt) override;
+  SystemAccess getAccess() const override;
 
 private:
   AnimationSystem() = default;
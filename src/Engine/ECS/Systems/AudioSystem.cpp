@@ -74,6 +74,15 @@ AudioSystem::initialize(ECSManager& ecsManager)
             << (deviceName ? deviceName : "unknown") << std::endl;
 }
 
+SystemAccess
+AudioSystem::getAccess() const
+{
+  // Listener follows the main camera; OpenAL itself is thread-safe
+  return SystemAccess{}
+    .read<CameraComponent, PositionComponent>()
+    .write<AudioSourceComponent>();
+}
+
 void
 AudioSystem::update(float /* dt */)
 {
@@ -130,7 +139,7 @@ AudioSystem::update(float /* dt */)
         alSourcef(src, AL_ROLLOFF_FACTOR, audio.rolloffFactor);
 
         // Set initial position from entity
-        auto* pos = m_manager->getComponent<PositionComponent>(entity);
+        auto pos = m_manager->readComponent<PositionComponent>(entity);
         if (pos) {
           alSource3f(src,
                      AL_POSITION,
@@ -170,7 +179,7 @@ AudioSystem::update(float /* dt */)
 
       // Sync 3D position
       if (audio.is3D) {
-        auto* pos = m_manager->getComponent<PositionComponent>(entity);
+        auto pos = m_manager->readComponent<PositionComponent>(entity);
         if (pos) {
           alSource3f(src,
                      AL_POSITION,
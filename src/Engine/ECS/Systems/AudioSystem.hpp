@@ -20,6 +20,7 @@ class AudioSystem
 public:
   void initialize(ECSManager& ecsManager) override;
   void update(float dt) override;
+  SystemAccess getAccess() const override;
   void shutdown();
 
   // Buffer management (load/cache audio files, returns OpenAL buffer ID)
@@ -3,21 +3,24 @@
 #include "ECS/ECSManager.hpp"
 #include "Graphics/RenderResources.hpp"
 
+SystemAccess
+CameraSystem::getAccess() const
+{
+  return SystemAccess{}.read<PositionComponent>().write<CameraComponent>();
+}
+
 void
 CameraSystem::update(float /* dt */)
 {
-  std::vector<Entity> view = m_manager->view<CameraComponent>();
-
-  for (auto& e : view) {
-    auto* c = m_manager->getComponent<CameraComponent>(e);
-
-    if (auto* p = m_manager->getComponent<PositionComponent>(e); p) {
-      c->m_position = p->position + c->m_offset;
-      updateMatrices(c);
-    } else if (c->m_matrixNeedsUpdate) {
-      updateMatrices(c);
-    }
-  }
+  m_manager->query<CameraComponent>().each(
+    [this](Entity e, CameraComponent& c) {
+      if (auto p = m_manager->readComponent<PositionComponent>(e); p) {
+        c.m_position = p->position + c.m_offset;
+        updateMatrices(&c);
+      } else if (c.m_matrixNeedsUpdate) {
+        updateMatrices(&c);
+      }
+    });
 }
 
 void
@@ -49,6 +52,7 @@ CameraSystem::updateCameraUBO(CameraComponent* camera)
   ubo.projMatrix = camera->m_ProjectionMatrix;
   ubo.viewProjMatrix = camera->m_ProjectionMatrix * camera->m_viewMatrix;
   ubo.cameraPosition = glm::vec4(camera->m_position, 1.0f);
+  ubo.invViewProjMatrix = glm::inverse(ubo.viewProjMatrix);
 
   resources.flushCameraUBO();
 }
@@ -14,6 +14,7 @@ class CameraSystem
 
 public:
   void update(float dt) override;
+  SystemAccess getAccess() const override;
 
   static void updateCameraUBO(CameraComponent* camera);
 
@@ -12,6 +12,7 @@ class ParticleSystem
 
 public:
   void update(float dt) override;
+  SystemAccess getAccess() const override;
 
 private:
   ParticleSystem() = default;
@@ -159,6 +159,13 @@ PhysicsSystem::initialize(ECSManager& ecsManager)
 #endif
 }
 
+SystemAccess
+PhysicsSystem::getAccess() const
+{
+  // Also appends debug lines, which GraphicsSystem (exclusive) consumes
+  return SystemAccess{}.write<PositionComponent, PhysicsComponent>();
+}
+
 void
 PhysicsSystem::update(float dt)
 {
@@ -167,29 +174,31 @@ PhysicsSystem::update(float dt)
     m_joltSystem->Update(dt, 1, m_tempAllocator.get(), m_jobSystem.get());
 
     // Sync physics transforms to ECS PositionComponents
-    std::vector<Entity> view =
-      m_manager->view<PositionComponent, PhysicsComponent>();
-    for (auto e : view) {
-      auto p = m_manager->getComponent<PositionComponent>(e);
-      auto phy = m_manager->getComponent<PhysicsComponent>(e);
-
-      if (!phy || !phy->isValid()) {
-        continue;
-      }
-
-      auto& bodyInterface = m_joltSystem->GetBodyInterfaceNoLock();
-      JPH::RVec3 pos = bodyInterface.GetPosition(phy->getBodyID());
-      JPH::Quat rot = bodyInterface.GetRotation(phy->getBodyID());
-
-      p->position =
-        glm::vec3(float(pos.GetX()), float(pos.GetY()), float(pos.GetZ()));
-      p->rotation = glm::quat(rot.GetW(), rot.GetX(), rot.GetY(), rot.GetZ());
-    }
+    auto& bodyInterface = m_joltSystem->GetBodyInterfaceNoLock();
+    m_manager->query<PositionComponent, PhysicsComponent>().each(
+      [&](Entity e, PositionComponent& p, PhysicsComponent& phy) {
+        if (!phy.isValid()) {
+          return;
+        }
+
+        JPH::RVec3 pos = bodyInterface.GetPosition(phy.getBodyID());
+        JPH::Quat rot = bodyInterface.GetRotation(phy.getBodyID());
+
+        glm::vec3 position(
+          float(pos.GetX()), float(pos.GetY()), float(pos.GetZ()));
+        glm::quat rotation(rot.GetW(), rot.GetX(), rot.GetY(), rot.GetZ());
+        // Resting bodies keep their version so render caches stay valid
+        if (position != p.position || rotation != p.rotation) {
+          p.position = position;
+          p.rotation = rotation;
+          m_manager->markChanged<PositionComponent>(e);
+        }
+      });
   } else {
     // Editor mode: sync picked entity position to physics body
     Entity picked = m_manager->getPickedEntity();
     if (picked != 0) {
-      auto p = m_manager->getComponent<PositionComponent>(picked);
+      auto p = m_manager->readComponent<PositionComponent>(picked);
       auto phy = m_manager->getComponent<PhysicsComponent>(picked);
 
       if (p && phy && phy->isValid()) {
@@ -206,40 +215,38 @@ PhysicsSystem::update(float dt)
 #if !defined(EMSCRIPTEN) && !defined(NDEBUG)
   // Draw debug wireframe AABBs for all physics bodies
   auto& dbgBodyInterface = m_joltSystem->GetBodyInterfaceNoLock();
-  std::vector<Entity> debugView =
-    m_manager->view<PositionComponent, PhysicsComponent>();
-  for (auto e : debugView) {
-    auto phy = m_manager->getComponent<PhysicsComponent>(e);
-    if (!phy || !phy->isValid()) {
-      continue;
-    }
+  m_manager->query<PositionComponent, PhysicsComponent>().each(
+    [&](Entity /* e */, PositionComponent& /* p */, PhysicsComponent& phy) {
+      if (!phy.isValid()) {
+        return;
+      }
 
-    JPH::TransformedShape ts =
-      dbgBodyInterface.GetTransformedShape(phy->getBodyID());
-    JPH::AABox worldBounds = ts.GetWorldSpaceBounds();
-    glm::vec3 mn(worldBounds.mMin.GetX(),
-                 worldBounds.mMin.GetY(),
-                 worldBounds.mMin.GetZ());
-    glm::vec3 mx(worldBounds.mMax.GetX(),
-                 worldBounds.mMax.GetY(),
-                 worldBounds.mMax.GetZ());
-
-    glm::vec3 color(0.0f, 1.0f, 0.0f);
-
-    // 12 edges of an AABB
-    m_dDraw.drawLine({ mn.x, mn.y, mn.z }, { mx.x, mn.y, mn.z }, color);
-    m_dDraw.drawLine({ mn.x, mn.y, mn.z }, { mn.x, mx.y, mn.z }, color);
-    m_dDraw.drawLine({ mn.x, mn.y, mn.z }, { mn.x, mn.y, mx.z }, color);
-    m_dDraw.drawLine({ mx.x, mx.y, mx.z }, { mn.x, mx.y, mx.z }, color);
-    m_dDraw.drawLine({ mx.x, mx.y, mx.z }, { mx.x, mn.y, mx.z }, color);
-    m_dDraw.drawLine({ mx.x, mx.y, mx.z }, { mx.x, mx.y, mn.z }, color);
-    m_dDraw.drawLine({ mn.x, mx.y, mn.z }, { mx.x, mx.y, mn.z }, color);
-    m_dDraw.drawLine({ mn.x, mx.y, mn.z }, { mn.x, mx.y, mx.z }, color);
-    m_dDraw.drawLine({ mx.x, mn.y, mn.z }, { mx.x, mn.y, mx.z }, color);
-    m_dDraw.drawLine({ mx.x, mn.y, mn.z }, { mx.x, mx.y, mn.z }, color);
-    m_dDraw.drawLine({ mn.x, mn.y, mx.z }, { mx.x, mn.y, mx.z }, color);
-    m_dDraw.drawLine({ mn.x, mn.y, mx.z }, { mn.x, mx.y, mx.z }, color);
-  }
+      JPH::TransformedShape ts =
+        dbgBodyInterface.GetTransformedShape(phy.getBodyID());
+      JPH::AABox worldBounds = ts.GetWorldSpaceBounds();
+      glm::vec3 mn(worldBounds.mMin.GetX(),
+                   worldBounds.mMin.GetY(),
+                   worldBounds.mMin.GetZ());
+      glm::vec3 mx(worldBounds.mMax.GetX(),
+                   worldBounds.mMax.GetY(),
+                   worldBounds.mMax.GetZ());
+
+      glm::vec3 color(0.0f, 1.0f, 0.0f);
+
+      // 12 edges of an AABB
+      m_dDraw.drawLine({ mn.x, mn.y, mn.z }, { mx.x, mn.y, mn.z }, color);
+      m_dDraw.drawLine({ mn.x, mn.y, mn.z }, { mn.x, mx.y, mn.z }, color);
+      m_dDraw.drawLine({ mn.x, mn.y, mn.z }, { mn.x, mn.y, mx.z }, color);
+      m_dDraw.drawLine({ mx.x, mx.y, mx.z }, { mn.x, mx.y, mx.z }, color);
+      m_dDraw.drawLine({ mx.x, mx.y, mx.z }, { mx.x, mn.y, mx.z }, color);
+      m_dDraw.drawLine({ mx.x, mx.y, mx.z }, { mx.x, mx.y, mn.z }, color);
+      m_dDraw.drawLine({ mn.x, mx.y, mn.z }, { mx.x, mx.y, mn.z }, color);
+      m_dDraw.drawLine({ mn.x, mx.y, mn.z }, { mn.x, mx.y, mx.z }, color);
+      m_dDraw.drawLine({ mx.x, mn.y, mn.z }, { mx.x, mn.y, mx.z }, color);
+      m_dDraw.drawLine({ mx.x, mn.y, mn.z }, { mx.x, mx.y, mn.z }, color);
+      m_dDraw.drawLine({ mn.x, mn.y, mx.z }, { mx.x, mn.y, mx.z }, color);
+      m_dDraw.drawLine({ mn.x, mn.y, mx.z }, { mn.x, mx.y, mx.z }, color);
+    });
 #endif
 }
 
@@ -247,7 +254,7 @@ JPH::BodyID
 PhysicsSystem::createBody(Entity entity, float mass, CollisionShapeType type)
 {
   auto posComp =
-    ECSManager::getInstance().getComponent<PositionComponent>(entity);
+    ECSManager::getInstance().readComponent<PositionComponent>(entity);
   if (!posComp) {
     return JPH::BodyID();
   }
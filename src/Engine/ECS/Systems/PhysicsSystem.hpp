@@ -27,6 +27,7 @@ class PhysicsSystem
 public:
   void initialize(ECSManager& ecsManager) override;
   void update(float dt) override;
+  SystemAccess getAccess() const override;
   void setViewport(u32, u32){};
 
   // Body lifecycle
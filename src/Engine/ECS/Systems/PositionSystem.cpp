@@ -1,8 +1,332 @@
 #include "PositionSystem.hpp"
+#include "ECS/Components/HierarchyComponent.hpp"
+#include "ECS/Components/PositionComponent.hpp"
+#include <ECS/ECSManager.hpp>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define POSITIONSYSTEM_SSE 1
+#endif
+
+namespace {
+
+using Layout = SoALayout<PositionComponent>;
+
+// Same result as glm::translate * glm::mat4_cast * glm::scale for one
+// transform; the kernel's scalar tail and the non-SSE path
+void
+composeScalar(const float* const* s, size_t i, glm::mat4& m)
+{
+  float qx = s[Layout::RotX][i], qy = s[Layout::RotY][i];
+  float qz = s[Layout::RotZ][i], qw = s[Layout::RotW][i];
+  float sx = s[Layout::ScaleX][i], sy = s[Layout::ScaleY][i];
+  float sz = s[Layout::ScaleZ][i];
+
+  float xx = qx * qx, yy = qy * qy, zz = qz * qz;
+  float xy = qx * qy, xz = qx * qz, yz = qy * qz;
+  float wx = qw * qx, wy = qw * qy, wz = qw * qz;
+
+  m[0] = glm::vec4((1.0f - 2.0f * (yy + zz)) * sx,
+                   2.0f * (xy + wz) * sx,
+                   2.0f * (xz - wy) * sx,
+                   0.0f);
+  m[1] = glm::vec4(2.0f * (xy - wz) * sy,
+                   (1.0f - 2.0f * (xx + zz)) * sy,
+                   2.0f * (yz + wx) * sy,
+                   0.0f);
+  m[2] = glm::vec4(2.0f * (xz + wy) * sz,
+                   2.0f * (yz - wx) * sz,
+                   (1.0f - 2.0f * (xx + yy)) * sz,
+                   0.0f);
+  m[3] = glm::vec4(
+    s[Layout::PosX][i], s[Layout::PosY][i], s[Layout::PosZ][i], 1.0f);
+}
+
+// The pool's streams as the pointers the kernels take
+std::array<const float*, Layout::Count>
+poolStreams(const SoAComponentPool<PositionComponent>& pool)
+{
+  std::array<const float*, Layout::Count> streams;
+  for (size_t s = 0; s < Layout::Count; ++s) {
+    streams[s] = pool.stream(static_cast<Layout::Stream>(s)).data();
+  }
+  return streams;
+}
+
+} // namespace
+
+void
+PositionSystem::composeWorldMatrices(const float* const* streams,
+                                     size_t count,
+                                     const u32* targets,
+                                     WorldMatrix* out)
+{
+  size_t i = 0;
+#ifdef POSITIONSYSTEM_SSE
+  // Four transforms per iteration: each __m128 holds one matrix element for
+  // four entities, transposed into per-matrix columns before storing
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    __m128 qx = _mm_loadu_ps(streams[Layout::RotX] + i);
+    __m128 qy = _mm_loadu_ps(streams[Layout::RotY] + i);
+    __m128 qz = _mm_loadu_ps(streams[Layout::RotZ] + i);
+    __m128 qw = _mm_loadu_ps(streams[Layout::RotW] + i);
+    __m128 sx = _mm_loadu_ps(streams[Layout::ScaleX] + i);
+    __m128 sy = _mm_loadu_ps(streams[Layout::ScaleY] + i);
+    __m128 sz = _mm_loadu_ps(streams[Layout::ScaleZ] + i);
+
+    __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy);
+    __m128 zz = _mm_mul_ps(qz, qz), xy = _mm_mul_ps(qx, qy);
+    __m128 xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+    __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy);
+    __m128 wz = _mm_mul_ps(qw, qz);
+
+    auto diag = [&](__m128 a, __m128 b, __m128 scale) {
+      return _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(a, b))),
+                        scale);
+    };
+    auto sum = [&](__m128 a, __m128 b, __m128 scale) {
+      return _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(a, b)), scale);
+    };
+    auto diff = [&](__m128 a, __m128 b, __m128 scale) {
+      return _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(a, b)), scale);
+    };
+
+    // cRr = column C, row R of the four matrices
+    __m128 c0r0 = diag(yy, zz, sx), c0r1 = sum(xy, wz, sx);
+    __m128 c0r2 = diff(xz, wy, sx), c0r3 = zero;
+    __m128 c1r0 = diff(xy, wz, sy), c1r1 = diag(xx, zz, sy);
+    __m128 c1r2 = sum(yz, wx, sy), c1r3 = zero;
+    __m128 c2r0 = sum(xz, wy, sz), c2r1 = diff(yz, wx, sz);
+    __m128 c2r2 = diag(xx, yy, sz), c2r3 = zero;
+    __m128 c3r0 = _mm_loadu_ps(streams[Layout::PosX] + i);
+    __m128 c3r1 = _mm_loadu_ps(streams[Layout::PosY] + i);
+    __m128 c3r2 = _mm_loadu_ps(streams[Layout::PosZ] + i);
+    __m128 c3r3 = one;
+
+    _MM_TRANSPOSE4_PS(c0r0, c0r1, c0r2, c0r3);
+    _MM_TRANSPOSE4_PS(c1r0, c1r1, c1r2, c1r3);
+    _MM_TRANSPOSE4_PS(c2r0, c2r1, c2r2, c2r3);
+    _MM_TRANSPOSE4_PS(c3r0, c3r1, c3r2, c3r3);
+
+    // After the transposes register cCrK holds column C of matrix K
+    const __m128 columns[4][4] = { { c0r0, c1r0, c2r0, c3r0 },
+                                   { c0r1, c1r1, c2r1, c3r1 },
+                                   { c0r2, c1r2, c2r2, c3r2 },
+                                   { c0r3, c1r3, c2r3, c3r3 } };
+    for (size_t k = 0; k < 4; ++k) {
+      float* dst = &out[targets[i + k]].value[0][0];
+      _mm_store_ps(dst + 0, columns[k][0]);
+      _mm_store_ps(dst + 4, columns[k][1]);
+      _mm_store_ps(dst + 8, columns[k][2]);
+      _mm_store_ps(dst + 12, columns[k][3]);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    composeScalar(streams, i, out[targets[i]].value);
+  }
+}
+
+SystemAccess
+PositionSystem::getAccess() const
+{
+  return SystemAccess{}
+    .read<PositionComponent>()
+    .write<HierarchyComponent>()
+    .write(SystemResource::WorldMatrices);
+}
+
+glm::mat4
+PositionSystem::getWorldMatrix(Entity entity) const
+{
+  auto* pool = m_manager->getPool<PositionComponent>();
+  if (!pool || !pool->has(entity)) {
+    return glm::mat4(1.0f);
+  }
+  // A slot refilled by swap-and-pop or group reordering still holds its
+  // previous entity's matrix until the next update; a new one holds none
+  size_t slot = pool->indexOf(entity);
+  if (slot < m_slotEntities.size() && m_slotEntities[slot] == entity) {
+    return m_worldMatrices[slot].value;
+  }
+  return composeWorld(entity);
+}
+
+glm::mat4
+PositionSystem::composeWorld(Entity entity) const
+{
+  auto* positions = m_manager->getPool<PositionComponent>();
+  auto* nodes = m_manager->getPool<HierarchyComponent>();
+  glm::mat4 world(1.0f);
+  // Ancestors apply on the left; one without a PositionComponent acts as
+  // the identity and its own parent still applies, as in
+  // propagateHierarchy()
+  auto streams = poolStreams(*positions);
+  for (Entity current = entity; current != 0;) {
+    if (positions->has(current)) {
+      glm::mat4 local;
+      composeScalar(streams.data(), positions->indexOf(current), local);
+      world = local * world;
+    }
+    current = nodes && nodes->has(current)
+                ? (*nodes)[nodes->indexOf(current)].parent
+                : 0;
+  }
+  return world;
+}
 
 void
 PositionSystem::update(float /* dt */)
 {
-  // Model matrix computation moved to render passes (GeometryPass, ShadowPass)
-  // to keep PositionComponent small and cache-friendly.
+  auto* pool = m_manager->getPool<PositionComponent>();
+  size_t count = pool ? pool->size() : 0;
+
+  u32 since = m_seenTick;
+  m_seenTick = m_manager->getChangeTick();
+
+  // Slots whose entity moved (swap-and-pop, group reordering) are rebuilt
+  // along with the ones that changed
+  m_worldMatrices.resize(count);
+  m_slotEntities.resize(count, 0);
+  m_worldVersions.resize(count, 0);
+  m_rebuilt.assign(count, 0);
+  m_dirtySlots.clear();
+  for (size_t i = 0; i < count; ++i) {
+    Entity entity = pool->entityAt(i);
+    if (m_slotEntities[i] != entity || pool->changedSince(i, since)) {
+      m_slotEntities[i] = entity;
+      m_dirtySlots.push_back(static_cast<u32>(i));
+      m_rebuilt[i] = 1;
+    }
+  }
+
+  size_t dirty = m_dirtySlots.size();
+  if (dirty == count && dirty > 0) {
+    // Every slot is dirty, e.g. after loading a scene: compose straight
+    // from the pool's streams, m_dirtySlots being 0..count-1
+    auto streams = poolStreams(*pool);
+    composeWorldMatrices(
+      streams.data(), dirty, m_dirtySlots.data(), m_worldMatrices.data());
+  } else if (dirty > 0) {
+    // Gather the dirty lanes of each stream, then compose them in one batch
+    auto source = poolStreams(*pool);
+    std::array<const float*, Layout::Count> streams;
+    for (size_t s = 0; s < Layout::Count; ++s) {
+      m_streams[s].reserve(dirty, 0);
+      float* gathered = m_streams[s].data();
+      for (size_t k = 0; k < dirty; ++k) {
+        gathered[k] = source[s][m_dirtySlots[k]];
+      }
+      streams[s] = gathered;
+    }
+    composeWorldMatrices(
+      streams.data(), dirty, m_dirtySlots.data(), m_worldMatrices.data());
+  }
+
+  // Dirty slots now hold their local matrix; parented ones get their
+  // parent's world applied, and clean children of a rebuilt parent follow
+  sortHierarchy();
+  propagateHierarchy();
+
+  for (size_t i = 0; i < count; ++i) {
+    if (m_rebuilt[i]) {
+      m_worldVersions[i] = m_seenTick;
+    }
+  }
+}
+
+void
+PositionSystem::sortHierarchy()
+{
+  auto* nodes = m_manager->getPool<HierarchyComponent>();
+  if (!nodes) {
+    return;
+  }
+  size_t count = nodes->size();
+  auto byDepth = [&](u32 a, u32 b) {
+    return (*nodes)[a].depth < (*nodes)[b].depth;
+  };
+
+  // Reparenting is rare, so this is usually a single check
+  m_order.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    m_order[i] = static_cast<u32>(i);
+  }
+  if (std::is_sorted(m_order.begin(), m_order.end(), byDepth)) {
+    return;
+  }
+  std::stable_sort(m_order.begin(), m_order.end(), byDepth);
+
+  // Apply the order with swapEntries so the pool's sparse index follows.
+  // m_position: original slot -> current slot, m_occupant: the inverse.
+  m_position.resize(count);
+  m_occupant.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    m_position[i] = static_cast<u32>(i);
+    m_occupant[i] = static_cast<u32>(i);
+  }
+  for (size_t target = 0; target < count; ++target) {
+    u32 source = m_position[m_order[target]];
+    if (source == target) {
+      continue;
+    }
+    u32 displaced = m_occupant[target];
+    nodes->swapEntries(target, source);
+    m_position[displaced] = source;
+    m_occupant[source] = displaced;
+    m_position[m_order[target]] = static_cast<u32>(target);
+    m_occupant[target] = m_order[target];
+  }
+}
+
+void
+PositionSystem::propagateHierarchy()
+{
+  auto* nodes = m_manager->getPool<HierarchyComponent>();
+  auto* positions = m_manager->getPool<PositionComponent>();
+  if (!nodes || !positions) {
+    return;
+  }
+  size_t count = positions->size();
+  auto streams = poolStreams(*positions);
+
+  // Depth order visits every parent before its children, so the parent's
+  // world matrix is final by the time a child reads it
+  for (size_t i = 0; i < nodes->size(); ++i) {
+    Entity parent = (*nodes)[i].parent;
+    if (parent == 0) {
+      continue;
+    }
+    size_t slot = positions->indexOf(nodes->entityAt(i));
+    if (slot == count) {
+      continue;
+    }
+    // Ancestors without a PositionComponent act as the identity, so the
+    // child follows the nearest one that has one, as in composeWorld()
+    size_t parentSlot = positions->indexOf(parent);
+    while (parentSlot == count && parent != 0 && nodes->has(parent)) {
+      parent = (*nodes)[nodes->indexOf(parent)].parent;
+      parentSlot = parent != 0 ? positions->indexOf(parent) : count;
+    }
+    bool hasParentWorld = parentSlot != count;
+    bool parentRebuilt = hasParentWorld && m_rebuilt[parentSlot];
+    if (!m_rebuilt[slot] && !parentRebuilt) {
+      continue;
+    }
+
+    glm::mat4& world = m_worldMatrices[slot].value;
+    if (!m_rebuilt[slot]) {
+      // Clean child under a moved parent: its local matrix was replaced by
+      // its world one last time, so compose it again
+      composeScalar(streams.data(), slot, world);
+      m_rebuilt[slot] = 1;
+    }
+    if (hasParentWorld) {
+      world = m_worldMatrices[parentSlot].value * world;
+    }
+  }
 }
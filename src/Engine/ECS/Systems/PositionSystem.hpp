@@ -2,8 +2,25 @@
 #define POSITIONSYSTEM_H_
 
 #include "System.hpp"
+#include <ECS/Components/PositionComponent.hpp>
+#include <ECS/SoAComponentPool.hpp>
 #include <Singleton.hpp>
+#include <vector>
 
+// Model matrix padded to its own cache line, so the world-matrix array is
+// dense and every SIMD store is aligned
+struct alignas(64) WorldMatrix
+{
+  glm::mat4 value{ 1.0f };
+};
+
+// Owns the world matrix (translate * rotate * scale) of every entity with a
+// PositionComponent. Matrices are only recomputed for components added or
+// marked changed since the previous update, in SIMD batches, and consumers
+// such as the render passes read them from here instead of composing their
+// own. Entities parented through ECSManager::setParent get parent world *
+// local; the HierarchyComponent pool is kept sorted by depth so that is one
+// linear pass touching only the subtrees under a changed transform.
 class PositionSystem
   : public System
   , public Singleton<PositionSystem>
@@ -12,10 +29,64 @@ class PositionSystem
 
 public:
   void update(float dt) override;
+  SystemAccess getAccess() const override;
   void setViewport(u32 /* w */, u32 /* h */){};
 
+  // Indexed like the PositionComponent pool's dense array, so slot i of the
+  // Position+Graphics owning group maps straight to matrix i. Valid until
+  // the next structural change to PositionComponent.
+  [[nodiscard]] const glm::mat4& getWorldMatrix(size_t slot) const
+  {
+    return m_worldMatrices[slot].value;
+  }
+  // As of the last update(), or composed from the current components if the
+  // entity's slot has been refilled or added since. Identity if the entity
+  // has no PositionComponent.
+  [[nodiscard]] glm::mat4 getWorldMatrix(Entity entity) const;
+  [[nodiscard]] size_t getWorldMatrixCount() const
+  {
+    return m_worldMatrices.size();
+  }
+  // True if the slot's world matrix was rebuilt at or after `tick`, either
+  // from its own change or from one of its ancestors moving
+  [[nodiscard]] bool worldChangedSince(size_t slot, u32 tick) const
+  {
+    return m_worldVersions[slot] >= tick;
+  }
+
+  // Batch kernel: composes `count` transforms given as
+  // SoALayout<PositionComponent> streams and writes transform k to
+  // out[targets[k]]
+  static void composeWorldMatrices(const float* const* streams,
+                                   size_t count,
+                                   const u32* targets,
+                                   WorldMatrix* out);
+
 private:
   PositionSystem() = default;
+
+  void sortHierarchy();
+  void propagateHierarchy();
+  // World matrix from the current PositionComponents of the entity and its
+  // ancestors, bypassing the cache
+  [[nodiscard]] glm::mat4 composeWorld(Entity entity) const;
+
+  std::vector<WorldMatrix> m_worldMatrices;
+  std::vector<Entity> m_slotEntities; // Entity each matrix was built for
+  std::vector<u32> m_worldVersions;   // Change tick each matrix was built at
+  u32 m_seenTick{ 0 };
+
+  // Per-update scratch: slots rebuilt this update, and the depth order used
+  // to sort the HierarchyComponent pool
+  std::vector<u8> m_rebuilt;
+  std::vector<u32> m_order;
+  std::vector<u32> m_position;
+  std::vector<u32> m_occupant;
+
+  // Per-update scratch: dirty slots, and their lanes of the pool's streams
+  // when only some slots are dirty
+  std::vector<u32> m_dirtySlots;
+  std::array<AlignedStream, SoALayout<PositionComponent>::Count> m_streams;
 };
 
 #endif // POSITIONSYSTEM_H_
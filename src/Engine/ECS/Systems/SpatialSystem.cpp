@@ -0,0 +1,136 @@
+#include "SpatialSystem.hpp"
+#include "ECS/Components/GraphicsComponent.hpp"
+#include "ECS/Components/PositionComponent.hpp"
+#include <ECS/ECSManager.hpp>
+#include <ECS/Systems/PositionSystem.hpp>
+
+namespace {
+
+// Model-space bounds of every primitive in the object, placed by its node.
+// Empty if any primitive lacks bounds, since the union would be a lie.
+Aabb
+localBounds(GraphicsObject& obj)
+{
+  Aabb bounds;
+  for (u32 nodeIdx = 0; nodeIdx < obj.p_numNodes; nodeIdx++) {
+    if (obj.p_nodes[nodeIdx].mesh < 0) {
+      continue;
+    }
+    glm::mat4 nodeModel = obj.getMatrix(nodeIdx);
+    Mesh& mesh = obj.p_meshes[obj.p_nodes[nodeIdx].mesh];
+    for (u32 primIdx = 0; primIdx < mesh.numPrims; primIdx++) {
+      const Aabb& prim = mesh.m_primitives[primIdx].m_bounds;
+      if (prim.isEmpty()) {
+        return {};
+      }
+      bounds.expand(prim.transformed(nodeModel));
+    }
+  }
+  return bounds;
+}
+
+} // namespace
+
+void
+SpatialSystem::initialize(ECSManager& ecsManager)
+{
+  System::initialize(ecsManager);
+  ecsManager.group<PositionComponent, GraphicsComponent>();
+}
+
+void
+SpatialSystem::update(float /* dt */)
+{
+  // Position and Graphics are co-sorted by the owning group, so group slot i
+  // is Position slot i and PositionSystem's world matrix i
+  auto renderables = m_manager->group<PositionComponent, GraphicsComponent>();
+  auto& graphics = renderables.pool<GraphicsComponent>();
+  auto& transforms = PositionSystem::getInstance();
+
+  u32 since = m_seenTick;
+  m_seenTick = m_manager->getChangeTick();
+  m_frame++;
+
+  size_t count = renderables.size();
+  m_slotEntities.resize(count, 0);
+  m_slotNodes.resize(count, Bvh::kNull);
+  for (size_t i = 0; i < count; ++i) {
+    Entity entity = graphics.entityAt(i);
+    auto [it, added] = m_proxies.try_emplace(entity);
+    Proxy& proxy = it->second;
+    proxy.seen = m_frame;
+
+    // An entity new to its slot may have stale change stamps there
+    bool remapped = m_slotEntities[i] != entity;
+    m_slotEntities[i] = entity;
+    bool graphicsChanged =
+      added || remapped || graphics.changedSince(i, since);
+
+    if (!graphicsChanged && !transforms.worldChangedSince(i, since)) {
+      if (proxy.node != Bvh::kNull && !m_tree.isStatic(proxy.node) &&
+          m_frame - proxy.lastMoved >= kPromoteAfter) {
+        m_tree.setStatic(proxy.node, true);
+      }
+      continue;
+    }
+
+    // Node animation moves an object through its PositionComponent stamp,
+    // so the local bounds are taken again on any change
+    proxy.local = localBounds(*graphics[i].m_grapObj);
+    proxy.lastMoved = m_frame;
+    if (proxy.local.isEmpty()) {
+      if (proxy.node != Bvh::kNull) {
+        m_tree.remove(proxy.node);
+        proxy.node = Bvh::kNull;
+      }
+      proxy.world = {};
+      m_slotNodes[i] = Bvh::kNull;
+      continue;
+    }
+    proxy.world = proxy.local.transformed(transforms.getWorldMatrix(i));
+    if (proxy.node == Bvh::kNull) {
+      proxy.node = m_tree.insert(proxy.world, entity);
+    } else {
+      m_tree.refit(proxy.node, proxy.world);
+    }
+    m_slotNodes[i] = proxy.node;
+  }
+
+  // Entities that left the group were not visited this update
+  if (m_proxies.size() != count) {
+    m_stale.clear();
+    for (const auto& [entity, proxy] : m_proxies) {
+      if (proxy.seen != m_frame) {
+        m_stale.push_back(entity);
+      }
+    }
+    for (Entity entity : m_stale) {
+      remove(entity);
+    }
+  }
+}
+
+SystemAccess
+SpatialSystem::getAccess() const
+{
+  return SystemAccess{}
+    .read<PositionComponent, GraphicsComponent>()
+    .read(SystemResource::WorldMatrices);
+}
+
+Aabb
+SpatialSystem::getBounds(Entity entity) const
+{
+  auto it = m_proxies.find(entity);
+  return it != m_proxies.end() ? it->second.world : Aabb{};
+}
+
+void
+SpatialSystem::remove(Entity entity)
+{
+  auto it = m_proxies.find(entity);
+  if (it->second.node != Bvh::kNull) {
+    m_tree.remove(it->second.node);
+  }
+  m_proxies.erase(it);
+}
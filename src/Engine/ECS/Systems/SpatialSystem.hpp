@@ -0,0 +1,67 @@
+#ifndef SPATIALSYSTEM_H_
+#define SPATIALSYSTEM_H_
+
+#include "System.hpp"
+#include <Rendering/Bvh.hpp>
+#include <Singleton.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Keeps a Bvh over the world bounds of every entity with a Position and a
+// GraphicsComponent, for visibility (InstanceBatcher::cull) and spatial
+// queries. Runs after PositionSystem and only refits entities whose world
+// matrix or graphics changed. Entities that have not moved for kPromoteAfter
+// updates are moved to the static tree, so queries can skip them wholesale.
+// Entities whose meshes carry no bounds are not indexed.
+class SpatialSystem
+  : public System
+  , public Singleton<SpatialSystem>
+{
+  friend class Singleton<SpatialSystem>;
+
+public:
+  static constexpr u32 kPromoteAfter = 60;
+
+  // Registers the Position+Graphics group here on the main thread: its
+  // first use reorders both pools, which update() cannot do on a worker
+  void initialize(ECSManager& ecsManager) override;
+  void update(float dt) override;
+  SystemAccess getAccess() const override;
+  void setViewport(u32 /* w */, u32 /* h */){};
+
+  // Leaf user data is the Entity
+  [[nodiscard]] Bvh& getTree() { return m_tree; }
+  // World bounds last indexed for the entity; empty if it is not indexed
+  [[nodiscard]] Aabb getBounds(Entity entity) const;
+  // True if the last update() indexed `entity` in the tree from group slot
+  // `slot`, so a query reports it at its current world matrix
+  [[nodiscard]] bool indexes(size_t slot, Entity entity) const
+  {
+    return slot < m_slotEntities.size() && m_slotEntities[slot] == entity &&
+           m_slotNodes[slot] != Bvh::kNull;
+  }
+
+private:
+  SpatialSystem() = default;
+
+  struct Proxy
+  {
+    u32 node{ Bvh::kNull };
+    Aabb local; // Union of the mesh's primitive bounds in model space
+    Aabb world; // Exact world bounds; the tree stores them fattened
+    u32 lastMoved{ 0 };
+    u32 seen{ 0 };
+  };
+
+  void remove(Entity entity);
+
+  Bvh m_tree;
+  std::unordered_map<Entity, Proxy> m_proxies;
+  std::vector<Entity> m_slotEntities; // Entity each group slot was seen with
+  std::vector<u32> m_slotNodes;       // Its tree leaf, or Bvh::kNull
+  std::vector<Entity> m_stale;
+  u32 m_seenTick{ 0 };
+  u32 m_frame{ 0 };
+};
+
+#endif // SPATIALSYSTEM_H_
@@ -1,8 +1,85 @@
 #ifndef SYSTEM_H_
 #define SYSTEM_H_
 
+#include <ECS/ComponentTypeID.hpp>
 #include <Singleton.hpp>
 
+// Engine state shared between systems outside of any component, declared
+// in SystemAccess like components so the systems using it stay ordered
+enum class SystemResource : u8
+{
+  WorldMatrices, // PositionSystem's world-matrix cache
+  Count
+};
+
+// Component types and resources a system touches during update(). The
+// scheduler runs two systems concurrently only when neither writes what the
+// other accesses; otherwise they keep their order in ECSManager's update
+// list.
+struct SystemAccess
+{
+  using Resources = std::bitset<static_cast<size_t>(SystemResource::Count)>;
+
+  Signature reads;
+  Signature writes;
+  Resources resourceReads;
+  Resources resourceWrites;
+  bool mainThread{ false }; // Must run on the thread owning the GL context
+
+  template<typename... T>
+  SystemAccess& read()
+  {
+    (reads.set(componentTypeID<T>()), ...);
+    return *this;
+  }
+
+  template<typename... T>
+  SystemAccess& write()
+  {
+    (writes.set(componentTypeID<T>()), ...);
+    return *this;
+  }
+
+  SystemAccess& read(SystemResource resource)
+  {
+    resourceReads.set(static_cast<size_t>(resource));
+    return *this;
+  }
+
+  SystemAccess& write(SystemResource resource)
+  {
+    resourceWrites.set(static_cast<size_t>(resource));
+    return *this;
+  }
+
+  SystemAccess& onMainThread()
+  {
+    mainThread = true;
+    return *this;
+  }
+
+  // Conflicts with every other system and stays on the main thread
+  static SystemAccess exclusive()
+  {
+    SystemAccess access;
+    access.reads.set();
+    access.writes.set();
+    access.resourceReads.set();
+    access.resourceWrites.set();
+    access.mainThread = true;
+    return access;
+  }
+
+  bool conflictsWith(const SystemAccess& other) const
+  {
+    return (writes & (other.reads | other.writes)).any() ||
+           (other.writes & reads).any() ||
+           (resourceWrites & (other.resourceReads | other.resourceWrites))
+             .any() ||
+           (other.resourceWrites & resourceReads).any();
+  }
+};
+
 class ECSManager;
 class System
 {
@@ -12,6 +89,9 @@ public:
   virtual void update(float dt) = 0;
   // Initialize system
   virtual void initialize(ECSManager& ecsManager) { m_manager = &ecsManager; };
+  // Components read/written by update(); systems that do not override this
+  // are scheduled exclusively
+  virtual SystemAccess getAccess() const { return SystemAccess::exclusive(); }
 
 protected:
   System() = default;
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "CommandBuffer.hpp"
+#include "GraphicsTypes.hpp"
+#include "Handle.hpp"
+#include "Resources/Buffer.hpp"
+#include "Resources/Framebuffer.hpp"
+#include "Resources/Pipeline.hpp"
+#include "Resources/Renderbuffer.hpp"
+#include "Resources/Sampler.hpp"
+#include "Resources/Shader.hpp"
+#include "Resources/Texture.hpp"
+#include <optional>
+#include <span>
+
+namespace gfx {
+
+enum class BackendType : u8
+{
+  GLES3, // OpenGL ES 3 / WebGL 2, needs a current context from Window
+  Null,  // No GPU: decodes and counts commands, see null::Device
+};
+
+/// Interface GraphicsDevice forwards to. Each backend owns its resource
+/// pools and executes CommandBuffers its own way; see GraphicsDevice for what
+/// each call does.
+class Backend
+{
+public:
+  virtual ~Backend() = default;
+
+  [[nodiscard]] virtual BackendType type() const = 0;
+
+  virtual bool initialize() = 0;
+  virtual void shutdown() = 0;
+
+  virtual BufferId createBuffer(const BufferCreateInfo& info) = 0;
+  virtual void destroyBuffer(BufferId buffer) = 0;
+
+  virtual TextureId createTexture(const TextureCreateInfo& info) = 0;
+  virtual void destroyTexture(TextureId texture) = 0;
+
+  virtual SamplerId createSampler(const SamplerCreateInfo& info) = 0;
+  virtual void destroySampler(SamplerId sampler) = 0;
+
+  virtual ShaderId createShader(const ShaderCreateInfo& info) = 0;
+  virtual ShaderId createShaderProgram(const ShaderProgramCreateInfo& info) = 0;
+  virtual void destroyShader(ShaderId shader) = 0;
+
+  virtual PipelineId createPipeline(const PipelineCreateInfo& info) = 0;
+  virtual void destroyPipeline(PipelineId pipeline) = 0;
+
+  virtual FramebufferId createFramebuffer(
+    const FramebufferCreateInfo& info) = 0;
+  virtual void destroyFramebuffer(FramebufferId framebuffer) = 0;
+  virtual void setFramebufferAttachment(FramebufferId fbo,
+                                        u32 attachmentIndex,
+                                        TextureId texture,
+                                        u32 mipLevel,
+                                        u32 layer) = 0;
+  virtual void setFramebufferDepthAttachment(FramebufferId fbo,
+                                             TextureId texture,
+                                             u32 mipLevel,
+                                             u32 layer) = 0;
+  virtual void setFramebufferRenderbuffer(FramebufferId fbo,
+                                          RenderbufferAttachment attachmentType,
+                                          RenderbufferId rbo) = 0;
+  virtual void setDrawBuffers(FramebufferId fbo,
+                              std::span<const u32> attachments) = 0;
+
+  virtual RenderbufferId createRenderbuffer(
+    const RenderbufferCreateInfo& info) = 0;
+  virtual void destroyRenderbuffer(RenderbufferId renderbuffer) = 0;
+  virtual void resizeRenderbuffer(RenderbufferId renderbuffer,
+                                  u32 width,
+                                  u32 height) = 0;
+
+  virtual VertexArrayId createVertexArray(
+    const VertexArrayCreateInfo& info) = 0;
+  virtual void destroyVertexArray(VertexArrayId vao) = 0;
+  virtual void bindVertexArray(VertexArrayId vao) = 0;
+  virtual void drawVertexArray(VertexArrayId vao, BufferId vertexBuffer) = 0;
+  virtual void drawVertexArrayDynamic(VertexArrayId vao,
+                                      BufferId vertexBuffer,
+                                      PrimitiveTopology topology,
+                                      u32 vertexCount,
+                                      u64 bufferOffset) = 0;
+  virtual void drawIndexedVertexArray(VertexArrayId vao,
+                                      BufferId vertexBuffer,
+                                      BufferId indexBuffer,
+                                      u32 indexCount,
+                                      IndexType indexType,
+                                      u32 offset) = 0;
+
+  virtual void updateBuffer(BufferId buffer,
+                            u64 offset,
+                            const void* data,
+                            u64 size) = 0;
+  virtual void* mapBuffer(BufferId buffer) = 0;
+  virtual void unmapBuffer(BufferId buffer) = 0;
+
+  virtual StreamAllocation streamUpload(StreamUsage usage,
+                                        const void* data,
+                                        u64 size,
+                                        u32 alignment) = 0;
+  [[nodiscard]] virtual const StreamStats& getStreamStats() const = 0;
+
+  virtual void updateTexture(TextureId texture,
+                             u32 mipLevel,
+                             u32 layer,
+                             const void* data,
+                             u64 dataSize) = 0;
+  virtual void resizeTexture(TextureId texture,
+                             u32 newWidth,
+                             u32 newHeight,
+                             const void* data) = 0;
+  virtual const TextureCreateInfo* getTextureInfo(TextureId texture) const = 0;
+  virtual void generateMipmaps(TextureId texture) = 0;
+
+  virtual CommandBufferId createCommandBuffer() = 0;
+  virtual void destroyCommandBuffer(CommandBufferId cmdBuffer) = 0;
+  virtual CommandBuffer* getCommandBuffer(CommandBufferId cmdId) = 0;
+
+  virtual void executeCommandBuffer(const CommandBuffer& cmdBuffer) = 0;
+
+  virtual void beginFrame() = 0;
+  virtual void endFrame() = 0;
+
+  [[nodiscard]] virtual bool isValid(BufferId handle) const = 0;
+  [[nodiscard]] virtual bool isValid(TextureId handle) const = 0;
+  [[nodiscard]] virtual bool isValid(SamplerId handle) const = 0;
+  [[nodiscard]] virtual bool isValid(ShaderId handle) const = 0;
+  [[nodiscard]] virtual bool isValid(PipelineId handle) const = 0;
+  [[nodiscard]] virtual bool isValid(FramebufferId handle) const = 0;
+  [[nodiscard]] virtual bool isValid(RenderbufferId handle) const = 0;
+  [[nodiscard]] virtual bool isValid(VertexArrayId handle) const = 0;
+
+  [[nodiscard]] virtual bool isFramebufferComplete(FramebufferId fbo) const = 0;
+
+  [[nodiscard]] virtual u32 getUniformBufferOffsetAlignment() const = 0;
+
+  [[nodiscard]] virtual u32 getNativeHandle(BufferId buffer) const = 0;
+  [[nodiscard]] virtual u32 getNativeHandle(TextureId texture) const = 0;
+  [[nodiscard]] virtual u32 getNativeHandle(ShaderId program) const = 0;
+  [[nodiscard]] virtual u32 getNativeHandle(
+    FramebufferId framebuffer) const = 0;
+  [[nodiscard]] virtual u32 getNativeHandle(
+    RenderbufferId renderbuffer) const = 0;
+
+  [[nodiscard]] virtual i32 getUniformLocation(ShaderId program,
+                                               const char* name) const = 0;
+  [[nodiscard]] virtual i32 getAttribLocation(ShaderId program,
+                                              const char* name) const = 0;
+
+  virtual void setUniformInt(i32 location, i32 value) = 0;
+  virtual void setUniformIntArray(i32 location,
+                                  std::span<const i32> values) = 0;
+  virtual void setUniformFloat(i32 location, float value) = 0;
+  virtual void setUniformVec2(i32 location, const glm::vec2& value) = 0;
+  virtual void setUniformVec3(i32 location, const glm::vec3& value) = 0;
+  virtual void setUniformVec4(i32 location, const glm::vec4& value) = 0;
+  virtual void setUniformMat3(i32 location, const glm::mat3& value) = 0;
+  virtual void setUniformMat4(i32 location, const glm::mat4& value) = 0;
+
+  [[nodiscard]] virtual FramebufferId getDefaultFramebuffer() const = 0;
+
+  virtual void bindFramebuffer(FramebufferId fbo) = 0;
+  virtual void setViewport(i32 x, i32 y, u32 width, u32 height) = 0;
+  virtual void setScissor(i32 x, i32 y, u32 width, u32 height) = 0;
+  virtual void clearColor(std::optional<u32> attachment,
+                          const glm::vec4& color) = 0;
+  virtual void clearDepth(float depth) = 0;
+  virtual void clearStencil(i32 value) = 0;
+  virtual void clearDepthStencil(float depth, i32 stencil) = 0;
+  virtual void setDepthTest(bool enable) = 0;
+  virtual void setDepthFunc(CompareOp op) = 0;
+  virtual void setDepthWrite(bool enable) = 0;
+  virtual void setCullMode(CullMode mode) = 0;
+  virtual void setFrontFace(FrontFace face) = 0;
+  virtual void setBlendEnabled(bool enable) = 0;
+  virtual void setBlendFunc(BlendFactor srcColor,
+                            BlendFactor dstColor,
+                            BlendFactor srcAlpha,
+                            BlendFactor dstAlpha) = 0;
+  virtual void setBlendEquation(BlendOp colorOp, BlendOp alphaOp) = 0;
+  virtual void setScissorTest(bool enable) = 0;
+  virtual void bindShaderProgram(ShaderId program) = 0;
+  virtual void bindTexture(u32 unit, TextureId texture) = 0;
+  virtual void bindSampler(u32 unit, SamplerId sampler) = 0;
+  virtual void blitFramebuffer(FramebufferId srcFbo,
+                               FramebufferId dstFbo,
+                               i32 srcX0,
+                               i32 srcY0,
+                               i32 srcX1,
+                               i32 srcY1,
+                               i32 dstX0,
+                               i32 dstY0,
+                               i32 dstX1,
+                               i32 dstY1,
+                               bool colorBit,
+                               bool depthBit,
+                               bool stencilBit,
+                               bool linearFilter) = 0;
+  virtual void setSeamlessCubemap(bool enable) = 0;
+  virtual void setLineWidth(float width) = 0;
+  virtual void setLineSmoothing(bool enable) = 0;
+  virtual void setColorMask(bool r, bool g, bool b, bool a) = 0;
+  virtual void setBlendColor(float r, float g, float b, float a) = 0;
+  virtual void setReadBuffer(std::optional<u32> attachment) = 0;
+  virtual void bindUniformBuffer(u32 bindingPoint,
+                                 BufferId buffer,
+                                 u64 offset,
+                                 u64 size) = 0;
+  virtual void bindUniformBlock(ShaderId program,
+                                const char* blockName,
+                                u32 bindingPoint) = 0;
+};
+
+} // namespace gfx
@@ -25,6 +25,12 @@ Device::initialize()
   defaultFb.isDefault = true;
   m_defaultFramebuffer = m_framebuffers.allocate(std::move(defaultFb));
 
+  GLint uboAlignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+  if (uboAlignment > 0) {
+    m_uniformBufferOffsetAlignment = static_cast<u32>(uboAlignment);
+  }
+
   m_stateCache.reset();
   m_initialized = true;
   return true;
@@ -87,6 +93,17 @@ Device::shutdown()
     queue.clear();
   }
 
+  for (StreamRing& ring : m_streams) {
+    for (GLsync& fence : ring.fences) {
+      if (fence != nullptr) {
+        glDeleteSync(fence);
+        fence = nullptr;
+      }
+    }
+    ring = {};
+  }
+  m_retiredStreamBuffers.clear();
+
   // Delete remaining live resources
   for (auto& buffer : m_buffers.getAll()) {
     if (buffer.glName != 0) {
@@ -181,6 +198,15 @@ Device::updateBuffer(BufferId buffer, u64 offset, const void* data, u64 size)
   }
 
   glBindBuffer(target, res->glName);
+  if (offset == 0 && hasFlag(res->usage, BufferUsage::Dynamic)) {
+    // Dynamic buffers are rewritten from the start each time. Orphaning the
+    // old storage lets the driver hand out fresh memory instead of waiting
+    // for draws still reading it.
+    glBufferData(target,
+                 static_cast<GLsizeiptr>(res->size),
+                 nullptr,
+                 toGLBufferUsage(res->usage));
+  }
   glBufferSubData(
     target, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
   glBindBuffer(target, 0);
@@ -228,6 +254,143 @@ Device::unmapBuffer(BufferId buffer)
   glBindBuffer(target, 0);
 }
 
+StreamAllocation
+Device::streamUpload(StreamUsage usage,
+                     const void* data,
+                     u64 size,
+                     u32 alignment)
+{
+  if (usage == StreamUsage::Uniform) {
+    alignment = std::max(alignment, m_uniformBufferOffsetAlignment);
+  }
+  StreamRing& ring = m_streams[static_cast<size_t>(usage)];
+  u64 offset = (ring.head + alignment - 1) / alignment * alignment;
+  if (!ring.buffer.isValid() || offset + size > ring.regionSize) {
+    growStream(ring, usage, size);
+    offset = 0;
+  }
+  ring.head = offset + size;
+
+  // Regions follow the frame index; the ring's own offset within the buffer
+  u64 regionBase = (m_frameIndex % kDeletionDelay) * ring.regionSize;
+  writeStream(ring, regionBase + offset, data, size);
+
+  m_streamStats.bytesUploaded += size;
+  m_streamStats.allocations++;
+  return { ring.buffer, regionBase + offset, size };
+}
+
+void
+Device::growStream(StreamRing& ring, StreamUsage usage, u64 minRegionSize)
+{
+  // Allocations already recorded this frame still point at the old buffer,
+  // so it is kept until endFrame()
+  static constexpr u64 kInitialRegionSize[] = { 1024 * 1024, 64 * 1024 };
+  u64 regionSize = std::max(ring.regionSize * 2,
+                            kInitialRegionSize[static_cast<size_t>(usage)]);
+  while (regionSize < minRegionSize) {
+    regionSize *= 2;
+  }
+  if (ring.buffer.isValid()) {
+    m_retiredStreamBuffers.push_back(ring.buffer);
+    m_streamStats.grows++;
+  }
+  for (GLsync& fence : ring.fences) {
+    if (fence != nullptr) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  BufferCreateInfo info{};
+  info.size = regionSize * kDeletionDelay;
+  info.usage = usage == StreamUsage::Uniform
+                 ? BufferUsage::Uniform | BufferUsage::Dynamic
+                 : BufferUsage::Vertex | BufferUsage::Dynamic;
+  info.debugName = usage == StreamUsage::Uniform ? "UniformStreamRing"
+                                                 : "VertexStreamRing";
+  ring.buffer = createBuffer(info);
+  ring.regionSize = regionSize;
+  ring.head = 0;
+}
+
+void
+Device::writeStream(const StreamRing& ring,
+                    u64 offset,
+                    const void* data,
+                    u64 size)
+{
+  auto* res = m_buffers.get(ring.buffer);
+  if (!res || res->glName == 0) {
+    return;
+  }
+  // The copy-write target leaves vertex, index and uniform bindings alone
+  glBindBuffer(GL_COPY_WRITE_BUFFER, res->glName);
+#ifndef EMSCRIPTEN
+  // The region's fence has already been waited on, so the driver does not
+  // need to synchronize the mapping
+  void* dst = glMapBufferRange(GL_COPY_WRITE_BUFFER,
+                               static_cast<GLintptr>(offset),
+                               static_cast<GLsizeiptr>(size),
+                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                 GL_MAP_UNSYNCHRONIZED_BIT);
+  if (dst != nullptr) {
+    std::memcpy(dst, data, size);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return;
+  }
+#endif
+  // WebGL has no buffer mapping; its bufferSubData copies without stalling
+  glBufferSubData(GL_COPY_WRITE_BUFFER,
+                  static_cast<GLintptr>(offset),
+                  static_cast<GLsizeiptr>(size),
+                  data);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void
+Device::beginStreamFrame()
+{
+  u32 region = m_frameIndex % kDeletionDelay;
+  for (StreamRing& ring : m_streams) {
+    ring.head = 0;
+    GLsync& fence = ring.fences[region];
+    if (fence == nullptr) {
+      continue;
+    }
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+      m_streamStats.stalls++;
+      constexpr GLuint64 kWaitNs = 1000000000;
+      glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kWaitNs);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+}
+
+void
+Device::endStreamFrame()
+{
+  u32 region = m_frameIndex % kDeletionDelay;
+  for (StreamRing& ring : m_streams) {
+    if (ring.buffer.isValid() && ring.head > 0) {
+      ring.fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    m_streamStats.capacity += ring.regionSize * kDeletionDelay;
+  }
+  // Commands using them have been submitted; the GL names themselves go
+  // through the deletion delay
+  for (BufferId buffer : m_retiredStreamBuffers) {
+    destroyBuffer(buffer);
+  }
+  m_retiredStreamBuffers.clear();
+
+  m_lastStreamStats = m_streamStats;
+  m_streamStats = {};
+}
+
 TextureId
 Device::createTexture(const TextureCreateInfo& info)
 {
@@ -822,21 +985,24 @@ Device::setFramebufferDepthAttachment(FramebufferId fbo,
     m_stateCache.boundFBO = framebuffer->glName;
   }
 
+  // Replaces a depth-stencil renderbuffer as well when it has stencil
+  GLenum attachment = GL_DEPTH_ATTACHMENT;
+  if (tex->info.format == PixelFormat::Depth24Stencil8) {
+    attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+  }
+
   if (tex->info.type == TextureType::Texture2DArray) {
     glFramebufferTextureLayer(
-      GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, tex->glName, mipLevel, layer);
+      GL_FRAMEBUFFER, attachment, tex->glName, mipLevel, layer);
   } else if (tex->info.type == TextureType::TextureCube) {
     glFramebufferTexture2D(GL_FRAMEBUFFER,
-                           GL_DEPTH_ATTACHMENT,
+                           attachment,
                            GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer,
                            tex->glName,
                            mipLevel);
   } else {
-    glFramebufferTexture2D(GL_FRAMEBUFFER,
-                           GL_DEPTH_ATTACHMENT,
-                           tex->glTarget,
-                           tex->glName,
-                           mipLevel);
+    glFramebufferTexture2D(
+      GL_FRAMEBUFFER, attachment, tex->glTarget, tex->glName, mipLevel);
   }
 }
 
@@ -1056,7 +1222,8 @@ void
 Device::drawVertexArrayDynamic(VertexArrayId vao,
                                BufferId vertexBuffer,
                                PrimitiveTopology topology,
-                               u32 vertexCount)
+                               u32 vertexCount,
+                               u64 bufferOffset)
 {
   auto* vaoRes = m_vertexArrays.get(vao);
   auto* bufRes = m_buffers.get(vertexBuffer);
@@ -1081,7 +1248,7 @@ Device::drawVertexArrayDynamic(VertexArrayId vao,
         break;
       }
     }
-    configureVertexAttribPointers(attrib, stride, 0, perInstance);
+    configureVertexAttribPointers(attrib, stride, bufferOffset, perInstance);
   }
 
   GLenum mode = toGLPrimitive(topology);
@@ -1169,11 +1336,13 @@ void
 Device::beginFrame()
 {
   processDeletionQueues();
+  beginStreamFrame();
 }
 
 void
 Device::endFrame()
 {
+  endStreamFrame();
   m_frameIndex++;
 }
 
@@ -1438,134 +1607,81 @@ Device::getDefaultFramebuffer() const
 void
 Device::executeCommandBuffer(const CommandBuffer& cmdBuffer)
 {
-  const auto& stream = cmdBuffer.getCommandStream();
   const auto& debugNames = cmdBuffer.getDebugNames();
 
-  size_t offset = 0;
-  auto read = [&]<typename T>(T& value) {
-    assert(offset + sizeof(T) <= stream.size() &&
-           "Command buffer read out of bounds");
-    std::memcpy(&value, stream.data() + offset, sizeof(T));
-    offset += sizeof(T);
-  };
-
-  while (offset < stream.size()) {
-    CommandType cmd;
-    read(cmd);
-
-    switch (cmd) {
-      case CommandType::BeginRenderPass: {
-        RenderPassBeginInfo info;
-        read(info);
-        executeBeginRenderPass(info);
+  CommandReader reader(cmdBuffer.getCommandStream());
+  while (!reader.atEnd()) {
+    switch (reader.next()) {
+      case CommandType::BeginRenderPass:
+        executeBeginRenderPass(reader.read<cmd::BeginRenderPass>().info);
         break;
-      }
       case CommandType::EndRenderPass:
         executeEndRenderPass();
         break;
-      case CommandType::BindPipeline: {
-        PipelineId pipeline;
-        read(pipeline);
-        executeBindPipeline(pipeline);
+      case CommandType::BindPipeline:
+        executeBindPipeline(reader.read<cmd::BindPipeline>().pipeline);
         break;
-      }
-      case CommandType::SetViewport: {
-        Viewport viewport;
-        read(viewport);
-        executeSetViewport(viewport);
+      case CommandType::SetViewport:
+        executeSetViewport(reader.read<cmd::SetViewport>().viewport);
         break;
-      }
-      case CommandType::SetScissor: {
-        ScissorRect scissor;
-        read(scissor);
-        executeSetScissor(scissor);
+      case CommandType::SetScissor:
+        executeSetScissor(reader.read<cmd::SetScissor>().scissor);
         break;
-      }
       case CommandType::BindVertexBuffer: {
-        u32 binding;
-        BufferId buffer;
-        u64 bufOffset;
-        read(binding);
-        read(buffer);
-        read(bufOffset);
-        executeBindVertexBuffer(binding, buffer, bufOffset);
+        auto bind = reader.read<cmd::BindVertexBuffer>();
+        executeBindVertexBuffer(bind.binding, bind.buffer, bind.offset);
         break;
       }
       case CommandType::BindIndexBuffer: {
-        BufferId buffer;
-        u64 bufOffset;
-        IndexType indexType;
-        read(buffer);
-        read(bufOffset);
-        read(indexType);
-        executeBindIndexBuffer(buffer, bufOffset, indexType);
+        auto bind = reader.read<cmd::BindIndexBuffer>();
+        executeBindIndexBuffer(bind.buffer, bind.offset, bind.indexType);
         break;
       }
       case CommandType::BindUniformBuffer: {
-        u32 binding;
-        BufferId buffer;
-        u64 bufOffset;
-        u64 size;
-        read(binding);
-        read(buffer);
-        read(bufOffset);
-        read(size);
-        auto* res = m_buffers.get(buffer);
+        auto bind = reader.read<cmd::BindUniformBuffer>();
+        auto* res = m_buffers.get(bind.buffer);
         if (res) {
           glBindBufferRange(GL_UNIFORM_BUFFER,
-                            binding,
+                            bind.binding,
                             res->glName,
-                            static_cast<GLintptr>(bufOffset),
-                            static_cast<GLsizeiptr>(size));
+                            static_cast<GLintptr>(bind.offset),
+                            static_cast<GLsizeiptr>(bind.size));
         }
         break;
       }
       case CommandType::BindTexture: {
-        u32 slot;
-        TextureId texture;
-        SamplerId sampler;
-        read(slot);
-        read(texture);
-        read(sampler);
-        executeBindTexture(slot, texture, sampler);
+        auto bind = reader.read<cmd::BindTexture>();
+        executeBindTexture(bind.slot, bind.texture, bind.sampler);
+        break;
+      }
+      case CommandType::BindTextures: {
+        auto bind = reader.read<cmd::BindTextures>();
+        for (u32 i = 0; i < bind.textures.size(); i++) {
+          executeBindTexture(
+            bind.firstSlot + i, bind.textures[i], bind.sampler);
+        }
         break;
       }
       case CommandType::SetFramebufferAttachment: {
-        FramebufferId fbo;
-        u32 attachmentIndex;
-        TextureId texture;
-        u32 mipLevel;
-        u32 layer;
-        read(fbo);
-        read(attachmentIndex);
-        read(texture);
-        read(mipLevel);
-        read(layer);
-        setFramebufferAttachment(
-          fbo, attachmentIndex, texture, mipLevel, layer);
+        auto attach = reader.read<cmd::SetFramebufferAttachment>();
+        setFramebufferAttachment(attach.fbo,
+                                 attach.attachmentIndex,
+                                 attach.texture,
+                                 attach.mipLevel,
+                                 attach.layer);
         break;
       }
       case CommandType::SetFramebufferDepthAttachment: {
-        FramebufferId fbo;
-        TextureId texture;
-        u32 mipLevel;
-        u32 layer;
-        read(fbo);
-        read(texture);
-        read(mipLevel);
-        read(layer);
-        setFramebufferDepthAttachment(fbo, texture, mipLevel, layer);
+        auto attach = reader.read<cmd::SetFramebufferDepthAttachment>();
+        setFramebufferDepthAttachment(
+          attach.fbo, attach.texture, attach.mipLevel, attach.layer);
         break;
       }
-      case CommandType::ClearDepth: {
-        float depth;
-        read(depth);
-        clearDepth(depth);
+      case CommandType::ClearDepth:
+        clearDepth(reader.read<cmd::ClearDepth>().depth);
         break;
-      }
       case CommandType::BindVertexArray: {
-        VertexArrayId vao;
-        read(vao);
+        VertexArrayId vao = reader.read<cmd::BindVertexArray>().vao;
         auto* vaoRes = m_vertexArrays.get(vao);
         if (vaoRes) {
           glBindVertexArray(vaoRes->glName);
@@ -1576,31 +1692,20 @@ Device::executeCommandBuffer(const CommandBuffer& cmdBuffer)
         break;
       }
       case CommandType::BindTextureByName: {
-        u32 slot;
-        u32 len;
-        SamplerId sampler;
-        read(slot);
-        read(len);
-        assert(offset + len <= stream.size() &&
-               "Command buffer string read out of bounds");
-        std::string textureName(
-          reinterpret_cast<const char*>(stream.data() + offset), len);
-        offset += len;
-        read(sampler);
+        auto bind = reader.read<cmd::BindTextureByName>();
         // Use RenderResources::bindTexture which handles both regular textures
         // (m_textures) and data textures (m_dataTextures like jointMats)
         auto& resources = RenderResources::getInstance();
-        resources.bindTexture(slot, textureName);
-        auto* samp = m_samplers.get(sampler);
+        resources.bindTexture(bind.slot, std::string(bind.name));
+        auto* samp = m_samplers.get(bind.sampler);
         if (samp) {
-          glBindSampler(slot, samp->glName);
-          m_stateCache.boundSamplers[slot] = samp->glName;
+          glBindSampler(bind.slot, samp->glName);
+          m_stateCache.boundSamplers[bind.slot] = samp->glName;
         }
         break;
       }
       case CommandType::SetCullMode: {
-        CullMode mode;
-        read(mode);
+        CullMode mode = reader.read<cmd::SetCullMode>().mode;
         if (mode != CullMode::None) {
           glEnable(GL_CULL_FACE);
           glCullFace(mode == CullMode::Front ? GL_FRONT : GL_BACK);
@@ -1610,9 +1715,7 @@ Device::executeCommandBuffer(const CommandBuffer& cmdBuffer)
         break;
       }
       case CommandType::SetBlendEnabled: {
-        bool enabled;
-        read(enabled);
-        if (enabled) {
+        if (reader.read<cmd::SetBlendEnabled>().enabled) {
           glEnable(GL_BLEND);
         } else {
           glDisable(GL_BLEND);
@@ -1620,15 +1723,11 @@ Device::executeCommandBuffer(const CommandBuffer& cmdBuffer)
         break;
       }
       case CommandType::SetBlendFunc: {
-        BlendFactor srcColor, dstColor, srcAlpha, dstAlpha;
-        read(srcColor);
-        read(dstColor);
-        read(srcAlpha);
-        read(dstAlpha);
-        glBlendFuncSeparate(toGLBlendFactor(srcColor),
-                            toGLBlendFactor(dstColor),
-                            toGLBlendFactor(srcAlpha),
-                            toGLBlendFactor(dstAlpha));
+        auto func = reader.read<cmd::SetBlendFunc>();
+        glBlendFuncSeparate(toGLBlendFactor(func.srcColor),
+                            toGLBlendFactor(func.dstColor),
+                            toGLBlendFactor(func.srcAlpha),
+                            toGLBlendFactor(func.dstAlpha));
         break;
       }
       case CommandType::FlushMaterialUBO: {
@@ -1637,97 +1736,67 @@ Device::executeCommandBuffer(const CommandBuffer& cmdBuffer)
         break;
       }
       case CommandType::UpdateMaterialUBO: {
-        MaterialUBO data;
-        read(data);
         auto& resources = RenderResources::getInstance();
-        resources.getMaterialUBO() = data;
+        resources.getMaterialUBO() = reader.read<cmd::UpdateMaterialUBO>().data;
         resources.flushMaterialUBO();
         break;
       }
       case CommandType::SetUniformMat4: {
-        i32 location;
-        glm::mat4 value;
-        read(location);
-        read(value);
-        glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+        auto uniform = reader.read<cmd::SetUniformMat4>();
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &uniform.value[0][0]);
         break;
       }
       case CommandType::SetUniformVec4: {
-        i32 location;
-        glm::vec4 value;
-        read(location);
-        read(value);
-        glUniform4fv(location, 1, &value[0]);
+        auto uniform = reader.read<cmd::SetUniformVec4>();
+        glUniform4fv(uniform.location, 1, &uniform.value[0]);
         break;
       }
       case CommandType::SetUniformVec3: {
-        i32 location;
-        glm::vec3 value;
-        read(location);
-        read(value);
-        glUniform3fv(location, 1, &value[0]);
+        auto uniform = reader.read<cmd::SetUniformVec3>();
+        glUniform3fv(uniform.location, 1, &uniform.value[0]);
         break;
       }
       case CommandType::SetUniformVec2: {
-        i32 location;
-        glm::vec2 value;
-        read(location);
-        read(value);
-        glUniform2fv(location, 1, &value[0]);
+        auto uniform = reader.read<cmd::SetUniformVec2>();
+        glUniform2fv(uniform.location, 1, &uniform.value[0]);
         break;
       }
       case CommandType::SetUniformFloat: {
-        i32 location;
-        float value;
-        read(location);
-        read(value);
-        glUniform1f(location, value);
+        auto uniform = reader.read<cmd::SetUniformFloat>();
+        glUniform1f(uniform.location, uniform.value);
         break;
       }
       case CommandType::SetUniformInt: {
-        i32 location;
-        i32 value;
-        read(location);
-        read(value);
-        glUniform1i(location, value);
+        auto uniform = reader.read<cmd::SetUniformInt>();
+        glUniform1i(uniform.location, uniform.value);
         break;
       }
       case CommandType::UpdateBuffer: {
-        BufferId buffer;
-        u64 bufOffset, bufSize;
-        read(buffer);
-        read(bufOffset);
-        read(bufSize);
         // Data is inline in command stream
-        const void* data = stream.data() + offset;
-        offset += static_cast<size_t>(bufSize);
-        updateBuffer(buffer, bufOffset, data, bufSize);
+        auto update = reader.read<cmd::UpdateBuffer>();
+        updateBuffer(
+          update.buffer, update.offset, update.data.data(), update.data.size());
         break;
       }
       case CommandType::Draw: {
-        u32 vertexCount, instanceCount, firstVertex, firstInstance;
-        read(vertexCount);
-        read(instanceCount);
-        read(firstVertex);
-        read(firstInstance);
-        executeDraw(vertexCount, instanceCount, firstVertex, firstInstance);
+        auto draw = reader.read<cmd::Draw>();
+        executeDraw(draw.vertexCount,
+                    draw.instanceCount,
+                    draw.firstVertex,
+                    draw.firstInstance);
         break;
       }
       case CommandType::DrawIndexed: {
-        u32 indexCount, instanceCount, firstIndex, firstInstance;
-        i32 vertexOffset;
-        read(indexCount);
-        read(instanceCount);
-        read(firstIndex);
-        read(vertexOffset);
-        read(firstInstance);
-        executeDrawIndexed(
-          indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+        auto draw = reader.read<cmd::DrawIndexed>();
+        executeDrawIndexed(draw.indexCount,
+                           draw.instanceCount,
+                           draw.firstIndex,
+                           draw.vertexOffset,
+                           draw.firstInstance);
         break;
       }
       case CommandType::PushDebugGroup: {
-        u32 nameIndex;
-        read(nameIndex);
+        u32 nameIndex = reader.read<cmd::PushDebugGroup>().nameIndex;
 #ifndef __EMSCRIPTEN__
         if (nameIndex < debugNames.size()) {
           glPushDebugGroup(
@@ -1742,40 +1811,28 @@ Device::executeCommandBuffer(const CommandBuffer& cmdBuffer)
 #endif
         break;
       case CommandType::BlitFramebuffer: {
-        FramebufferId src, dst;
-        i32 srcX0, srcY0, srcX1, srcY1;
-        i32 dstX0, dstY0, dstX1, dstY1;
-        bool colorBit, depthBit, stencilBit, linearFilter;
-        read(src);
-        read(dst);
-        read(srcX0);
-        read(srcY0);
-        read(srcX1);
-        read(srcY1);
-        read(dstX0);
-        read(dstY0);
-        read(dstX1);
-        read(dstY1);
-        read(colorBit);
-        read(depthBit);
-        read(stencilBit);
-        read(linearFilter);
-        blitFramebuffer(src,
-                        dst,
-                        srcX0,
-                        srcY0,
-                        srcX1,
-                        srcY1,
-                        dstX0,
-                        dstY0,
-                        dstX1,
-                        dstY1,
-                        colorBit,
-                        depthBit,
-                        stencilBit,
-                        linearFilter);
+        auto blit = reader.read<cmd::BlitFramebuffer>();
+        blitFramebuffer(blit.src,
+                        blit.dst,
+                        blit.srcX0,
+                        blit.srcY0,
+                        blit.srcX1,
+                        blit.srcY1,
+                        blit.dstX0,
+                        blit.dstY0,
+                        blit.dstX1,
+                        blit.dstY1,
+                        blit.colorBit,
+                        blit.depthBit,
+                        blit.stencilBit,
+                        blit.linearFilter);
         break;
       }
+      default:
+        // No executor (UpdateDataTexture); skip() stops at the end of the
+        // stream since nothing after it can be located
+        reader.skip();
+        break;
     }
   }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../../Backend.hpp"
 #include "../../CommandBuffer.hpp"
 #include "Resources.hpp"
 #include <array>
@@ -8,174 +9,210 @@
 
 namespace gfx::gles3 {
 
-class Device
+class Device final : public Backend
 {
 public:
   Device() = default;
-  ~Device();
+  ~Device() override;
 
   Device(const Device&) = delete;
   Device& operator=(const Device&) = delete;
 
-  bool initialize();
+  [[nodiscard]] BackendType type() const override
+  {
+    return BackendType::GLES3;
+  }
+
+  bool initialize() override;
 
-  void shutdown();
+  void shutdown() override;
 
-  BufferId createBuffer(const BufferCreateInfo& info);
-  void destroyBuffer(BufferId buffer);
+  BufferId createBuffer(const BufferCreateInfo& info) override;
+  void destroyBuffer(BufferId buffer) override;
 
-  TextureId createTexture(const TextureCreateInfo& info);
-  void destroyTexture(TextureId texture);
+  TextureId createTexture(const TextureCreateInfo& info) override;
+  void destroyTexture(TextureId texture) override;
 
-  SamplerId createSampler(const SamplerCreateInfo& info);
-  void destroySampler(SamplerId sampler);
+  SamplerId createSampler(const SamplerCreateInfo& info) override;
+  void destroySampler(SamplerId sampler) override;
 
-  ShaderId createShader(const ShaderCreateInfo& info);
-  ShaderId createShaderProgram(const ShaderProgramCreateInfo& info);
-  void destroyShader(ShaderId shader);
+  ShaderId createShader(const ShaderCreateInfo& info) override;
+  ShaderId createShaderProgram(const ShaderProgramCreateInfo& info) override;
+  void destroyShader(ShaderId shader) override;
 
-  PipelineId createPipeline(const PipelineCreateInfo& info);
-  void destroyPipeline(PipelineId pipeline);
+  PipelineId createPipeline(const PipelineCreateInfo& info) override;
+  void destroyPipeline(PipelineId pipeline) override;
 
-  FramebufferId createFramebuffer(const FramebufferCreateInfo& info);
-  void destroyFramebuffer(FramebufferId framebuffer);
+  FramebufferId createFramebuffer(const FramebufferCreateInfo& info) override;
+  void destroyFramebuffer(FramebufferId framebuffer) override;
   void setFramebufferAttachment(FramebufferId fbo,
                                 u32 attachmentIndex,
                                 TextureId texture,
                                 u32 mipLevel,
-                                u32 layer);
+                                u32 layer) override;
   void setFramebufferDepthAttachment(FramebufferId fbo,
                                      TextureId texture,
                                      u32 mipLevel,
-                                     u32 layer);
+                                     u32 layer) override;
   void setFramebufferRenderbuffer(FramebufferId fbo,
                                   RenderbufferAttachment attachmentType,
-                                  RenderbufferId rbo);
-  void setDrawBuffers(FramebufferId fbo, std::span<const u32> attachments);
-
-  RenderbufferId createRenderbuffer(const RenderbufferCreateInfo& info);
-  void destroyRenderbuffer(RenderbufferId renderbuffer);
-  void resizeRenderbuffer(RenderbufferId renderbuffer, u32 width, u32 height);
-
-  VertexArrayId createVertexArray(const VertexArrayCreateInfo& info);
-  void destroyVertexArray(VertexArrayId vao);
-  void bindVertexArray(VertexArrayId vao);
-  void drawVertexArray(VertexArrayId vao, BufferId vertexBuffer);
+                                  RenderbufferId rbo) override;
+  void setDrawBuffers(FramebufferId fbo,
+                      std::span<const u32> attachments) override;
+
+  RenderbufferId createRenderbuffer(
+    const RenderbufferCreateInfo& info) override;
+  void destroyRenderbuffer(RenderbufferId renderbuffer) override;
+  void resizeRenderbuffer(RenderbufferId renderbuffer,
+                          u32 width,
+                          u32 height) override;
+
+  VertexArrayId createVertexArray(const VertexArrayCreateInfo& info) override;
+  void destroyVertexArray(VertexArrayId vao) override;
+  void bindVertexArray(VertexArrayId vao) override;
+  void drawVertexArray(VertexArrayId vao, BufferId vertexBuffer) override;
+  /// `bufferOffset` is where the vertices start in `vertexBuffer`
   void drawVertexArrayDynamic(VertexArrayId vao,
                               BufferId vertexBuffer,
                               PrimitiveTopology topology,
-                              u32 vertexCount);
+                              u32 vertexCount,
+                              u64 bufferOffset) override;
   void drawIndexedVertexArray(VertexArrayId vao,
                               BufferId vertexBuffer,
                               BufferId indexBuffer,
                               u32 indexCount,
                               IndexType indexType,
-                              u32 offset = 0);
-
-  void updateBuffer(BufferId buffer, u64 offset, const void* data, u64 size);
-  void* mapBuffer(BufferId buffer);
-  void unmapBuffer(BufferId buffer);
+                              u32 offset) override;
+
+  void updateBuffer(BufferId buffer,
+                    u64 offset,
+                    const void* data,
+                    u64 size) override;
+  void* mapBuffer(BufferId buffer) override;
+  void unmapBuffer(BufferId buffer) override;
+
+  /// Copy `data` into this frame's region of the usage's streaming ring and
+  /// return where it landed, with the offset a multiple of `alignment`.
+  /// Uniform allocations are also aligned for bindUniformBuffer.
+  StreamAllocation streamUpload(StreamUsage usage,
+                                const void* data,
+                                u64 size,
+                                u32 alignment) override;
+  /// Streaming ring activity of the last completed frame
+  [[nodiscard]] const StreamStats& getStreamStats() const override
+  {
+    return m_lastStreamStats;
+  }
 
   // Texture operations
   void updateTexture(TextureId texture,
                      u32 mipLevel,
                      u32 layer,
                      const void* data,
-                     u64 dataSize);
+                     u64 dataSize) override;
   void resizeTexture(TextureId texture,
                      u32 newWidth,
                      u32 newHeight,
-                     const void* data = nullptr);
-  const TextureCreateInfo* getTextureInfo(TextureId texture) const;
-  void generateMipmaps(TextureId texture);
+                     const void* data) override;
+  const TextureCreateInfo* getTextureInfo(TextureId texture) const override;
+  void generateMipmaps(TextureId texture) override;
 
-  CommandBufferId createCommandBuffer();
-  void destroyCommandBuffer(CommandBufferId cmdBuffer);
-  CommandBuffer* getCommandBuffer(CommandBufferId cmdId);
+  CommandBufferId createCommandBuffer() override;
+  void destroyCommandBuffer(CommandBufferId cmdBuffer) override;
+  CommandBuffer* getCommandBuffer(CommandBufferId cmdId) override;
 
-  void executeCommandBuffer(const CommandBuffer& cmdBuffer);
+  void executeCommandBuffer(const CommandBuffer& cmdBuffer) override;
 
-  void beginFrame();
-  void endFrame();
+  void beginFrame() override;
+  void endFrame() override;
 
-  [[nodiscard]] bool isValid(BufferId handle) const;
-  [[nodiscard]] bool isValid(TextureId handle) const;
-  [[nodiscard]] bool isValid(SamplerId handle) const;
-  [[nodiscard]] bool isValid(ShaderId handle) const;
-  [[nodiscard]] bool isValid(PipelineId handle) const;
-  [[nodiscard]] bool isValid(FramebufferId handle) const;
-  [[nodiscard]] bool isValid(RenderbufferId handle) const;
-  [[nodiscard]] bool isValid(VertexArrayId handle) const;
+  [[nodiscard]] bool isValid(BufferId handle) const override;
+  [[nodiscard]] bool isValid(TextureId handle) const override;
+  [[nodiscard]] bool isValid(SamplerId handle) const override;
+  [[nodiscard]] bool isValid(ShaderId handle) const override;
+  [[nodiscard]] bool isValid(PipelineId handle) const override;
+  [[nodiscard]] bool isValid(FramebufferId handle) const override;
+  [[nodiscard]] bool isValid(RenderbufferId handle) const override;
+  [[nodiscard]] bool isValid(VertexArrayId handle) const override;
 
-  [[nodiscard]] bool isFramebufferComplete(FramebufferId fbo) const;
+  [[nodiscard]] bool isFramebufferComplete(FramebufferId fbo) const override;
+
+  /// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, queried at initialize()
+  [[nodiscard]] u32 getUniformBufferOffsetAlignment() const override
+  {
+    return m_uniformBufferOffsetAlignment;
+  }
 
   // Native handle access (for interop)
-  [[nodiscard]] GLuint getNativeHandle(BufferId buffer) const;
-  [[nodiscard]] GLuint getNativeHandle(TextureId texture) const;
-  [[nodiscard]] GLuint getNativeHandle(ShaderId program) const;
-  [[nodiscard]] GLuint getNativeHandle(FramebufferId framebuffer) const;
-  [[nodiscard]] GLuint getNativeHandle(RenderbufferId renderbuffer) const;
+  [[nodiscard]] GLuint getNativeHandle(BufferId buffer) const override;
+  [[nodiscard]] GLuint getNativeHandle(TextureId texture) const override;
+  [[nodiscard]] GLuint getNativeHandle(ShaderId program) const override;
+  [[nodiscard]] GLuint getNativeHandle(
+    FramebufferId framebuffer) const override;
+  [[nodiscard]] GLuint getNativeHandle(
+    RenderbufferId renderbuffer) const override;
 
   [[nodiscard]] GLint getUniformLocation(ShaderId program,
-                                         const char* name) const;
+                                         const char* name) const override;
   [[nodiscard]] GLint getAttribLocation(ShaderId program,
-                                        const char* name) const;
+                                        const char* name) const override;
 
   // Uniform setting (for gradual shader migration)
-  void setUniformInt(i32 location, i32 value);
-  void setUniformIntArray(i32 location, std::span<const i32> values);
-  void setUniformFloat(i32 location, float value);
-  void setUniformVec2(i32 location, const glm::vec2& value);
-  void setUniformVec3(i32 location, const glm::vec3& value);
-  void setUniformVec4(i32 location, const glm::vec4& value);
-  void setUniformMat3(i32 location, const glm::mat3& value);
-  void setUniformMat4(i32 location, const glm::mat4& value);
+  void setUniformInt(i32 location, i32 value) override;
+  void setUniformIntArray(i32 location, std::span<const i32> values) override;
+  void setUniformFloat(i32 location, float value) override;
+  void setUniformVec2(i32 location, const glm::vec2& value) override;
+  void setUniformVec3(i32 location, const glm::vec3& value) override;
+  void setUniformVec4(i32 location, const glm::vec4& value) override;
+  void setUniformMat3(i32 location, const glm::mat3& value) override;
+  void setUniformMat4(i32 location, const glm::mat4& value) override;
 
-  [[nodiscard]] FramebufferId getDefaultFramebuffer() const;
+  [[nodiscard]] FramebufferId getDefaultFramebuffer() const override;
 
   // Render state management (immediate mode, for migration from raw GL)
 
-  void bindFramebuffer(FramebufferId fbo);
+  void bindFramebuffer(FramebufferId fbo) override;
 
-  void setViewport(i32 x, i32 y, u32 width, u32 height);
+  void setViewport(i32 x, i32 y, u32 width, u32 height) override;
 
-  void setScissor(i32 x, i32 y, u32 width, u32 height);
+  void setScissor(i32 x, i32 y, u32 width, u32 height) override;
 
   /// Clear color attachment(s). nullopt = clear all.
-  void clearColor(std::optional<u32> attachment, const glm::vec4& color);
+  void clearColor(std::optional<u32> attachment,
+                  const glm::vec4& color) override;
 
-  void clearDepth(float depth);
+  void clearDepth(float depth) override;
 
-  void clearStencil(i32 value);
+  void clearStencil(i32 value) override;
 
-  void clearDepthStencil(float depth, i32 stencil);
+  void clearDepthStencil(float depth, i32 stencil) override;
 
-  void setDepthTest(bool enable);
+  void setDepthTest(bool enable) override;
 
-  void setDepthFunc(CompareOp op);
+  void setDepthFunc(CompareOp op) override;
 
-  void setDepthWrite(bool enable);
+  void setDepthWrite(bool enable) override;
 
-  void setCullMode(CullMode mode);
+  void setCullMode(CullMode mode) override;
 
-  void setFrontFace(FrontFace face);
+  void setFrontFace(FrontFace face) override;
 
-  void setBlendEnabled(bool enable);
+  void setBlendEnabled(bool enable) override;
 
   void setBlendFunc(BlendFactor srcColor,
                     BlendFactor dstColor,
                     BlendFactor srcAlpha,
-                    BlendFactor dstAlpha);
+                    BlendFactor dstAlpha) override;
 
-  void setBlendEquation(BlendOp colorOp, BlendOp alphaOp);
+  void setBlendEquation(BlendOp colorOp, BlendOp alphaOp) override;
 
-  void setScissorTest(bool enable);
+  void setScissorTest(bool enable) override;
 
-  void bindShaderProgram(ShaderId program);
+  void bindShaderProgram(ShaderId program) override;
 
-  void bindTexture(u32 unit, TextureId texture);
+  void bindTexture(u32 unit, TextureId texture) override;
 
-  void bindSampler(u32 unit, SamplerId sampler);
+  void bindSampler(u32 unit, SamplerId sampler) override;
 
   void blitFramebuffer(FramebufferId srcFbo,
                        FramebufferId dstFbo,
@@ -190,21 +227,21 @@ public:
                        bool colorBit,
                        bool depthBit,
                        bool stencilBit,
-                       bool linearFilter);
+                       bool linearFilter) override;
 
-  void setSeamlessCubemap(bool enable);
+  void setSeamlessCubemap(bool enable) override;
 
-  void setLineWidth(float width);
+  void setLineWidth(float width) override;
 
-  void setLineSmoothing(bool enable);
+  void setLineSmoothing(bool enable) override;
 
-  void setColorMask(bool r, bool g, bool b, bool a);
+  void setColorMask(bool r, bool g, bool b, bool a) override;
 
-  void setBlendColor(float r, float g, float b, float a);
+  void setBlendColor(float r, float g, float b, float a) override;
 
   /// Set read buffer for the currently bound framebuffer
   /// attachment: 0-7 for color attachments, nullopt for GL_NONE
-  void setReadBuffer(std::optional<u32> attachment);
+  void setReadBuffer(std::optional<u32> attachment) override;
 
   /// Bind a uniform buffer to a binding point
   /// @param bindingPoint UBO binding point (0-15)
@@ -214,7 +251,7 @@ public:
   void bindUniformBuffer(u32 bindingPoint,
                          BufferId buffer,
                          u64 offset,
-                         u64 size);
+                         u64 size) override;
 
   /// Bind a shader's uniform block to a binding point.
   /// This must be called once per shader program to associate the block name
@@ -224,7 +261,7 @@ public:
   /// @param bindingPoint UBO binding point (0-15)
   void bindUniformBlock(ShaderId program,
                         const char* blockName,
-                        u32 bindingPoint);
+                        u32 bindingPoint) override;
 
 private:
   void processDeletionQueues();
@@ -336,6 +373,32 @@ private:
   GLenum m_boundIndexType{ GL_UNSIGNED_SHORT };
   u64 m_boundIndexBufferOffset{ 0 };
 
+  // Frame-partitioned ring: the buffer holds kDeletionDelay regions and
+  // frame N writes region N % kDeletionDelay, after waiting for the fence
+  // set when that region was last used
+  struct StreamRing
+  {
+    BufferId buffer;
+    u64 regionSize{ 0 };
+    u64 head{ 0 }; // Next free byte in the current region
+    std::array<GLsync, kDeletionDelay> fences{};
+  };
+
+  void beginStreamFrame();
+  void endStreamFrame();
+  void growStream(StreamRing& ring, StreamUsage usage, u64 minRegionSize);
+  void writeStream(const StreamRing& ring,
+                   u64 offset,
+                   const void* data,
+                   u64 size);
+
+  std::array<StreamRing, static_cast<size_t>(StreamUsage::Count)> m_streams;
+  std::vector<BufferId> m_retiredStreamBuffers; // Outgrown, freed at endFrame
+  StreamStats m_streamStats;
+  StreamStats m_lastStreamStats;
+
+  // The largest value the GLES 3.0 spec allows, until queried
+  u32 m_uniformBufferOffsetAlignment{ 256 };
   bool m_initialized{ false };
 };
 
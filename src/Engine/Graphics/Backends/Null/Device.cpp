@@ -0,0 +1,880 @@
+#include "Device.hpp"
+#include <Graphics/RenderResources.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace gfx::null {
+
+Device::~Device()
+{
+  if (m_initialized) {
+    shutdown();
+  }
+}
+
+size_t
+Device::getLiveResourceCount() const
+{
+  return m_buffers.liveCount() + m_textures.liveCount() +
+         m_samplers.liveCount() + m_shaders.liveCount() +
+         m_pipelines.liveCount() + m_framebuffers.liveCount() +
+         m_renderbuffers.liveCount() + m_vertexArrays.liveCount() +
+         m_commandBuffers.liveCount();
+}
+
+bool
+Device::initialize()
+{
+  if (m_initialized) {
+    return true;
+  }
+
+  Framebuffer defaultFb;
+  defaultFb.isDefault = true;
+  m_defaultFramebuffer = m_framebuffers.allocate(std::move(defaultFb));
+
+  m_initialized = true;
+  return true;
+}
+
+void
+Device::shutdown()
+{
+  if (!m_initialized) {
+    return;
+  }
+
+  // Nothing to free on a GPU; just let go of the handles
+  for (StreamRing& ring : m_streams) {
+    m_buffers.release(ring.buffer);
+    ring = {};
+  }
+  for (BufferId buffer : m_retiredStreamBuffers) {
+    m_buffers.release(buffer);
+  }
+  m_retiredStreamBuffers.clear();
+  m_framebuffers.release(m_defaultFramebuffer);
+  m_defaultFramebuffer = {};
+
+  m_initialized = false;
+}
+
+BufferId
+Device::createBuffer(const BufferCreateInfo& info)
+{
+  Buffer buffer;
+  buffer.size = info.size;
+  buffer.usage = info.usage;
+  if (info.initialData != nullptr) {
+    m_counters.bytesUploaded += info.size;
+  }
+  return m_buffers.allocate(std::move(buffer));
+}
+
+void
+Device::destroyBuffer(BufferId buffer)
+{
+  m_buffers.release(buffer);
+}
+
+TextureId
+Device::createTexture(const TextureCreateInfo& info)
+{
+  Texture texture;
+  texture.info = info;
+  texture.info.initialData = nullptr;
+  if (info.initialData != nullptr) {
+    m_counters.bytesUploaded +=
+      u64{ info.width } * info.height * info.depthOrLayers;
+  }
+  return m_textures.allocate(std::move(texture));
+}
+
+void
+Device::destroyTexture(TextureId texture)
+{
+  m_textures.release(texture);
+}
+
+SamplerId
+Device::createSampler(const SamplerCreateInfo& /* info */)
+{
+  return m_samplers.allocate(Sampler{});
+}
+
+void
+Device::destroySampler(SamplerId sampler)
+{
+  m_samplers.release(sampler);
+}
+
+ShaderId
+Device::createShader(const ShaderCreateInfo& /* info */)
+{
+  return m_shaders.allocate(ShaderProgram{});
+}
+
+ShaderId
+Device::createShaderProgram(const ShaderProgramCreateInfo& info)
+{
+  if (!m_shaders.isValid(info.vertexShader) ||
+      !m_shaders.isValid(info.fragmentShader)) {
+    return ShaderId{};
+  }
+  ShaderProgram program;
+  program.isLinkedProgram = true;
+  return m_shaders.allocate(std::move(program));
+}
+
+void
+Device::destroyShader(ShaderId shader)
+{
+  m_shaders.release(shader);
+}
+
+PipelineId
+Device::createPipeline(const PipelineCreateInfo& /* info */)
+{
+  return m_pipelines.allocate(Pipeline{});
+}
+
+void
+Device::destroyPipeline(PipelineId pipeline)
+{
+  m_pipelines.release(pipeline);
+}
+
+FramebufferId
+Device::createFramebuffer(const FramebufferCreateInfo& /* info */)
+{
+  return m_framebuffers.allocate(Framebuffer{});
+}
+
+void
+Device::destroyFramebuffer(FramebufferId framebuffer)
+{
+  auto* fb = m_framebuffers.get(framebuffer);
+  if (fb && !fb->isDefault) {
+    m_framebuffers.release(framebuffer);
+  }
+}
+
+void
+Device::setFramebufferAttachment(FramebufferId /* fbo */,
+                                 u32 /* attachmentIndex */,
+                                 TextureId /* texture */,
+                                 u32 /* mipLevel */,
+                                 u32 /* layer */)
+{
+  stateChange();
+}
+
+void
+Device::setFramebufferDepthAttachment(FramebufferId /* fbo */,
+                                      TextureId /* texture */,
+                                      u32 /* mipLevel */,
+                                      u32 /* layer */)
+{
+  stateChange();
+}
+
+void
+Device::setFramebufferRenderbuffer(FramebufferId /* fbo */,
+                                   RenderbufferAttachment /* attachmentType */,
+                                   RenderbufferId /* rbo */)
+{
+  stateChange();
+}
+
+void
+Device::setDrawBuffers(FramebufferId /* fbo */,
+                       std::span<const u32> /* attachments */)
+{
+  stateChange();
+}
+
+RenderbufferId
+Device::createRenderbuffer(const RenderbufferCreateInfo& info)
+{
+  Renderbuffer rbo;
+  rbo.width = info.width;
+  rbo.height = info.height;
+  return m_renderbuffers.allocate(std::move(rbo));
+}
+
+void
+Device::destroyRenderbuffer(RenderbufferId renderbuffer)
+{
+  m_renderbuffers.release(renderbuffer);
+}
+
+void
+Device::resizeRenderbuffer(RenderbufferId renderbuffer, u32 width, u32 height)
+{
+  if (auto* rbo = m_renderbuffers.get(renderbuffer)) {
+    rbo->width = width;
+    rbo->height = height;
+  }
+}
+
+VertexArrayId
+Device::createVertexArray(const VertexArrayCreateInfo& /* info */)
+{
+  return m_vertexArrays.allocate(VertexArray{});
+}
+
+void
+Device::destroyVertexArray(VertexArrayId vao)
+{
+  m_vertexArrays.release(vao);
+}
+
+void
+Device::bindVertexArray(VertexArrayId /* vao */)
+{
+  stateChange();
+}
+
+void
+Device::drawVertexArray(VertexArrayId /* vao */, BufferId /* vertexBuffer */)
+{
+  draw(1);
+}
+
+void
+Device::drawVertexArrayDynamic(VertexArrayId /* vao */,
+                               BufferId /* vertexBuffer */,
+                               PrimitiveTopology /* topology */,
+                               u32 /* vertexCount */,
+                               u64 /* bufferOffset */)
+{
+  draw(1);
+}
+
+void
+Device::drawIndexedVertexArray(VertexArrayId /* vao */,
+                               BufferId /* vertexBuffer */,
+                               BufferId /* indexBuffer */,
+                               u32 /* indexCount */,
+                               IndexType /* indexType */,
+                               u32 /* offset */)
+{
+  draw(1);
+}
+
+void
+Device::updateBuffer(BufferId buffer,
+                     u64 offset,
+                     const void* /* data */,
+                     u64 size)
+{
+  auto* res = m_buffers.get(buffer);
+  if (!res) {
+    return;
+  }
+  assert(offset + size <= res->size && "Buffer update out of bounds");
+  m_counters.bytesUploaded += size;
+}
+
+void*
+Device::mapBuffer(BufferId buffer)
+{
+  auto* res = m_buffers.get(buffer);
+  if (!res) {
+    return nullptr;
+  }
+  res->mapped.resize(res->size);
+  return res->mapped.data();
+}
+
+void
+Device::unmapBuffer(BufferId buffer)
+{
+  // Counted as one upload of the whole buffer, as glUnmapBuffer would be
+  if (auto* res = m_buffers.get(buffer)) {
+    m_counters.bytesUploaded += res->size;
+  }
+}
+
+StreamAllocation
+Device::streamUpload(StreamUsage usage,
+                     const void* /* data */,
+                     u64 size,
+                     u32 alignment)
+{
+  if (usage == StreamUsage::Uniform) {
+    alignment = std::max(alignment, kUniformBufferOffsetAlignment);
+  }
+  StreamRing& ring = m_streams[static_cast<size_t>(usage)];
+  u64 offset = (ring.head + alignment - 1) / alignment * alignment;
+  if (!ring.buffer.isValid() || offset + size > ring.capacity) {
+    // Same growth as gles3::Device so capacity reads alike
+    static constexpr u64 kInitialCapacity[] = { 1024 * 1024, 64 * 1024 };
+    u64 capacity = std::max(ring.capacity * 2,
+                            kInitialCapacity[static_cast<size_t>(usage)]);
+    while (capacity < size) {
+      capacity *= 2;
+    }
+    if (ring.buffer.isValid()) {
+      m_retiredStreamBuffers.push_back(ring.buffer);
+      m_streamStats.grows++;
+    }
+    Buffer buffer;
+    buffer.size = capacity;
+    buffer.usage = usage == StreamUsage::Uniform ? BufferUsage::Uniform
+                                                 : BufferUsage::Vertex;
+    ring.buffer = m_buffers.allocate(std::move(buffer));
+    ring.capacity = capacity;
+    offset = 0;
+  }
+  ring.head = offset + size;
+
+  m_streamStats.bytesUploaded += size;
+  m_streamStats.allocations++;
+  m_counters.bytesUploaded += size;
+  return { ring.buffer, offset, size };
+}
+
+void
+Device::updateTexture(TextureId texture,
+                      u32 /* mipLevel */,
+                      u32 /* layer */,
+                      const void* /* data */,
+                      u64 dataSize)
+{
+  if (m_textures.isValid(texture)) {
+    m_counters.bytesUploaded += dataSize;
+  }
+}
+
+void
+Device::resizeTexture(TextureId texture,
+                      u32 newWidth,
+                      u32 newHeight,
+                      const void* /* data */)
+{
+  auto* res = m_textures.get(texture);
+  if (!res) {
+    return;
+  }
+  assert(res->info.storageMode == TextureStorageMode::Mutable &&
+         "resizeTexture only works on mutable-storage textures");
+  res->info.width = newWidth;
+  res->info.height = newHeight;
+}
+
+const TextureCreateInfo*
+Device::getTextureInfo(TextureId texture) const
+{
+  auto* res = m_textures.get(texture);
+  return res ? &res->info : nullptr;
+}
+
+void
+Device::generateMipmaps(TextureId /* texture */)
+{
+}
+
+CommandBufferId
+Device::createCommandBuffer()
+{
+  return m_commandBuffers.allocate(CommandBuffer{});
+}
+
+void
+Device::destroyCommandBuffer(CommandBufferId cmdBuffer)
+{
+  m_commandBuffers.release(cmdBuffer);
+}
+
+CommandBuffer*
+Device::getCommandBuffer(CommandBufferId cmdId)
+{
+  return m_commandBuffers.get(cmdId);
+}
+
+void
+Device::executeCommandBuffer(const CommandBuffer& cmdBuffer)
+{
+  m_counters.submits++;
+
+  CommandReader reader(cmdBuffer.getCommandStream());
+  while (!reader.atEnd()) {
+    CommandType type = reader.next();
+    m_counters.commands++;
+
+    switch (type) {
+      case CommandType::BindPipeline:
+      case CommandType::SetViewport:
+      case CommandType::SetScissor:
+      case CommandType::BindVertexArray:
+      case CommandType::BindVertexBuffer:
+      case CommandType::BindIndexBuffer:
+      case CommandType::BindTexture:
+      case CommandType::SetCullMode:
+      case CommandType::SetBlendEnabled:
+      case CommandType::SetBlendFunc:
+      case CommandType::SetUniformMat4:
+      case CommandType::SetUniformVec4:
+      case CommandType::SetUniformVec3:
+      case CommandType::SetUniformVec2:
+      case CommandType::SetUniformFloat:
+      case CommandType::SetUniformInt:
+        reader.skip();
+        stateChange();
+        break;
+      case CommandType::BindUniformBuffer: {
+        auto bind = reader.read<cmd::BindUniformBuffer>();
+        bindUniformBuffer(bind.binding, bind.buffer, bind.offset, bind.size);
+        break;
+      }
+      case CommandType::BindTextures:
+        m_counters.stateChanges +=
+          reader.read<cmd::BindTextures>().textures.size();
+        break;
+      case CommandType::BindTextureByName: {
+        auto bind = reader.read<cmd::BindTextureByName>();
+        // The name lookup is CPU work the GL backend does too
+        RenderResources::getInstance().bindTexture(bind.slot,
+                                                   std::string(bind.name));
+        stateChange();
+        break;
+      }
+      case CommandType::SetFramebufferAttachment: {
+        auto attach = reader.read<cmd::SetFramebufferAttachment>();
+        setFramebufferAttachment(attach.fbo,
+                                 attach.attachmentIndex,
+                                 attach.texture,
+                                 attach.mipLevel,
+                                 attach.layer);
+        break;
+      }
+      case CommandType::SetFramebufferDepthAttachment: {
+        auto attach = reader.read<cmd::SetFramebufferDepthAttachment>();
+        setFramebufferDepthAttachment(
+          attach.fbo, attach.texture, attach.mipLevel, attach.layer);
+        break;
+      }
+      case CommandType::FlushMaterialUBO:
+        RenderResources::getInstance().flushMaterialUBO();
+        break;
+      case CommandType::UpdateMaterialUBO: {
+        auto& resources = RenderResources::getInstance();
+        resources.getMaterialUBO() = reader.read<cmd::UpdateMaterialUBO>().data;
+        resources.flushMaterialUBO();
+        break;
+      }
+      case CommandType::UpdateBuffer: {
+        auto update = reader.read<cmd::UpdateBuffer>();
+        updateBuffer(
+          update.buffer, update.offset, update.data.data(), update.data.size());
+        break;
+      }
+      case CommandType::Draw:
+        draw(reader.read<cmd::Draw>().instanceCount);
+        break;
+      case CommandType::DrawIndexed:
+        draw(reader.read<cmd::DrawIndexed>().instanceCount);
+        break;
+      default:
+        // Passes, clears, blits and debug markers cost nothing here. No
+        // executor in the GL backend either for a command without a layout
+        // (UpdateDataTexture).
+        if (!reader.skip()) {
+          assert(false && "Null device: command without an executor");
+        }
+        break;
+    }
+  }
+}
+
+void
+Device::beginFrame()
+{
+  for (StreamRing& ring : m_streams) {
+    ring.head = 0;
+  }
+}
+
+void
+Device::endFrame()
+{
+  for (BufferId buffer : m_retiredStreamBuffers) {
+    m_buffers.release(buffer);
+  }
+  m_retiredStreamBuffers.clear();
+
+  m_streamStats.capacity = 0;
+  for (const StreamRing& ring : m_streams) {
+    m_streamStats.capacity += ring.capacity;
+  }
+  m_lastStreamStats = m_streamStats;
+  m_streamStats = {};
+
+  m_lastCounters = m_counters;
+  m_counters = {};
+}
+
+bool
+Device::isValid(BufferId handle) const
+{
+  return m_buffers.isValid(handle);
+}
+
+bool
+Device::isValid(TextureId handle) const
+{
+  return m_textures.isValid(handle);
+}
+
+bool
+Device::isValid(SamplerId handle) const
+{
+  return m_samplers.isValid(handle);
+}
+
+bool
+Device::isValid(ShaderId handle) const
+{
+  return m_shaders.isValid(handle);
+}
+
+bool
+Device::isValid(PipelineId handle) const
+{
+  return m_pipelines.isValid(handle);
+}
+
+bool
+Device::isValid(FramebufferId handle) const
+{
+  return m_framebuffers.isValid(handle);
+}
+
+bool
+Device::isValid(RenderbufferId handle) const
+{
+  return m_renderbuffers.isValid(handle);
+}
+
+bool
+Device::isValid(VertexArrayId handle) const
+{
+  return m_vertexArrays.isValid(handle);
+}
+
+bool
+Device::isFramebufferComplete(FramebufferId fbo) const
+{
+  return m_framebuffers.isValid(fbo);
+}
+
+u32
+Device::getNativeHandle(BufferId /* buffer */) const
+{
+  return 0;
+}
+
+u32
+Device::getNativeHandle(TextureId /* texture */) const
+{
+  return 0;
+}
+
+u32
+Device::getNativeHandle(ShaderId /* program */) const
+{
+  return 0;
+}
+
+u32
+Device::getNativeHandle(FramebufferId /* framebuffer */) const
+{
+  return 0;
+}
+
+u32
+Device::getNativeHandle(RenderbufferId /* renderbuffer */) const
+{
+  return 0;
+}
+
+i32
+Device::getUniformLocation(ShaderId program, const char* name) const
+{
+  auto* res = m_shaders.get(program);
+  if (!res || !res->isLinkedProgram) {
+    return -1;
+  }
+  // const_cast for the name table, as the GL backend does for its cache
+  auto& uniforms = const_cast<ShaderProgram*>(res)->uniforms;
+  auto [it, inserted] =
+    uniforms.try_emplace(name, static_cast<i32>(uniforms.size()));
+  return it->second;
+}
+
+i32
+Device::getAttribLocation(ShaderId program, const char* name) const
+{
+  auto* res = m_shaders.get(program);
+  if (!res || !res->isLinkedProgram) {
+    return -1;
+  }
+  auto& attribs = const_cast<ShaderProgram*>(res)->attribs;
+  auto [it, inserted] =
+    attribs.try_emplace(name, static_cast<i32>(attribs.size()));
+  return it->second;
+}
+
+void
+Device::setUniformInt(i32 /* location */, i32 /* value */)
+{
+  stateChange();
+}
+
+void
+Device::setUniformIntArray(i32 /* location */,
+                           std::span<const i32> /* values */)
+{
+  stateChange();
+}
+
+void
+Device::setUniformFloat(i32 /* location */, float /* value */)
+{
+  stateChange();
+}
+
+void
+Device::setUniformVec2(i32 /* location */, const glm::vec2& /* value */)
+{
+  stateChange();
+}
+
+void
+Device::setUniformVec3(i32 /* location */, const glm::vec3& /* value */)
+{
+  stateChange();
+}
+
+void
+Device::setUniformVec4(i32 /* location */, const glm::vec4& /* value */)
+{
+  stateChange();
+}
+
+void
+Device::setUniformMat3(i32 /* location */, const glm::mat3& /* value */)
+{
+  stateChange();
+}
+
+void
+Device::setUniformMat4(i32 /* location */, const glm::mat4& /* value */)
+{
+  stateChange();
+}
+
+FramebufferId
+Device::getDefaultFramebuffer() const
+{
+  return m_defaultFramebuffer;
+}
+
+void
+Device::bindFramebuffer(FramebufferId /* fbo */)
+{
+  stateChange();
+}
+
+void
+Device::setViewport(i32 /* x */, i32 /* y */, u32 /* width */, u32 /* height */)
+{
+  stateChange();
+}
+
+void
+Device::setScissor(i32 /* x */, i32 /* y */, u32 /* width */, u32 /* height */)
+{
+  stateChange();
+}
+
+void
+Device::clearColor(std::optional<u32> /* attachment */,
+                   const glm::vec4& /* color */)
+{
+}
+
+void
+Device::clearDepth(float /* depth */)
+{
+}
+
+void
+Device::clearStencil(i32 /* value */)
+{
+}
+
+void
+Device::clearDepthStencil(float /* depth */, i32 /* stencil */)
+{
+}
+
+void
+Device::setDepthTest(bool /* enable */)
+{
+  stateChange();
+}
+
+void
+Device::setDepthFunc(CompareOp /* op */)
+{
+  stateChange();
+}
+
+void
+Device::setDepthWrite(bool /* enable */)
+{
+  stateChange();
+}
+
+void
+Device::setCullMode(CullMode /* mode */)
+{
+  stateChange();
+}
+
+void
+Device::setFrontFace(FrontFace /* face */)
+{
+  stateChange();
+}
+
+void
+Device::setBlendEnabled(bool /* enable */)
+{
+  stateChange();
+}
+
+void
+Device::setBlendFunc(BlendFactor /* srcColor */,
+                     BlendFactor /* dstColor */,
+                     BlendFactor /* srcAlpha */,
+                     BlendFactor /* dstAlpha */)
+{
+  stateChange();
+}
+
+void
+Device::setBlendEquation(BlendOp /* colorOp */, BlendOp /* alphaOp */)
+{
+  stateChange();
+}
+
+void
+Device::setScissorTest(bool /* enable */)
+{
+  stateChange();
+}
+
+void
+Device::bindShaderProgram(ShaderId /* program */)
+{
+  stateChange();
+}
+
+void
+Device::bindTexture(u32 /* unit */, TextureId /* texture */)
+{
+  stateChange();
+}
+
+void
+Device::bindSampler(u32 /* unit */, SamplerId /* sampler */)
+{
+  stateChange();
+}
+
+void
+Device::blitFramebuffer(FramebufferId /* srcFbo */,
+                        FramebufferId /* dstFbo */,
+                        i32 /* srcX0 */,
+                        i32 /* srcY0 */,
+                        i32 /* srcX1 */,
+                        i32 /* srcY1 */,
+                        i32 /* dstX0 */,
+                        i32 /* dstY0 */,
+                        i32 /* dstX1 */,
+                        i32 /* dstY1 */,
+                        bool /* colorBit */,
+                        bool /* depthBit */,
+                        bool /* stencilBit */,
+                        bool /* linearFilter */)
+{
+}
+
+void
+Device::setSeamlessCubemap(bool /* enable */)
+{
+}
+
+void
+Device::setLineWidth(float /* width */)
+{
+}
+
+void
+Device::setLineSmoothing(bool /* enable */)
+{
+}
+
+void
+Device::setColorMask(bool /* r */, bool /* g */, bool /* b */, bool /* a */)
+{
+  stateChange();
+}
+
+void
+Device::setBlendColor(float /* r */,
+                      float /* g */,
+                      float /* b */,
+                      float /* a */)
+{
+  stateChange();
+}
+
+void
+Device::setReadBuffer(std::optional<u32> /* attachment */)
+{
+}
+
+void
+Device::bindUniformBuffer(u32 /* bindingPoint */,
+                          BufferId buffer,
+                          u64 offset,
+                          u64 size)
+{
+  auto* res = m_buffers.get(buffer);
+  assert((!res || offset + size <= res->size) &&
+         "Uniform buffer range out of bounds");
+  (void)res;
+  (void)offset;
+  (void)size;
+  stateChange();
+}
+
+void
+Device::bindUniformBlock(ShaderId /* program */,
+                         const char* /* blockName */,
+                         u32 /* bindingPoint */)
+{
+}
+
+void
+Device::draw(u32 instanceCount)
+{
+  m_counters.draws++;
+  m_counters.instances += instanceCount;
+}
+
+} // namespace gfx::null
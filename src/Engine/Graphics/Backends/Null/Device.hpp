@@ -0,0 +1,318 @@
+#pragma once
+
+#include "../../Backend.hpp"
+#include "../../ResourcePool.hpp"
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gfx::null {
+
+/// What the null backend was asked to do during one frame
+struct FrameCounters
+{
+  u32 submits{ 0 };  // Command buffers executed
+  u32 commands{ 0 }; // Commands decoded from them
+  u32 draws{ 0 };    // Draw calls, recorded or immediate
+  u64 instances{ 0 };
+  u32 stateChanges{ 0 }; // Binds, raster state and uniforms
+  u64 bytesUploaded{ 0 }; // Buffer and texture updates plus streamed data
+};
+
+struct Buffer
+{
+  u64 size{ 0 };
+  BufferUsage usage{ BufferUsage::None };
+  std::vector<u8> mapped; // Backing for mapBuffer(), allocated on first map
+};
+
+struct Texture
+{
+  TextureCreateInfo info;
+};
+
+struct ShaderProgram
+{
+  bool isLinkedProgram{ false };
+  // Locations handed out by name, stable for the program's lifetime
+  std::unordered_map<std::string, i32> uniforms;
+  std::unordered_map<std::string, i32> attribs;
+};
+
+struct Framebuffer
+{
+  bool isDefault{ false };
+};
+
+struct Renderbuffer
+{
+  u32 width{ 0 };
+  u32 height{ 0 };
+};
+
+// Nothing to keep for these beyond the handle
+struct Sampler
+{};
+struct Pipeline
+{};
+struct VertexArray
+{};
+
+/// Backend without a GPU. Resources are handed out from the same
+/// ResourcePool scheme as gles3::Device, so handles behave identically, and
+/// every CommandBuffer is decoded in full without issuing any GL call. What
+/// would have reached the GPU is tallied in FrameCounters instead.
+///
+/// Lets the CPU side of rendering (pass recording, instancing, culling,
+/// command encoding and decoding) run, be profiled and be tested in a
+/// process without a window or GL context.
+class Device final : public Backend
+{
+public:
+  Device() = default;
+  ~Device() override;
+
+  Device(const Device&) = delete;
+  Device& operator=(const Device&) = delete;
+
+  [[nodiscard]] BackendType type() const override { return BackendType::Null; }
+
+  /// Counters of the last completed frame, i.e. up to the last endFrame()
+  [[nodiscard]] const FrameCounters& getFrameCounters() const
+  {
+    return m_lastCounters;
+  }
+  /// Resources of every kind currently allocated, command buffers included
+  [[nodiscard]] size_t getLiveResourceCount() const;
+
+  bool initialize() override;
+  void shutdown() override;
+
+  BufferId createBuffer(const BufferCreateInfo& info) override;
+  void destroyBuffer(BufferId buffer) override;
+
+  TextureId createTexture(const TextureCreateInfo& info) override;
+  void destroyTexture(TextureId texture) override;
+
+  SamplerId createSampler(const SamplerCreateInfo& info) override;
+  void destroySampler(SamplerId sampler) override;
+
+  ShaderId createShader(const ShaderCreateInfo& info) override;
+  ShaderId createShaderProgram(const ShaderProgramCreateInfo& info) override;
+  void destroyShader(ShaderId shader) override;
+
+  PipelineId createPipeline(const PipelineCreateInfo& info) override;
+  void destroyPipeline(PipelineId pipeline) override;
+
+  FramebufferId createFramebuffer(const FramebufferCreateInfo& info) override;
+  void destroyFramebuffer(FramebufferId framebuffer) override;
+  void setFramebufferAttachment(FramebufferId fbo,
+                                u32 attachmentIndex,
+                                TextureId texture,
+                                u32 mipLevel,
+                                u32 layer) override;
+  void setFramebufferDepthAttachment(FramebufferId fbo,
+                                     TextureId texture,
+                                     u32 mipLevel,
+                                     u32 layer) override;
+  void setFramebufferRenderbuffer(FramebufferId fbo,
+                                  RenderbufferAttachment attachmentType,
+                                  RenderbufferId rbo) override;
+  void setDrawBuffers(FramebufferId fbo,
+                      std::span<const u32> attachments) override;
+
+  RenderbufferId createRenderbuffer(
+    const RenderbufferCreateInfo& info) override;
+  void destroyRenderbuffer(RenderbufferId renderbuffer) override;
+  void resizeRenderbuffer(RenderbufferId renderbuffer,
+                          u32 width,
+                          u32 height) override;
+
+  VertexArrayId createVertexArray(const VertexArrayCreateInfo& info) override;
+  void destroyVertexArray(VertexArrayId vao) override;
+  void bindVertexArray(VertexArrayId vao) override;
+  void drawVertexArray(VertexArrayId vao, BufferId vertexBuffer) override;
+  void drawVertexArrayDynamic(VertexArrayId vao,
+                              BufferId vertexBuffer,
+                              PrimitiveTopology topology,
+                              u32 vertexCount,
+                              u64 bufferOffset) override;
+  void drawIndexedVertexArray(VertexArrayId vao,
+                              BufferId vertexBuffer,
+                              BufferId indexBuffer,
+                              u32 indexCount,
+                              IndexType indexType,
+                              u32 offset) override;
+
+  void updateBuffer(BufferId buffer,
+                    u64 offset,
+                    const void* data,
+                    u64 size) override;
+  void* mapBuffer(BufferId buffer) override;
+  void unmapBuffer(BufferId buffer) override;
+
+  /// Bump-allocates from one buffer per usage, rewound every beginFrame();
+  /// nothing is in flight, so it never stalls
+  StreamAllocation streamUpload(StreamUsage usage,
+                                const void* data,
+                                u64 size,
+                                u32 alignment) override;
+  [[nodiscard]] const StreamStats& getStreamStats() const override
+  {
+    return m_lastStreamStats;
+  }
+
+  void updateTexture(TextureId texture,
+                     u32 mipLevel,
+                     u32 layer,
+                     const void* data,
+                     u64 dataSize) override;
+  void resizeTexture(TextureId texture,
+                     u32 newWidth,
+                     u32 newHeight,
+                     const void* data) override;
+  const TextureCreateInfo* getTextureInfo(TextureId texture) const override;
+  void generateMipmaps(TextureId texture) override;
+
+  CommandBufferId createCommandBuffer() override;
+  void destroyCommandBuffer(CommandBufferId cmdBuffer) override;
+  CommandBuffer* getCommandBuffer(CommandBufferId cmdId) override;
+
+  void executeCommandBuffer(const CommandBuffer& cmdBuffer) override;
+
+  void beginFrame() override;
+  void endFrame() override;
+
+  [[nodiscard]] bool isValid(BufferId handle) const override;
+  [[nodiscard]] bool isValid(TextureId handle) const override;
+  [[nodiscard]] bool isValid(SamplerId handle) const override;
+  [[nodiscard]] bool isValid(ShaderId handle) const override;
+  [[nodiscard]] bool isValid(PipelineId handle) const override;
+  [[nodiscard]] bool isValid(FramebufferId handle) const override;
+  [[nodiscard]] bool isValid(RenderbufferId handle) const override;
+  [[nodiscard]] bool isValid(VertexArrayId handle) const override;
+
+  [[nodiscard]] bool isFramebufferComplete(FramebufferId fbo) const override;
+
+  /// The largest value GLES 3.0 allows, so ranges are laid out as on the
+  /// strictest GL device
+  [[nodiscard]] u32 getUniformBufferOffsetAlignment() const override
+  {
+    return kUniformBufferOffsetAlignment;
+  }
+
+  /// No native objects; always 0
+  [[nodiscard]] u32 getNativeHandle(BufferId buffer) const override;
+  [[nodiscard]] u32 getNativeHandle(TextureId texture) const override;
+  [[nodiscard]] u32 getNativeHandle(ShaderId program) const override;
+  [[nodiscard]] u32 getNativeHandle(FramebufferId framebuffer) const override;
+  [[nodiscard]] u32 getNativeHandle(
+    RenderbufferId renderbuffer) const override;
+
+  /// Every name resolves, to a location unique within the program
+  [[nodiscard]] i32 getUniformLocation(ShaderId program,
+                                       const char* name) const override;
+  [[nodiscard]] i32 getAttribLocation(ShaderId program,
+                                      const char* name) const override;
+
+  void setUniformInt(i32 location, i32 value) override;
+  void setUniformIntArray(i32 location, std::span<const i32> values) override;
+  void setUniformFloat(i32 location, float value) override;
+  void setUniformVec2(i32 location, const glm::vec2& value) override;
+  void setUniformVec3(i32 location, const glm::vec3& value) override;
+  void setUniformVec4(i32 location, const glm::vec4& value) override;
+  void setUniformMat3(i32 location, const glm::mat3& value) override;
+  void setUniformMat4(i32 location, const glm::mat4& value) override;
+
+  [[nodiscard]] FramebufferId getDefaultFramebuffer() const override;
+
+  void bindFramebuffer(FramebufferId fbo) override;
+  void setViewport(i32 x, i32 y, u32 width, u32 height) override;
+  void setScissor(i32 x, i32 y, u32 width, u32 height) override;
+  void clearColor(std::optional<u32> attachment,
+                  const glm::vec4& color) override;
+  void clearDepth(float depth) override;
+  void clearStencil(i32 value) override;
+  void clearDepthStencil(float depth, i32 stencil) override;
+  void setDepthTest(bool enable) override;
+  void setDepthFunc(CompareOp op) override;
+  void setDepthWrite(bool enable) override;
+  void setCullMode(CullMode mode) override;
+  void setFrontFace(FrontFace face) override;
+  void setBlendEnabled(bool enable) override;
+  void setBlendFunc(BlendFactor srcColor,
+                    BlendFactor dstColor,
+                    BlendFactor srcAlpha,
+                    BlendFactor dstAlpha) override;
+  void setBlendEquation(BlendOp colorOp, BlendOp alphaOp) override;
+  void setScissorTest(bool enable) override;
+  void bindShaderProgram(ShaderId program) override;
+  void bindTexture(u32 unit, TextureId texture) override;
+  void bindSampler(u32 unit, SamplerId sampler) override;
+  void blitFramebuffer(FramebufferId srcFbo,
+                       FramebufferId dstFbo,
+                       i32 srcX0,
+                       i32 srcY0,
+                       i32 srcX1,
+                       i32 srcY1,
+                       i32 dstX0,
+                       i32 dstY0,
+                       i32 dstX1,
+                       i32 dstY1,
+                       bool colorBit,
+                       bool depthBit,
+                       bool stencilBit,
+                       bool linearFilter) override;
+  void setSeamlessCubemap(bool enable) override;
+  void setLineWidth(float width) override;
+  void setLineSmoothing(bool enable) override;
+  void setColorMask(bool r, bool g, bool b, bool a) override;
+  void setBlendColor(float r, float g, float b, float a) override;
+  void setReadBuffer(std::optional<u32> attachment) override;
+  void bindUniformBuffer(u32 bindingPoint,
+                         BufferId buffer,
+                         u64 offset,
+                         u64 size) override;
+  void bindUniformBlock(ShaderId program,
+                        const char* blockName,
+                        u32 bindingPoint) override;
+
+private:
+  static constexpr u32 kUniformBufferOffsetAlignment = 256;
+
+  struct StreamRing
+  {
+    BufferId buffer;
+    u64 capacity{ 0 };
+    u64 head{ 0 };
+  };
+
+  void draw(u32 instanceCount);
+  void stateChange() { m_counters.stateChanges++; }
+
+  ResourcePool<Buffer, BufferId> m_buffers;
+  ResourcePool<Texture, TextureId> m_textures;
+  ResourcePool<Sampler, SamplerId> m_samplers;
+  ResourcePool<ShaderProgram, ShaderId> m_shaders;
+  ResourcePool<Pipeline, PipelineId> m_pipelines;
+  ResourcePool<Framebuffer, FramebufferId> m_framebuffers;
+  ResourcePool<Renderbuffer, RenderbufferId> m_renderbuffers;
+  ResourcePool<VertexArray, VertexArrayId> m_vertexArrays;
+  ResourcePool<CommandBuffer, CommandBufferId> m_commandBuffers;
+
+  FramebufferId m_defaultFramebuffer;
+
+  std::array<StreamRing, static_cast<size_t>(StreamUsage::Count)> m_streams;
+  // Outgrown ring buffers; recorded allocations may still name them, so
+  // they are released at endFrame()
+  std::vector<BufferId> m_retiredStreamBuffers;
+  StreamStats m_streamStats;
+  StreamStats m_lastStreamStats;
+
+  FrameCounters m_counters;
+  FrameCounters m_lastCounters;
+  bool m_initialized{ false };
+};
+
+} // namespace gfx::null
@@ -3,6 +3,15 @@
 
 namespace gfx {
 
+template<typename Cmd>
+void
+CommandBuffer::record(Cmd command)
+{
+  encode(Cmd::kType);
+  std::apply([this](const auto&... field) { (encode(field), ...); },
+             command.fields());
+}
+
 template<typename T>
 void
 CommandBuffer::encode(const T& value)
@@ -12,68 +21,75 @@ CommandBuffer::encode(const T& value)
 }
 
 void
-CommandBuffer::encodeCommand(CommandType cmd)
+CommandBuffer::encode(const TextureList& textures)
 {
-  encode(cmd);
+  encode(textures.size());
+  const auto* bytes = reinterpret_cast<const u8*>(textures.bytes().data());
+  m_commandStream.insert(
+    m_commandStream.end(), bytes, bytes + textures.bytes().size());
+}
+
+void
+CommandBuffer::encode(std::string_view text)
+{
+  encode(static_cast<u32>(text.size()));
+  m_commandStream.insert(m_commandStream.end(), text.begin(), text.end());
+}
+
+void
+CommandBuffer::encode(std::span<const std::byte> bytes)
+{
+  encode(static_cast<u64>(bytes.size()));
+  const auto* data = reinterpret_cast<const u8*>(bytes.data());
+  m_commandStream.insert(m_commandStream.end(), data, data + bytes.size());
 }
 
 void
 CommandBuffer::beginRenderPass(const RenderPassBeginInfo& info)
 {
-  encodeCommand(CommandType::BeginRenderPass);
-  encode(info);
+  record(cmd::BeginRenderPass{ info });
 }
 
 void
 CommandBuffer::endRenderPass()
 {
-  encodeCommand(CommandType::EndRenderPass);
+  record(cmd::EndRenderPass{});
 }
 
 void
 CommandBuffer::bindPipeline(PipelineId pipeline)
 {
-  encodeCommand(CommandType::BindPipeline);
-  encode(pipeline);
+  record(cmd::BindPipeline{ pipeline });
 }
 
 void
 CommandBuffer::setViewport(const Viewport& viewport)
 {
-  encodeCommand(CommandType::SetViewport);
-  encode(viewport);
+  record(cmd::SetViewport{ viewport });
 }
 
 void
 CommandBuffer::setScissor(const ScissorRect& scissor)
 {
-  encodeCommand(CommandType::SetScissor);
-  encode(scissor);
+  record(cmd::SetScissor{ scissor });
 }
 
 void
 CommandBuffer::bindVertexArray(VertexArrayId vao)
 {
-  encodeCommand(CommandType::BindVertexArray);
-  encode(vao);
+  record(cmd::BindVertexArray{ vao });
 }
 
 void
 CommandBuffer::bindVertexBuffer(u32 binding, BufferId buffer, u64 offset)
 {
-  encodeCommand(CommandType::BindVertexBuffer);
-  encode(binding);
-  encode(buffer);
-  encode(offset);
+  record(cmd::BindVertexBuffer{ binding, buffer, offset });
 }
 
 void
 CommandBuffer::bindIndexBuffer(BufferId buffer, u64 offset, IndexType indexType)
 {
-  encodeCommand(CommandType::BindIndexBuffer);
-  encode(buffer);
-  encode(offset);
-  encode(indexType);
+  record(cmd::BindIndexBuffer{ buffer, offset, indexType });
 }
 
 void
@@ -82,20 +98,21 @@ CommandBuffer::bindUniformBuffer(u32 binding,
                                  u64 offset,
                                  u64 size)
 {
-  encodeCommand(CommandType::BindUniformBuffer);
-  encode(binding);
-  encode(buffer);
-  encode(offset);
-  encode(size);
+  record(cmd::BindUniformBuffer{ binding, buffer, offset, size });
 }
 
 void
 CommandBuffer::bindTexture(u32 slot, TextureId texture, SamplerId sampler)
 {
-  encodeCommand(CommandType::BindTexture);
-  encode(slot);
-  encode(texture);
-  encode(sampler);
+  record(cmd::BindTexture{ slot, texture, sampler });
+}
+
+void
+CommandBuffer::bindTextures(u32 firstSlot,
+                            std::span<const TextureId> textures,
+                            SamplerId sampler)
+{
+  record(cmd::BindTextures{ firstSlot, sampler, TextureList(textures) });
 }
 
 void
@@ -103,14 +120,7 @@ CommandBuffer::bindTextureByName(u32 slot,
                                  const std::string& textureName,
                                  SamplerId sampler)
 {
-  encodeCommand(CommandType::BindTextureByName);
-  encode(slot);
-  // Encode string length followed by characters
-  u32 len = static_cast<u32>(textureName.size());
-  encode(len);
-  m_commandStream.insert(
-    m_commandStream.end(), textureName.begin(), textureName.end());
-  encode(sampler);
+  record(cmd::BindTextureByName{ slot, textureName, sampler });
 }
 
 void
@@ -120,12 +130,8 @@ CommandBuffer::setFramebufferAttachment(FramebufferId fbo,
                                         u32 mipLevel,
                                         u32 layer)
 {
-  encodeCommand(CommandType::SetFramebufferAttachment);
-  encode(fbo);
-  encode(attachmentIndex);
-  encode(texture);
-  encode(mipLevel);
-  encode(layer);
+  record(cmd::SetFramebufferAttachment{
+    fbo, attachmentIndex, texture, mipLevel, layer });
 }
 
 void
@@ -134,32 +140,25 @@ CommandBuffer::setFramebufferDepthAttachment(FramebufferId fbo,
                                              u32 mipLevel,
                                              u32 layer)
 {
-  encodeCommand(CommandType::SetFramebufferDepthAttachment);
-  encode(fbo);
-  encode(texture);
-  encode(mipLevel);
-  encode(layer);
+  record(cmd::SetFramebufferDepthAttachment{ fbo, texture, mipLevel, layer });
 }
 
 void
 CommandBuffer::clearDepth(float depth)
 {
-  encodeCommand(CommandType::ClearDepth);
-  encode(depth);
+  record(cmd::ClearDepth{ depth });
 }
 
 void
 CommandBuffer::setCullMode(CullMode mode)
 {
-  encodeCommand(CommandType::SetCullMode);
-  encode(mode);
+  record(cmd::SetCullMode{ mode });
 }
 
 void
 CommandBuffer::setBlendEnabled(bool enabled)
 {
-  encodeCommand(CommandType::SetBlendEnabled);
-  encode(enabled);
+  record(cmd::SetBlendEnabled{ enabled });
 }
 
 void
@@ -168,72 +167,55 @@ CommandBuffer::setBlendFunc(BlendFactor srcColor,
                             BlendFactor srcAlpha,
                             BlendFactor dstAlpha)
 {
-  encodeCommand(CommandType::SetBlendFunc);
-  encode(srcColor);
-  encode(dstColor);
-  encode(srcAlpha);
-  encode(dstAlpha);
+  record(cmd::SetBlendFunc{ srcColor, dstColor, srcAlpha, dstAlpha });
 }
 
 void
 CommandBuffer::flushMaterialUBO()
 {
-  encodeCommand(CommandType::FlushMaterialUBO);
+  record(cmd::FlushMaterialUBO{});
 }
 
 void
 CommandBuffer::updateMaterialUBO(const MaterialUBO& data)
 {
-  encodeCommand(CommandType::UpdateMaterialUBO);
-  encode(data);
+  record(cmd::UpdateMaterialUBO{ data });
 }
 
 void
 CommandBuffer::setUniform(i32 location, const glm::mat4& value)
 {
-  encodeCommand(CommandType::SetUniformMat4);
-  encode(location);
-  encode(value);
+  record(cmd::SetUniformMat4{ location, value });
 }
 
 void
 CommandBuffer::setUniform(i32 location, const glm::vec4& value)
 {
-  encodeCommand(CommandType::SetUniformVec4);
-  encode(location);
-  encode(value);
+  record(cmd::SetUniformVec4{ location, value });
 }
 
 void
 CommandBuffer::setUniform(i32 location, const glm::vec3& value)
 {
-  encodeCommand(CommandType::SetUniformVec3);
-  encode(location);
-  encode(value);
+  record(cmd::SetUniformVec3{ location, value });
 }
 
 void
 CommandBuffer::setUniform(i32 location, const glm::vec2& value)
 {
-  encodeCommand(CommandType::SetUniformVec2);
-  encode(location);
-  encode(value);
+  record(cmd::SetUniformVec2{ location, value });
 }
 
 void
 CommandBuffer::setUniform(i32 location, float value)
 {
-  encodeCommand(CommandType::SetUniformFloat);
-  encode(location);
-  encode(value);
+  record(cmd::SetUniformFloat{ location, value });
 }
 
 void
 CommandBuffer::setUniform(i32 location, i32 value)
 {
-  encodeCommand(CommandType::SetUniformInt);
-  encode(location);
-  encode(value);
+  record(cmd::SetUniformInt{ location, value });
 }
 
 void
@@ -242,13 +224,11 @@ CommandBuffer::updateBuffer(BufferId buffer,
                             const void* data,
                             u64 size)
 {
-  encodeCommand(CommandType::UpdateBuffer);
-  encode(buffer);
-  encode(offset);
-  encode(size);
   // Inline the raw data bytes into the command stream
-  const auto* bytes = reinterpret_cast<const u8*>(data);
-  m_commandStream.insert(m_commandStream.end(), bytes, bytes + size);
+  record(cmd::UpdateBuffer{
+    buffer,
+    offset,
+    { static_cast<const std::byte*>(data), static_cast<size_t>(size) } });
 }
 
 void
@@ -257,11 +237,7 @@ CommandBuffer::draw(u32 vertexCount,
                     u32 firstVertex,
                     u32 firstInstance)
 {
-  encodeCommand(CommandType::Draw);
-  encode(vertexCount);
-  encode(instanceCount);
-  encode(firstVertex);
-  encode(firstInstance);
+  record(cmd::Draw{ vertexCount, instanceCount, firstVertex, firstInstance });
 }
 
 void
@@ -271,12 +247,8 @@ CommandBuffer::drawIndexed(u32 indexCount,
                            i32 vertexOffset,
                            u32 firstInstance)
 {
-  encodeCommand(CommandType::DrawIndexed);
-  encode(indexCount);
-  encode(instanceCount);
-  encode(firstIndex);
-  encode(vertexOffset);
-  encode(firstInstance);
+  record(cmd::DrawIndexed{
+    indexCount, instanceCount, firstIndex, vertexOffset, firstInstance });
 }
 
 void
@@ -295,36 +267,34 @@ CommandBuffer::blitFramebuffer(FramebufferId src,
                                bool stencilBit,
                                bool linearFilter)
 {
-  encodeCommand(CommandType::BlitFramebuffer);
-  encode(src);
-  encode(dst);
-  encode(srcX0);
-  encode(srcY0);
-  encode(srcX1);
-  encode(srcY1);
-  encode(dstX0);
-  encode(dstY0);
-  encode(dstX1);
-  encode(dstY1);
-  encode(colorBit);
-  encode(depthBit);
-  encode(stencilBit);
-  encode(linearFilter);
+  record(cmd::BlitFramebuffer{ src,
+                               dst,
+                               srcX0,
+                               srcY0,
+                               srcX1,
+                               srcY1,
+                               dstX0,
+                               dstY0,
+                               dstX1,
+                               dstY1,
+                               colorBit,
+                               depthBit,
+                               stencilBit,
+                               linearFilter });
 }
 
 void
 CommandBuffer::pushDebugGroup(const char* name)
 {
-  encodeCommand(CommandType::PushDebugGroup);
   u32 nameIndex = static_cast<u32>(m_debugNames.size());
   m_debugNames.emplace_back(name);
-  encode(nameIndex);
+  record(cmd::PushDebugGroup{ nameIndex });
 }
 
 void
 CommandBuffer::popDebugGroup()
 {
-  encodeCommand(CommandType::PopDebugGroup);
+  record(cmd::PopDebugGroup{});
 }
 
 void
@@ -334,4 +304,132 @@ CommandBuffer::reset()
   m_debugNames.clear();
 }
 
+void
+CommandReader::readField(TextureList& textures)
+{
+  u32 count;
+  readField(count);
+  textures = TextureList(take(count * sizeof(TextureId)));
+}
+
+void
+CommandReader::readField(std::string_view& text)
+{
+  u32 length;
+  readField(length);
+  std::span<const std::byte> bytes = take(length);
+  text = { reinterpret_cast<const char*>(bytes.data()), bytes.size() };
+}
+
+void
+CommandReader::readField(std::span<const std::byte>& bytes)
+{
+  u64 size;
+  readField(size);
+  bytes = take(static_cast<size_t>(size));
+}
+
+bool
+CommandReader::skip()
+{
+  switch (m_type) {
+    case CommandType::BeginRenderPass:
+      read<cmd::BeginRenderPass>();
+      return true;
+    case CommandType::EndRenderPass:
+      return true;
+    case CommandType::BindPipeline:
+      read<cmd::BindPipeline>();
+      return true;
+    case CommandType::SetViewport:
+      read<cmd::SetViewport>();
+      return true;
+    case CommandType::SetScissor:
+      read<cmd::SetScissor>();
+      return true;
+    case CommandType::BindVertexArray:
+      read<cmd::BindVertexArray>();
+      return true;
+    case CommandType::BindVertexBuffer:
+      read<cmd::BindVertexBuffer>();
+      return true;
+    case CommandType::BindIndexBuffer:
+      read<cmd::BindIndexBuffer>();
+      return true;
+    case CommandType::BindUniformBuffer:
+      read<cmd::BindUniformBuffer>();
+      return true;
+    case CommandType::BindTexture:
+      read<cmd::BindTexture>();
+      return true;
+    case CommandType::BindTextures:
+      read<cmd::BindTextures>();
+      return true;
+    case CommandType::BindTextureByName:
+      read<cmd::BindTextureByName>();
+      return true;
+    case CommandType::SetFramebufferAttachment:
+      read<cmd::SetFramebufferAttachment>();
+      return true;
+    case CommandType::SetFramebufferDepthAttachment:
+      read<cmd::SetFramebufferDepthAttachment>();
+      return true;
+    case CommandType::ClearDepth:
+      read<cmd::ClearDepth>();
+      return true;
+    case CommandType::SetCullMode:
+      read<cmd::SetCullMode>();
+      return true;
+    case CommandType::SetBlendEnabled:
+      read<cmd::SetBlendEnabled>();
+      return true;
+    case CommandType::SetBlendFunc:
+      read<cmd::SetBlendFunc>();
+      return true;
+    case CommandType::FlushMaterialUBO:
+      return true;
+    case CommandType::UpdateMaterialUBO:
+      read<cmd::UpdateMaterialUBO>();
+      return true;
+    case CommandType::SetUniformMat4:
+      read<cmd::SetUniformMat4>();
+      return true;
+    case CommandType::SetUniformVec4:
+      read<cmd::SetUniformVec4>();
+      return true;
+    case CommandType::SetUniformVec3:
+      read<cmd::SetUniformVec3>();
+      return true;
+    case CommandType::SetUniformVec2:
+      read<cmd::SetUniformVec2>();
+      return true;
+    case CommandType::SetUniformFloat:
+      read<cmd::SetUniformFloat>();
+      return true;
+    case CommandType::SetUniformInt:
+      read<cmd::SetUniformInt>();
+      return true;
+    case CommandType::UpdateBuffer:
+      read<cmd::UpdateBuffer>();
+      return true;
+    case CommandType::Draw:
+      read<cmd::Draw>();
+      return true;
+    case CommandType::DrawIndexed:
+      read<cmd::DrawIndexed>();
+      return true;
+    case CommandType::BlitFramebuffer:
+      read<cmd::BlitFramebuffer>();
+      return true;
+    case CommandType::PushDebugGroup:
+      read<cmd::PushDebugGroup>();
+      return true;
+    case CommandType::PopDebugGroup:
+      return true;
+    default:
+      m_offset = m_stream.size();
+      return false;
+  }
+}
+
 } // namespace gfx
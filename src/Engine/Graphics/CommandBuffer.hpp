@@ -4,8 +4,13 @@
 #include "Handle.hpp"
 #include "UBOStructs.hpp"
 #include <array>
+#include <cassert>
+#include <cstring>
 #include <glm/glm.hpp>
+#include <span>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 namespace gfx {
@@ -60,6 +65,7 @@ enum class CommandType : u8
   BindIndexBuffer,
   BindUniformBuffer,
   BindTexture,
+  BindTextures,      // Consecutive slots sharing one sampler
   BindTextureByName, // Texture lookup by string name at execution time
                      // Framebuffer modification
   SetFramebufferAttachment,
@@ -92,6 +98,314 @@ enum class CommandType : u8
   PopDebugGroup,
 };
 
+/// Texture handles of a BindTextures command, read in place from the stream
+class TextureList
+{
+public:
+  TextureList() = default;
+  explicit TextureList(std::span<const TextureId> textures)
+    : m_bytes(std::as_bytes(textures))
+  {
+  }
+  explicit TextureList(std::span<const std::byte> bytes)
+    : m_bytes(bytes)
+  {
+  }
+
+  [[nodiscard]] u32 size() const
+  {
+    return static_cast<u32>(m_bytes.size() / sizeof(TextureId));
+  }
+  [[nodiscard]] TextureId operator[](u32 i) const
+  {
+    TextureId texture;
+    std::memcpy(
+      &texture, m_bytes.data() + i * sizeof(TextureId), sizeof(TextureId));
+    return texture;
+  }
+  [[nodiscard]] std::span<const std::byte> bytes() const { return m_bytes; }
+
+private:
+  std::span<const std::byte> m_bytes;
+};
+
+/// The arguments of each command, in the order the stream carries them:
+/// fields() lists them, CommandBuffer encodes through it and CommandReader
+/// decodes through it, so this is the one place the byte layout is written
+/// down. Fields are packed without padding. Variable-length data is prefixed
+/// with its length: a u64 byte count for UpdateBuffer's data, a u32 for a
+/// texture name and for a texture list's count.
+namespace cmd {
+
+struct BeginRenderPass
+{
+  static constexpr CommandType kType = CommandType::BeginRenderPass;
+  RenderPassBeginInfo info;
+  auto fields() { return std::tie(info); }
+};
+
+struct EndRenderPass
+{
+  static constexpr CommandType kType = CommandType::EndRenderPass;
+  auto fields() { return std::tie(); }
+};
+
+struct BindPipeline
+{
+  static constexpr CommandType kType = CommandType::BindPipeline;
+  PipelineId pipeline;
+  auto fields() { return std::tie(pipeline); }
+};
+
+struct SetViewport
+{
+  static constexpr CommandType kType = CommandType::SetViewport;
+  Viewport viewport;
+  auto fields() { return std::tie(viewport); }
+};
+
+struct SetScissor
+{
+  static constexpr CommandType kType = CommandType::SetScissor;
+  ScissorRect scissor;
+  auto fields() { return std::tie(scissor); }
+};
+
+struct BindVertexArray
+{
+  static constexpr CommandType kType = CommandType::BindVertexArray;
+  VertexArrayId vao;
+  auto fields() { return std::tie(vao); }
+};
+
+struct BindVertexBuffer
+{
+  static constexpr CommandType kType = CommandType::BindVertexBuffer;
+  u32 binding;
+  BufferId buffer;
+  u64 offset;
+  auto fields() { return std::tie(binding, buffer, offset); }
+};
+
+struct BindIndexBuffer
+{
+  static constexpr CommandType kType = CommandType::BindIndexBuffer;
+  BufferId buffer;
+  u64 offset;
+  IndexType indexType;
+  auto fields() { return std::tie(buffer, offset, indexType); }
+};
+
+struct BindUniformBuffer
+{
+  static constexpr CommandType kType = CommandType::BindUniformBuffer;
+  u32 binding;
+  BufferId buffer;
+  u64 offset;
+  u64 size;
+  auto fields() { return std::tie(binding, buffer, offset, size); }
+};
+
+struct BindTexture
+{
+  static constexpr CommandType kType = CommandType::BindTexture;
+  u32 slot;
+  TextureId texture;
+  SamplerId sampler;
+  auto fields() { return std::tie(slot, texture, sampler); }
+};
+
+struct BindTextures
+{
+  static constexpr CommandType kType = CommandType::BindTextures;
+  u32 firstSlot;
+  SamplerId sampler;
+  TextureList textures;
+  auto fields() { return std::tie(firstSlot, sampler, textures); }
+};
+
+struct BindTextureByName
+{
+  static constexpr CommandType kType = CommandType::BindTextureByName;
+  u32 slot;
+  std::string_view name;
+  SamplerId sampler;
+  auto fields() { return std::tie(slot, name, sampler); }
+};
+
+struct SetFramebufferAttachment
+{
+  static constexpr CommandType kType = CommandType::SetFramebufferAttachment;
+  FramebufferId fbo;
+  u32 attachmentIndex;
+  TextureId texture;
+  u32 mipLevel;
+  u32 layer;
+  auto fields()
+  {
+    return std::tie(fbo, attachmentIndex, texture, mipLevel, layer);
+  }
+};
+
+struct SetFramebufferDepthAttachment
+{
+  static constexpr CommandType kType =
+    CommandType::SetFramebufferDepthAttachment;
+  FramebufferId fbo;
+  TextureId texture;
+  u32 mipLevel;
+  u32 layer;
+  auto fields() { return std::tie(fbo, texture, mipLevel, layer); }
+};
+
+struct ClearDepth
+{
+  static constexpr CommandType kType = CommandType::ClearDepth;
+  float depth;
+  auto fields() { return std::tie(depth); }
+};
+
+struct SetCullMode
+{
+  static constexpr CommandType kType = CommandType::SetCullMode;
+  CullMode mode;
+  auto fields() { return std::tie(mode); }
+};
+
+struct SetBlendEnabled
+{
+  static constexpr CommandType kType = CommandType::SetBlendEnabled;
+  bool enabled;
+  auto fields() { return std::tie(enabled); }
+};
+
+struct SetBlendFunc
+{
+  static constexpr CommandType kType = CommandType::SetBlendFunc;
+  BlendFactor srcColor;
+  BlendFactor dstColor;
+  BlendFactor srcAlpha;
+  BlendFactor dstAlpha;
+  auto fields() { return std::tie(srcColor, dstColor, srcAlpha, dstAlpha); }
+};
+
+struct FlushMaterialUBO
+{
+  static constexpr CommandType kType = CommandType::FlushMaterialUBO;
+  auto fields() { return std::tie(); }
+};
+
+struct UpdateMaterialUBO
+{
+  static constexpr CommandType kType = CommandType::UpdateMaterialUBO;
+  MaterialUBO data;
+  auto fields() { return std::tie(data); }
+};
+
+template<CommandType Type, typename T>
+struct SetUniform
+{
+  static constexpr CommandType kType = Type;
+  i32 location;
+  T value;
+  auto fields() { return std::tie(location, value); }
+};
+
+using SetUniformMat4 = SetUniform<CommandType::SetUniformMat4, glm::mat4>;
+using SetUniformVec4 = SetUniform<CommandType::SetUniformVec4, glm::vec4>;
+using SetUniformVec3 = SetUniform<CommandType::SetUniformVec3, glm::vec3>;
+using SetUniformVec2 = SetUniform<CommandType::SetUniformVec2, glm::vec2>;
+using SetUniformFloat = SetUniform<CommandType::SetUniformFloat, float>;
+using SetUniformInt = SetUniform<CommandType::SetUniformInt, i32>;
+
+struct UpdateBuffer
+{
+  static constexpr CommandType kType = CommandType::UpdateBuffer;
+  BufferId buffer;
+  u64 offset;
+  std::span<const std::byte> data;
+  auto fields() { return std::tie(buffer, offset, data); }
+};
+
+struct Draw
+{
+  static constexpr CommandType kType = CommandType::Draw;
+  u32 vertexCount;
+  u32 instanceCount;
+  u32 firstVertex;
+  u32 firstInstance;
+  auto fields()
+  {
+    return std::tie(vertexCount, instanceCount, firstVertex, firstInstance);
+  }
+};
+
+struct DrawIndexed
+{
+  static constexpr CommandType kType = CommandType::DrawIndexed;
+  u32 indexCount;
+  u32 instanceCount;
+  u32 firstIndex;
+  i32 vertexOffset;
+  u32 firstInstance;
+  auto fields()
+  {
+    return std::tie(
+      indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+  }
+};
+
+struct BlitFramebuffer
+{
+  static constexpr CommandType kType = CommandType::BlitFramebuffer;
+  FramebufferId src;
+  FramebufferId dst;
+  i32 srcX0;
+  i32 srcY0;
+  i32 srcX1;
+  i32 srcY1;
+  i32 dstX0;
+  i32 dstY0;
+  i32 dstX1;
+  i32 dstY1;
+  bool colorBit;
+  bool depthBit;
+  bool stencilBit;
+  bool linearFilter;
+  auto fields()
+  {
+    return std::tie(src,
+                    dst,
+                    srcX0,
+                    srcY0,
+                    srcX1,
+                    srcY1,
+                    dstX0,
+                    dstY0,
+                    dstX1,
+                    dstY1,
+                    colorBit,
+                    depthBit,
+                    stencilBit,
+                    linearFilter);
+  }
+};
+
+struct PushDebugGroup
+{
+  static constexpr CommandType kType = CommandType::PushDebugGroup;
+  u32 nameIndex; // Into CommandBuffer::getDebugNames()
+  auto fields() { return std::tie(nameIndex); }
+};
+
+struct PopDebugGroup
+{
+  static constexpr CommandType kType = CommandType::PopDebugGroup;
+  auto fields() { return std::tie(); }
+};
+
+} // namespace cmd
+
 /// Records rendering commands for deferred execution.
 /// Commands are encoded into a byte stream and executed by the backend.
 class CommandBuffer
@@ -120,8 +434,14 @@ public:
   void bindIndexBuffer(BufferId buffer, u64 offset, IndexType indexType);
   void bindUniformBuffer(u32 binding, BufferId buffer, u64 offset, u64 size);
   void bindTexture(u32 slot, TextureId texture, SamplerId sampler);
+  /// Bind textures to slots firstSlot, firstSlot + 1, ... with one command
+  void bindTextures(u32 firstSlot,
+                    std::span<const TextureId> textures,
+                    SamplerId sampler);
   /// Bind texture by name (lookup deferred to execution time via
-  /// RenderResources)
+  /// RenderResources). Copies the name into the stream and hashes it on
+  /// execution, so it is meant for tools and debugging; per-draw code should
+  /// resolve handles up front and use bindTexture.
   void bindTextureByName(u32 slot,
                          const std::string& textureName,
                          SamplerId sampler);
@@ -210,19 +530,107 @@ public:
   {
     return m_commandStream;
   }
+  // Replaces the recorded commands with `stream`; swapped, so both keep
+  // their capacity (for CommandStreamOptimizer)
+  void swapCommandStream(std::vector<u8>& stream)
+  {
+    m_commandStream.swap(stream);
+  }
   [[nodiscard]] const std::vector<std::string>& getDebugNames() const
   {
     return m_debugNames;
   }
 
 private:
+  template<typename Cmd>
+  void record(Cmd command);
+
   template<typename T>
   void encode(const T& value);
-
-  void encodeCommand(CommandType cmd);
+  void encode(const TextureList& textures);
+  void encode(std::string_view text);
+  void encode(std::span<const std::byte> bytes);
 
   std::vector<u8> m_commandStream;
   std::vector<std::string> m_debugNames;
 };
 
+/// Decodes a recorded command stream one command at a time, for the backends
+/// that execute it and for CommandStreamOptimizer:
+///
+///   CommandReader reader(cmd.getCommandStream());
+///   while (!reader.atEnd()) {
+///     switch (reader.next()) {
+///       case CommandType::Draw: {
+///         cmd::Draw draw = reader.read<cmd::Draw>();
+///         ...
+///       }
+///       default:
+///         reader.skip();
+///     }
+///   }
+///
+/// Views in the decoded commands (texture names, lists, buffer data) point
+/// into the stream and live as long as it does.
+class CommandReader
+{
+public:
+  explicit CommandReader(std::span<const u8> stream)
+    : m_stream(stream)
+  {
+  }
+
+  [[nodiscard]] bool atEnd() const { return m_offset >= m_stream.size(); }
+  /// Stream offset of the next unread byte
+  [[nodiscard]] size_t offset() const { return m_offset; }
+
+  /// Reads the type of the next command, whose arguments then follow through
+  /// read() or skip()
+  CommandType next()
+  {
+    readField(m_type);
+    return m_type;
+  }
+
+  /// Decodes the arguments of the command next() returned, which must be a
+  /// Cmd
+  template<typename Cmd>
+  Cmd read()
+  {
+    assert(Cmd::kType == m_type && "Command stream read as the wrong command");
+    Cmd command{};
+    std::apply([this](auto&... field) { (readField(field), ...); },
+               command.fields());
+    return command;
+  }
+
+  /// Steps over the arguments of the command next() returned. Returns false
+  /// for a command without a layout (UpdateDataTexture has no encoder), after
+  /// moving to the end of the stream, as nothing after it can be located.
+  bool skip();
+
+private:
+  template<typename T>
+  void readField(T& value)
+  {
+    std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+  }
+  void readField(TextureList& textures);
+  void readField(std::string_view& text);
+  void readField(std::span<const std::byte>& bytes);
+
+  std::span<const std::byte> take(size_t size)
+  {
+    assert(m_offset + size <= m_stream.size() &&
+           "Command stream read out of bounds");
+    auto bytes = std::as_bytes(m_stream.subspan(m_offset, size));
+    m_offset += size;
+    return bytes;
+  }
+
+  std::span<const u8> m_stream;
+  size_t m_offset{ 0 };
+  CommandType m_type{};
+};
+
 } // namespace gfx
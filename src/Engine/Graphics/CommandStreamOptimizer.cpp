@@ -0,0 +1,330 @@
+#include "CommandStreamOptimizer.hpp"
+#include <cassert>
+#include <cstring>
+#include <optional>
+
+namespace gfx {
+
+namespace {
+
+// Slots and bindings tracked individually; commands past them are kept
+constexpr u32 kTrackedSlots = 16;
+
+struct VertexBufferBinding
+{
+  BufferId buffer;
+  u64 offset;
+
+  bool operator==(const VertexBufferBinding&) const = default;
+};
+
+struct IndexBufferBinding
+{
+  BufferId buffer;
+  u64 offset;
+  IndexType type;
+
+  bool operator==(const IndexBufferBinding&) const = default;
+};
+
+struct UniformBufferBinding
+{
+  BufferId buffer;
+  u64 offset;
+  u64 size;
+
+  bool operator==(const UniformBufferBinding&) const = default;
+};
+
+struct TextureBinding
+{
+  TextureId texture;
+  SamplerId sampler;
+
+  bool operator==(const TextureBinding&) const = default;
+};
+
+struct BlendFunc
+{
+  BlendFactor srcColor;
+  BlendFactor dstColor;
+  BlendFactor srcAlpha;
+  BlendFactor dstAlpha;
+
+  bool operator==(const BlendFunc&) const = default;
+};
+
+// Last value set through a SetUniform* command, as raw bytes
+struct UniformValue
+{
+  i32 location;
+  CommandType type;
+  u32 size;
+  std::array<u8, sizeof(glm::mat4)> bytes;
+};
+
+bool
+operator==(const Viewport& a, const Viewport& b)
+{
+  return std::memcmp(&a, &b, sizeof(Viewport)) == 0;
+}
+
+bool
+operator==(const ScissorRect& a, const ScissorRect& b)
+{
+  return a.x == b.x && a.y == b.y && a.width == b.width &&
+         a.height == b.height;
+}
+
+// Bound state as far as the stream so far tells; nullopt is unknown
+struct TrackedState
+{
+  std::optional<PipelineId> pipeline;
+  // Invalid handle: the pipeline's own vertex array
+  std::optional<VertexArrayId> vertexArray;
+  std::array<std::optional<VertexBufferBinding>, kTrackedSlots> vertexBuffers;
+  std::optional<IndexBufferBinding> indexBuffer;
+  std::array<std::optional<UniformBufferBinding>, kTrackedSlots>
+    uniformBuffers;
+  std::array<std::optional<TextureBinding>, kTrackedSlots> textures;
+  std::optional<Viewport> viewport;
+  std::optional<ScissorRect> scissor;
+  std::optional<CullMode> cullMode;
+  std::optional<bool> blendEnabled;
+  std::optional<BlendFunc> blendFunc;
+  std::optional<MaterialUBO> material;
+  std::vector<UniformValue> uniforms;
+
+  void forgetVertexInput()
+  {
+    vertexBuffers.fill(std::nullopt);
+    indexBuffer.reset();
+  }
+};
+
+// Sets `slot` to `value`; returns false if it already held it
+template<typename T>
+bool
+update(std::optional<T>& slot, const T& value)
+{
+  if (slot && *slot == value) {
+    return false;
+  }
+  slot = value;
+  return true;
+}
+
+} // namespace
+
+CommandStreamStats
+CommandStreamOptimizer::optimize(CommandBuffer& cmd)
+{
+  CommandStreamStats stats = optimize(cmd.getCommandStream(), m_scratch);
+  cmd.swapCommandStream(m_scratch);
+  return stats;
+}
+
+CommandStreamStats
+CommandStreamOptimizer::optimize(std::span<const u8> stream,
+                                 std::vector<u8>& out) const
+{
+  CommandStreamStats stats;
+  TrackedState state;
+  out.clear();
+  out.reserve(stream.size());
+
+  // Whether a SetUniform* command changes the uniform's value
+  auto changesUniform = [&](const auto& command) {
+    UniformValue value{};
+    value.location = command.location;
+    value.type = command.kType;
+    value.size = sizeof(command.value);
+    std::memcpy(value.bytes.data(), &command.value, value.size);
+    for (UniformValue& known : state.uniforms) {
+      if (known.location == value.location) {
+        bool same = known.type == value.type &&
+                    std::memcmp(known.bytes.data(),
+                                value.bytes.data(),
+                                value.size) == 0;
+        known = value;
+        return !same;
+      }
+    }
+    state.uniforms.push_back(value);
+    return true;
+  };
+
+  CommandReader reader(stream);
+  while (!reader.atEnd()) {
+    size_t start = reader.offset();
+    CommandType type = reader.next();
+    stats.commands++;
+
+    bool keep = true;
+    switch (type) {
+      case CommandType::BindPipeline: {
+        PipelineId pipeline = reader.read<cmd::BindPipeline>().pipeline;
+        // Rebinding the current pipeline only matters when it puts back
+        // its own vertex array
+        bool samePipeline = state.pipeline && *state.pipeline == pipeline;
+        if (samePipeline && state.vertexArray &&
+            !state.vertexArray->isValid()) {
+          keep = false;
+          break;
+        }
+        if (!samePipeline) {
+          // New program and raster state
+          state.uniforms.clear();
+          state.cullMode.reset();
+          state.blendEnabled.reset();
+          state.blendFunc.reset();
+        }
+        state.pipeline = pipeline;
+        state.vertexArray = VertexArrayId{};
+        state.forgetVertexInput();
+        break;
+      }
+      case CommandType::BindVertexArray: {
+        VertexArrayId vao = reader.read<cmd::BindVertexArray>().vao;
+        keep = update(state.vertexArray, vao);
+        if (keep) {
+          state.forgetVertexInput();
+        }
+        break;
+      }
+      case CommandType::BindVertexBuffer: {
+        auto bind = reader.read<cmd::BindVertexBuffer>();
+        if (bind.binding < kTrackedSlots) {
+          keep = update(state.vertexBuffers[bind.binding],
+                        VertexBufferBinding{ bind.buffer, bind.offset });
+        }
+        break;
+      }
+      case CommandType::BindIndexBuffer: {
+        auto bind = reader.read<cmd::BindIndexBuffer>();
+        keep = update(state.indexBuffer,
+                      IndexBufferBinding{
+                        bind.buffer, bind.offset, bind.indexType });
+        break;
+      }
+      case CommandType::BindUniformBuffer: {
+        auto bind = reader.read<cmd::BindUniformBuffer>();
+        if (bind.binding < kTrackedSlots) {
+          keep = update(
+            state.uniformBuffers[bind.binding],
+            UniformBufferBinding{ bind.buffer, bind.offset, bind.size });
+        }
+        if (keep && bind.binding == static_cast<u32>(UBOBinding::Material)) {
+          // The shared material UBO is no longer the one bound
+          state.material.reset();
+        }
+        break;
+      }
+      case CommandType::BindTexture: {
+        auto bind = reader.read<cmd::BindTexture>();
+        if (bind.slot < kTrackedSlots) {
+          keep = update(state.textures[bind.slot],
+                        TextureBinding{ bind.texture, bind.sampler });
+        }
+        break;
+      }
+      case CommandType::BindTextures: {
+        auto bind = reader.read<cmd::BindTextures>();
+        // Kept whole if any slot changes
+        keep = false;
+        for (u32 i = 0; i < bind.textures.size(); i++) {
+          u32 slot = bind.firstSlot + i;
+          if (slot >= kTrackedSlots) {
+            keep = true;
+          } else if (update(state.textures[slot],
+                            { bind.textures[i], bind.sampler })) {
+            keep = true;
+          }
+        }
+        break;
+      }
+      case CommandType::BindTextureByName: {
+        u32 slot = reader.read<cmd::BindTextureByName>().slot;
+        if (slot < kTrackedSlots) {
+          state.textures[slot].reset();
+        }
+        break;
+      }
+      case CommandType::SetViewport:
+        keep = update(state.viewport, reader.read<cmd::SetViewport>().viewport);
+        break;
+      case CommandType::SetScissor:
+        keep = update(state.scissor, reader.read<cmd::SetScissor>().scissor);
+        break;
+      case CommandType::SetCullMode:
+        keep = update(state.cullMode, reader.read<cmd::SetCullMode>().mode);
+        break;
+      case CommandType::SetBlendEnabled:
+        keep = update(state.blendEnabled,
+                      reader.read<cmd::SetBlendEnabled>().enabled);
+        break;
+      case CommandType::SetBlendFunc: {
+        auto func = reader.read<cmd::SetBlendFunc>();
+        keep = update(state.blendFunc,
+                      BlendFunc{ func.srcColor,
+                                 func.dstColor,
+                                 func.srcAlpha,
+                                 func.dstAlpha });
+        break;
+      }
+      case CommandType::FlushMaterialUBO:
+        // Uploads whatever the CPU copy holds and rebinds the shared UBO
+        state.material.reset();
+        state.uniformBuffers[static_cast<u32>(UBOBinding::Material)].reset();
+        break;
+      case CommandType::UpdateMaterialUBO: {
+        MaterialUBO data = reader.read<cmd::UpdateMaterialUBO>().data;
+        if (state.material &&
+            std::memcmp(&*state.material, &data, sizeof(data)) == 0) {
+          keep = false;
+          break;
+        }
+        state.material = data;
+        state.uniformBuffers[static_cast<u32>(UBOBinding::Material)].reset();
+        break;
+      }
+      case CommandType::SetUniformMat4:
+        keep = changesUniform(reader.read<cmd::SetUniformMat4>());
+        break;
+      case CommandType::SetUniformVec4:
+        keep = changesUniform(reader.read<cmd::SetUniformVec4>());
+        break;
+      case CommandType::SetUniformVec3:
+        keep = changesUniform(reader.read<cmd::SetUniformVec3>());
+        break;
+      case CommandType::SetUniformVec2:
+        keep = changesUniform(reader.read<cmd::SetUniformVec2>());
+        break;
+      case CommandType::SetUniformFloat:
+        keep = changesUniform(reader.read<cmd::SetUniformFloat>());
+        break;
+      case CommandType::SetUniformInt:
+        keep = changesUniform(reader.read<cmd::SetUniformInt>());
+        break;
+      default:
+        // Draws, passes, clears, uploads and debug markers are kept as they
+        // are. A command without a layout (UpdateDataTexture has no encoder)
+        // ends the walk, keeping the rest of the stream.
+        if (!reader.skip()) {
+          assert(false && "Command stream optimizer: unknown command");
+        }
+        break;
+    }
+
+    if (keep) {
+      out.insert(
+        out.end(), stream.begin() + start, stream.begin() + reader.offset());
+    } else {
+      stats.removedCommands++;
+      stats.removedBytes += reader.offset() - start;
+    }
+  }
+  return stats;
+}
+
+} // namespace gfx
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CommandBuffer.hpp"
+#include <span>
+#include <vector>
+
+namespace gfx {
+
+/// What one optimize() call took out of a command stream
+struct CommandStreamStats
+{
+  u32 commands{ 0 };        ///< Commands in the input stream
+  u32 removedCommands{ 0 }; ///< Commands dropped as redundant
+  u64 removedBytes{ 0 };
+};
+
+/// Rewrites a recorded command stream without the commands that cannot
+/// change what the backend does, before it is executed.
+///
+/// The optimizer walks the stream tracking the state each command sets:
+/// pipeline, vertex array, vertex/index/uniform buffer bindings, texture
+/// slots, viewport, scissor, raster state, material UBO contents and
+/// uniforms. A command that sets a value already in place is dropped.
+/// Draws are kept as recorded: passes already draw each batch of instances
+/// with one call, offsetting the instance buffer per batch since GLES3 has
+/// no base instance, so adjacent draws are never of one batch.
+///
+/// State is only assumed from earlier commands of the same stream, never
+/// from what the device had bound before it, and anything a command may
+/// change as a side effect is forgotten:
+/// - binding a different pipeline drops uniforms and raster state
+/// - any pipeline or vertex array bind drops vertex and index buffers
+/// - material UBO updates drop the uniform buffer bindings
+/// The result is deterministic and needs no GL context, so it can run on
+/// the thread that recorded the buffer.
+class CommandStreamOptimizer
+{
+public:
+  /// Optimizes `cmd` in place
+  CommandStreamStats optimize(CommandBuffer& cmd);
+
+  /// Writes the optimized form of `stream` to `out`, which is cleared first
+  CommandStreamStats optimize(std::span<const u8> stream,
+                              std::vector<u8>& out) const;
+
+private:
+  std::vector<u8> m_scratch;
+};
+
+} // namespace gfx
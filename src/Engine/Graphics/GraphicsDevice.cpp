@@ -1,5 +1,6 @@
 #include "GraphicsDevice.hpp"
 #include "Backends/GLES3/Device.hpp"
+#include "Backends/Null/Device.hpp"
 
 namespace gfx {
 
@@ -12,13 +13,20 @@ GraphicsDevice::~GraphicsDevice()
 }
 
 bool
-GraphicsDevice::initialize()
+GraphicsDevice::initialize(BackendType type)
 {
   if (m_backend) {
-    return true;
+    return m_backend->type() == type;
   }
 
-  m_backend = std::make_unique<gles3::Device>();
+  switch (type) {
+    case BackendType::GLES3:
+      m_backend = std::make_unique<gles3::Device>();
+      break;
+    case BackendType::Null:
+      m_backend = std::make_unique<null::Device>();
+      break;
+  }
   return m_backend->initialize();
 }
 
@@ -223,10 +231,12 @@ void
 GraphicsDevice::drawVertexArrayDynamic(VertexArrayId vao,
                                        BufferId vertexBuffer,
                                        PrimitiveTopology topology,
-                                       u32 vertexCount)
+                                       u32 vertexCount,
+                                       u64 bufferOffset)
 {
   if (m_backend) {
-    m_backend->drawVertexArrayDynamic(vao, vertexBuffer, topology, vertexCount);
+    m_backend->drawVertexArrayDynamic(
+      vao, vertexBuffer, topology, vertexCount, bufferOffset);
   }
 }
 
@@ -255,6 +265,22 @@ GraphicsDevice::updateBuffer(BufferId buffer,
   }
 }
 
+StreamAllocation
+GraphicsDevice::streamUpload(StreamUsage usage,
+                             const void* data,
+                             u64 size,
+                             u32 alignment)
+{
+  return m_backend ? m_backend->streamUpload(usage, data, size, alignment)
+                   : StreamAllocation{};
+}
+
+StreamStats
+GraphicsDevice::getStreamStats() const
+{
+  return m_backend ? m_backend->getStreamStats() : StreamStats{};
+}
+
 void*
 GraphicsDevice::mapBuffer(BufferId buffer)
 {
@@ -423,6 +449,12 @@ GraphicsDevice::isValid(VertexArrayId handle) const
   return m_backend && m_backend->isValid(handle);
 }
 
+u32
+GraphicsDevice::getUniformBufferOffsetAlignment() const
+{
+  return m_backend ? m_backend->getUniformBufferOffsetAlignment() : 256;
+}
+
 u32
 GraphicsDevice::getNativeHandle(BufferId buffer) const
 {
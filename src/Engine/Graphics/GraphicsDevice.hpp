@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Backend.hpp"
 #include "CommandBuffer.hpp"
 #include "GraphicsTypes.hpp"
 #include "Handle.hpp"
@@ -17,20 +18,24 @@
 
 namespace gfx {
 
-namespace gles3 {
-class Device;
-}
-
 /// Backend-agnostic GPU resource management singleton.
 class GraphicsDevice : public Singleton<GraphicsDevice>
 {
   friend class Singleton<GraphicsDevice>;
 
 public:
-  bool initialize();
+  /// Creates and initializes the backend. GLES3 needs Window's context to be
+  /// current; Null needs nothing and runs in a windowless process.
+  bool initialize(BackendType type = BackendType::GLES3);
 
   void shutdown();
 
+  /// The running backend, or nullptr before initialize(). Reach for its
+  /// concrete type only for backend-specific queries (e.g. null::Device's
+  /// counters).
+  [[nodiscard]] Backend* getBackend() { return m_backend.get(); }
+  [[nodiscard]] const Backend* getBackend() const { return m_backend.get(); }
+
   BufferId createBuffer(const BufferCreateInfo& info);
   void destroyBuffer(BufferId buffer);
 
@@ -97,10 +102,12 @@ public:
   void destroyVertexArray(VertexArrayId vao);
   void bindVertexArray(VertexArrayId vao);
   void drawVertexArray(VertexArrayId vao, BufferId vertexBuffer);
+  /// `bufferOffset` is where the vertices start in `vertexBuffer`
   void drawVertexArrayDynamic(VertexArrayId vao,
                               BufferId vertexBuffer,
                               PrimitiveTopology topology,
-                              u32 vertexCount);
+                              u32 vertexCount,
+                              u64 bufferOffset = 0);
   void drawIndexedVertexArray(VertexArrayId vao,
                               BufferId vertexBuffer,
                               BufferId indexBuffer,
@@ -112,6 +119,15 @@ public:
   void* mapBuffer(BufferId buffer);
   void unmapBuffer(BufferId buffer);
 
+  /// Sub-allocate per-frame data from the usage's streaming ring; see
+  /// gles3::Device::streamUpload. The result is valid until endFrame().
+  StreamAllocation streamUpload(StreamUsage usage,
+                                const void* data,
+                                u64 size,
+                                u32 alignment = 16);
+  /// Streaming ring activity of the last completed frame
+  [[nodiscard]] StreamStats getStreamStats() const;
+
   // Texture operations
   void updateTexture(TextureId texture,
                      u32 mipLevel,
@@ -146,6 +162,9 @@ public:
 
   [[nodiscard]] bool isFramebufferComplete(FramebufferId fbo) const;
 
+  /// Required alignment of uniform buffer range offsets, in bytes
+  [[nodiscard]] u32 getUniformBufferOffsetAlignment() const;
+
   // Native handle access (for interop during migration)
   [[nodiscard]] u32 getNativeHandle(BufferId buffer) const;
   [[nodiscard]] u32 getNativeHandle(TextureId texture) const;
@@ -294,11 +313,11 @@ private:
   GraphicsDevice();
   ~GraphicsDevice();
 
-  // Prevent move/copy (unique_ptr with incomplete type requires explicit dtor)
+  // Non-copyable; owns the backend
   GraphicsDevice(const GraphicsDevice&) = delete;
   GraphicsDevice& operator=(const GraphicsDevice&) = delete;
 
-  std::unique_ptr<gles3::Device> m_backend;
+  std::unique_ptr<Backend> m_backend;
 };
 
 } // namespace gfx
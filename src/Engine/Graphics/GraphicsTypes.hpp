@@ -51,6 +51,55 @@ enum class PixelFormat : u8
   Depth24Stencil8,
 };
 
+/// Bytes one texel of a texture format occupies in memory, as drivers
+/// typically store it (RGB formats padded to four channels). 0 for
+/// vertex-only formats.
+inline u32
+bytesPerPixel(PixelFormat format)
+{
+  switch (format) {
+    case PixelFormat::R8:
+    case PixelFormat::R8UI:
+      return 1;
+    case PixelFormat::RG8:
+    case PixelFormat::RG8UI:
+    case PixelFormat::R16UI:
+    case PixelFormat::R16:
+    case PixelFormat::R16F:
+    case PixelFormat::Depth16:
+      return 2;
+    case PixelFormat::RGB8:
+    case PixelFormat::RGBA8:
+    case PixelFormat::RGB8UI:
+    case PixelFormat::RGBA8UI:
+    case PixelFormat::RG16UI:
+    case PixelFormat::RG16:
+    case PixelFormat::RG16F:
+    case PixelFormat::R32F:
+    case PixelFormat::R11G11B10F:
+    case PixelFormat::RGB10A2:
+    case PixelFormat::Depth24:
+    case PixelFormat::Depth32F:
+    case PixelFormat::Depth24Stencil8:
+      return 4;
+    case PixelFormat::RGB16UI:
+    case PixelFormat::RGBA16UI:
+    case PixelFormat::RGB16:
+    case PixelFormat::RGBA16:
+    case PixelFormat::RGB16F:
+    case PixelFormat::RGBA16F:
+    case PixelFormat::RG32F:
+      return 8;
+    case PixelFormat::RGB32F:
+    case PixelFormat::RGBA32F:
+      return 16;
+    case PixelFormat::Unknown:
+    case PixelFormat::MAT4F:
+      return 0;
+  }
+  return 0;
+}
+
 /// Buffer usage flags (bitfield)
 enum class BufferUsage : u16
 {
@@ -0,0 +1,105 @@
+#include "MaterialParameterBuffer.hpp"
+#include "GraphicsDevice.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace gfx {
+
+void
+MaterialParameterBuffer::initialize()
+{
+  u32 alignment =
+    GraphicsDevice::getInstance().getUniformBufferOffsetAlignment();
+  m_stride = (sizeof(MaterialUBO) + alignment - 1) / alignment * alignment;
+}
+
+void
+MaterialParameterBuffer::shutdown()
+{
+  auto& device = GraphicsDevice::getInstance();
+  for (Page& page : m_pages) {
+    if (page.buffer.isValid()) {
+      device.destroyBuffer(page.buffer);
+    }
+  }
+  m_pages.clear();
+  m_freeSlots.clear();
+  m_slotCount = 0;
+}
+
+u32
+MaterialParameterBuffer::allocate()
+{
+  if (!m_freeSlots.empty()) {
+    u32 slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+    return slot;
+  }
+  if (m_slotCount == m_pages.size() * kSlotsPerPage) {
+    addPage();
+  }
+  return m_slotCount++;
+}
+
+void
+MaterialParameterBuffer::release(u32 slot)
+{
+  // Pages are gone after shutdown(), and their slots with them
+  if (slot < m_slotCount) {
+    m_freeSlots.push_back(slot);
+  }
+}
+
+void
+MaterialParameterBuffer::write(u32 slot, const MaterialUBO& data)
+{
+  assert(slot < m_slotCount && "Writing an unallocated material slot");
+  Page& page = m_pages[slot / kSlotsPerPage];
+  u32 index = slot % kSlotsPerPage;
+  std::memcpy(page.data.data() + index * m_stride, &data, sizeof(data));
+  page.dirtyBegin = std::min(page.dirtyBegin, index);
+  page.dirtyEnd = std::max(page.dirtyEnd, index + 1);
+}
+
+void
+MaterialParameterBuffer::flush()
+{
+  auto& device = GraphicsDevice::getInstance();
+  for (Page& page : m_pages) {
+    if (page.dirtyBegin >= page.dirtyEnd) {
+      continue;
+    }
+    // One upload per page covers every slot written since the last flush,
+    // including clean ones in between; they hold their current values
+    u64 offset = u64{ page.dirtyBegin } * m_stride;
+    u64 size = u64{ page.dirtyEnd - page.dirtyBegin - 1 } * m_stride +
+               sizeof(MaterialUBO);
+    device.updateBuffer(page.buffer, offset, page.data.data() + offset, size);
+    page.dirtyBegin = kSlotsPerPage;
+    page.dirtyEnd = 0;
+  }
+}
+
+MaterialParameterBuffer::Range
+MaterialParameterBuffer::range(u32 slot) const
+{
+  return { m_pages[slot / kSlotsPerPage].buffer,
+           u64{ slot % kSlotsPerPage } * m_stride };
+}
+
+void
+MaterialParameterBuffer::addPage()
+{
+  BufferCreateInfo info{};
+  info.size = u64{ kSlotsPerPage } * m_stride;
+  info.usage = BufferUsage::Uniform;
+  info.debugName = "MaterialParameters";
+
+  Page& page = m_pages.emplace_back();
+  page.data.resize(info.size);
+  info.initialData = page.data.data();
+  page.buffer = GraphicsDevice::getInstance().createBuffer(info);
+}
+
+} // namespace gfx
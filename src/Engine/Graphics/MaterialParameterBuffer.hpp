@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Handle.hpp"
+#include "UBOStructs.hpp"
+#include <vector>
+
+namespace gfx {
+
+/// Persistent MaterialUBO storage: each material owns a fixed slot in a page
+/// of a large uniform buffer and is drawn by binding that slot's range at
+/// UBOBinding::Material. Slots are written on the CPU only when a material's
+/// values change, and flush() uploads each page's dirty range in one update.
+///
+/// Pages are never reallocated, so a recorded slot range stays valid while
+/// more materials are added.
+class MaterialParameterBuffer
+{
+public:
+  static constexpr u32 kInvalidSlot = ~0u;
+  static constexpr u32 kSlotsPerPage = 256;
+
+  /// Where a slot lives, for bindUniformBuffer
+  struct Range
+  {
+    BufferId buffer;
+    u64 offset;
+  };
+
+  /// Reads the device's offset alignment; call after GraphicsDevice init
+  void initialize();
+  void shutdown();
+
+  [[nodiscard]] u32 allocate();
+  void release(u32 slot);
+
+  /// Stores `data` in the slot; uploaded by the next flush()
+  void write(u32 slot, const MaterialUBO& data);
+
+  /// Uploads every dirty range. Call before executing commands that bind
+  /// written slots.
+  void flush();
+
+  [[nodiscard]] Range range(u32 slot) const;
+
+  /// Distance between slots, sizeof(MaterialUBO) rounded up to the
+  /// uniform buffer offset alignment
+  [[nodiscard]] u32 stride() const { return m_stride; }
+
+private:
+  struct Page
+  {
+    BufferId buffer;
+    std::vector<u8> data;            // CPU copy of the whole page
+    u32 dirtyBegin{ kSlotsPerPage }; // Dirty slots are [dirtyBegin, dirtyEnd)
+    u32 dirtyEnd{ 0 };
+  };
+
+  void addPage();
+
+  std::vector<Page> m_pages;
+  std::vector<u32> m_freeSlots;
+  u32 m_slotCount{ 0 }; // Slots handed out at least once
+  u32 m_stride{ sizeof(MaterialUBO) };
+};
+
+} // namespace gfx
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "CommandBuffer.hpp"
+#include "GraphicsDevice.hpp"
+#include "UBOStructs.hpp"
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace gfx {
+
+/// Uniform blocks for the draws of one pass, uploaded together and selected
+/// per draw with a ranged uniform buffer bind.
+///
+/// A pass that needs different block values between draws pushes one block
+/// per set of values, upload()s them once from Prepare() into the uniform
+/// streaming ring at the device's offset alignment, and records bind() before
+/// each draw. The command buffer then carries every draw without the shared
+/// UBO having to be rewritten, and submitted, in between.
+template<typename T>
+class ParameterBlocks
+{
+public:
+  void clear() { m_blocks.clear(); }
+
+  /// Adds a block and returns its index for bind()
+  u32 push(const T& block)
+  {
+    m_blocks.push_back(block);
+    return static_cast<u32>(m_blocks.size() - 1);
+  }
+
+  /// Uploads the pushed blocks for this frame. Main thread, after the last
+  /// push() and before the commands binding them are executed.
+  void upload()
+  {
+    auto& device = GraphicsDevice::getInstance();
+    u32 alignment = device.getUniformBufferOffsetAlignment();
+    m_stride = (sizeof(T) + alignment - 1) / alignment * alignment;
+
+    m_packed.assign(m_blocks.size() * m_stride, 0);
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+      std::memcpy(m_packed.data() + i * m_stride, &m_blocks[i], sizeof(T));
+    }
+    m_allocation = device.streamUpload(
+      StreamUsage::Uniform, m_packed.data(), m_packed.size(), alignment);
+  }
+
+  /// Records binding block `index` of the last upload() at `binding`
+  void bind(CommandBuffer& cmd, UBOBinding binding, u32 index) const
+  {
+    assert(index < m_blocks.size() && "Parameter block was never pushed");
+    cmd.bindUniformBuffer(static_cast<u32>(binding),
+                          m_allocation.buffer,
+                          m_allocation.offset + u64{ index } * m_stride,
+                          sizeof(T));
+  }
+
+  [[nodiscard]] u32 size() const { return static_cast<u32>(m_blocks.size()); }
+
+private:
+  std::vector<T> m_blocks;
+  std::vector<u8> m_packed; // Blocks at m_stride, as uploaded
+  StreamAllocation m_allocation;
+  u32 m_stride{ sizeof(T) };
+};
+
+} // namespace gfx
@@ -178,11 +178,13 @@ RenderResources::shutdown()
     device.destroyBuffer(entry.handle);
   }
   m_uniformBuffers.clear();
+  m_materialParameters.shutdown();
 
   for (auto& [name, entry] : m_textures) {
     device.destroyTexture(entry.handle);
   }
   m_textures.clear();
+  m_textureGeneration++;
 
   for (auto& [name, sampler] : m_samplers) {
     device.destroySampler(sampler);
@@ -454,6 +456,7 @@ RenderResources::createTexture2D(const std::string& name,
 
   // Store for potential recreation on resize
   m_textures[name] = { handle, modifiedInfo };
+  m_textureGeneration++;
 
   return handle;
 }
@@ -474,6 +477,7 @@ RenderResources::createTexture2DArray(const std::string& name,
   }
 
   m_textures[name] = { handle, modifiedInfo };
+  m_textureGeneration++;
 
   return handle;
 }
@@ -494,6 +498,7 @@ RenderResources::createTextureCube(const std::string& name,
   }
 
   m_textures[name] = { handle, modifiedInfo };
+  m_textureGeneration++;
 
   return handle;
 }
@@ -521,6 +526,24 @@ RenderResources::destroyTexture(const std::string& name)
 
   GraphicsDevice::getInstance().destroyTexture(it->second.handle);
   m_textures.erase(it);
+  m_textureGeneration++;
+}
+
+void
+RenderResources::registerTexture(const std::string& name,
+                                 TextureId handle,
+                                 const TextureCreateInfo& info)
+{
+  m_textures[name] = { handle, info };
+  m_textureGeneration++;
+}
+
+void
+RenderResources::unregisterTexture(const std::string& name)
+{
+  if (m_textures.erase(name) > 0) {
+    m_textureGeneration++;
+  }
 }
 
 TextureId
@@ -540,6 +563,7 @@ RenderResources::createDataTexture(const std::string& name, PixelFormat format)
 
   TextureId handle = device.createTexture(info);
   m_dataTextures[name] = handle;
+  m_textureGeneration++;
   return handle;
 }
 
@@ -550,6 +574,13 @@ RenderResources::getDataTexture(const std::string& name) const
   return (it != m_dataTextures.end()) ? it->second : TextureId{};
 }
 
+TextureId
+RenderResources::findTexture(const std::string& name) const
+{
+  TextureId texture = getTexture(name);
+  return texture.isValid() ? texture : getDataTexture(name);
+}
+
 void
 RenderResources::updateDataTexture(const std::string& name,
                                    u32 width,
@@ -590,6 +621,7 @@ RenderResources::recreateTexture2D(const std::string& name,
   auto& device = GraphicsDevice::getInstance();
 
   device.destroyTexture(it->second.handle);
+  m_textureGeneration++;
 
   TextureCreateInfo newInfo = it->second.info;
   newInfo.width = newWidth;
@@ -893,6 +925,8 @@ RenderResources::createStandardUBOs()
 {
   auto& device = GraphicsDevice::getInstance();
 
+  m_materialParameters.initialize();
+
   {
     BufferCreateInfo info{};
     info.size = sizeof(CameraUBO);
@@ -978,8 +1012,14 @@ RenderResources::flushLightingUBO()
 void
 RenderResources::flushMaterialUBO()
 {
-  GraphicsDevice::getInstance().updateBuffer(
+  auto& device = GraphicsDevice::getInstance();
+  device.updateBuffer(
     m_materialUBO, 0, &m_materialUBOData, sizeof(MaterialUBO));
+  // Recorded draws leave a MaterialParameterBuffer slot bound here
+  device.bindUniformBuffer(static_cast<u32>(UBOBinding::Material),
+                           m_materialUBO,
+                           0,
+                           sizeof(MaterialUBO));
 }
 
 void
@@ -1037,7 +1077,8 @@ RenderResources::getSampler(const std::string& name) const
 ShaderId
 RenderResources::loadShaderProgram(const std::string& name,
                                    const std::string& vertPath,
-                                   const std::string& fragPath)
+                                   const std::string& fragPath,
+                                   std::span<const std::string_view> defines)
 {
   auto& device = GraphicsDevice::getInstance();
 
@@ -1049,6 +1090,21 @@ RenderResources::loadShaderProgram(const std::string& name,
     return ShaderId{};
   }
 
+  if (!defines.empty()) {
+    std::string block;
+    for (std::string_view define : defines) {
+      block += "#define ";
+      block += define;
+      block += "\n";
+    }
+    // GLSL ES wants #version first, so the block goes right after it
+    for (std::string* source : { &vertSource, &fragSource }) {
+      size_t lineEnd = source->starts_with("#version") ? source->find('\n')
+                                                       : std::string::npos;
+      source->insert(lineEnd == std::string::npos ? 0 : lineEnd + 1, block);
+    }
+  }
+
   ShaderCreateInfo vertInfo{};
   vertInfo.stage = ShaderStage::Vertex;
   vertInfo.source = vertSource.c_str();
@@ -1467,22 +1523,8 @@ RenderResources::getAttribLocation(const std::string& shaderName,
 void
 RenderResources::bindTexture(u32 unit, const std::string& name)
 {
-  // First check regular textures managed by GraphicsDevice
-  TextureId texture = getTexture(name);
-  if (texture.isValid()) {
-    GraphicsDevice::getInstance().bindTexture(unit, texture);
-    return;
-  }
-
-  // Then check data textures (managed by GraphicsDevice with mutable storage)
-  auto dataIt = m_dataTextures.find(name);
-  if (dataIt != m_dataTextures.end()) {
-    GraphicsDevice::getInstance().bindTexture(unit, dataIt->second);
-    return;
-  }
-
-  // Texture not found - bind nothing (or could log warning)
-  GraphicsDevice::getInstance().bindTexture(unit, TextureId{});
+  // Binds nothing if the texture is not found
+  GraphicsDevice::getInstance().bindTexture(unit, findTexture(name));
 }
 
 void
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "GraphicsDevice.hpp"
+#include "MaterialParameterBuffer.hpp"
 #include "Singleton.hpp"
 #include "UBOStructs.hpp"
 #include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace gfx {
@@ -53,6 +56,14 @@ public:
 
   void destroyTexture(const std::string& name);
 
+  /// Make `name` resolve to a texture owned elsewhere (FrameGraph's transient
+  /// targets, which several names may share). Not destroyed by
+  /// RenderResources; unregisterTexture() forgets the name again.
+  void registerTexture(const std::string& name,
+                       TextureId handle,
+                       const TextureCreateInfo& info);
+  void unregisterTexture(const std::string& name);
+
   /// Recreate a texture with new dimensions (for viewport resize).
   /// Preserves the same handle but creates new GL storage.
   TextureId recreateTexture2D(const std::string& name,
@@ -66,6 +77,17 @@ public:
 
   [[nodiscard]] TextureId getDataTexture(const std::string& name) const;
 
+  /// Look up a regular texture, then a data texture, by name. For resolving
+  /// names to handles ahead of time; invalid if neither exists.
+  [[nodiscard]] TextureId findTexture(const std::string& name) const;
+
+  /// Bumped whenever a texture is created, destroyed or recreated, so
+  /// handles resolved from names can tell when they may be stale.
+  [[nodiscard]] u32 getTextureGeneration() const
+  {
+    return m_textureGeneration;
+  }
+
   /// Update a data texture's contents (mutable storage).
   /// If reallocate is true or dimensions changed, reallocates via glTexImage2D.
   /// Otherwise uses glTexSubImage2D for faster updates.
@@ -143,6 +165,13 @@ public:
   void flushTransformUBO();
   void flushPostProcessUBO();
 
+  /// Per-material slots bound instead of the shared MaterialUBO; flushed by
+  /// FrameGraph before it submits recorded passes
+  [[nodiscard]] MaterialParameterBuffer& getMaterialParameters()
+  {
+    return m_materialParameters;
+  }
+
   /// Bind a shader's uniform block to a standard UBO binding point.
   /// Call this once per shader that uses UBOs.
   /// @param program Shader program handle
@@ -174,9 +203,13 @@ public:
   }
   [[nodiscard]] SamplerId getShadowSampler() const { return m_shadowSampler; }
 
+  /// Compile and link a program from two shader files. Each of `defines`
+  /// is #defined in both stages, after the #version line, so one source
+  /// can build several variants under different names.
   ShaderId loadShaderProgram(const std::string& name,
                              const std::string& vertPath,
-                             const std::string& fragPath);
+                             const std::string& fragPath,
+                             std::span<const std::string_view> defines = {});
   [[nodiscard]] ShaderId getShaderProgram(const std::string& name) const;
 
   PipelineId createPipeline(const std::string& name,
@@ -332,6 +365,7 @@ private:
 
   std::unordered_map<std::string, TextureEntry> m_textures;
   std::unordered_map<std::string, TextureId> m_dataTextures;
+  u32 m_textureGeneration{ 0 };
   std::unordered_map<std::string, FramebufferId> m_framebuffers;
   std::unordered_map<std::string, RenderbufferEntry> m_renderbuffers;
   std::unordered_map<std::string, UniformBufferEntry> m_uniformBuffers;
@@ -369,6 +403,8 @@ private:
   TransformUBO m_transformUBOData{};
   PostProcessUBO m_postProcessUBOData{};
 
+  MaterialParameterBuffer m_materialParameters;
+
   bool m_initialized{ false };
 };
 
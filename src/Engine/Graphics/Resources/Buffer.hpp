@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../GraphicsTypes.hpp"
+#include "../Handle.hpp"
 
 namespace gfx {
 
@@ -13,4 +14,31 @@ struct BufferCreateInfo
   const char* debugName{ nullptr };
 };
 
+/// Streaming ring a per-frame upload goes through; each has its own buffer
+enum class StreamUsage : u8
+{
+  Vertex,  // Vertex and instance data
+  Uniform, // Uniform ranges, aligned for bindUniformBuffer
+  Count
+};
+
+/// Range sub-allocated from a streaming ring. Only valid for the frame it was
+/// allocated in: the ring reuses it once the GPU is done with that frame.
+struct StreamAllocation
+{
+  BufferId buffer;
+  u64 offset{ 0 };
+  u64 size{ 0 };
+};
+
+/// Streaming ring activity of one frame, over all usages
+struct StreamStats
+{
+  u64 bytesUploaded{ 0 };
+  u32 allocations{ 0 };
+  u32 stalls{ 0 }; // Frames whose region was still in use by the GPU
+  u32 grows{ 0 };  // Rings reallocated because a frame outgrew them
+  u64 capacity{ 0 };
+};
+
 } // namespace gfx
@@ -16,36 +16,38 @@ enum class UBOBinding : u32
 };
 
 /// Camera matrices - shared across all passes that need view/projection.
-/// std140 layout - 208 bytes
+/// std140 layout - 272 bytes. Shaders may declare any prefix of it.
 struct alignas(16) CameraUBO
 {
-  glm::mat4 viewMatrix;     // offset: 0
-  glm::mat4 projMatrix;     // offset: 64
-  glm::mat4 viewProjMatrix; // offset: 128
-  glm::vec4 cameraPosition; // offset: 192 (xyz = pos, w = unused)
+  glm::mat4 viewMatrix;        // offset: 0
+  glm::mat4 projMatrix;        // offset: 64
+  glm::mat4 viewProjMatrix;    // offset: 128
+  glm::vec4 cameraPosition;    // offset: 192 (xyz = pos, w = unused)
+  glm::mat4 invViewProjMatrix; // offset: 208 (position from depth)
 };
-static_assert(sizeof(CameraUBO) == 208, "CameraUBO size mismatch");
+static_assert(sizeof(CameraUBO) == 272, "CameraUBO size mismatch");
 
-/// Point light data for the lighting UBO.
-/// std140 layout - 48 bytes
+/// Point light as stored in the "pointLights" data texture: two RGBA32F
+/// texels per light
 struct alignas(16) PointLightData
 {
   glm::vec4 positionRadius; // xyz = position, w = radius
   glm::vec4 colorIntensity; // xyz = color, w = unused
-  glm::vec4 attenuation; // x = constant, y = linear, z = quadratic, w = unused
 };
-static_assert(sizeof(PointLightData) == 48, "PointLightData size mismatch");
+static_assert(sizeof(PointLightData) == 32, "PointLightData size mismatch");
 
-/// Lighting data - directional light + point lights.
-/// std140 layout - 528 bytes
+/// Lighting data - directional light + how to find point lights.
+/// Point lights live in data textures, binned into LightClusters' grid.
+/// std140 layout - 80 bytes
 struct alignas(16) LightingUBO
 {
-  glm::vec4 dirLightDirection;    // xyz = direction, w = unused
-  glm::vec4 dirLightColor;        // xyz = color, w = intensity
-  PointLightData pointLights[10]; // 480 bytes (10 * 48)
-  glm::ivec4 lightConfig; // x = numPointLights, y = debugView, zw = unused
+  glm::vec4 dirLightDirection; // xyz = direction, w = unused
+  glm::vec4 dirLightColor;     // xyz = color, w = intensity
+  glm::ivec4 lightConfig;  // x = numPointLights, y = debugView, zw = unused
+  glm::ivec4 clusterGrid;  // xyz = tiles x, tiles y, slices, w = unused
+  glm::vec4 clusterScale;  // xy = tiles per pixel, z = slice scale, w = bias
 };
-static_assert(sizeof(LightingUBO) == 528, "LightingUBO size mismatch");
+static_assert(sizeof(LightingUBO) == 80, "LightingUBO size mismatch");
 
 /// PBR material properties.
 /// std140 layout - 64 bytes
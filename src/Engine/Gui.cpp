@@ -68,7 +68,7 @@ GUI::drawSceneHierarchy()
     // Apply filter
     if (m_entityFilter[0] != '\0') {
       char label[256];
-      snprintf(label, sizeof(label), "[%zu] %s", en, name.c_str());
+      snprintf(label, sizeof(label), "[%u] %s", en, name.c_str());
       if (std::string_view(label).find(m_entityFilter) ==
           std::string_view::npos)
         continue;
@@ -96,7 +96,7 @@ GUI::drawSceneHierarchy()
     std::string_view name = ecsMan.getEntityName(en);
     char label[256];
     snprintf(
-      label, sizeof(label), "[%zu] %.*s", en, (int)name.size(), name.data());
+      label, sizeof(label), "[%u] %.*s", en, (int)name.size(), name.data());
     bool isSelected = (en == picked);
     if (ImGui::Selectable(label, isSelected)) {
       ecsMan.setPickedEntity(en);
@@ -160,22 +160,27 @@ GUI::drawInspector()
     return;
   }
 
-  ImGui::Text("Entity: [%zu] %.*s",
+  ImGui::Text("Entity: [%u] %.*s",
               en,
               (int)ecsMan.getEntityName(en).size(),
               ecsMan.getEntityName(en).data());
   ImGui::Separator();
 
-  // PositionComponent
-  auto posComp = ecsMan.getComponent<PositionComponent>(en);
-  if (posComp &&
+  // PositionComponent, marked changed only when a widget edits it. The
+  // SoARef writes back when this block ends, before anything below can
+  // move the entity's slot.
+  if (auto posComp = ecsMan.getComponent<PositionComponent>(en);
+      posComp &&
       ImGui::CollapsingHeader("Position", ImGuiTreeNodeFlags_DefaultOpen)) {
-    ImGui::InputFloat3("Position##pos", glm::value_ptr(posComp->position));
+    bool edited =
+      ImGui::InputFloat3("Position##pos", glm::value_ptr(posComp->position));
     glm::vec3 euler = glm::eulerAngles(posComp->rotation) * RAD2DEG;
     if (ImGui::InputFloat3("Rotation##pos", glm::value_ptr(euler))) {
       posComp->rotation = glm::quat(euler * DEG2RAD);
+      edited = true;
     }
-    ImGui::InputFloat3("Scale##pos", glm::value_ptr(posComp->scale));
+    edited |=
+      ImGui::InputFloat3("Scale##pos", glm::value_ptr(posComp->scale));
 
     // ImGuizmo gizmo
     if (ImGui::RadioButton("Translate",
@@ -205,6 +210,7 @@ GUI::drawInspector()
 
       // Sync transform to physics body when gizmo is manipulated
       if (ImGuizmo::IsUsing()) {
+        edited = true;
         auto phyComp = ecsMan.getComponent<PhysicsComponent>(en);
         if (phyComp && phyComp->isValid()) {
           auto& physSys = PhysicsSystem::getInstance();
@@ -221,6 +227,9 @@ GUI::drawInspector()
         }
       }
     }
+    if (edited) {
+      ecsMan.markChanged<PositionComponent>(en);
+    }
   }
 
   // GraphicsComponent
@@ -328,7 +337,8 @@ GUI::drawInspector()
   // Add Component section
   ImGui::Separator();
   if (ImGui::CollapsingHeader("Add Component")) {
-    if (!posComp && ImGui::Button("+ Position")) {
+    if (!ecsMan.hasComponent<PositionComponent>(en) &&
+        ImGui::Button("+ Position")) {
       ecsMan.emplaceComponent<PositionComponent>(en);
     }
     if (!camComp && ImGui::Button("+ Camera")) {
@@ -355,10 +365,16 @@ GUI::drawSettingsWindow(Profiler& profiler)
     ImGui::Checkbox("Enabled", &ECSManager::getInstance().refSimulatePhysics());
   }
 
+  if (ImGui::CollapsingHeader("Rendering")) {
+    ImGui::Checkbox("Compact G-buffer",
+                    &ECSManager::getInstance().refCompactGBuffer());
+  }
+
   if (ImGui::CollapsingHeader("Debug")) {
     const std::vector<std::string> debugNamesInputs = {
       "none",     "Base color", "Normal",    "Occlusion",
-      "Emissive", "Metallic",   "Roughness", "Shadows"
+      "Emissive", "Metallic",   "Roughness", "Shadows",
+      "Point lights"
     };
     std::vector<const char*> charitems;
     charitems.reserve(debugNamesInputs.size());
@@ -483,6 +499,19 @@ GUI::drawProfilerWindow(Profiler& profiler)
     ImGui::Text("Total Render: %.3f ms", totalPass);
   }
 
+  // Per-frame counters, e.g. geometry pass state changes
+  if (profiler.getCounterCount() > 0 &&
+      ImGui::CollapsingHeader("Draw Counters",
+                              ImGuiTreeNodeFlags_DefaultOpen)) {
+    for (size_t idx = 0; idx < profiler.getCounterCount(); ++idx) {
+      const auto& counter = profiler.getCounter(idx);
+      ImGui::Text("%-26.*s %u",
+                  static_cast<int>(counter.name.size()),
+                  counter.name.data(),
+                  counter.value);
+    }
+  }
+
   // Frame breakdown
   if (ImGui::CollapsingHeader("Frame Breakdown",
                               ImGuiTreeNodeFlags_DefaultOpen)) {
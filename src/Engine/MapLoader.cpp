@@ -101,12 +101,13 @@ MapLoader::createWall(int x, int z)
   float offsetX = -(m_width * m_tileSize) / 2.0f;
   float offsetZ = -(m_height * m_tileSize) / 2.0f;
 
-  auto& pc = m_ecsMan->emplaceComponent<PositionComponent>(wallEntity);
+  PositionComponent pc;
   pc.position = glm::vec3(offsetX + x * m_tileSize + m_tileSize / 2.0f,
                           m_tileSize / 2.0f,
                           offsetZ + z * m_tileSize + m_tileSize / 2.0f);
   pc.scale = glm::vec3(m_tileSize, m_tileSize, m_tileSize);
   pc.rotation = glm::quat(glm::vec3(0.0f, 0.0f, 0.0f));
+  m_ecsMan->emplaceComponent<PositionComponent>(wallEntity, pc);
 
   m_ecsMan->emplaceComponent<PhysicsComponent>(
     wallEntity, wallEntity, 0.0f, CollisionShapeType::BOX);
@@ -129,10 +130,11 @@ MapLoader::createFloor()
   float floorDepth = m_height * m_tileSize;
   float floorHeight = 0.1f * m_tileSize;
 
-  auto& pc = m_ecsMan->emplaceComponent<PositionComponent>(floorEntity);
+  PositionComponent pc;
   pc.position = glm::vec3(0.0f, 0.0f, 0.0f);
   pc.scale = glm::vec3(floorWidth, floorHeight, floorDepth);
   pc.rotation = glm::quat(glm::vec3(0.0f, 0.0f, 0.0f));
+  m_ecsMan->emplaceComponent<PositionComponent>(floorEntity, pc);
 
   m_ecsMan->emplaceComponent<PhysicsComponent>(
     floorEntity, floorEntity, 0.0f, CollisionShapeType::BOX);
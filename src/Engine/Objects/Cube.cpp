@@ -101,6 +101,7 @@ Cube::Cube()
   newPrim->m_topology = gfx::PrimitiveTopology::Triangles;
   newPrim->m_count = 36;
   newPrim->m_offset = 0;
+  newPrim->m_bounds = { glm::vec3(-0.5f), glm::vec3(0.5f) };
 
   p_collisionShape = new JPH::BoxShape(JPH::Vec3(0.5f, 0.5f, 0.5f));
 
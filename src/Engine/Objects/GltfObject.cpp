@@ -158,8 +158,9 @@ GltfObject::loadMaterials(tinygltf::Model& model)
     p_materials[numNodes].m_emissiveFactor = glm::vec3(
       mat.emissiveFactor[0], mat.emissiveFactor[1], mat.emissiveFactor[2]);
     p_materials[numNodes].m_doubleSided = mat.doubleSided;
-    p_materials[numNodes].m_alphaMode = mat.alphaMode;
+    p_materials[numNodes].m_alphaMode = Material::parseAlphaMode(mat.alphaMode);
     p_materials[numNodes].m_alphaCutoff = mat.alphaCutoff;
+    p_materials[numNodes].resolveTextures();
     numNodes++;
   }
 }
@@ -275,6 +276,7 @@ GltfObject::loadMeshes(tinygltf::Model& model)
             vertices[idx].position = glm::vec3(positions[idx * 3 + 0],
                                                positions[idx * 3 + 1],
                                                positions[idx * 3 + 2]);
+            newPrim->m_bounds.expand(vertices[idx].position);
           }
           // Collect vertices for collision shape generation
           for (u32 idx = 0; idx < vertexCount; idx++) {
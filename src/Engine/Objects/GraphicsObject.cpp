@@ -70,28 +70,10 @@ GraphicsObject::resetMatrixCache()
 void
 GraphicsObject::applySkinning(gfx::ShaderId shader, i32 node)
 {
-  if (m_skinningCache.size() < static_cast<size_t>(p_numSkins)) {
-    m_skinningCache.resize(p_numSkins);
-  }
-
-  SkinningCache& cache = m_skinningCache[node];
-
-  // Recompute joint matrices only if cache is invalid
-  if (!cache.valid) {
-    cache.jointMatrices.clear();
-    cache.jointMatrices.reserve(p_skins[node].joints.size());
-
-    for (u32 j = 0; j < p_skins[node].joints.size(); j++) {
-      i32 joint = p_skins[node].joints[j];
-      cache.jointMatrices.push_back(getMatrix(joint) *
-                                    p_skins[node].inverseBindMatrices[j]);
-    }
-
-    cache.valid = true;
-  }
+  const std::vector<glm::mat4>& jointMatrices = getJointMatrices(node);
 
   // Upload joint matrices to GPU texture
-  if (!cache.jointMatrices.empty()) {
+  if (!jointMatrices.empty()) {
     auto& resources = gfx::RenderResources::getInstance();
     auto& device = gfx::GraphicsDevice::getInstance();
 
@@ -106,15 +88,83 @@ GraphicsObject::applySkinning(gfx::ShaderId shader, i32 node)
     // Update texture data (width=4 for mat4 columns, height=jointCount)
     // Always reallocate since the jointMats texture is shared globally and
     // different skinned objects may have different joint counts.
-    u32 jointCount = static_cast<u32>(cache.jointMatrices.size());
+    u32 jointCount = static_cast<u32>(jointMatrices.size());
     constexpr u32 kMatrixColumns = 4;
     resources.updateDataTexture("jointMats",
                                 kMatrixColumns,
                                 jointCount,
-                                glm::value_ptr(cache.jointMatrices[0]));
+                                glm::value_ptr(jointMatrices[0]));
   }
 }
 
+bool
+GraphicsObject::hasSkin() const
+{
+  for (u32 idx = 0; idx < p_numNodes; idx++) {
+    if (p_nodes[idx].skin >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const std::vector<glm::mat4>&
+GraphicsObject::getJointMatrices(i32 skin)
+{
+  if (m_skinningCache.size() < static_cast<size_t>(p_numSkins)) {
+    m_skinningCache.resize(p_numSkins);
+  }
+
+  SkinningCache& cache = m_skinningCache[skin];
+
+  // Recompute joint matrices only if cache is invalid
+  if (!cache.valid) {
+    cache.jointMatrices.clear();
+    cache.jointMatrices.reserve(p_skins[skin].joints.size());
+
+    for (u32 j = 0; j < p_skins[skin].joints.size(); j++) {
+      i32 joint = p_skins[skin].joints[j];
+      cache.jointMatrices.push_back(getMatrix(joint) *
+                                    p_skins[skin].inverseBindMatrices[j]);
+    }
+
+    cache.valid = true;
+  }
+  return cache.jointMatrices;
+}
+
+Aabb
+GraphicsObject::getPoseBounds()
+{
+  Aabb bounds;
+  for (u32 i = 0; i < p_numNodes; i++) {
+    if (p_nodes[i].mesh < 0) {
+      continue;
+    }
+    // Same transforms the shaders apply below the entity's model matrix
+    std::span<const glm::mat4> transforms;
+    glm::mat4 nodeMat;
+    if (p_nodes[i].skin >= 0) {
+      transforms = getJointMatrices(p_nodes[i].skin);
+    } else {
+      nodeMat = getMatrix(i);
+      transforms = { &nodeMat, 1 };
+    }
+
+    Mesh& mesh = p_meshes[p_nodes[i].mesh];
+    for (u32 j = 0; j < mesh.numPrims; j++) {
+      const Aabb& local = mesh.m_primitives[j].m_bounds;
+      if (local.isEmpty()) {
+        return {};
+      }
+      for (const glm::mat4& transform : transforms) {
+        bounds.expand(local.transformed(transform));
+      }
+    }
+  }
+  return bounds;
+}
+
 void
 GraphicsObject::draw(gfx::ShaderId shader)
 {
@@ -167,82 +217,94 @@ GraphicsObject::drawGeom(gfx::ShaderId shader)
 }
 
 void
-GraphicsObject::recordDraw(gfx::CommandBuffer& cmd,
-                           gfx::SamplerId sampler,
-                           const glm::mat4& entityModel,
-                           gfx::BufferId instanceBuffer,
-                           i32 isSkinnedLoc)
+GraphicsObject::prepareDraw(const glm::mat4& entityModel,
+                            std::vector<gfx::StreamAllocation>& nodeInstances)
 {
   auto& resources = gfx::RenderResources::getInstance();
+  auto& device = gfx::GraphicsDevice::getInstance();
+  // The shared data texture is never recreated, so its handle is looked up
+  // once rather than by name per draw
+  static gfx::TextureId jointMatsTexId = resources.getDataTexture("jointMats");
 
   for (u32 i = 0; i < p_numNodes; i++) {
     if (p_nodes[i].mesh >= 0) {
       bool isSkinned = p_nodes[i].skin >= 0;
 
-      // Write per-node model matrix to instance buffer (deferred).
+      // Stream the per-node model matrix as a 1-instance buffer range.
       // Skinned meshes: entityModel only (skinning encodes node-to-world).
       // Non-skinned meshes: bake the node's local-to-world into modelMatrix.
       glm::mat4 nodeModel =
         isSkinned ? entityModel : entityModel * getMatrix(i);
-      cmd.updateBuffer(instanceBuffer, 0, &nodeModel, sizeof(glm::mat4));
+      nodeInstances.push_back(device.streamUpload(
+        gfx::StreamUsage::Vertex, &nodeModel, sizeof(glm::mat4)));
 
-      // Set is_skinned uniform if location is valid
-      if (isSkinnedLoc >= 0) {
-        cmd.setUniform(isSkinnedLoc, isSkinned ? 1 : 0);
-      }
-
-      // Handle skinning: upload joint matrices (immediate), then record
-      // bindings
+      // Handle skinning: upload joint matrices (immediate)
       if (isSkinned) {
-        // Compute joint matrices if cache invalid
-        if (m_skinningCache.size() < static_cast<size_t>(p_numSkins)) {
-          m_skinningCache.resize(p_numSkins);
-        }
-        SkinningCache& cache = m_skinningCache[p_nodes[i].skin];
-        if (!cache.valid) {
-          cache.jointMatrices.clear();
-          cache.jointMatrices.reserve(p_skins[p_nodes[i].skin].joints.size());
-          for (u32 j = 0; j < p_skins[p_nodes[i].skin].joints.size(); j++) {
-            i32 joint = p_skins[p_nodes[i].skin].joints[j];
-            cache.jointMatrices.push_back(
-              getMatrix(joint) *
-              p_skins[p_nodes[i].skin].inverseBindMatrices[j]);
-          }
-          cache.valid = true;
-        }
+        const std::vector<glm::mat4>& jointMatrices =
+          getJointMatrices(p_nodes[i].skin);
 
         // Upload joint matrices to texture (immediate operation)
         // Must bind texture to unit before updating!
         constexpr u32 kJointMatsUnit = 5;
-        if (!cache.jointMatrices.empty()) {
+        if (!jointMatrices.empty()) {
           constexpr u32 kMatrixColumns = 4;
-          u32 jointCount = static_cast<u32>(cache.jointMatrices.size());
-          static gfx::TextureId jointMatsTexId =
-            resources.getDataTexture("jointMats");
+          u32 jointCount = static_cast<u32>(jointMatrices.size());
           resources.bindTexture(kJointMatsUnit, jointMatsTexId);
           resources.updateDataTexture("jointMats",
                                       kMatrixColumns,
                                       jointCount,
-                                      glm::value_ptr(cache.jointMatrices[0]));
+                                      glm::value_ptr(jointMatrices[0]));
         }
       }
 
+      Mesh& mesh = p_meshes[p_nodes[i].mesh];
+      for (u32 j = 0; j < mesh.numPrims; j++) {
+        Material* mat = mesh.m_primitives[j].m_material > -1
+                          ? &p_materials[mesh.m_primitives[j].m_material]
+                          : &defaultMat;
+        mat->prepareBind();
+      }
+    }
+  }
+}
+
+void
+GraphicsObject::recordDraw(gfx::CommandBuffer& cmd,
+                           gfx::SamplerId sampler,
+                           std::span<const gfx::StreamAllocation> nodeInstances,
+                           i32 isSkinnedLoc)
+{
+  auto& resources = gfx::RenderResources::getInstance();
+  static gfx::TextureId jointMatsTexId = resources.getDataTexture("jointMats");
+
+  size_t meshNode = 0;
+  for (u32 i = 0; i < p_numNodes; i++) {
+    if (p_nodes[i].mesh >= 0) {
+      bool isSkinned = p_nodes[i].skin >= 0;
+      const gfx::StreamAllocation& instance = nodeInstances[meshNode++];
+
+      // Set is_skinned uniform if location is valid
+      if (isSkinnedLoc >= 0) {
+        cmd.setUniform(isSkinnedLoc, isSkinned ? 1 : 0);
+      }
+
       Mesh& mesh = p_meshes[p_nodes[i].mesh];
       for (u32 j = 0; j < mesh.numPrims; j++) {
         // If skinned, record jointMats binding for EACH primitive
         // to ensure it's bound right before the draw
         if (isSkinned) {
           constexpr u32 kJointMatsUnit = 5;
-          cmd.bindTextureByName(
-            kJointMatsUnit, "jointMats", resources.getLinearClampSampler());
+          cmd.bindTexture(
+            kJointMatsUnit, jointMatsTexId, resources.getLinearClampSampler());
         }
 
-        Material* mat = mesh.m_primitives[j].m_material > -1
-                          ? &p_materials[mesh.m_primitives[j].m_material]
-                          : &defaultMat;
+        const Material* mat =
+          mesh.m_primitives[j].m_material > -1
+            ? &p_materials[mesh.m_primitives[j].m_material]
+            : &defaultMat;
 
         mat->recordBind(cmd, sampler);
-        cmd.bindVertexBuffer(1, instanceBuffer, 0);
+        cmd.bindVertexBuffer(1, instance.buffer, instance.offset);
         mesh.m_primitives[j].recordDraw(cmd);
       }
     }
@@ -250,70 +312,36 @@ GraphicsObject::recordDraw(gfx::CommandBuffer& cmd,
 }
 
 void
-GraphicsObject::recordDrawGeom(gfx::CommandBuffer& cmd,
-                               const glm::mat4& entityModel,
-                               gfx::BufferId instanceBuffer,
-                               i32 isSkinnedLoc)
+GraphicsObject::recordDrawGeom(
+  gfx::CommandBuffer& cmd,
+  std::span<const gfx::StreamAllocation> nodeInstances,
+  i32 isSkinnedLoc)
 {
   auto& resources = gfx::RenderResources::getInstance();
+  static gfx::TextureId jointMatsTexId = resources.getDataTexture("jointMats");
 
+  size_t meshNode = 0;
   for (u32 i = 0; i < p_numNodes; i++) {
     if (p_nodes[i].mesh >= 0) {
       bool isSkinned = p_nodes[i].skin >= 0;
-
-      // Write per-node model matrix to instance buffer (deferred).
-      glm::mat4 nodeModel =
-        isSkinned ? entityModel : entityModel * getMatrix(i);
-      cmd.updateBuffer(instanceBuffer, 0, &nodeModel, sizeof(glm::mat4));
+      const gfx::StreamAllocation& instance = nodeInstances[meshNode++];
 
       // Set is_skinned uniform if location is valid
       if (isSkinnedLoc >= 0) {
         cmd.setUniform(isSkinnedLoc, isSkinned ? 1 : 0);
       }
 
-      // Handle skinning for shadow pass
+      // Record: bind jointMats texture to unit 5 (for command buffer
+      // execution)
       if (isSkinned) {
-        // Compute joint matrices if cache invalid
-        if (m_skinningCache.size() < static_cast<size_t>(p_numSkins)) {
-          m_skinningCache.resize(p_numSkins);
-        }
-        SkinningCache& cache = m_skinningCache[p_nodes[i].skin];
-        if (!cache.valid) {
-          cache.jointMatrices.clear();
-          cache.jointMatrices.reserve(p_skins[p_nodes[i].skin].joints.size());
-          for (u32 j = 0; j < p_skins[p_nodes[i].skin].joints.size(); j++) {
-            i32 joint = p_skins[p_nodes[i].skin].joints[j];
-            cache.jointMatrices.push_back(
-              getMatrix(joint) *
-              p_skins[p_nodes[i].skin].inverseBindMatrices[j]);
-          }
-          cache.valid = true;
-        }
-
-        // Upload joint matrices to texture (immediate operation)
-        // Must bind texture to unit before updating!
         constexpr u32 kJointMatsUnit = 5;
-        if (!cache.jointMatrices.empty()) {
-          constexpr u32 kMatrixColumns = 4;
-          u32 jointCount = static_cast<u32>(cache.jointMatrices.size());
-          static gfx::TextureId jointMatsTexId =
-            resources.getDataTexture("jointMats");
-          resources.bindTexture(kJointMatsUnit, jointMatsTexId);
-          resources.updateDataTexture("jointMats",
-                                      kMatrixColumns,
-                                      jointCount,
-                                      glm::value_ptr(cache.jointMatrices[0]));
-        }
-
-        // Record: bind jointMats texture to unit 5 (for command buffer
-        // execution)
-        cmd.bindTextureByName(
-          kJointMatsUnit, "jointMats", resources.getLinearClampSampler());
+        cmd.bindTexture(
+          kJointMatsUnit, jointMatsTexId, resources.getLinearClampSampler());
       }
 
       Mesh& mesh = p_meshes[p_nodes[i].mesh];
       for (u32 j = 0; j < mesh.numPrims; j++) {
-        cmd.bindVertexBuffer(1, instanceBuffer, 0);
+        cmd.bindVertexBuffer(1, instance.buffer, instance.offset);
         mesh.m_primitives[j].recordDraw(cmd);
       }
     }
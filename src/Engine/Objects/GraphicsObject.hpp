@@ -3,12 +3,14 @@
 
 #include "Rendering/Skin.hpp"
 #include <Graphics/Handle.hpp>
+#include <Graphics/Resources/Buffer.hpp>
 #include <Rendering/Animation.hpp>
 #include <Rendering/Material.hpp>
 #include <Rendering/Mesh.hpp>
 #include <Rendering/Node.hpp>
 #include <Rendering/Primitive.hpp>
 #include <glm/gtx/string_cast.hpp>
+#include <span>
 
 #include <Jolt/Jolt.h>
 #include <Jolt/Physics/Collision/Shape/Shape.h>
@@ -30,25 +32,39 @@ public:
 
   virtual void drawGeom(gfx::ShaderId shader);
 
-  /// Record draw commands (with materials) into CommandBuffer.
-  /// Model matrix is written to instanceBuffer at offset 0 per-node (1-instance
-  /// draws).
+  /// Streams each mesh node's model matrix as a 1-instance vertex range,
+  /// appending one allocation per mesh node to `nodeInstances`, uploads the
+  /// joint matrices and prepares the materials. Main thread, before any
+  /// recordDraw()/recordDrawGeom() of the frame.
+  void prepareDraw(const glm::mat4& entityModel,
+                   std::vector<gfx::StreamAllocation>& nodeInstances);
+
+  /// Record draw commands (with materials) into CommandBuffer, drawing each
+  /// node from the ranges prepareDraw() streamed. Only encodes, so it may
+  /// run on a worker thread.
   virtual void recordDraw(gfx::CommandBuffer& cmd,
                           gfx::SamplerId sampler,
-                          const glm::mat4& entityModel,
-                          gfx::BufferId instanceBuffer,
+                          std::span<const gfx::StreamAllocation> nodeInstances,
                           i32 isSkinnedLoc = -1);
 
   /// Record geometry-only draw commands into CommandBuffer (for shadow pass).
-  /// Model matrix is written to instanceBuffer at offset 0 per-node (1-instance
-  /// draws).
-  virtual void recordDrawGeom(gfx::CommandBuffer& cmd,
-                              const glm::mat4& entityModel,
-                              gfx::BufferId instanceBuffer,
-                              i32 isSkinnedLoc = -1);
+  /// Same contract as recordDraw().
+  virtual void recordDrawGeom(
+    gfx::CommandBuffer& cmd,
+    std::span<const gfx::StreamAllocation> nodeInstances,
+    i32 isSkinnedLoc = -1);
 
   void applySkinning(gfx::ShaderId shader, i32 node);
 
+  // True if any node is skinned
+  [[nodiscard]] bool hasSkin() const;
+
+  /// Model-space box around every mesh node in its current pose. A skinned
+  /// vertex is a weighted blend of its joint matrices applied to the bind
+  /// pose, so a skinned node's bind-pose boxes carried by each of its joints
+  /// enclose it. Empty if a primitive has no bounds.
+  [[nodiscard]] Aabb getPoseBounds();
+
   // Compute the local transformation matrix of the given node
   glm::mat4 getLocalMat(i32 node);
   // Compute the world matrix of a node by recursively combining with parent
@@ -83,6 +99,9 @@ private:
     std::vector<glm::mat4> jointMatrices; // Cached joint matrices
   };
   mutable std::vector<SkinningCache> m_skinningCache;
+
+  // The skin's joint matrices, recomputed if the cache was reset
+  const std::vector<glm::mat4>& getJointMatrices(i32 skin);
 };
 
 #endif // GRAPHICSOBJECT_H_
@@ -110,6 +110,9 @@ Heightmap::Heightmap(std::string filename)
     newPrim->m_indexType = gfx::IndexType::U32;
     newPrim->m_count = static_cast<u32>(m_indices.size());
     newPrim->m_offset = 0;
+    for (const glm::vec3& vertex : m_vertices) {
+      newPrim->m_bounds.expand(vertex);
+    }
   }
 
   stbi_image_free(imageData);
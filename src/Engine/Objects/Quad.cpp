@@ -43,6 +43,10 @@ Quad::Quad()
   newPrim->m_indexType = gfx::IndexType::U32;
   newPrim->m_count = 6;
   newPrim->m_offset = 0;
+  for (u32 idx = 0; idx < 4; idx++) {
+    newPrim->m_bounds.expand(glm::vec3(
+      m_vertices[idx * 9], m_vertices[idx * 9 + 1], m_vertices[idx * 9 + 2]));
+  }
 
   p_collisionShape = new JPH::BoxShape(JPH::Vec3(0.5f, 0.5f, 0.5f));
 }
@@ -11,6 +11,7 @@ struct ProfilerConfig
 {
   static constexpr size_t kHistorySize = 256;
   static constexpr size_t kMaxSections = 16;
+  static constexpr size_t kMaxCounters = 10;
   static constexpr float kSmoothingFactor =
     0.05f; // EMA alpha (lower = smoother)
 };
@@ -56,6 +57,12 @@ struct TimerEntry
   SectionCategory category{ SectionCategory::kSystem };
 };
 
+struct CounterEntry
+{
+  std::string_view name;
+  uint32_t value{ 0 };
+};
+
 class Profiler
 {
 public:
@@ -112,6 +119,32 @@ public:
     }
   }
 
+  // Records a section timed elsewhere (e.g. on a worker thread)
+  void addSection(std::string_view name, SectionCategory cat, float durationMs)
+  {
+    if (m_sectionCount < ProfilerConfig::kMaxSections) {
+      m_sections[m_sectionCount].name = name;
+      m_sections[m_sectionCount].category = cat;
+      m_sections[m_sectionCount].durationMs = durationMs;
+      ++m_sectionCount;
+    }
+  }
+
+  // Per-frame count (draw calls, state changes), shown unsmoothed. Counters
+  // keep their slot once set, so they are listed in first-set order.
+  void setCounter(std::string_view name, uint32_t value)
+  {
+    for (size_t idx = 0; idx < m_counterCount; ++idx) {
+      if (m_counters[idx].name == name) {
+        m_counters[idx].value = value;
+        return;
+      }
+    }
+    if (m_counterCount < ProfilerConfig::kMaxCounters) {
+      m_counters[m_counterCount++] = { name, value };
+    }
+  }
+
   static constexpr size_t kPhaseECS = 0;
   static constexpr size_t kPhaseUI = 1;
   static constexpr size_t kPhaseSwap = 2;
@@ -128,6 +161,8 @@ public:
   size_t getSectionCount() const { return m_sectionCount; }
   const TimerEntry& getSection(size_t i) const { return m_smoothedSections[i]; }
   float getPhaseMs(size_t i) const { return m_smoothedPhaseDurations[i]; }
+  size_t getCounterCount() const { return m_counterCount; }
+  const CounterEntry& getCounter(size_t i) const { return m_counters[i]; }
 
   RingBuffer& fpsHistory() { return m_fpsHistory; }
   RingBuffer& frameTimeHistory() { return m_frameTimeHistory; }
@@ -156,6 +191,8 @@ private:
   size_t m_sectionCount{ 0 };
   std::array<TimePoint, kNumPhases> m_phaseStarts;
   std::array<float, kNumPhases> m_phaseDurations{};
+  std::array<CounterEntry, ProfilerConfig::kMaxCounters> m_counters;
+  size_t m_counterCount{ 0 };
 
   // Smoothed values (EMA)
   float m_smoothedFps{ 0.0f };
@@ -29,50 +29,16 @@ BloomPass::BloomPass()
   resources.createBareFramebuffer("bloomFBO");
   resources.createBareFramebuffer("bloomFinalFBO");
 
-  // Create main textures through new RenderResources system
-  // These are used by other passes (FxaaPass reads frameBloomFinal)
-  gfx::TextureCreateInfo brightInfo{};
-  brightInfo.width = m_width;
-  brightInfo.height = m_height;
-  brightInfo.format = gfx::PixelFormat::RGBA16F;
-  brightInfo.mipLevels = 1;
-  brightInfo.debugName = "frameBright";
-  resources.createTexture2D("frameBright", brightInfo);
-
-  gfx::TextureCreateInfo finalInfo{};
-  finalInfo.width = m_width;
-  finalInfo.height = m_height;
-  finalInfo.format = gfx::PixelFormat::RGBA16F;
-  finalInfo.mipLevels = 1;
-  finalInfo.debugName = "frameBloomFinal";
-  resources.createTexture2D("frameBloomFinal", finalInfo);
-
+  // frameBright, the mip chain and frameBloomFinal are transient, declared
+  // in Setup(); sizes are filled in by setViewport()
   m_useNewResources = true;
 
-  // Create mip chain textures through RenderResources
-  glm::vec2 currentMipSize(m_width, m_height);
-  glm::ivec2 currentMipSizeInt(m_width, m_height);
-  for (u32 i = 0; i < 5; i++) {
+  for (u32 i = 0; i < kMipCount; i++) {
     mipLevel mip;
-    currentMipSize *= 0.5f;
-    currentMipSizeInt /= 2;
-    mip.size = currentMipSize;
-    mip.intSize = currentMipSizeInt;
     mip.textureName = "bloomMip" + std::to_string(i);
-
-    gfx::TextureCreateInfo mipInfo{};
-    mipInfo.width = static_cast<u32>(currentMipSize.x);
-    mipInfo.height = static_cast<u32>(currentMipSize.y);
-    mipInfo.format = gfx::PixelFormat::R11G11B10F;
-    mipInfo.mipLevels = 1;
-    mipInfo.debugName = mip.textureName.c_str();
-    resources.createTexture2D(mip.textureName, mipInfo);
-
     m_mipChain.emplace_back(mip);
   }
 
-  setViewport(m_width, m_height);
-
   // Bind PostProcessData UBO block for all bloom shaders
   useShader();
   resources.bindShaderUniformBlock(
@@ -151,11 +117,30 @@ BloomPass::BloomPass()
 }
 
 void
-BloomPass::Execute(ECSManager& /* eManager */)
+BloomPass::Prepare(ECSManager& /* eManager */)
+{
+  // Downsample i reads the level above it: the full-size bright texture
+  // first, with mipLevel 0 selecting the Karis average, then mip i - 1
+  m_params.clear();
+  gfx::PostProcessUBO params{};
+  params.resolution = glm::vec4(
+    static_cast<float>(m_width), static_cast<float>(m_height), 1.0f, 0.005f);
+  params.postConfig = glm::ivec4(0, 0, 0, 0);
+  for (const mipLevel& mip : m_mipChain) {
+    m_params.push(params);
+    params.resolution.x = mip.size.x;
+    params.resolution.y = mip.size.y;
+    params.postConfig.x = 1;
+  }
+  // Upsampling only reads the filter radius
+  m_params.push(params);
+  m_params.upload();
+}
+
+void
+BloomPass::Record(ECSManager& /* eManager */)
 {
   auto& resources = gfx::RenderResources::getInstance();
-  auto& device = gfx::GraphicsDevice::getInstance();
-  gfx::PostProcessUBO& postProcessUBO = resources.getPostProcessUBO();
 
   gfx::CommandBuffer* cmd = getCommandBuffer();
   if (cmd == nullptr) {
@@ -166,6 +151,7 @@ BloomPass::Execute(ECSManager& /* eManager */)
   gfx::FramebufferId brightFBO = resources.getFramebuffer("brightFBO");
   gfx::FramebufferId bloomFBO = resources.getFramebuffer("bloomFBO");
   gfx::FramebufferId bloomFinalFBO = resources.getFramebuffer("bloomFinalFBO");
+  const u32 upParams = m_params.size() - 1;
 
 #if !defined(EMSCRIPTEN) && !defined(NDEBUG)
   cmd->pushDebugGroup("Bloom Pass");
@@ -198,27 +184,14 @@ BloomPass::Execute(ECSManager& /* eManager */)
 
   cmd->endRenderPass();
 
-  // Submit extract pass before downsample since we need to set UBO for
-  // downsample
-  device.submit(m_cmdBuffer);
-
   // =========================================================================
   // Stage 2: Progressive downsample through mip chain
   // =========================================================================
-  // Set initial resolution and mipLevel=0 for Karis average
-  postProcessUBO.resolution = glm::vec4(
-    static_cast<float>(m_width), static_cast<float>(m_height), 1.0f, 0.005f);
-  postProcessUBO.postConfig = glm::ivec4(0, 0, 0, 0); // mipLevel = 0
-  resources.flushPostProcessUBO();
-
   gfx::TextureId prevTexture = resources.getTexture("frameBright");
 
   for (u32 i = 0; i < static_cast<u32>(m_mipChain.size()); i++) {
     const mipLevel& mip = m_mipChain[i];
 
-    // Reset command buffer for this mip level
-    cmd->reset();
-
     // Set framebuffer attachment for this mip level
     cmd->setFramebufferAttachment(
       bloomFBO, 0, resources.getTexture(mip.textureName), 0, 0);
@@ -231,6 +204,7 @@ BloomPass::Execute(ECSManager& /* eManager */)
     cmd->beginRenderPass(downPassInfo);
 
     cmd->bindPipeline(m_downPipeline);
+    m_params.bind(*cmd, gfx::UBOBinding::PostProcess, i);
 
     gfx::Viewport mipViewport{};
     mipViewport.x = 0;
@@ -247,16 +221,6 @@ BloomPass::Execute(ECSManager& /* eManager */)
 
     cmd->endRenderPass();
 
-    device.submit(m_cmdBuffer);
-
-    // Update UBO for next iteration
-    postProcessUBO.resolution.x = mip.size.x;
-    postProcessUBO.resolution.y = mip.size.y;
-    if (i == 0) {
-      postProcessUBO.postConfig.x = 1; // mipLevel = 1 (disable Karis average)
-    }
-    resources.flushPostProcessUBO();
-
     prevTexture = resources.getTexture(mip.textureName);
   }
 
@@ -267,8 +231,6 @@ BloomPass::Execute(ECSManager& /* eManager */)
     const mipLevel& mip = m_mipChain[i];
     const mipLevel& nextMip = m_mipChain[i - 1];
 
-    cmd->reset();
-
     // Set framebuffer attachment for next mip level
     cmd->setFramebufferAttachment(
       bloomFBO, 0, resources.getTexture(nextMip.textureName), 0, 0);
@@ -281,6 +243,7 @@ BloomPass::Execute(ECSManager& /* eManager */)
     cmd->beginRenderPass(upPassInfo);
 
     cmd->bindPipeline(m_upPipeline); // Uses additive blend
+    m_params.bind(*cmd, gfx::UBOBinding::PostProcess, upParams);
 
     gfx::Viewport upViewport{};
     upViewport.x = 0;
@@ -297,17 +260,11 @@ BloomPass::Execute(ECSManager& /* eManager */)
     cmd->draw(gfx::RenderResources::kQuadVertexCount, 1, 0, 0);
 
     cmd->endRenderPass();
-
-    device.submit(m_cmdBuffer);
   }
 
   // =========================================================================
   // Stage 4: Final combine pass
   // =========================================================================
-  resources.flushPostProcessUBO();
-
-  cmd->reset();
-
   gfx::RenderPassBeginInfo combinePassInfo{};
   combinePassInfo.framebuffer = bloomFinalFBO;
   combinePassInfo.clearColors[0] = glm::vec4(0.0f);
@@ -319,6 +276,7 @@ BloomPass::Execute(ECSManager& /* eManager */)
   cmd->beginRenderPass(combinePassInfo);
 
   cmd->bindPipeline(m_combinePipeline);
+  m_params.bind(*cmd, gfx::UBOBinding::PostProcess, upParams);
 
   cmd->setViewport(fullViewport);
 
@@ -338,8 +296,27 @@ BloomPass::Execute(ECSManager& /* eManager */)
 #if !defined(EMSCRIPTEN) && !defined(NDEBUG)
   cmd->popDebugGroup();
 #endif
+}
 
-  device.submit(m_cmdBuffer);
+void
+BloomPass::Setup(RenderGraph::Builder& builder)
+{
+  builder.read("cubeFrame");
+
+  RenderGraph::TextureDesc frame{ gfx::PixelFormat::RGBA16F,
+                                  builder.width(),
+                                  builder.height() };
+  builder.create("frameBright", frame);
+  // Halved per level, rounding down like the sizes setViewport() computes
+  RenderGraph::TextureDesc mipDesc = frame;
+  mipDesc.format = gfx::PixelFormat::R11G11B10F;
+  for (const mipLevel& mip : m_mipChain) {
+    mipDesc.width /= 2;
+    mipDesc.height /= 2;
+    builder.create(mip.textureName, mipDesc);
+  }
+  // Read by FxaaPass
+  builder.create("frameBloomFinal", frame);
 }
 
 void
@@ -353,19 +330,15 @@ BloomPass::setViewport(u32 w, u32 h)
   // Update mip chain sizes
   glm::vec2 currentMipSize(m_width, m_height);
   glm::ivec2 currentMipSizeInt(m_width, m_height);
-  for (u32 i = 0; i < 5; i++) {
+  for (u32 i = 0; i < kMipCount; i++) {
     currentMipSize *= 0.5f;
     currentMipSizeInt /= 2;
     m_mipChain[i].size = currentMipSize;
     m_mipChain[i].intSize = currentMipSizeInt;
   }
 
-  // Recreate frameBright texture with new size
-  if (m_useNewResources) {
-    resources.recreateTexture2D("frameBright", m_width, m_height);
-  }
-
-  // Attach frameBright to brightFBO
+  // Targets come from the FrameGraph at the new size; attach frameBright to
+  // brightFBO
   resources.setFramebufferAttachment("brightFBO", 0, "frameBright");
   std::array<u32, 1> drawBuffers = { 0 };
   resources.setDrawBuffers("brightFBO", drawBuffers);
@@ -374,16 +347,6 @@ BloomPass::setViewport(u32 w, u32 h)
     std::cout << "brightFBO not complete!\n";
   }
 
-  // Recreate mip chain textures through RenderResources
-  for (u32 i = 0; i < 5; i++) {
-    mipLevel& mip = m_mipChain[i];
-    if (m_useNewResources) {
-      resources.recreateTexture2D(mip.textureName,
-                                  static_cast<u32>(mip.size.x),
-                                  static_cast<u32>(mip.size.y));
-    }
-  }
-
   // Attach first mip to bloomFBO
   resources.setFramebufferAttachment("bloomFBO", 0, m_mipChain[0].textureName);
   resources.setDrawBuffers("bloomFBO", drawBuffers);
@@ -393,11 +356,6 @@ BloomPass::setViewport(u32 w, u32 h)
     assert(false);
   }
 
-  // Recreate frameBloomFinal texture with new size
-  if (m_useNewResources) {
-    resources.recreateTexture2D("frameBloomFinal", m_width, m_height);
-  }
-
   // Attach frameBloomFinal to bloomFinalFBO
   resources.setFramebufferAttachment("bloomFinalFBO", 0, "frameBloomFinal");
   resources.setDrawBuffers("bloomFinalFBO", drawBuffers);
@@ -2,6 +2,7 @@
 #define BLOOMPASS_H_
 
 #include "RenderPasses/RenderPass.hpp"
+#include <Graphics/ParameterBlocks.hpp>
 #include <Graphics/RenderResources.hpp>
 
 class BloomPass final : public RenderPass
@@ -9,12 +10,15 @@ class BloomPass final : public RenderPass
 public:
   BloomPass();
   ~BloomPass() override = default;
-  void Execute(ECSManager& eManager) override;
-  [[nodiscard]] bool selfSubmitting() const override { return true; }
+  void Prepare(ECSManager& eManager) override;
+  void Record(ECSManager& eManager) override;
+  void Setup(RenderGraph::Builder& builder) override;
   void setViewport(u32 w, u32 h) override;
   void Init(FrameGraph& /* fGraph */) override {};
 
 private:
+  static constexpr u32 kMipCount = 5;
+
   struct mipLevel
   {
     glm::vec2 size;
@@ -24,6 +28,10 @@ private:
 
   std::vector<mipLevel> m_mipChain;
 
+  // PostProcessData for each downsample draw, followed by the one shared by
+  // the upsample and combine draws
+  gfx::ParameterBlocks<gfx::PostProcessUBO> m_params;
+
   // Shader names (loaded via RenderResources)
   std::string m_extractBrightName{ "ExtractBright" };
   std::string m_downShaderName{ "BloomDown" };
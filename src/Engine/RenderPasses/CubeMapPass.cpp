@@ -149,27 +149,22 @@ CubeMapPass::CubeMapPass()
   rboInfo.debugName = "cubeFBODepth";
   resources.createRenderbuffer("cubeFBODepth", rboInfo);
 
-  // Create cubeFrame texture through new RenderResources system
-  // This is read by BloomPass
-  gfx::TextureCreateInfo cubeFrameInfo{};
-  cubeFrameInfo.width = m_width;
-  cubeFrameInfo.height = m_height;
-  cubeFrameInfo.format = gfx::PixelFormat::RGBA16F;
-  cubeFrameInfo.mipLevels = 1;
-  cubeFrameInfo.debugName = "cubeFrame";
-  resources.createTexture2D("cubeFrame", cubeFrameInfo);
   m_useNewResources = true;
 
-  setViewport(m_width, m_height);
   resources.bindDefaultFramebuffer();
 }
 
 void
-CubeMapPass::Init(FrameGraph& fGraph)
+CubeMapPass::Setup(RenderGraph::Builder& builder)
 {
-  fGraph.getPass(PassId::kLight)->addTexture("irradianceMap");
-  fGraph.getPass(PassId::kLight)->addTexture("prefilterMap");
-  fGraph.getPass(PassId::kLight)->addTexture("brdfLUT");
+  // Lit scene and its depth are blitted in before the background is drawn
+  builder.read("lightFrame");
+  builder.read("gBufferDepth");
+  builder.read("envCubemap");
+  // Read by BloomPass
+  builder.create(
+    "cubeFrame",
+    { gfx::PixelFormat::RGBA16F, builder.width(), builder.height() });
 }
 
 void
@@ -245,9 +240,8 @@ CubeMapPass::setViewport(u32 w, u32 h)
 
   auto& resources = gfx::RenderResources::getInstance();
 
-  // Recreate cubeFrame texture and renderbuffer with new size
+  // cubeFrame comes from the FrameGraph at the new size
   if (m_useNewResources) {
-    resources.recreateTexture2D("cubeFrame", m_width, m_height);
     resources.resizeRenderbuffer("cubeFBODepth", m_width, m_height);
   }
 
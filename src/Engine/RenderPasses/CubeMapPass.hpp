@@ -9,8 +9,9 @@ public:
   CubeMapPass();
   ~CubeMapPass() override = default;
   void Record(ECSManager& eManager) override;
+  void Setup(RenderGraph::Builder& builder) override;
   void setViewport(u32 w, u32 h) override;
-  void Init(FrameGraph& fGraph) override;
+  void Init(FrameGraph& /* fGraph */) override {};
 
 private:
   void generateCubeMap();
@@ -10,6 +10,11 @@ public:
   ~DebugPass() override = default;
   void Execute(ECSManager& eManager) override;
   [[nodiscard]] bool selfSubmitting() const override { return true; }
+  void Setup(RenderGraph::Builder& builder) override
+  {
+    // Lines over the finished frame
+    builder.write(RenderGraph::kBackbuffer);
+  }
   void setViewport(u32 /* w */, u32 /* h */) override{};
   void Init(FrameGraph& /* fGraph */) override {};
 };
@@ -0,0 +1,114 @@
+#include "DrawSort.hpp"
+#include <array>
+#include <bit>
+
+namespace DrawSort {
+
+namespace {
+
+constexpr u64
+mask(u32 bits)
+{
+  return (u64{ 1 } << bits) - 1;
+}
+
+constexpr u32 kLayerShift = 62;
+
+// Field offsets for each layer, from the bit layout in the header
+struct Layout
+{
+  u32 pipeline;
+  u32 material;
+  u32 mesh;
+  u32 depth;
+};
+constexpr Layout kOpaque{ 54, 38, 22, 0 };
+constexpr Layout kBlend{ 32, 16, 0, 40 };
+
+const Layout&
+layoutOf(u64 key)
+{
+  return (key >> kLayerShift) == static_cast<u64>(Layer::Blend) ? kBlend
+                                                                : kOpaque;
+}
+
+} // namespace
+
+u32
+quantizeDepth(float depth)
+{
+  // Positive floats compare like their bits; the sign bit is 0, so the top
+  // 22 of the remaining 31 bits are kept
+  u32 bits = std::bit_cast<u32>(depth > 0.0f ? depth : 0.0f);
+  return bits >> (31 - kDepthBits);
+}
+
+u64
+makeKey(Layer layer, u32 pipeline, u32 material, u32 mesh, float depth)
+{
+  u64 depthCode = quantizeDepth(depth);
+  const Layout& layout = layer == Layer::Blend ? kBlend : kOpaque;
+  if (layer == Layer::Blend) {
+    // Farthest first
+    depthCode = ~depthCode & mask(kDepthBits);
+  }
+  return static_cast<u64>(layer) << kLayerShift |
+         (pipeline & mask(kPipelineBits)) << layout.pipeline |
+         (material & mask(kMaterialBits)) << layout.material |
+         (mesh & mask(kMeshBits)) << layout.mesh | depthCode << layout.depth;
+}
+
+void
+sort(std::vector<Item>& items, std::vector<Item>& scratch)
+{
+  size_t count = items.size();
+  if (count < 2) {
+    return;
+  }
+  scratch.resize(count);
+  for (u32 shift = 0; shift < 64; shift += 8) {
+    std::array<u32, 256> offsets{};
+    for (const Item& item : items) {
+      offsets[(item.key >> shift) & 0xFF]++;
+    }
+    // Every key has the same byte here, the pass would not move anything
+    if (offsets[(items[0].key >> shift) & 0xFF] == count) {
+      continue;
+    }
+    u32 sum = 0;
+    for (u32& offset : offsets) {
+      u32 bucket = offset;
+      offset = sum;
+      sum += bucket;
+    }
+    for (const Item& item : items) {
+      scratch[offsets[(item.key >> shift) & 0xFF]++] = item;
+    }
+    items.swap(scratch);
+  }
+}
+
+StateChanges
+countStateChanges(const std::vector<Item>& items)
+{
+  StateChanges changes;
+  changes.draws = static_cast<u32>(items.size());
+  u64 pipeline = ~u64{ 0 };
+  u64 material = ~u64{ 0 };
+  u64 mesh = ~u64{ 0 };
+  for (const Item& item : items) {
+    const Layout& layout = layoutOf(item.key);
+    u64 nextPipeline = (item.key >> layout.pipeline) & mask(kPipelineBits);
+    u64 nextMaterial = (item.key >> layout.material) & mask(kMaterialBits);
+    u64 nextMesh = (item.key >> layout.mesh) & mask(kMeshBits);
+    changes.pipelines += nextPipeline != pipeline;
+    changes.materials += nextMaterial != material;
+    changes.meshes += nextMesh != mesh;
+    pipeline = nextPipeline;
+    material = nextMaterial;
+    mesh = nextMesh;
+  }
+  return changes;
+}
+
+} // namespace DrawSort
@@ -0,0 +1,64 @@
+#ifndef DRAWSORT_H_
+#define DRAWSORT_H_
+
+#include <vector>
+
+// 64-bit draw sort keys. Draws are recorded in ascending key order, so the
+// high bits decide what changes least often:
+//
+//   opaque: layer:2 | pipeline:8 | material:16 | mesh:16 | depth:22
+//   blend:  layer:2 | ~depth:22  | pipeline:8  | material:16 | mesh:16
+//
+// Opaque draws are grouped by state, nearest first within a mesh so early-Z
+// rejects what is behind; blended draws go farthest first, state second.
+namespace DrawSort {
+
+enum class Layer : u8
+{
+  Opaque,
+  Blend
+};
+
+// A draw to order: its key and whatever index the caller uses to find it
+struct Item
+{
+  u64 key;
+  u32 index;
+};
+
+constexpr u32 kDepthBits = 22;
+constexpr u32 kPipelineBits = 8;
+constexpr u32 kMaterialBits = 16;
+constexpr u32 kMeshBits = 16;
+
+// Order-preserving 22-bit code for a non-negative view depth (negative
+// depths, i.e. behind the eye, clamp to 0). Uses the float's bit pattern,
+// which sorts like the value, so no depth range is needed.
+[[nodiscard]] u32 quantizeDepth(float depth);
+
+[[nodiscard]] u64 makeKey(Layer layer,
+                          u32 pipeline,
+                          u32 material,
+                          u32 mesh,
+                          float depth);
+
+// Stable LSD radix sort of `items` by key, 8 bits per pass. Passes over a
+// byte every key shares are skipped. `scratch` is reused between calls.
+void sort(std::vector<Item>& items, std::vector<Item>& scratch);
+
+// State changes in a recorded draw list, to compare orderings
+struct StateChanges
+{
+  u32 draws{ 0 };
+  u32 pipelines{ 0 };
+  u32 materials{ 0 };
+  u32 meshes{ 0 };
+};
+
+// Counts transitions in each of the key's state fields along `items`; the
+// first draw counts as one change of each
+[[nodiscard]] StateChanges countStateChanges(const std::vector<Item>& items);
+
+} // namespace DrawSort
+
+#endif // DRAWSORT_H_
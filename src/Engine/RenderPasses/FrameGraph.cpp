@@ -13,6 +13,21 @@
 #include <RenderPasses/LightPass.hpp>
 #include <RenderPasses/ParticlePass.hpp>
 #include <RenderPasses/ShadowPass.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+// In PassId order
+constexpr std::string_view kPassNames[] = {
+  "Shadow", "Geometry", "Light", "CubeMap", "Particle", "Bloom", "FXAA",
+#if !defined(EMSCRIPTEN) && !defined(NDEBUG)
+  "Debug",
+#endif
+};
+
+} // namespace
 
 FrameGraph::FrameGraph()
 {
@@ -43,10 +58,20 @@ FrameGraph::FrameGraph()
     std::make_unique<DebugPass>();
 #endif
 
+  m_passEnabled.fill(true);
   for (auto& p : m_renderPass) {
     p->Init(*this);
   }
+  // Compiles the graph, which allocates every pass's targets
   setViewport(m_width, m_height);
+
+  u32 hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  setRecordWorkerCount(std::min(kDefaultRecordWorkers, hardwareThreads - 1));
+}
+
+FrameGraph::~FrameGraph()
+{
+  stopRecordWorkers();
 }
 
 void
@@ -55,59 +80,218 @@ FrameGraph::draw(ECSManager& eManager)
   auto& resources = gfx::RenderResources::getInstance();
   auto& device = gfx::GraphicsDevice::getInstance();
 
+  // Opens this frame's region of the streaming rings and runs deferred
+  // deletions
+  device.beginFrame();
+  m_passMs.fill(0.0f);
+  m_optimizerStats.fill({});
+
+  GBufferLayout layout = eManager.getCompactGBuffer() ? GBufferLayout::kCompact
+                                                      : GBufferLayout::kFull;
+  if (layout != m_gBufferLayout) {
+    m_gBufferLayout = layout;
+    compileGraph();
+  }
+
   resources.clearColor(std::nullopt, 0.0f, 0.0f, 0.0f, 0.0f);
   resources.clearDepth(1.0f);
   resources.clearStencil(0);
   resources.setViewportRect(0, 0, m_width, m_height);
 
-  // Two-phase rendering: record all pass commands first, then batch submit.
-  // Self-submitting passes (e.g. BloomPass) manage their own submission
-  // because they need mid-frame CPU work between submits.
-  std::vector<gfx::CommandBufferId> pendingBuffers;
-  pendingBuffers.reserve(static_cast<size_t>(PassId::kNumPasses));
+  // Extract the render world once; every pass culls it for its own views
+  m_instances.update(eManager);
 
-#ifndef NDEBUG
-  static constexpr std::string_view kPassNames[] = {
-    "Shadow", "Geometry", "Light", "CubeMap", "Particle", "Bloom", "FXAA",
-#if !defined(EMSCRIPTEN)
-    "Debug",
-#endif
-  };
-  size_t passIdx = 0;
-#endif
+  // Streams skinned entities' node matrices and joints, which both the
+  // shadow and geometry passes draw from
+  m_instances.prepareSkinned();
 
+  // Buffers exist before any worker records into one, and the pool never
+  // grows while they do
   for (const auto& pass : m_renderPass) {
+    pass->ensureCommandBuffer();
+  }
+
+  // Self-submitting passes (e.g. DebugPass) split the frame into segments of
+  // batched passes, see drawSegment(). A self-submitting pass runs once
+  // everything before it has been submitted, and the passes after it only
+  // prepare once it has.
+  size_t segmentStart = 0;
+  for (size_t k = 0; k < m_passOrder.size(); ++k) {
+    size_t i = m_passOrder[k];
+    if (!m_renderPass[i]->selfSubmitting()) {
+      continue;
+    }
+    drawSegment(eManager, segmentStart, k);
+    segmentStart = k + 1;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    m_renderPass[i]->Execute(eManager);
+    auto end = std::chrono::high_resolution_clock::now();
+    m_passMs[i] = std::chrono::duration<float, std::milli>(end - start).count();
+  }
+  drawSegment(eManager, segmentStart, m_passOrder.size());
+
+  // Every command using this frame's stream allocations has been submitted
+  device.endFrame();
+
 #ifndef NDEBUG
-    if (m_profiler)
-      m_profiler->beginSection(kPassNames[passIdx],
-                               SectionCategory::kRenderPass);
+  if (m_profiler) {
+    for (size_t i = 0; i < kPassCount; ++i) {
+      m_profiler->addSection(
+        kPassNames[i], SectionCategory::kRenderPass, m_passMs[i]);
+    }
+
+    const auto* geometry =
+      static_cast<const GeometryPass*>(getPass(PassId::kGeom));
+    const auto& sorted = geometry->getStateChanges();
+    const auto& unsorted = geometry->getUnsortedStateChanges();
+    m_profiler->setCounter("Instanced draws", sorted.draws);
+    m_profiler->setCounter("Material binds", sorted.materials);
+    m_profiler->setCounter("Material binds (unsorted)", unsorted.materials);
+    m_profiler->setCounter("Mesh binds", sorted.meshes);
+    m_profiler->setCounter("Mesh binds (unsorted)", unsorted.meshes);
+    gfx::StreamStats stream = device.getStreamStats();
+    m_profiler->setCounter("Streamed KiB",
+                           static_cast<u32>(stream.bytesUploaded / 1024));
+    m_profiler->setCounter("Stream stalls", stream.stalls);
+    u32 removed = 0;
+    for (const gfx::CommandStreamStats& stats : m_optimizerStats) {
+      removed += stats.removedCommands;
+    }
+    m_profiler->setCounter("Commands removed", removed);
+    const RenderGraph::Stats& graph = m_graph.getStats();
+    m_profiler->setCounter("Passes culled", graph.culledPasses);
+    m_profiler->setCounter(
+      "Targets KiB saved",
+      static_cast<u32>((graph.declaredBytes - graph.physicalBytes) / 1024));
+  }
 #endif
-    if (pass->selfSubmitting()) {
-      // Flush any pending command buffers before this pass executes,
-      // since it may depend on their results.
-      if (!pendingBuffers.empty()) {
-        device.submit(pendingBuffers);
-        pendingBuffers.clear();
-      }
-      pass->Execute(eManager);
-    } else {
-      pass->Record(eManager);
-      gfx::CommandBufferId cmdId = pass->getCommandBufferId();
-      if (cmdId.isValid()) {
-        pendingBuffers.push_back(cmdId);
+}
+
+void
+FrameGraph::drawSegment(ECSManager& eManager, size_t first, size_t last)
+{
+  if (first == last) {
+    return;
+  }
+  auto& device = gfx::GraphicsDevice::getInstance();
+
+  // Uploads and everything else that reaches GL stay on this thread, in
+  // pass order, so they happen as they would recording serially
+  for (size_t k = first; k < last; ++k) {
+    size_t i = m_passOrder[k];
+    auto start = std::chrono::high_resolution_clock::now();
+    m_renderPass[i]->Prepare(eManager);
+    auto end = std::chrono::high_resolution_clock::now();
+    m_passMs[i] = std::chrono::duration<float, std::milli>(end - start).count();
+  }
+  // Upload material slots written while preparing
+  gfx::RenderResources::getInstance().getMaterialParameters().flush();
+
+  std::unique_lock lock(m_recordMutex);
+  m_recordEcs = &eManager;
+  for (size_t k = first; k < last; ++k) {
+    m_recorded[m_passOrder[k]] = false;
+    m_recordQueue.push(m_passOrder[k]);
+  }
+  m_recordReady.notify_all();
+
+  // Each pass is submitted as soon as it and every pass before it are
+  // recorded. While the next one is not, the caller records queued passes
+  // itself.
+  for (size_t k = first; k < last; ++k) {
+    size_t i = m_passOrder[k];
+    while (!m_recorded[i]) {
+      if (m_recordQueue.empty()) {
+        m_recordDone.wait(lock);
+        continue;
       }
+      size_t index = m_recordQueue.front();
+      m_recordQueue.pop();
+
+      lock.unlock();
+      recordPass(index);
+      lock.lock();
+      m_recorded[index] = true;
     }
-#ifndef NDEBUG
-    if (m_profiler)
-      m_profiler->endSection();
-    ++passIdx;
+
+    lock.unlock();
+    gfx::CommandBufferId cmdId = m_renderPass[i]->getCommandBufferId();
+    if (cmdId.isValid()) {
+      device.submit(cmdId);
+    }
+    lock.lock();
+  }
+}
+
+void
+FrameGraph::recordPass(size_t index)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+  m_renderPass[index]->Record(*m_recordEcs);
+  m_optimizerStats[index] = {};
+  gfx::CommandBufferId cmdId = m_renderPass[index]->getCommandBufferId();
+  if (m_optimizeCommands && cmdId.isValid()) {
+    m_optimizerStats[index] = m_optimizers[index].optimize(
+      *gfx::GraphicsDevice::getInstance().getCommandBuffer(cmdId));
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  m_passMs[index] +=
+    std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void
+FrameGraph::setRecordWorkerCount(u32 count)
+{
+#ifdef EMSCRIPTEN
+  // No pthreads in the web build
+  count = 0;
 #endif
+  if (count == m_recordWorkers.size()) {
+    return;
+  }
+
+  stopRecordWorkers();
+  m_stopping = false;
+  m_recordWorkers.reserve(count);
+  for (u32 i = 0; i < count; ++i) {
+    m_recordWorkers.emplace_back([this] { recordWorkerLoop(); });
+  }
+}
+
+void
+FrameGraph::recordWorkerLoop()
+{
+  std::unique_lock lock(m_recordMutex);
+  while (true) {
+    m_recordReady.wait(
+      lock, [this] { return m_stopping || !m_recordQueue.empty(); });
+    if (m_stopping) {
+      return;
+    }
+    size_t index = m_recordQueue.front();
+    m_recordQueue.pop();
+
+    lock.unlock();
+    recordPass(index);
+    lock.lock();
+    m_recorded[index] = true;
+    m_recordDone.notify_one();
   }
+}
 
-  // Submit any remaining recorded command buffers
-  if (!pendingBuffers.empty()) {
-    device.submit(pendingBuffers);
+void
+FrameGraph::stopRecordWorkers()
+{
+  {
+    std::lock_guard lock(m_recordMutex);
+    m_stopping = true;
+  }
+  m_recordReady.notify_all();
+  for (auto& worker : m_recordWorkers) {
+    worker.join();
   }
+  m_recordWorkers.clear();
 }
 
 void
@@ -115,7 +299,96 @@ FrameGraph::setViewport(u32 w, u32 h)
 {
   m_width = w;
   m_height = h;
-  for (const auto& pass : m_renderPass) {
-    pass->setViewport(w, h);
+  compileGraph();
+}
+
+void
+FrameGraph::setPassEnabled(PassId id, bool enabled)
+{
+  size_t index = static_cast<size_t>(id);
+  if (m_passEnabled[index] == enabled) {
+    return;
   }
+  m_passEnabled[index] = enabled;
+  compileGraph();
+}
+
+void
+FrameGraph::compileGraph()
+{
+  auto& resources = gfx::RenderResources::getInstance();
+  auto& device = gfx::GraphicsDevice::getInstance();
+
+  m_graph.reset(m_width, m_height);
+  for (size_t i = 0; i < kPassCount; ++i) {
+    if (m_passEnabled[i]) {
+      RenderGraph::Builder builder =
+        m_graph.addPass(kPassNames[i], static_cast<u32>(i));
+      m_renderPass[i]->Setup(builder);
+    }
+  }
+  if (!m_graph.compile()) {
+    std::cerr << "Render graph has a cycle, running passes in PassId order\n";
+  }
+  std::vector<size_t> previousOrder = std::move(m_passOrder);
+  m_passOrder.assign(m_graph.getOrder().begin(), m_graph.getOrder().end());
+
+  // Back each physical slot with a pooled texture of its format and size
+  for (PooledTexture& pooled : m_texturePool) {
+    pooled.inUse = false;
+  }
+  std::vector<gfx::TextureId> physical;
+  for (const RenderGraph::TextureDesc& desc : m_graph.getPhysicalTextures()) {
+    auto it = std::find_if(
+      m_texturePool.begin(), m_texturePool.end(), [&](const PooledTexture& p) {
+        return !p.inUse && p.desc == desc;
+      });
+    if (it == m_texturePool.end()) {
+      gfx::TextureCreateInfo info{};
+      info.format = desc.format;
+      info.width = desc.width;
+      info.height = desc.height;
+      info.mipLevels = 1;
+      info.usage = gfx::TextureUsage::Sampled | gfx::TextureUsage::RenderTarget;
+      info.debugName = "FrameGraphTarget";
+      m_texturePool.push_back({ desc, device.createTexture(info), false });
+      it = m_texturePool.end() - 1;
+    }
+    it->inUse = true;
+    physical.push_back(it->handle);
+  }
+  // Shapes nothing needs any more, e.g. the sizes from before a resize
+  std::erase_if(m_texturePool, [&](const PooledTexture& pooled) {
+    if (!pooled.inUse) {
+      device.destroyTexture(pooled.handle);
+    }
+    return !pooled.inUse;
+  });
+
+  // Passes find their targets by name; culled passes' names resolve to
+  // nothing
+  for (const std::string& name : m_registeredTransients) {
+    resources.unregisterTexture(name);
+  }
+  m_registeredTransients.clear();
+  for (const RenderGraph::Transient& transient : m_graph.getTransients()) {
+    if (transient.physical == RenderGraph::kInvalid) {
+      continue;
+    }
+    gfx::TextureId handle = physical[transient.physical];
+    resources.registerTexture(
+      transient.name, handle, *device.getTextureInfo(handle));
+    m_registeredTransients.push_back(transient.name);
+  }
+
+  for (size_t i : m_passOrder) {
+    m_renderPass[i]->setViewport(m_width, m_height);
+  }
+
+#ifndef NDEBUG
+  // Resizes only change sizes; report when passes come or go
+  if (m_passOrder != previousOrder) {
+    std::cout << m_graph.describe();
+  }
+#endif
 }
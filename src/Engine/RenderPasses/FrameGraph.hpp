@@ -1,14 +1,23 @@
 #ifndef FRAMEGRAPH_H_
 #define FRAMEGRAPH_H_
 
+#include <Graphics/CommandStreamOptimizer.hpp>
+#include <RenderPasses/InstanceBatcher.hpp>
+#include <RenderPasses/RenderGraph.hpp>
 #include <RenderPasses/RenderPass.hpp>
 #include <array>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
 
 #ifndef NDEBUG
 class Profiler;
 #endif
 
-// Moving a pass enum to the right of kNumPasses will deactivate it.
+// Moving a pass enum to the right of kNumPasses will deactivate it. Passes
+// run in the order their Setup() dependencies give; this order only breaks
+// ties.
 enum class PassId : size_t
 {
   kShadow,
@@ -30,11 +39,36 @@ class FrameGraph : public Singleton<FrameGraph>
 
 public:
   FrameGraph();
-  ~FrameGraph() = default;
+  ~FrameGraph();
 
   void draw(ECSManager& eManager);
   void setViewport(u32 w, u32 h);
 
+  // Threads recording passes' command buffers alongside the main thread; 0
+  // records every pass on the caller
+  void setRecordWorkerCount(u32 count);
+  u32 getRecordWorkerCount() const
+  {
+    return static_cast<u32>(m_recordWorkers.size());
+  }
+
+  // Leaves a pass out of the render graph. Passes that only fed it are
+  // culled with it and their transient targets freed.
+  void setPassEnabled(PassId id, bool enabled);
+  bool isPassEnabled(PassId id) const
+  {
+    return m_passEnabled[static_cast<size_t>(id)];
+  }
+  // Follows ECSManager's compact G-buffer setting, recompiling the graph
+  // at the start of the draw() that sees it change
+  GBufferLayout getGBufferLayout() const { return m_gBufferLayout; }
+  // The graph as last compiled: pass order, culling and target aliasing
+  const RenderGraph& getGraph() const { return m_graph; }
+
+  // Strips redundant binds from each recorded pass before it is submitted
+  void setOptimizeCommands(bool enabled) { m_optimizeCommands = enabled; }
+  bool getOptimizeCommands() const { return m_optimizeCommands; }
+
   RenderPass* getPass(PassId id)
   {
     return m_renderPass[static_cast<size_t>(id)].get();
@@ -43,14 +77,64 @@ public:
   {
     return m_renderPass[static_cast<size_t>(id)].get();
   }
+  // Scene draw batches, refreshed once per draw() before any pass runs
+  InstanceBatcher& getInstances() { return m_instances; }
 
 private:
-  std::array<std::unique_ptr<RenderPass>,
-             static_cast<size_t>(PassId::kNumPasses)>
-    m_renderPass;
+  static constexpr size_t kPassCount = static_cast<size_t>(PassId::kNumPasses);
+  static constexpr u32 kDefaultRecordWorkers = 3;
+
+  // Rebuilds m_graph from the enabled passes' Setup(), backs its transient
+  // textures from m_texturePool and re-attaches the surviving passes'
+  // targets
+  void compileGraph();
+
+  // Prepares the batched passes m_passOrder[first, last) on the calling
+  // thread, records them in parallel and submits them in that order
+  void drawSegment(ECSManager& eManager, size_t first, size_t last);
+  void recordPass(size_t index);
+  void recordWorkerLoop();
+  void stopRecordWorkers();
+
+  std::array<std::unique_ptr<RenderPass>, kPassCount> m_renderPass;
+  std::array<bool, kPassCount> m_passEnabled{};
+  GBufferLayout m_gBufferLayout{ GBufferLayout::kFull };
+  RenderGraph m_graph;
+  std::vector<size_t> m_passOrder; // Surviving passes, in execution order
+
+  // Textures behind the graph's physical slots. Kept across recompiles and
+  // reused by any slot of the same format and size.
+  struct PooledTexture
+  {
+    RenderGraph::TextureDesc desc;
+    gfx::TextureId handle;
+    bool inUse{ false };
+  };
+  std::vector<PooledTexture> m_texturePool;
+  std::vector<std::string> m_registeredTransients;
+
+  InstanceBatcher m_instances;
   u32 m_width{ 800 };
   u32 m_height{ 800 };
 
+  // CPU time spent on each pass this frame, over all threads
+  std::array<float, kPassCount> m_passMs{};
+
+  // One per pass, so workers never share scratch memory
+  std::array<gfx::CommandStreamOptimizer, kPassCount> m_optimizers;
+  std::array<gfx::CommandStreamStats, kPassCount> m_optimizerStats{};
+  bool m_optimizeCommands{ true };
+
+  std::vector<std::thread> m_recordWorkers;
+  // Guards everything below
+  std::mutex m_recordMutex;
+  std::condition_variable m_recordReady; // Wakes workers
+  std::condition_variable m_recordDone;  // Wakes the thread inside draw()
+  std::queue<size_t> m_recordQueue;      // Passes waiting to be recorded
+  std::array<bool, kPassCount> m_recorded{};
+  ECSManager* m_recordEcs{ nullptr };
+  bool m_stopping{ false };
+
 #ifndef NDEBUG
   Profiler* m_profiler{ nullptr };
 
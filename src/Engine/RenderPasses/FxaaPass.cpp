@@ -1,6 +1,7 @@
 #include "FxaaPass.hpp"
 #include <Graphics/GraphicsDevice.hpp>
 #include <Graphics/UBOStructs.hpp>
+#include <RenderPasses/FrameGraph.hpp>
 #include <array>
 
 FxaaPass::FxaaPass()
@@ -19,7 +20,8 @@ FxaaPass::FxaaPass()
     shader, "PostProcessData", gfx::UBOBinding::PostProcess);
 
   // Set sampler uniform (texture unit 0)
-  device.setUniformInt(device.getUniformLocation(shader, "scene"), 0);
+  m_sceneLoc = device.getUniformLocation(shader, "scene");
+  device.setUniformInt(m_sceneLoc, 0);
 
   // Create pipeline for fullscreen quad rendering (for future use)
   static constexpr u32 kQuadStride = 5 * sizeof(float);
@@ -50,18 +52,26 @@ FxaaPass::FxaaPass()
   m_pipeline = resources.createPipeline("FxaaPassPipeline", pipeInfo);
 }
 
+void
+FxaaPass::Prepare(ECSManager& /* eManager */)
+{
+  // Own block rather than the shared PostProcess UBO, which BloomPass's
+  // draws in the same batch bind ranges over
+  gfx::PostProcessUBO params{};
+  params.resolution = glm::vec4(
+    static_cast<float>(m_width), static_cast<float>(m_height), 1.0f, 0.0f);
+  params.postConfig = glm::ivec4(1, 0, 0, 0);
+  m_params.clear();
+  m_params.push(params);
+  m_params.upload();
+}
+
 void
 FxaaPass::Record(ECSManager& /* eManager */)
 {
   auto& resources = gfx::RenderResources::getInstance();
   auto& device = gfx::GraphicsDevice::getInstance();
 
-  // Set resolution in PostProcessUBO and flush before CommandBuffer
-  gfx::PostProcessUBO& postProcessUBO = resources.getPostProcessUBO();
-  postProcessUBO.resolution = glm::vec4(
-    static_cast<float>(m_width), static_cast<float>(m_height), 1.0f, 0.0f);
-  resources.flushPostProcessUBO();
-
   // Get command buffer for this pass
   gfx::CommandBuffer* cmd = getCommandBuffer();
   if (cmd == nullptr) {
@@ -85,10 +95,11 @@ FxaaPass::Record(ECSManager& /* eManager */)
 
   // Bind pipeline
   cmd->bindPipeline(m_pipeline);
+  m_params.bind(*cmd, gfx::UBOBinding::PostProcess, 0);
 
   // Set sampler uniform (must be done after pipeline bind since it uses the
   // shader)
-  cmd->setUniform(getUniformLocation("scene"), 0);
+  cmd->setUniform(m_sceneLoc, 0);
 
   // Set viewport
   gfx::Viewport viewport{};
@@ -104,7 +115,7 @@ FxaaPass::Record(ECSManager& /* eManager */)
   cmd->bindVertexBuffer(0, resources.getQuadVertexBuffer(), 0);
 
   // Bind input texture
-  gfx::TextureId tex = resources.getTexture("frameBloomFinal");
+  gfx::TextureId tex = resources.getTexture(m_input);
   gfx::SamplerId sampler = resources.getLinearClampSampler();
 
   cmd->bindTexture(0, tex, sampler);
@@ -119,6 +130,15 @@ FxaaPass::Record(ECSManager& /* eManager */)
 #endif
 }
 
+void
+FxaaPass::Setup(RenderGraph::Builder& builder)
+{
+  m_input = m_frameGraph->isPassEnabled(PassId::kBloom) ? "frameBloomFinal"
+                                                        : "cubeFrame";
+  builder.read(m_input);
+  builder.write(RenderGraph::kBackbuffer);
+}
+
 void
 FxaaPass::setViewport(u32 w, u32 h)
 {
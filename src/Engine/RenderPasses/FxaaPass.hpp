@@ -1,23 +1,31 @@
 #ifndef FXAAPASS_H_
 #define FXAAPASS_H_
 
+#include <Graphics/ParameterBlocks.hpp>
 #include <RenderPasses/RenderPass.hpp>
 
 /// FXAA (Fast Approximate Anti-Aliasing) post-processing pass.
 ///
-/// Input: "frameBloomFinal" texture from BloomPass
+/// Input: "frameBloomFinal" texture from BloomPass, or "cubeFrame" from
+/// CubeMapPass/ParticlePass while bloom is disabled
 /// Output: Default framebuffer (screen)
 class FxaaPass final : public RenderPass
 {
 public:
   FxaaPass();
   ~FxaaPass() override = default;
+  void Prepare(ECSManager& eManager) override;
   void Record(ECSManager& eManager) override;
+  void Setup(RenderGraph::Builder& builder) override;
   void setViewport(u32 w, u32 h) override;
-  void Init(FrameGraph& /* fGraph */) override {};
+  void Init(FrameGraph& fGraph) override { m_frameGraph = &fGraph; }
 
 private:
+  FrameGraph* m_frameGraph{ nullptr };
+  std::string m_input{ "frameBloomFinal" }; // Picked in Setup()
   gfx::PipelineId m_pipeline;
+  i32 m_sceneLoc{ -1 };
+  gfx::ParameterBlocks<gfx::PostProcessUBO> m_params;
 };
 
 #endif // FXAAPASS_H_
@@ -1,7 +1,6 @@
 #include "GeometryPass.hpp"
 #include "ECS/Components/CameraComponent.hpp"
 #include "ECS/Components/GraphicsComponent.hpp"
-#include "ECS/Components/PositionComponent.hpp"
 #include <ECS/ECSManager.hpp>
 #include <ECS/Systems/CameraSystem.hpp>
 #include <Graphics/CommandBuffer.hpp>
@@ -10,49 +9,23 @@
 #include <Graphics/UBOStructs.hpp>
 #include <RenderPasses/FrameGraph.hpp>
 #include <RenderPasses/RenderPass.hpp>
-#include <unordered_map>
 
 namespace {
 
-// Instance key for grouping entities that share the same primitive
-struct InstanceKey
-{
-  GraphicsObject* obj;
-  u32 nodeIdx;
-  u32 primIdx;
-
-  bool operator==(const InstanceKey&) const = default;
-};
-
-struct InstanceKeyHash
-{
-  size_t operator()(const InstanceKey& key) const
-  {
-    auto h1 = std::hash<void*>{}(key.obj);
-    auto h2 = std::hash<u32>{}(key.nodeIdx);
-    auto h3 = std::hash<u32>{}(key.primIdx);
-    return h1 ^ (h2 << 16) ^ (h3 << 32);
-  }
-};
-
-struct DrawGroup
-{
-  InstanceKey key;
-  u32 offset; // index into allMatrices
-  u32 count;  // number of instances
-};
-
 // Mesh vertex stride (must match InterleavedVertex in GltfObject.cpp)
 // vec3 pos + vec3 norm + vec4 tan + vec2 uv + u16vec4 joints + vec4 weights
 constexpr u32 kMeshVertexStride = 72;
 constexpr u32 kInstanceStride = sizeof(glm::mat4); // 64 bytes
 
+constexpr const char* kVertexShader = "resources/Shaders/mesh.vert";
+constexpr const char* kFragmentShader = "resources/Shaders/pbrMesh.frag";
+// pbrMesh.frag writes the GBufferLayout::kCompact targets with this defined
+constexpr std::string_view kCompactDefines[] = { "COMPACT_GBUFFER" };
+
 } // namespace
 
 GeometryPass::GeometryPass()
-  : RenderPass("GeometryPass",
-               "resources/Shaders/mesh.vert",
-               "resources/Shaders/pbrMesh.frag")
+  : RenderPass("GeometryPass", kVertexShader, kFragmentShader)
 {
   auto& resources = gfx::RenderResources::getInstance();
   auto& device = gfx::GraphicsDevice::getInstance();
@@ -69,25 +42,7 @@ GeometryPass::GeometryPass()
   rboInfo.debugName = "gBufferDepth";
   resources.createRenderbuffer("gBufferDepth", rboInfo);
 
-  // Create G-buffer textures through new RenderResources system
-  // These are read by LightPass
-  gfx::TextureCreateInfo gBufferInfo{};
-  gBufferInfo.width = m_width;
-  gBufferInfo.height = m_height;
-  gBufferInfo.format = gfx::PixelFormat::RGBA16F;
-  gBufferInfo.mipLevels = 1;
-
-  gBufferInfo.debugName = "gPositionAo";
-  resources.createTexture2D("gPositionAo", gBufferInfo);
-
-  gBufferInfo.debugName = "gNormalMetal";
-  resources.createTexture2D("gNormalMetal", gBufferInfo);
-
-  gBufferInfo.debugName = "gAlbedoSpecRough";
-  resources.createTexture2D("gAlbedoSpecRough", gBufferInfo);
-
-  gBufferInfo.debugName = "gEmissive";
-  resources.createTexture2D("gEmissive", gBufferInfo);
+  // G-buffer textures are transient, declared in Setup()
 
   // Create material sampler for texture binding
   gfx::SamplerCreateInfo samplerInfo{};
@@ -100,28 +55,13 @@ GeometryPass::GeometryPass()
 
   m_useNewResources = true;
 
-  setViewport(m_width, m_height);
-
-  // Bind uniform blocks
-  useShader();
-  resources.bindShaderUniformBlock(
-    getShaderId(), "CameraData", gfx::UBOBinding::Camera);
-  resources.bindShaderUniformBlock(
-    getShaderId(), "MaterialData", gfx::UBOBinding::Material);
-
-  // Set texture sampler uniform once (always {0,1,2,3,4})
-  constexpr i32 kNumMaterialTextures = 5;
-  std::array<i32, kNumMaterialTextures> texUnits = { 0, 1, 2, 3, 4 };
-  device.setUniformIntArray(
-    device.getUniformLocation(getShaderId(), "textures"), texUnits);
-
-  // Set jointMats sampler uniform to texture unit 5 (for skinning)
-  constexpr i32 kJointMatsUnit = 5;
-  i32 jointMatsLoc = device.getUniformLocation(getShaderId(), "jointMats");
-  device.setUniformInt(jointMatsLoc, kJointMatsUnit);
-
-  // Cache uniform locations
-  m_isSkinnedLoc = device.getUniformLocation(getShaderId(), "is_skinned");
+  // Both layouts' programs are built up front; Setup() picks one
+  auto& full = m_variants[static_cast<size_t>(GBufferLayout::kFull)];
+  auto& compact = m_variants[static_cast<size_t>(GBufferLayout::kCompact)];
+  full.shaderName = m_shaderName;
+  compact.shaderName = m_shaderName + "Compact";
+  resources.loadShaderProgram(
+    compact.shaderName, kVertexShader, kFragmentShader, kCompactDefines);
 
   // Pipeline with full instanced vertex layout.
   // Binding 0: mesh vertex data (per-vertex, locations 0-5)
@@ -163,7 +103,6 @@ GeometryPass::GeometryPass()
       .format = gfx::PixelFormat::MAT4F }, // modelMatrix
   } };
   gfx::PipelineCreateInfo pipeInfo{};
-  pipeInfo.shaderProgram = getShaderId();
   pipeInfo.vertexBindings = pipeBindings;
   pipeInfo.vertexAttributes = pipeAttribs;
   pipeInfo.topology = gfx::PrimitiveTopology::Triangles;
@@ -172,8 +111,40 @@ GeometryPass::GeometryPass()
   pipeInfo.depthStencil.depthCompareOp = gfx::CompareOp::Less;
   pipeInfo.blend.attachments[0].blendEnable = false;
   pipeInfo.rasterizer.cullMode = gfx::CullMode::Back;
-  pipeInfo.debugName = "GeometryPassPipeline";
-  m_pipeline = resources.createPipeline("GeometryPassPipeline", pipeInfo);
+
+  for (Variant& variant : m_variants) {
+    m_shaderName = variant.shaderName;
+
+    // Bind uniform blocks
+    useShader();
+    resources.bindShaderUniformBlock(
+      getShaderId(), "CameraData", gfx::UBOBinding::Camera);
+    resources.bindShaderUniformBlock(
+      getShaderId(), "MaterialData", gfx::UBOBinding::Material);
+
+    // Set texture sampler uniform once (always {0,1,2,3,4})
+    constexpr i32 kNumMaterialTextures = 5;
+    std::array<i32, kNumMaterialTextures> texUnits = { 0, 1, 2, 3, 4 };
+    device.setUniformIntArray(
+      device.getUniformLocation(getShaderId(), "textures"), texUnits);
+
+    // Set jointMats sampler uniform to texture unit 5 (for skinning)
+    constexpr i32 kJointMatsUnit = 5;
+    i32 jointMatsLoc = device.getUniformLocation(getShaderId(), "jointMats");
+    device.setUniformInt(jointMatsLoc, kJointMatsUnit);
+
+    // Cache uniform locations
+    variant.isSkinnedLoc =
+      device.getUniformLocation(getShaderId(), "is_skinned");
+
+    std::string pipelineName = m_shaderName + "Pipeline";
+    pipeInfo.shaderProgram = getShaderId();
+    pipeInfo.debugName = pipelineName.c_str();
+    variant.pipeline = resources.createPipeline(pipelineName, pipeInfo);
+  }
+  m_shaderName = full.shaderName;
+  m_pipeline = full.pipeline;
+  m_isSkinnedLoc = full.isSkinnedLoc;
 
   // Create instance buffer for batched model matrices
   gfx::BufferCreateInfo instanceBufInfo{};
@@ -184,29 +155,50 @@ GeometryPass::GeometryPass()
   m_instanceBuffer = device.createBuffer(instanceBufInfo);
   m_instanceBufferCapacity = kInitialInstanceCapacity;
 
-  // Single-instance buffer for skinned entity draws (1 mat4)
-  gfx::BufferCreateInfo singleBufInfo{};
-  singleBufInfo.size = kInstanceStride;
-  singleBufInfo.usage = gfx::BufferUsage::Vertex | gfx::BufferUsage::Dynamic;
-  singleBufInfo.debugName = "GeometrySingleInstanceBuffer";
-  m_singleInstanceBuffer = device.createBuffer(singleBufInfo);
-
   resources.bindDefaultFramebuffer();
 }
 
 void
 GeometryPass::Init(FrameGraph& fGraph)
 {
-  fGraph.getPass(PassId::kLight)->addTexture("gPositionAo");
-  fGraph.getPass(PassId::kLight)->addTexture("gNormalMetal");
-  fGraph.getPass(PassId::kLight)->addTexture("gAlbedoSpecRough");
-  fGraph.getPass(PassId::kLight)->addTexture("gEmissive");
+  m_instances = &fGraph.getInstances();
+  m_frameGraph = &fGraph;
 }
 
 void
-GeometryPass::Record(ECSManager& eManager)
+GeometryPass::Setup(RenderGraph::Builder& builder)
+{
+  m_layout = m_frameGraph->getGBufferLayout();
+  const Variant& variant = m_variants[static_cast<size_t>(m_layout)];
+  m_shaderName = variant.shaderName;
+  m_pipeline = variant.pipeline;
+  m_isSkinnedLoc = variant.isSkinnedLoc;
+
+  // Read by LightPass
+  u32 w = builder.width();
+  u32 h = builder.height();
+  if (m_layout == GBufferLayout::kCompact) {
+    builder.create("gNormalRough", { gfx::PixelFormat::RGB10A2, w, h });
+    builder.create("gAlbedoMetal", { gfx::PixelFormat::RGBA8, w, h });
+    builder.create("gOcclusion", { gfx::PixelFormat::R8, w, h });
+    builder.create("gEmissive", { gfx::PixelFormat::R11G11B10F, w, h });
+    // Sampled too, for positions; replaces the renderbuffer
+    builder.create("gBufferDepth",
+                   { gfx::PixelFormat::Depth24Stencil8, w, h });
+    return;
+  }
+
+  RenderGraph::TextureDesc gBuffer{ gfx::PixelFormat::RGBA16F, w, h };
+  builder.create("gPositionAo", gBuffer);
+  builder.create("gNormalMetal", gBuffer);
+  builder.create("gAlbedoSpecRough", gBuffer);
+  builder.create("gEmissive", gBuffer);
+  builder.write("gBufferDepth");
+}
+
+void
+GeometryPass::Prepare(ECSManager& /* eManager */)
 {
-  auto& resources = gfx::RenderResources::getInstance();
   auto& device = gfx::GraphicsDevice::getInstance();
 
   // Update CameraUBO with current camera matrices (before CommandBuffer
@@ -221,6 +213,55 @@ GeometryPass::Record(ECSManager& eManager)
   device.setUniformInt(device.getUniformLocation(getShaderId(), "jointMats"),
                        kJointMatsUnit);
 
+  // Phase 1: Cull the shared instance batches against the camera, redone
+  // only when the batches or the frustum changed
+  Frustum frustum = cam->getFrustum();
+  bool instancesChanged = m_instances->version() != m_culledVersion ||
+                          m_culledFrustum != frustum;
+  if (instancesChanged) {
+    m_culledVersion = m_instances->version();
+    m_culledFrustum = frustum;
+    m_visibleMatrices.clear();
+    m_visibleGroups.clear();
+    m_instances->cull(frustum, m_visibleMatrices, m_visibleGroups);
+    sortDraws(cam->m_viewMatrix);
+  }
+  const auto& allMatrices = m_visibleMatrices;
+
+  // Phase 2: Upload instance matrices, skipped when nothing moved
+  if (!allMatrices.empty()) {
+    auto totalSize = static_cast<u32>(allMatrices.size()) * kInstanceStride;
+
+    // Resize buffer if needed
+    if (static_cast<u32>(allMatrices.size()) > m_instanceBufferCapacity) {
+      device.destroyBuffer(m_instanceBuffer);
+      m_instanceBufferCapacity = static_cast<u32>(allMatrices.size()) * 2;
+      gfx::BufferCreateInfo info{};
+      info.size = static_cast<u64>(m_instanceBufferCapacity) * kInstanceStride;
+      info.usage = gfx::BufferUsage::Vertex | gfx::BufferUsage::Dynamic;
+      info.debugName = "GeometryInstanceBuffer";
+      m_instanceBuffer = device.createBuffer(info);
+      instancesChanged = true;
+    }
+
+    if (instancesChanged) {
+      device.updateBuffer(m_instanceBuffer, 0, allMatrices.data(), totalSize);
+    }
+  }
+
+  // Materials stage their parameters and textures here, so binding them
+  // while recording only encodes
+  for (auto& [material, id] : m_materialIds) {
+    material->prepareBind();
+  }
+}
+
+void
+GeometryPass::Record(ECSManager& /* eManager */)
+{
+  auto& resources = gfx::RenderResources::getInstance();
+  auto& device = gfx::GraphicsDevice::getInstance();
+
   // Get command buffer for this pass
   gfx::CommandBuffer* cmd = getCommandBuffer();
   if (cmd == nullptr) {
@@ -258,98 +299,33 @@ GeometryPass::Record(ECSManager& eManager)
   viewport.maxDepth = 1.0f;
   cmd->setViewport(viewport);
 
-  // Phase 1: Sort entities into instance groups vs non-instanced (skinned)
-  std::vector<Entity> entityView = eManager.view<GraphicsComponent>();
-
-  std::unordered_map<InstanceKey, std::vector<glm::mat4>, InstanceKeyHash>
-    instanceGroups;
-  std::vector<Entity> skinnedEntities;
-
-  for (auto entity : entityView) {
-    auto* posComp = eManager.getComponent<PositionComponent>(entity);
-    auto* gfxComp = eManager.getComponent<GraphicsComponent>(entity);
-    auto* obj = gfxComp->m_grapObj.get();
-
-    glm::mat4 entityModel =
-      posComp ? glm::translate(glm::mat4(1.0f), posComp->position) *
-                  glm::mat4_cast(posComp->rotation) *
-                  glm::scale(glm::mat4(1.0f), posComp->scale)
-              : glm::identity<glm::mat4>();
-
-    // Check if any node has skinning
-    bool hasSkin = false;
-    for (u32 idx = 0; idx < obj->p_numNodes; idx++) {
-      if (obj->p_nodes[idx].skin >= 0) {
-        hasSkin = true;
-        break;
-      }
-    }
-
-    if (hasSkin) {
-      skinnedEntities.push_back(entity);
-    } else {
-      // Group by (obj, node, primitive) for instancing
-      for (u32 nodeIdx = 0; nodeIdx < obj->p_numNodes; nodeIdx++) {
-        if (obj->p_nodes[nodeIdx].mesh < 0) {
-          continue;
-        }
-        glm::mat4 nodeModel = entityModel * obj->getMatrix(nodeIdx);
-        Mesh& mesh = obj->p_meshes[obj->p_nodes[nodeIdx].mesh];
-        for (u32 primIdx = 0; primIdx < mesh.numPrims; primIdx++) {
-          instanceGroups[{ obj, nodeIdx, primIdx }].push_back(nodeModel);
-        }
-      }
-    }
-  }
-
-  // Phase 2: Build contiguous matrix buffer and draw groups
-  static thread_local std::vector<glm::mat4> allMatrices;
-  static thread_local std::vector<DrawGroup> drawGroups;
-  allMatrices.clear();
-  drawGroups.clear();
-
-  for (auto& [key, matrices] : instanceGroups) {
-    drawGroups.push_back({ key,
-                           static_cast<u32>(allMatrices.size()),
-                           static_cast<u32>(matrices.size()) });
-    allMatrices.insert(allMatrices.end(), matrices.begin(), matrices.end());
-  }
-
-  // Upload all instance matrices
-  if (!allMatrices.empty()) {
-    auto totalSize = static_cast<u32>(allMatrices.size()) * kInstanceStride;
-
-    // Resize buffer if needed
-    if (static_cast<u32>(allMatrices.size()) > m_instanceBufferCapacity) {
-      device.destroyBuffer(m_instanceBuffer);
-      m_instanceBufferCapacity = static_cast<u32>(allMatrices.size()) * 2;
-      gfx::BufferCreateInfo info{};
-      info.size = static_cast<u64>(m_instanceBufferCapacity) * kInstanceStride;
-      info.usage = gfx::BufferUsage::Vertex | gfx::BufferUsage::Dynamic;
-      info.debugName = "GeometryInstanceBuffer";
-      m_instanceBuffer = device.createBuffer(info);
-    }
-
-    device.updateBuffer(m_instanceBuffer, 0, allMatrices.data(), totalSize);
-  }
-
-  // Phase 3: Issue instanced draw calls
+  // Phase 3: Issue instanced draw calls in sort-key order, binding material
+  // and geometry only when they differ from the previous draw
   cmd->setUniform(m_isSkinnedLoc, 0);
 
-  for (auto& group : drawGroups) {
-    auto* obj = group.key.obj;
-    Mesh& mesh = obj->p_meshes[obj->p_nodes[group.key.nodeIdx].mesh];
-    Primitive& prim = mesh.m_primitives[group.key.primIdx];
+  const Material* boundMaterial = nullptr;
+  gfx::VertexArrayId boundVao{};
+  gfx::BufferId boundVbo{};
+  for (const auto& item : m_drawOrder) {
+    const auto& group = m_visibleGroups[item.index];
+    auto* obj = group.obj;
+    Mesh& mesh = obj->p_meshes[obj->p_nodes[group.nodeIdx].mesh];
+    Primitive& prim = mesh.m_primitives[group.primIdx];
 
     // Bind material
-    Material* mat = prim.m_material > -1 ? &obj->p_materials[prim.m_material]
-                                         : &obj->defaultMat;
-    mat->recordBind(*cmd, m_sampler);
+    if (group.material != boundMaterial) {
+      group.material->recordBind(*cmd, m_sampler);
+      boundMaterial = group.material;
+    }
 
     // Bind per-primitive VAO (handles binding 0 with correct stride/offsets).
     // Binding 1 (instance data) falls through to the pipeline's vertex layout.
-    cmd->bindVertexArray(prim.m_vaoId);
-    cmd->bindVertexBuffer(0, prim.m_vboId);
+    if (!(prim.m_vaoId == boundVao && prim.m_vboId == boundVbo)) {
+      cmd->bindVertexArray(prim.m_vaoId);
+      cmd->bindVertexBuffer(0, prim.m_vboId);
+      boundVao = prim.m_vaoId;
+      boundVbo = prim.m_vboId;
+    }
     cmd->bindVertexBuffer(
       1, m_instanceBuffer, static_cast<u64>(group.offset) * kInstanceStride);
 
@@ -361,19 +337,12 @@ GeometryPass::Record(ECSManager& eManager)
     }
   }
 
-  // Phase 4: Draw skinned entities (1-instance draws via instance buffer)
-  for (auto entity : skinnedEntities) {
-    auto* posComp = eManager.getComponent<PositionComponent>(entity);
-    auto* gfxComp = eManager.getComponent<GraphicsComponent>(entity);
-
-    glm::mat4 entityModel =
-      posComp ? glm::translate(glm::mat4(1.0f), posComp->position) *
-                  glm::mat4_cast(posComp->rotation) *
-                  glm::scale(glm::mat4(1.0f), posComp->scale)
-              : glm::identity<glm::mat4>();
-
-    gfxComp->m_grapObj->recordDraw(
-      *cmd, m_sampler, entityModel, m_singleInstanceBuffer, m_isSkinnedLoc);
+  // Phase 4: Draw skinned entities (1-instance draws, streamed per node)
+  for (const auto& skinned : m_instances->skinnedDraws()) {
+    skinned.obj->recordDraw(*cmd,
+                            m_sampler,
+                            m_instances->skinnedInstances(skinned),
+                            m_isSkinnedLoc);
   }
 
   cmd->endRenderPass();
@@ -383,6 +352,46 @@ GeometryPass::Record(ECSManager& eManager)
 #endif
 }
 
+void
+GeometryPass::sortDraws(const glm::mat4& view)
+{
+  m_drawOrder.clear();
+  m_materialIds.clear();
+  for (u32 i = 0; i < m_visibleGroups.size(); ++i) {
+    const auto& group = m_visibleGroups[i];
+    auto* obj = group.obj;
+    const Primitive& prim = obj->p_meshes[obj->p_nodes[group.nodeIdx].mesh]
+                              .m_primitives[group.primIdx];
+    bool blend = group.alphaMode == Material::AlphaMode::Blend;
+
+    // View depth of the group's nearest instance, or its farthest when
+    // blended, from the instance origins
+    float depth = blend ? 0.0f : std::numeric_limits<float>::max();
+    for (u32 k = group.offset; k < group.offset + group.count; ++k) {
+      const glm::vec4& origin = m_visibleMatrices[k][3];
+      float d = -(view[0][2] * origin.x + view[1][2] * origin.y +
+                  view[2][2] * origin.z + view[3][2]);
+      depth = blend ? std::max(depth, d) : std::min(depth, d);
+    }
+
+    // Materials get dense ids in first-seen order; the mesh id is the VAO
+    // slot, which may alias past 16 bits but only costs a rebind if it does
+    auto [it, added] = m_materialIds.try_emplace(
+      group.material, static_cast<u32>(m_materialIds.size()));
+    u64 key = DrawSort::makeKey(
+      blend ? DrawSort::Layer::Blend : DrawSort::Layer::Opaque,
+      m_pipeline.index(),
+      it->second,
+      prim.m_vaoId.index(),
+      depth);
+    m_drawOrder.push_back({ key, i });
+  }
+
+  m_unsortedChanges = DrawSort::countStateChanges(m_drawOrder);
+  DrawSort::sort(m_drawOrder, m_sortScratch);
+  m_stateChanges = DrawSort::countStateChanges(m_drawOrder);
+}
+
 void
 GeometryPass::setViewport(u32 w, u32 h)
 {
@@ -390,29 +399,38 @@ GeometryPass::setViewport(u32 w, u32 h)
   m_height = h;
 
   auto& resources = gfx::RenderResources::getInstance();
+  bool compact = m_layout == GBufferLayout::kCompact;
 
-  // Recreate G-buffer textures with new size
+  // G-buffer textures come from the FrameGraph at the new size. The compact
+  // layout's depth is one of them, leaving the renderbuffer unused.
   if (m_useNewResources) {
-    resources.recreateTexture2D("gPositionAo", m_width, m_height);
-    resources.recreateTexture2D("gNormalMetal", m_width, m_height);
-    resources.recreateTexture2D("gAlbedoSpecRough", m_width, m_height);
-    resources.recreateTexture2D("gEmissive", m_width, m_height);
-    resources.resizeRenderbuffer("gBufferDepth", m_width, m_height);
+    resources.resizeRenderbuffer(
+      "gBufferDepth", compact ? 1 : m_width, compact ? 1 : m_height);
   }
 
-  // Attach G-buffer textures to FBO
-  resources.setFramebufferAttachment("gBuffer", 0, "gPositionAo");
-  resources.setFramebufferAttachment("gBuffer", 1, "gNormalMetal");
-  resources.setFramebufferAttachment("gBuffer", 2, "gAlbedoSpecRough");
-  resources.setFramebufferAttachment("gBuffer", 3, "gEmissive");
+  // Attach G-buffer textures to FBO, in pbrMesh.frag's output order
+  constexpr std::array<const char*, 4> kFullTargets = {
+    "gPositionAo", "gNormalMetal", "gAlbedoSpecRough", "gEmissive"
+  };
+  constexpr std::array<const char*, 4> kCompactTargets = {
+    "gNormalRough", "gAlbedoMetal", "gOcclusion", "gEmissive"
+  };
+  const auto& targets = compact ? kCompactTargets : kFullTargets;
+  for (u32 i = 0; i < targets.size(); ++i) {
+    resources.setFramebufferAttachment("gBuffer", i, targets[i]);
+  }
 
   // Set draw buffers
   std::array<u32, 4> drawBuffers = { 0, 1, 2, 3 };
   resources.setDrawBuffers("gBuffer", drawBuffers);
 
-  // Attach depth-stencil renderbuffer
-  resources.setFramebufferRenderbuffer(
-    "gBuffer", gfx::RenderbufferAttachment::DepthStencil, "gBufferDepth");
+  // Attach depth-stencil
+  if (compact) {
+    resources.setFramebufferDepthAttachment("gBuffer", "gBufferDepth");
+  } else {
+    resources.setFramebufferRenderbuffer(
+      "gBuffer", gfx::RenderbufferAttachment::DepthStencil, "gBufferDepth");
+  }
 
   // Check framebuffer completeness
   if (!resources.isFramebufferComplete("gBuffer")) {
@@ -1,30 +1,73 @@
 #ifndef GEOMETRYPASS_H_
 #define GEOMETRYPASS_H_
+#include "RenderPasses/DrawSort.hpp"
+#include "RenderPasses/InstanceBatcher.hpp"
 #include "RenderPasses/RenderPass.hpp"
 #include <Graphics/Handle.hpp>
+#include <array>
+#include <optional>
+#include <unordered_map>
 
 class GeometryPass final : public RenderPass
 {
 public:
   GeometryPass();
   ~GeometryPass() override = default;
+  void Prepare(ECSManager& eManager) override;
   void Record(ECSManager& eManager) override;
+  void Setup(RenderGraph::Builder& builder) override;
   void setViewport(u32 w, u32 h) override;
   void Init(FrameGraph& fGraph) override;
 
+  // State changes between the instanced draws as recorded, and as they would
+  // have been in the order the batches came in. Updated when the visible set
+  // is re-sorted.
+  [[nodiscard]] const DrawSort::StateChanges& getStateChanges() const
+  {
+    return m_stateChanges;
+  }
+  [[nodiscard]] const DrawSort::StateChanges& getUnsortedStateChanges() const
+  {
+    return m_unsortedChanges;
+  }
+
 private:
+  // Orders m_visibleGroups by DrawSort key into m_drawOrder
+  void sortDraws(const glm::mat4& view);
+
+  // Shader program, pipeline and skinning uniform for one GBufferLayout
+  struct Variant
+  {
+    std::string shaderName;
+    gfx::PipelineId pipeline;
+    i32 isSkinnedLoc{ -1 };
+  };
+
   gfx::SamplerId m_sampler{};
+  FrameGraph* m_frameGraph{ nullptr };
+  std::array<Variant, static_cast<size_t>(GBufferLayout::kNumLayouts)>
+    m_variants;
+  // The variant Setup() picked; m_shaderName follows it
+  GBufferLayout m_layout{ GBufferLayout::kFull };
   gfx::PipelineId m_pipeline{};
   i32 m_isSkinnedLoc{ -1 };
 
-  // Instanced rendering (batched non-skinned entities)
+  // Instanced rendering (batched non-skinned entities). The batches are
+  // FrameGraph's; the camera-visible part is kept until the batches or the
+  // frustum change.
+  InstanceBatcher* m_instances{ nullptr };
+  u32 m_culledVersion{ 0 };
+  std::optional<Frustum> m_culledFrustum;
+  std::vector<glm::mat4> m_visibleMatrices;
+  std::vector<InstanceBatcher::DrawGroup> m_visibleGroups;
+  std::vector<DrawSort::Item> m_drawOrder; // Indices into m_visibleGroups
+  std::vector<DrawSort::Item> m_sortScratch;
+  std::unordered_map<Material*, u32> m_materialIds; // Visible materials
+  DrawSort::StateChanges m_stateChanges;
+  DrawSort::StateChanges m_unsortedChanges;
   gfx::BufferId m_instanceBuffer{};
   u32 m_instanceBufferCapacity{ 0 };
   static constexpr u32 kInitialInstanceCapacity = 256;
-
-  // Single-instance buffer for skinned entity draws (separate to avoid
-  // overwriting batched data before command buffer execution)
-  gfx::BufferId m_singleInstanceBuffer{};
 };
 
 #endif // GEOMETRYPASS_H_
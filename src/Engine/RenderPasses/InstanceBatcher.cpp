@@ -0,0 +1,352 @@
+#include "InstanceBatcher.hpp"
+#include "ECS/Components/GraphicsComponent.hpp"
+#include "ECS/Components/PositionComponent.hpp"
+#include <ECS/ECSManager.hpp>
+#include <ECS/Systems/PositionSystem.hpp>
+#include <ECS/Systems/SpatialSystem.hpp>
+#include <unordered_map>
+
+namespace {
+
+// Extents given to primitives without bounds, so they are never culled
+constexpr float kUnbounded = 1e30f;
+
+// Writes the world bounds of a model-space box to element `k` of
+// Frustum::BoundsStream streams
+void
+writeBounds(float* const* streams,
+            size_t k,
+            const Aabb& local,
+            const glm::mat4& model)
+{
+  glm::vec3 center(0.0f);
+  glm::vec3 extents(kUnbounded);
+  if (!local.isEmpty()) {
+    Aabb world = local.transformed(model);
+    center = world.center();
+    extents = world.extents();
+  }
+  streams[Frustum::CenterX][k] = center.x;
+  streams[Frustum::CenterY][k] = center.y;
+  streams[Frustum::CenterZ][k] = center.z;
+  streams[Frustum::ExtentX][k] = extents.x;
+  streams[Frustum::ExtentY][k] = extents.y;
+  streams[Frustum::ExtentZ][k] = extents.z;
+}
+
+} // namespace
+
+size_t
+InstanceBatcher::InstanceKeyHash::operator()(const InstanceKey& key) const
+{
+  auto h1 = std::hash<void*>{}(key.obj);
+  auto h2 = std::hash<u32>{}(key.nodeIdx);
+  auto h3 = std::hash<u32>{}(key.primIdx);
+  return h1 ^ (h2 << 16) ^ (h3 << 32);
+}
+
+bool
+InstanceBatcher::update(ECSManager& ecs)
+{
+  // Position and Graphics are co-sorted by the owning group, so positioned
+  // entities are the leading Graphics slots; the rest use identity
+  auto renderables = ecs.group<PositionComponent, GraphicsComponent>();
+  auto& graphics = renderables.pool<GraphicsComponent>();
+  // World matrices come from PositionSystem, indexed like the Position pool;
+  // its change stamps also cover children moved by a parent
+  auto& transforms = PositionSystem::getInstance();
+
+  u32 since = m_seenTick;
+  m_seenTick = ecs.getChangeTick();
+
+  // Added/removed entities shift slots, so regroup on any size change
+  bool rebuild = m_slots.size() != graphics.size() ||
+                 m_positioned != renderables.size();
+  bool skinnedChanged = false;
+  m_slots.resize(graphics.size());
+  m_positioned = renderables.size();
+  m_movedSlots.clear();
+
+  for (size_t i = 0; i < graphics.size(); ++i) {
+    Slot& slot = m_slots[i];
+    bool positioned = i < m_positioned;
+    if (slot.entity == graphics.entityAt(i) &&
+        !graphics.changedSince(i, since) &&
+        !(positioned && transforms.worldChangedSince(i, since))) {
+      continue;
+    }
+
+    // A different entity or a changed GraphicsComponent changes the proxy
+    // set; only a new world matrix just moves the slot's proxies
+    GraphicsObject* obj = graphics[i].m_grapObj.get();
+    bool replaced = slot.entity != graphics.entityAt(i) || slot.obj != obj ||
+                    graphics.changedSince(i, since);
+    bool skinned = replaced ? obj->hasSkin() : slot.skinned;
+    slot.entity = graphics.entityAt(i);
+    slot.model = positioned ? transforms.getWorldMatrix(i)
+                            : glm::identity<glm::mat4>();
+    if (skinned || slot.skinned) {
+      // Skinned entities are drawn one by one, so only their list needs a
+      // refresh unless one turned into a batched entity or back
+      rebuild |= !skinned || !slot.skinned;
+      skinnedChanged = true;
+    } else if (replaced) {
+      rebuild = true;
+    } else {
+      m_movedSlots.push_back(static_cast<u32>(i));
+    }
+    slot.obj = obj;
+    slot.skinned = skinned;
+  }
+
+  // Batched slots cull() cannot reach through the scene BVH: unpositioned,
+  // without bounds, or not yet indexed by SpatialSystem
+  auto& spatial = SpatialSystem::getInstance();
+  m_graphics = &graphics;
+  m_unindexedSlots.clear();
+  for (size_t i = 0; i < m_slots.size(); ++i) {
+    const Slot& slot = m_slots[i];
+    if (!slot.skinned &&
+        (i >= m_positioned || !spatial.indexes(i, slot.entity))) {
+      m_unindexedSlots.push_back(static_cast<u32>(i));
+    }
+  }
+
+  if (rebuild) {
+    rebuildBatches();
+  } else {
+    for (u32 i : m_movedSlots) {
+      writeInstances(m_slots[i]);
+    }
+    if (skinnedChanged) {
+      rebuildSkinned();
+    }
+  }
+
+  if (!rebuild && m_movedSlots.empty()) {
+    return false;
+  }
+  m_version++;
+  return true;
+}
+
+void
+InstanceBatcher::rebuildBatches()
+{
+  // First pass: find each proxy's draw group, recording the group index in
+  // place of the instance index, and count the instances per group
+  m_groupIndex.clear();
+  m_allGroups.clear();
+  m_slotInstances.clear();
+  for (Slot& slot : m_slots) {
+    slot.firstInstance = static_cast<u32>(m_slotInstances.size());
+    slot.instanceCount = 0;
+    if (slot.skinned) {
+      continue;
+    }
+    GraphicsObject* obj = slot.obj;
+    for (u32 nodeIdx = 0; nodeIdx < obj->p_numNodes; nodeIdx++) {
+      if (obj->p_nodes[nodeIdx].mesh < 0) {
+        continue;
+      }
+      Mesh& mesh = obj->p_meshes[obj->p_nodes[nodeIdx].mesh];
+      for (u32 primIdx = 0; primIdx < mesh.numPrims; primIdx++) {
+        auto [it, added] = m_groupIndex.try_emplace(
+          { obj, nodeIdx, primIdx }, static_cast<u32>(m_allGroups.size()));
+        if (added) {
+          const Primitive& prim = mesh.m_primitives[primIdx];
+          Material* mat = prim.m_material > -1
+                            ? &obj->p_materials[prim.m_material]
+                            : &obj->defaultMat;
+          m_allGroups.push_back(
+            { obj, nodeIdx, primIdx, mat, mat->m_alphaMode, 0, 0 });
+        }
+        m_allGroups[it->second].count++;
+        m_slotInstances.push_back(it->second);
+        slot.instanceCount++;
+      }
+    }
+  }
+
+  // Contiguous matrix buffer, one range per draw group; count is reused as
+  // the fill cursor below
+  u32 total = 0;
+  for (DrawGroup& group : m_allGroups) {
+    group.offset = total;
+    total += group.count;
+    group.count = 0;
+  }
+  m_allMatrices.resize(total);
+  for (size_t s = 0; s < Frustum::BoundsStreamCount; ++s) {
+    m_bounds[s].reserve(total, 0);
+  }
+
+  // Second pass: assign instance indices and write the proxies
+  for (const Slot& slot : m_slots) {
+    for (u32 k = 0; k < slot.instanceCount; ++k) {
+      u32& instance = m_slotInstances[slot.firstInstance + k];
+      DrawGroup& group = m_allGroups[instance];
+      instance = group.offset + group.count++;
+    }
+    if (!slot.skinned) {
+      writeInstances(slot);
+    }
+  }
+
+  rebuildSkinned();
+}
+
+void
+InstanceBatcher::writeInstances(const Slot& slot)
+{
+  std::array<float*, Frustum::BoundsStreamCount> streams;
+  for (size_t s = 0; s < Frustum::BoundsStreamCount; ++s) {
+    streams[s] = m_bounds[s].data();
+  }
+
+  GraphicsObject* obj = slot.obj;
+  const u32* instance = m_slotInstances.data() + slot.firstInstance;
+  for (u32 nodeIdx = 0; nodeIdx < obj->p_numNodes; nodeIdx++) {
+    if (obj->p_nodes[nodeIdx].mesh < 0) {
+      continue;
+    }
+    glm::mat4 nodeModel = slot.model * obj->getMatrix(nodeIdx);
+    Mesh& mesh = obj->p_meshes[obj->p_nodes[nodeIdx].mesh];
+    for (u32 primIdx = 0; primIdx < mesh.numPrims; primIdx++) {
+      u32 k = *instance++;
+      m_allMatrices[k] = nodeModel;
+
+      writeBounds(
+        streams.data(), k, mesh.m_primitives[primIdx].m_bounds, nodeModel);
+    }
+  }
+}
+
+void
+InstanceBatcher::cull(const Frustum& frustum,
+                      std::vector<glm::mat4>& matrices,
+                      std::vector<DrawGroup>& groups,
+                      float minRadius)
+{
+  // Entities are found through the scene BVH, so whole subtrees outside the
+  // frustum are skipped; only the instances of the hits are tested
+  m_visible.assign(m_allMatrices.size(), 0);
+  float minRadiusSq = minRadius * minRadius;
+  SpatialSystem::getInstance().getTree().query(frustum, [&](u32 entity) {
+    size_t i = m_graphics->indexOf(entity);
+    if (i < m_positioned && !m_slots[i].skinned) {
+      cullSlot(frustum, m_slots[i], minRadiusSq);
+    }
+  });
+  for (u32 i : m_unindexedSlots) {
+    cullSlot(frustum, m_slots[i], minRadiusSq);
+  }
+
+  // Compact each group down to its visible instances, dropping empty ones
+  for (const DrawGroup& group : m_allGroups) {
+    DrawGroup visible = group;
+    visible.offset = static_cast<u32>(matrices.size());
+    visible.count = 0;
+    for (u32 k = group.offset; k < group.offset + group.count; ++k) {
+      if (m_visible[k]) {
+        matrices.push_back(m_allMatrices[k]);
+        visible.count++;
+      }
+    }
+    if (visible.count > 0) {
+      groups.push_back(visible);
+    }
+  }
+}
+
+void
+InstanceBatcher::cullSlot(const Frustum& frustum,
+                          const Slot& slot,
+                          float minRadiusSq)
+{
+  const u32* instance = m_slotInstances.data() + slot.firstInstance;
+  for (u32 n = 0; n < slot.instanceCount; ++n) {
+    u32 k = instance[n];
+    glm::vec3 center(m_bounds[Frustum::CenterX].data()[k],
+                     m_bounds[Frustum::CenterY].data()[k],
+                     m_bounds[Frustum::CenterZ].data()[k]);
+    glm::vec3 extents(m_bounds[Frustum::ExtentX].data()[k],
+                      m_bounds[Frustum::ExtentY].data()[k],
+                      m_bounds[Frustum::ExtentZ].data()[k]);
+    if (glm::dot(extents, extents) >= minRadiusSq &&
+        frustum.intersects(Aabb{ center - extents, center + extents })) {
+      m_visible[k] = 1;
+    }
+  }
+}
+
+void
+InstanceBatcher::cullSkinned(const Frustum& frustum,
+                             std::vector<u32>& draws,
+                             float minRadius)
+{
+  cullBounds(frustum, m_skinnedBounds, m_skinnedDraws.size(), minRadius);
+  for (u32 k = 0; k < m_skinnedDraws.size(); ++k) {
+    if (m_visible[k]) {
+      draws.push_back(k);
+    }
+  }
+}
+
+void
+InstanceBatcher::cullBounds(
+  const Frustum& frustum,
+  const std::array<AlignedStream, Frustum::BoundsStreamCount>& bounds,
+  size_t count,
+  float minRadius)
+{
+  m_visible.resize(count);
+  std::array<const float*, Frustum::BoundsStreamCount> streams;
+  for (size_t s = 0; s < Frustum::BoundsStreamCount; ++s) {
+    streams[s] = bounds[s].data();
+  }
+  frustum.cull(streams.data(), count, m_visible.data());
+
+  if (minRadius > 0.0f) {
+    float minRadiusSq = minRadius * minRadius;
+    for (size_t k = 0; k < count; ++k) {
+      float ex = streams[Frustum::ExtentX][k];
+      float ey = streams[Frustum::ExtentY][k];
+      float ez = streams[Frustum::ExtentZ][k];
+      if (ex * ex + ey * ey + ez * ez < minRadiusSq) {
+        m_visible[k] = 0;
+      }
+    }
+  }
+}
+
+void
+InstanceBatcher::rebuildSkinned()
+{
+  m_skinnedDraws.clear();
+  for (const Slot& slot : m_slots) {
+    if (slot.skinned) {
+      m_skinnedDraws.push_back({ slot.obj, slot.model });
+    }
+  }
+}
+
+void
+InstanceBatcher::prepareSkinned()
+{
+  m_skinnedInstances.clear();
+  std::array<float*, Frustum::BoundsStreamCount> streams;
+  for (size_t s = 0; s < Frustum::BoundsStreamCount; ++s) {
+    m_skinnedBounds[s].reserve(m_skinnedDraws.size(), 0);
+    streams[s] = m_skinnedBounds[s].data();
+  }
+  for (size_t k = 0; k < m_skinnedDraws.size(); ++k) {
+    SkinnedDraw& draw = m_skinnedDraws[k];
+    draw.firstInstance = static_cast<u32>(m_skinnedInstances.size());
+    draw.obj->prepareDraw(draw.model, m_skinnedInstances);
+    draw.instanceCount =
+      static_cast<u32>(m_skinnedInstances.size()) - draw.firstInstance;
+    // After prepareDraw(), which leaves the joint matrices cached
+    writeBounds(streams.data(), k, draw.obj->getPoseBounds(), draw.model);
+  }
+}
@@ -0,0 +1,168 @@
+#ifndef INSTANCEBATCHER_H_
+#define INSTANCEBATCHER_H_
+
+#include <ECS/ComponentPool.hpp>
+#include <ECS/SoALayout.hpp>
+#include <Graphics/Resources/Buffer.hpp>
+#include <Rendering/Frustum.hpp>
+#include <Rendering/Material.hpp>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class ECSManager;
+class GraphicsObject;
+struct GraphicsComponent;
+
+// Render-world extraction shared by every pass that draws the scene. Keeps a
+// persistent render proxy for each (object, node, primitive) of every
+// GraphicsComponent entity, grouped into instanced draw batches with their
+// world bounds, plus per-object flags (skin, alpha mode) resolved once.
+// FrameGraph updates it once per frame; each pass then culls the batches
+// against its own views with cull(), which walks SpatialSystem's BVH.
+//
+// Only entities whose world matrix or GraphicsComponent changed since the
+// last update() are revisited. A moved entity has its instances rewritten in
+// place; the batches are only regrouped when entities are added, removed or
+// change object, so static content costs nothing to extract.
+class InstanceBatcher
+{
+public:
+  // Instances sharing one primitive of one node of one object
+  struct DrawGroup
+  {
+    GraphicsObject* obj;
+    u32 nodeIdx;
+    u32 primIdx;
+    Material* material; // The primitive's material or the object's default
+    Material::AlphaMode alphaMode;
+    u32 offset; // Index into matrices()
+    u32 count;  // Number of instances
+  };
+
+  // Skinned entity, drawn individually
+  struct SkinnedDraw
+  {
+    GraphicsObject* obj;
+    glm::mat4 model;
+    u32 firstInstance{ 0 }; // Range of streamed node matrices, see
+    u32 instanceCount{ 0 }; // prepareSkinned()
+  };
+
+  // Refreshes from the Position+Graphics group. Returns true if matrices()
+  // or drawGroups() changed since the previous call.
+  bool update(ECSManager& ecs);
+
+  // Bumped by every update() that changed matrices() or drawGroups(), so
+  // passes can tell whether their culled copy is stale
+  [[nodiscard]] u32 version() const { return m_version; }
+
+  // Every batched instance, before culling
+  [[nodiscard]] const std::vector<glm::mat4>& matrices() const
+  {
+    return m_allMatrices;
+  }
+  [[nodiscard]] const std::vector<DrawGroup>& drawGroups() const
+  {
+    return m_allGroups;
+  }
+  // Skinned draws are culled one by one with cullSkinned(), their bounds
+  // move with the animation
+  [[nodiscard]] const std::vector<SkinnedDraw>& skinnedDraws() const
+  {
+    return m_skinnedDraws;
+  }
+  // Streams the node matrices and joints of every skinned draw through
+  // GraphicsObject::prepareDraw() and bounds its current pose. Main thread,
+  // once per frame after update() and before any pass culls or records
+  // skinned draws.
+  void prepareSkinned();
+  // The node ranges prepareSkinned() streamed for `draw`
+  [[nodiscard]] std::span<const gfx::StreamAllocation> skinnedInstances(
+    const SkinnedDraw& draw) const
+  {
+    return { m_skinnedInstances.data() + draw.firstInstance,
+             draw.instanceCount };
+  }
+  [[nodiscard]] size_t totalInstances() const { return m_allMatrices.size(); }
+
+  // Appends the batched instances whose bounds touch `frustum` to `matrices`
+  // and a group for each non-empty draw group to `groups`, with offsets into
+  // `matrices`. Instances with a bounding radius under `minRadius` are left
+  // out as well. Lets one batcher feed several views, e.g. shadow cascades.
+  void cull(const Frustum& frustum,
+            std::vector<glm::mat4>& matrices,
+            std::vector<DrawGroup>& groups,
+            float minRadius = 0.0f);
+  // Appends the index into skinnedDraws() of every skinned draw whose pose
+  // bounds from prepareSkinned() pass the same tests as cull()'s
+  void cullSkinned(const Frustum& frustum,
+                   std::vector<u32>& draws,
+                   float minRadius = 0.0f);
+
+private:
+  // Cached state for one GraphicsComponent pool slot
+  struct Slot
+  {
+    Entity entity{ 0 };
+    GraphicsObject* obj{ nullptr };
+    glm::mat4 model{ 1.0f };
+    bool skinned{ false };
+    u32 firstInstance{ 0 }; // Range of m_slotInstances holding its proxies
+    u32 instanceCount{ 0 };
+  };
+
+  struct InstanceKey
+  {
+    GraphicsObject* obj;
+    u32 nodeIdx;
+    u32 primIdx;
+
+    bool operator==(const InstanceKey&) const = default;
+  };
+  struct InstanceKeyHash
+  {
+    size_t operator()(const InstanceKey& key) const;
+  };
+
+  void rebuildBatches();
+  void rebuildSkinned();
+  // Rewrites the matrices and bounds of one slot's proxies in place
+  void writeInstances(const Slot& slot);
+  // Marks the visible instances of one batched slot in m_visible
+  void cullSlot(const Frustum& frustum, const Slot& slot, float minRadiusSq);
+  // Tests `count` boxes given as Frustum::BoundsStream streams, leaving the
+  // result in m_visible
+  void cullBounds(const Frustum& frustum,
+                  const std::array<AlignedStream, Frustum::BoundsStreamCount>&
+                    bounds,
+                  size_t count,
+                  float minRadius);
+
+  std::vector<Slot> m_slots; // Same order as the GraphicsComponent pool
+  size_t m_positioned{ 0 };  // Leading slots that have a PositionComponent
+  u32 m_seenTick{ 0 };       // Change tick of the last update()
+  u32 m_version{ 0 };
+
+  // Index into m_allMatrices of every proxy, slot by slot, in node then
+  // primitive order
+  std::vector<u32> m_slotInstances;
+  std::unordered_map<InstanceKey, u32, InstanceKeyHash> m_groupIndex;
+  std::vector<u32> m_movedSlots;
+  // Graphics pool of the last update(), mapping BVH hits back to slots, and
+  // the batched slots cull() tests directly instead
+  ComponentPool<GraphicsComponent>* m_graphics{ nullptr };
+  std::vector<u32> m_unindexedSlots;
+
+  // Every batched instance, and the world bounds of each as float streams
+  std::vector<glm::mat4> m_allMatrices;
+  std::vector<DrawGroup> m_allGroups;
+  std::array<AlignedStream, Frustum::BoundsStreamCount> m_bounds;
+  std::vector<u8> m_visible;
+  std::vector<SkinnedDraw> m_skinnedDraws;
+  std::vector<gfx::StreamAllocation> m_skinnedInstances;
+  // World bounds of each skinned draw's pose, laid out like m_bounds
+  std::array<AlignedStream, Frustum::BoundsStreamCount> m_skinnedBounds;
+};
+
+#endif // INSTANCEBATCHER_H_
@@ -1,47 +1,36 @@
 #include "LightPass.hpp"
+#include <ECS/Components/CameraComponent.hpp>
 #include <ECS/Components/LightingComponent.hpp>
 #include <ECS/ECSManager.hpp>
+#include <ECS/Systems/CameraSystem.hpp>
 #include <Graphics/GraphicsDevice.hpp>
 #include <Graphics/Resources/Pipeline.hpp>
 #include <Graphics/UBOStructs.hpp>
+#include <RenderPasses/FrameGraph.hpp>
 #include <array>
 
+namespace {
+
+constexpr const char* kVertexShader = "resources/Shaders/light.vert";
+constexpr const char* kFragmentShader = "resources/Shaders/pbrLight.frag";
+// pbrLight.frag reads the GBufferLayout::kCompact targets with this defined
+constexpr std::string_view kCompactDefines[] = { "COMPACT_GBUFFER" };
+
+} // namespace
+
 LightPass::LightPass()
-  : RenderPass("LightPass",
-               "resources/Shaders/light.vert",
-               "resources/Shaders/pbrLight.frag")
+  : RenderPass("LightPass", kVertexShader, kFragmentShader)
 {
   auto& resources = gfx::RenderResources::getInstance();
   auto& device = gfx::GraphicsDevice::getInstance();
 
-  useShader();
-  gfx::ShaderId shader = getShaderId();
-
-  // Bind UBO blocks
-  resources.bindShaderUniformBlock(
-    shader, "CascadeData", gfx::UBOBinding::CascadeData);
-  resources.bindShaderUniformBlock(
-    shader, "CameraData", gfx::UBOBinding::Camera);
-  resources.bindShaderUniformBlock(
-    shader, "LightingData", gfx::UBOBinding::Lighting);
-
-  // Set sampler uniform locations to match texture binding order.
-  // Textures are populated by addTexture() calls from other passes' Init()
-  // methods: CubeMapPass::Init: irradianceMap(0), prefilterMap(1), brdfLUT(2)
-  // ShadowPass::Init: depthMapArray(3)
-  // GeometryPass::Init: gPositionAo(4), gNormalMetal(5), gAlbedoSpecRough(6),
-  // gEmissive(7)
-  //
-  // Each sampler uniform must be set to the texture unit it will be bound to.
-  device.setUniformInt(device.getUniformLocation(shader, "irradianceMap"), 0);
-  device.setUniformInt(device.getUniformLocation(shader, "prefilterMap"), 1);
-  device.setUniformInt(device.getUniformLocation(shader, "brdfLUT"), 2);
-  device.setUniformInt(device.getUniformLocation(shader, "depthMapArray"), 3);
-  device.setUniformInt(device.getUniformLocation(shader, "gPositionAo"), 4);
-  device.setUniformInt(device.getUniformLocation(shader, "gNormalMetal"), 5);
-  device.setUniformInt(device.getUniformLocation(shader, "gAlbedoSpecRough"),
-                       6);
-  device.setUniformInt(device.getUniformLocation(shader, "gEmissive"), 7);
+  // Both layouts' programs are built up front; Setup() picks one
+  auto& full = m_variants[static_cast<size_t>(GBufferLayout::kFull)];
+  auto& compact = m_variants[static_cast<size_t>(GBufferLayout::kCompact)];
+  full.shaderName = m_shaderName;
+  compact.shaderName = m_shaderName + "Compact";
+  resources.loadShaderProgram(
+    compact.shaderName, kVertexShader, kFragmentShader, kCompactDefines);
 
   // Create FBO through new RenderResources system (bare FBO, attachments
   // managed in setViewport)
@@ -55,15 +44,10 @@ LightPass::LightPass()
   rboInfo.debugName = "lightFBODepth";
   resources.createRenderbuffer("lightFBODepth", rboInfo);
 
-  // Create lightFrame texture through new RenderResources system
-  // This is read by CubeMapPass
-  gfx::TextureCreateInfo lightFrameInfo{};
-  lightFrameInfo.width = m_width;
-  lightFrameInfo.height = m_height;
-  lightFrameInfo.format = gfx::PixelFormat::RGBA16F;
-  lightFrameInfo.mipLevels = 1;
-  lightFrameInfo.debugName = "lightFrame";
-  resources.createTexture2D("lightFrame", lightFrameInfo);
+  // Point lights and their clusters, filled every Prepare()
+  resources.createDataTexture("pointLights", gfx::PixelFormat::RGBA32F);
+  resources.createDataTexture("lightClusters", gfx::PixelFormat::RGBA16UI);
+  resources.createDataTexture("lightIndices", gfx::PixelFormat::R16UI);
 
   m_useNewResources = true;
 
@@ -85,7 +69,6 @@ LightPass::LightPass()
   };
 
   gfx::PipelineCreateInfo pipeInfo{};
-  pipeInfo.shaderProgram = getShaderId();
   pipeInfo.vertexBindings = bindings;
   pipeInfo.vertexAttributes = attributes;
   pipeInfo.topology = gfx::PrimitiveTopology::TriangleStrip;
@@ -93,28 +76,87 @@ LightPass::LightPass()
   pipeInfo.depthStencil.depthWriteEnable = false;
   pipeInfo.blend.attachments[0].blendEnable = false;
   pipeInfo.rasterizer.cullMode = gfx::CullMode::None;
-  pipeInfo.debugName = "LightPassPipeline";
-  m_pipeline = resources.createPipeline("LightPassPipeline", pipeInfo);
 
-  setViewport(m_width, m_height);
+  for (size_t layout = 0; layout < m_variants.size(); ++layout) {
+    Variant& variant = m_variants[layout];
+    m_shaderName = variant.shaderName;
+    useShader();
+    gfx::ShaderId shader = getShaderId();
+
+    // Bind UBO blocks
+    resources.bindShaderUniformBlock(
+      shader, "CascadeData", gfx::UBOBinding::CascadeData);
+    resources.bindShaderUniformBlock(
+      shader, "CameraData", gfx::UBOBinding::Camera);
+    resources.bindShaderUniformBlock(
+      shader, "LightingData", gfx::UBOBinding::Lighting);
+
+    // Each sampler uniform is set to the texture unit it is bound to, the
+    // order of the layout's inputs
+    auto layoutInputs = inputs(static_cast<GBufferLayout>(layout));
+    for (size_t unit = 0; unit < layoutInputs.size(); ++unit) {
+      std::string name(layoutInputs[unit]);
+      device.setUniformInt(device.getUniformLocation(shader, name.c_str()),
+                           static_cast<i32>(unit));
+    }
+
+    std::string pipelineName = m_shaderName + "Pipeline";
+    pipeInfo.shaderProgram = shader;
+    pipeInfo.debugName = pipelineName.c_str();
+    variant.pipeline = resources.createPipeline(pipelineName, pipeInfo);
+  }
+  m_shaderName = full.shaderName;
+  m_pipeline = full.pipeline;
+}
+
+void
+LightPass::Init(FrameGraph& fGraph)
+{
+  m_frameGraph = &fGraph;
+}
+
+std::span<const std::string_view>
+LightPass::inputs(GBufferLayout layout)
+{
+  if (layout == GBufferLayout::kCompact) {
+    return kCompactInputs;
+  }
+  return kFullInputs;
+}
+
+void
+LightPass::Setup(RenderGraph::Builder& builder)
+{
+  m_layout = m_frameGraph->getGBufferLayout();
+  const Variant& variant = m_variants[static_cast<size_t>(m_layout)];
+  m_shaderName = variant.shaderName;
+  m_pipeline = variant.pipeline;
+
+  for (std::string_view input : inputs(m_layout)) {
+    builder.read(input);
+  }
+  // Read by CubeMapPass. Lit color needs no alpha and little precision
+  // beyond what R11G11B10F keeps, so the compact layout saves it too.
+  gfx::PixelFormat format = m_layout == GBufferLayout::kCompact
+                              ? gfx::PixelFormat::R11G11B10F
+                              : gfx::PixelFormat::RGBA16F;
+  builder.create("lightFrame", { format, builder.width(), builder.height() });
 }
 
 void
-LightPass::Record(ECSManager& eManager)
+LightPass::Prepare(ECSManager& eManager)
 {
   auto& resources = gfx::RenderResources::getInstance();
 
   // Populate LightingUBO from ECS light components
   gfx::LightingUBO& lightingUBO = resources.getLightingUBO();
 
-  std::vector<Entity> view = eManager.view<LightingComponent>();
-  i32 numPLights = 0;
-  for (auto e : view) {
-    auto* g = eManager.getComponent<LightingComponent>(e);
-
-    switch (g->type) {
+  m_pointLights.clear();
+  eManager.query<LightingComponent>().each([&](Entity /* e */,
+                                               LightingComponent& g) {
+    switch (g.type) {
       case LightingComponent::TYPE::DIRECTIONAL: {
-        auto& light = static_cast<DirectionalLight&>(*g->light);
+        auto& light = static_cast<DirectionalLight&>(*g.light);
 
         lightingUBO.dirLightDirection = glm::vec4(light.direction, 0.0f);
         lightingUBO.dirLightColor = glm::vec4(light.color, light.intensity);
@@ -122,11 +164,11 @@ LightPass::Record(ECSManager& eManager)
         break;
       }
       case LightingComponent::TYPE::POINT: {
-        if (numPLights >= static_cast<i32>(MAX_POINT_LIGHTS)) {
+        if (m_pointLights.size() / 2 >= LightClusters::kMaxLights) {
           break;
         }
 
-        PointLight& light = static_cast<PointLight&>(*g->light);
+        PointLight& light = static_cast<PointLight&>(*g.light);
 
         // Calculate radius for culling
         const float constant = 1.0f;
@@ -139,29 +181,114 @@ LightPass::Record(ECSManager& eManager)
                        (constant - (256.0f / 5.0f) * maxBrightness))) /
           (2.0f * light.quadratic);
 
-        // Populate UBO point light data
-        lightingUBO.pointLights[numPLights].positionRadius =
-          glm::vec4(light.position, radius);
-        lightingUBO.pointLights[numPLights].colorIntensity =
-          glm::vec4(light.color, 0.0f);
-        lightingUBO.pointLights[numPLights].attenuation =
-          glm::vec4(light.constant, light.linear, light.quadratic, 0.0f);
-
-        numPLights++;
+        // Texels of its gfx::PointLightData
+        m_pointLights.push_back(glm::vec4(light.position, radius));
+        m_pointLights.push_back(glm::vec4(light.color, 0.0f));
         break;
       }
       default:
         break;
     }
+  });
+
+  // Without a camera there are no clusters to find lights through
+  i32 numPLights = 0;
+  CameraComponent* camera =
+    CameraSystem::getInstance().getMainCameraComponent();
+  if (camera != nullptr) {
+    numPLights = static_cast<i32>(m_pointLights.size() / 2);
+    uploadPointLights(*camera);
   }
 
   // Set light config (numPointLights, debugView)
   lightingUBO.lightConfig =
     glm::ivec4(numPLights, eManager.getDebugView(), 0, 0);
+  lightingUBO.clusterGrid = glm::ivec4(LightClusters::kTilesX,
+                                       LightClusters::kTilesY,
+                                       LightClusters::kSlices,
+                                       0);
+  lightingUBO.clusterScale =
+    glm::vec4(static_cast<float>(LightClusters::kTilesX) /
+                static_cast<float>(m_width),
+              static_cast<float>(LightClusters::kTilesY) /
+                static_cast<float>(m_height),
+              m_clusters.getSliceScale(),
+              m_clusters.getSliceBias());
 
   // Upload UBO to GPU before CommandBuffer recording
   resources.flushLightingUBO();
 
+  resolveInputs();
+}
+
+void
+LightPass::uploadPointLights(const CameraComponent& camera)
+{
+  auto& resources = gfx::RenderResources::getInstance();
+  u32 numLights = static_cast<u32>(m_pointLights.size() / 2);
+
+  // Bin the lights as view-space spheres
+  for (std::vector<float>& stream : m_lightSpheres) {
+    stream.resize(numLights);
+  }
+  for (u32 i = 0; i < numLights; ++i) {
+    const glm::vec4& positionRadius = m_pointLights[2 * i];
+    glm::vec4 center =
+      camera.m_viewMatrix * glm::vec4(glm::vec3(positionRadius), 1.0f);
+    m_lightSpheres[LightClusters::CenterX][i] = center.x;
+    m_lightSpheres[LightClusters::CenterY][i] = center.y;
+    m_lightSpheres[LightClusters::CenterZ][i] = center.z;
+    m_lightSpheres[LightClusters::Radius][i] = positionRadius.w;
+  }
+  const float* spheres[LightClusters::SphereStreamCount];
+  for (u32 s = 0; s < LightClusters::SphereStreamCount; ++s) {
+    spheres[s] = m_lightSpheres[s].data();
+  }
+  m_clusters.setProjection(
+    camera.m_ProjectionMatrix, camera.m_near, camera.m_far);
+  m_clusters.build(spheres, numLights);
+
+  // Textures hold whole rows; the padding is never read
+  u32 lightRows = std::max((numLights + kLightsPerRow - 1) / kLightsPerRow, 1u);
+  m_pointLights.resize(size_t{ 2 } * kLightsPerRow * lightRows);
+  resources.updateDataTexture(
+    "pointLights", 2 * kLightsPerRow, lightRows, m_pointLights.data());
+
+  // Indices past what the texture can hold are dropped from their clusters
+  const std::vector<u16>& indices = m_clusters.getLightIndices();
+  u32 indexRows = static_cast<u32>(
+    std::clamp<size_t>((indices.size() + kIndicesPerRow - 1) / kIndicesPerRow,
+                       1,
+                       kMaxIndexRows));
+  u32 kept = static_cast<u32>(
+    std::min<size_t>(indices.size(), size_t{ kIndicesPerRow } * indexRows));
+  m_indexTexels.assign(indices.begin(), indices.begin() + kept);
+  m_indexTexels.resize(size_t{ kIndicesPerRow } * indexRows);
+  resources.updateDataTexture(
+    "lightIndices", kIndicesPerRow, indexRows, m_indexTexels.data());
+
+  const std::vector<LightClusters::Cluster>& clusters =
+    m_clusters.getClusters();
+  m_clusterTexels.resize(clusters.size() * 4);
+  for (size_t c = 0; c < clusters.size(); ++c) {
+    u32 offset = clusters[c].offset;
+    u32 count = offset < kept ? std::min(clusters[c].count, kept - offset) : 0;
+    m_clusterTexels[4 * c] = static_cast<u16>(offset & 0xFFFF);
+    m_clusterTexels[4 * c + 1] = static_cast<u16>(offset >> 16);
+    m_clusterTexels[4 * c + 2] = static_cast<u16>(std::min(count, 0xFFFFu));
+    m_clusterTexels[4 * c + 3] = 0;
+  }
+  resources.updateDataTexture("lightClusters",
+                              LightClusters::kTilesX * LightClusters::kTilesY,
+                              LightClusters::kSlices,
+                              m_clusterTexels.data());
+}
+
+void
+LightPass::Record(ECSManager& /* eManager */)
+{
+  auto& resources = gfx::RenderResources::getInstance();
+
   // Get command buffer for this pass
   gfx::CommandBuffer* cmd = getCommandBuffer();
   if (cmd == nullptr) {
@@ -199,36 +326,58 @@ LightPass::Record(ECSManager& eManager)
   // Bind vertex buffer for fullscreen quad
   cmd->bindVertexBuffer(0, resources.getQuadVertexBuffer(), 0);
 
-  // Bind all input textures with appropriate samplers
+  for (size_t idx = 0; idx < m_inputs.size(); idx++) {
+    cmd->bindTexture(
+      static_cast<u32>(idx), m_inputs[idx].texture, m_inputs[idx].sampler);
+  }
+
+  // Draw fullscreen quad
+  cmd->draw(gfx::RenderResources::kQuadVertexCount, 1, 0, 0);
+
+  cmd->endRenderPass();
+
+#if !defined(EMSCRIPTEN) && !defined(NDEBUG)
+  cmd->popDebugGroup();
+#endif
+}
+
+void
+LightPass::resolveInputs()
+{
+  auto& resources = gfx::RenderResources::getInstance();
+  auto layoutInputs = inputs(m_layout);
+  if (m_inputsGeneration == resources.getTextureGeneration() &&
+      m_inputs.size() == layoutInputs.size()) {
+    return;
+  }
+  m_inputsGeneration = resources.getTextureGeneration();
+
   gfx::SamplerId linearClampSampler = resources.getLinearClampSampler();
   gfx::SamplerId linearMipmapClampSampler =
     resources.getLinearMipmapClampSampler();
   gfx::SamplerId shadowSampler = resources.getShadowSampler();
+  gfx::SamplerId nearestClampSampler = resources.getNearestClampSampler();
 
-  for (size_t idx = 0; idx < m_textures.size(); idx++) {
-    gfx::TextureId tex = resources.getTexture(m_textures[idx]);
+  m_inputs.clear();
+  for (std::string_view input : layoutInputs) {
+    std::string name(input);
     // Select appropriate sampler:
     // - Shadow sampler for depthMapArray (has comparison mode enabled)
     // - Mipmap sampler for IBL cubemaps that use textureLod() in shader
+    // - Nearest for gBufferDepth, since GLES can't filter depth textures
+    // - Nearest for the point light data textures, some of them integer
     // - Linear clamp for everything else
     gfx::SamplerId sampler = linearClampSampler;
-    if (m_textures[idx] == "depthMapArray") {
+    if (name == "depthMapArray") {
       sampler = shadowSampler;
-    } else if (m_textures[idx] == "irradianceMap" ||
-               m_textures[idx] == "prefilterMap") {
+    } else if (name == "irradianceMap" || name == "prefilterMap") {
       sampler = linearMipmapClampSampler;
+    } else if (name == "gBufferDepth" ||
+               resources.getDataTexture(name).isValid()) {
+      sampler = nearestClampSampler;
     }
-    cmd->bindTexture(static_cast<u32>(idx), tex, sampler);
+    m_inputs.push_back({ resources.findTexture(name), sampler });
   }
-
-  // Draw fullscreen quad
-  cmd->draw(gfx::RenderResources::kQuadVertexCount, 1, 0, 0);
-
-  cmd->endRenderPass();
-
-#if !defined(EMSCRIPTEN) && !defined(NDEBUG)
-  cmd->popDebugGroup();
-#endif
 }
 
 void
@@ -239,9 +388,8 @@ LightPass::setViewport(u32 w, u32 h)
 
   auto& resources = gfx::RenderResources::getInstance();
 
-  // Recreate lightFrame texture and renderbuffer with new size
+  // lightFrame comes from the FrameGraph at the new size
   if (m_useNewResources) {
-    resources.recreateTexture2D("lightFrame", m_width, m_height);
     resources.resizeRenderbuffer("lightFBODepth", m_width, m_height);
   }
 
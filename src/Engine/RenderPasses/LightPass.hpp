@@ -1,22 +1,95 @@
 #ifndef LIGHTPASS_H_
 #define LIGHTPASS_H_
 #include "RenderPasses/RenderPass.hpp"
+#include <Rendering/LightClusters.hpp>
+#include <array>
+#include <span>
+#include <string_view>
+#include <vector>
+
+struct CameraComponent;
 
 class LightPass final : public RenderPass
 {
 public:
   LightPass();
   ~LightPass() override = default;
+  void Prepare(ECSManager& eManager) override;
   void Record(ECSManager& eManager) override;
+  void Setup(RenderGraph::Builder& builder) override;
   void setViewport(u32 w, u32 h) override;
-  void Init(FrameGraph& /* fGraph */) override {};
+  void Init(FrameGraph& fGraph) override;
 
 private:
-  static constexpr u32 MAX_POINT_LIGHTS = 10;
   // Note: All light uniforms now come from LightingData UBO
   // Camera data comes from CameraData UBO
 
+  // Point lights reach the shader through data textures: "pointLights"
+  // holds gfx::PointLightData, kLightsPerRow lights of two texels per row;
+  // "lightClusters" a texel per cluster (offset low and high 16 bits, light
+  // count) with a row per slice; "lightIndices" every cluster's light
+  // indices, kIndicesPerRow per row
+  static constexpr u32 kLightsPerRow = 512;
+  static constexpr u32 kIndicesPerRow = 1024;
+  // Rows GLES3 guarantees a texture can have; light indices past them are
+  // dropped
+  static constexpr u32 kMaxIndexRows = 2048;
+
+  // Textures sampled, bound to units in this order: IBL maps, the shadow
+  // cascades, the G-buffer of each GBufferLayout, then the point lights
+  static constexpr std::array<std::string_view, 11> kFullInputs = {
+    "irradianceMap", "prefilterMap",  "brdfLUT",          "depthMapArray",
+    "gPositionAo",   "gNormalMetal",  "gAlbedoSpecRough", "gEmissive",
+    "pointLights",   "lightClusters", "lightIndices"
+  };
+  static constexpr std::array<std::string_view, 12> kCompactInputs = {
+    "irradianceMap", "prefilterMap", "brdfLUT",       "depthMapArray",
+    "gNormalRough",  "gAlbedoMetal", "gOcclusion",    "gEmissive",
+    "gBufferDepth",  "pointLights",  "lightClusters", "lightIndices"
+  };
+
+  [[nodiscard]] static std::span<const std::string_view> inputs(
+    GBufferLayout layout);
+
+  // inputs(m_layout) resolved to the handle and sampler bound at each unit
+  struct InputTexture
+  {
+    gfx::TextureId texture;
+    gfx::SamplerId sampler;
+  };
+
+  // Re-resolves m_inputs if RenderResources' textures changed since the
+  // last call, e.g. G-buffer targets reallocated on resize
+  void resolveInputs();
+
+  // Bins m_pointLights into the camera's clusters and uploads the lights,
+  // cluster ranges and light indices
+  void uploadPointLights(const CameraComponent& camera);
+
+  // Shader program and pipeline for one GBufferLayout
+  struct Variant
+  {
+    std::string shaderName;
+    gfx::PipelineId pipeline;
+  };
+
+  FrameGraph* m_frameGraph{ nullptr };
+  std::array<Variant, static_cast<size_t>(GBufferLayout::kNumLayouts)>
+    m_variants;
+  // The variant Setup() picked; m_shaderName follows it
+  GBufferLayout m_layout{ GBufferLayout::kFull };
   gfx::PipelineId m_pipeline;
+  std::vector<InputTexture> m_inputs;
+  u32 m_inputsGeneration{ ~0u };
+
+  LightClusters m_clusters;
+  // This frame's point lights, texels as uploaded to "pointLights"
+  std::vector<glm::vec4> m_pointLights;
+  // Scratch for uploadPointLights()
+  std::array<std::vector<float>, LightClusters::SphereStreamCount>
+    m_lightSpheres;
+  std::vector<u16> m_clusterTexels;
+  std::vector<u16> m_indexTexels;
 };
 
 #endif // LIGHTPASS_H_
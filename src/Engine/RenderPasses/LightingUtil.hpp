@@ -1,6 +1,7 @@
 #ifndef LIGHTINGUTIL_H_
 #define LIGHTINGUTIL_H_
 
+#include <Rendering/Frustum.hpp>
 #include <array>
 #include <cfloat>
 #include <cmath>
@@ -57,6 +58,17 @@ struct CascadeConfig
 
   glm::mat4 lightSpaceMatrices[NUM_CASCADES];
   std::array<float, NUM_CASCADES> cascadeSplits;
+  std::array<float, NUM_CASCADES> texelSizes; // World units per shadow texel
+
+  // Culling volume for a cascade's shadow casters: its light-space box with
+  // the side facing the light left open, since anything between the light
+  // and the box can still cast into it
+  [[nodiscard]] Frustum casterVolume(u32 cascade) const
+  {
+    Frustum volume = Frustum::fromMatrix(lightSpaceMatrices[cascade]);
+    volume.removePlane(Frustum::Near);
+    return volume;
+  }
 
   // Calculate cascade split distances using PSSM (Parallel-Split Shadow Maps)
   inline void calculateSplitDistances(float nearPlane,
@@ -152,6 +164,7 @@ struct CascadeConfig
         std::floor(lightMax.x / worldUnitsPerTexel) * worldUnitsPerTexel;
       lightMax.y =
         std::floor(lightMax.y / worldUnitsPerTexel) * worldUnitsPerTexel;
+      texelSizes[cascade] = worldUnitsPerTexel;
 
       // Create orthographic projection for this cascade
       glm::mat4 lightProj = glm::ortho(lightMin.x,
@@ -22,7 +22,6 @@ ParticlePass::ParticlePass()
                "resources/Shaders/particle.frag")
 {
   auto& resources = gfx::RenderResources::getInstance();
-  auto& device = gfx::GraphicsDevice::getInstance();
 
   // Cache uniform locations for performance
   useShader();
@@ -73,62 +72,50 @@ ParticlePass::ParticlePass()
   pipeInfo.rasterizer.cullMode = gfx::CullMode::None;
   pipeInfo.debugName = "ParticlePassPipeline";
   m_pipeline = resources.createPipeline("ParticlePassPipeline", pipeInfo);
-
-  // Create initial instance buffer
-  gfx::BufferCreateInfo instanceBufInfo{};
-  instanceBufInfo.size = kInitialInstanceCapacity * kInstanceStride;
-  instanceBufInfo.usage = gfx::BufferUsage::Vertex | gfx::BufferUsage::Dynamic;
-  instanceBufInfo.debugName = "ParticleInstanceBuffer";
-  m_instanceBuffer = device.createBuffer(instanceBufInfo);
-  m_instanceBufferCapacity = kInitialInstanceCapacity;
 }
 
 void
-ParticlePass::Record(ECSManager& eManager)
+ParticlePass::Prepare(ECSManager& eManager)
 {
-  auto& resources = gfx::RenderResources::getInstance();
   auto& device = gfx::GraphicsDevice::getInstance();
 
-  gfx::CommandBuffer* cmd = getCommandBuffer();
-  if (cmd == nullptr) {
-    return;
-  }
-
   auto cam = CameraSystem::getInstance().getMainCameraComponent();
+  m_viewMatrix = cam->m_viewMatrix;
+  m_projMatrix = cam->m_ProjectionMatrix;
 
   // Phase 1: Gather all alive particles into contiguous instance data
   static thread_local std::vector<ParticleInstanceData> instanceData;
   instanceData.clear();
 
-  std::vector<Entity> view = eManager.view<ParticlesComponent>();
-  for (auto& entity : view) {
-    auto* pComp = eManager.getComponent<ParticlesComponent>(entity);
-    for (auto& particle : pComp->aliveParticles) {
-      if (particle->life > 0.0f) {
-        instanceData.push_back({ particle->position, particle->color });
+  eManager.query<ParticlesComponent>().each(
+    [](Entity /* entity */, ParticlesComponent& pComp) {
+      for (auto& particle : pComp.aliveParticles) {
+        if (particle->life > 0.0f) {
+          instanceData.push_back({ particle->position, particle->color });
+        }
       }
-    }
-  }
+    });
 
-  auto particleCount = static_cast<u32>(instanceData.size());
-  if (particleCount == 0) {
+  m_particleCount = static_cast<u32>(instanceData.size());
+  if (m_particleCount == 0) {
     return;
   }
 
-  // Resize instance buffer if needed (2x amortization)
-  if (particleCount > m_instanceBufferCapacity) {
-    device.destroyBuffer(m_instanceBuffer);
-    m_instanceBufferCapacity = particleCount * 2;
-    gfx::BufferCreateInfo info{};
-    info.size = m_instanceBufferCapacity * kInstanceStride;
-    info.usage = gfx::BufferUsage::Vertex | gfx::BufferUsage::Dynamic;
-    info.debugName = "ParticleInstanceBuffer";
-    m_instanceBuffer = device.createBuffer(info);
-  }
+  // Particles change every frame, so they go through the streaming ring
+  m_instances = device.streamUpload(gfx::StreamUsage::Vertex,
+                                    instanceData.data(),
+                                    u64{ m_particleCount } * kInstanceStride);
+}
 
-  // Upload instance data
-  device.updateBuffer(
-    m_instanceBuffer, 0, instanceData.data(), particleCount * kInstanceStride);
+void
+ParticlePass::Record(ECSManager& /* eManager */)
+{
+  auto& resources = gfx::RenderResources::getInstance();
+
+  gfx::CommandBuffer* cmd = getCommandBuffer();
+  if (cmd == nullptr || m_particleCount == 0) {
+    return;
+  }
 
   // Phase 2: Record a single instanced draw call
   cmd->pushDebugGroup("Particle Pass");
@@ -149,20 +136,28 @@ ParticlePass::Record(ECSManager& eManager)
   viewport.height = static_cast<float>(m_height);
   cmd->setViewport(viewport);
 
-  cmd->setUniform(m_projMatrixLoc, cam->m_ProjectionMatrix);
-  cmd->setUniform(m_viewMatrixLoc, cam->m_viewMatrix);
+  cmd->setUniform(m_projMatrixLoc, m_projMatrix);
+  cmd->setUniform(m_viewMatrixLoc, m_viewMatrix);
 
   // Bind quad VBO (binding 0) and instance VBO (binding 1)
   cmd->bindVertexBuffer(0, resources.getQuadVertexBuffer(), 0);
-  cmd->bindVertexBuffer(1, m_instanceBuffer, 0);
+  cmd->bindVertexBuffer(1, m_instances.buffer, m_instances.offset);
 
   // One instanced draw for ALL particles
-  cmd->draw(gfx::RenderResources::kQuadVertexCount, particleCount, 0, 0);
+  cmd->draw(gfx::RenderResources::kQuadVertexCount, m_particleCount, 0, 0);
 
   cmd->endRenderPass();
   cmd->popDebugGroup();
 }
 
+void
+ParticlePass::Setup(RenderGraph::Builder& builder)
+{
+  // Blends over the background in cubeFBO, depth-tested against the
+  // geometry depth CubeMapPass blitted there
+  builder.write("cubeFrame");
+}
+
 void
 ParticlePass::setViewport(u32 w, u32 h)
 {
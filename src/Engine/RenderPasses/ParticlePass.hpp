@@ -10,7 +10,9 @@ class ParticlePass final : public RenderPass
 public:
   ParticlePass();
   ~ParticlePass() override = default;
+  void Prepare(ECSManager& eManager) override;
   void Record(ECSManager& eManager) override;
+  void Setup(RenderGraph::Builder& builder) override;
   void setViewport(u32 w, u32 h) override;
   void Init(FrameGraph& /* fGraph */) override {};
 
@@ -22,10 +24,11 @@ private:
   i32 m_projMatrixLoc{ -1 };
   i32 m_viewMatrixLoc{ -1 };
 
-  // Instanced rendering
-  gfx::BufferId m_instanceBuffer{};
-  u32 m_instanceBufferCapacity{ 0 };
-  static constexpr u32 kInitialInstanceCapacity = 50000;
+  // This frame's streamed particles and camera, from Prepare()
+  gfx::StreamAllocation m_instances;
+  u32 m_particleCount{ 0 };
+  glm::mat4 m_viewMatrix{ 1.0f };
+  glm::mat4 m_projMatrix{ 1.0f };
 };
 
 #endif // PARTICLEPASS_H_
@@ -0,0 +1,368 @@
+#include "RenderGraph.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+namespace {
+
+double
+toMiB(u64 bytes)
+{
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+void
+RenderGraph::Builder::create(std::string_view name, const TextureDesc& desc)
+{
+  u32 resource = m_graph.resourceIndex(name);
+  Resource& res = m_graph.m_resources[resource];
+  assert(res.transient == kInvalid && "Texture created twice");
+  assert(res.writers.empty() && "Texture written before it was created");
+  res.transient = static_cast<u32>(m_graph.m_transients.size());
+  m_graph.m_transients.push_back({ res.name, desc, kInvalid });
+  m_graph.use(m_pass, name, Access::Create);
+}
+
+void
+RenderGraph::Builder::write(std::string_view name)
+{
+  m_graph.use(m_pass, name, Access::Write);
+}
+
+void
+RenderGraph::Builder::read(std::string_view name)
+{
+  m_graph.use(m_pass, name, Access::Read);
+}
+
+void
+RenderGraph::reset(u32 width, u32 height)
+{
+  m_passes.clear();
+  m_resources.clear();
+  m_transients.clear();
+  m_physical.clear();
+  m_order.clear();
+  m_stats = {};
+  m_width = width;
+  m_height = height;
+}
+
+RenderGraph::Builder
+RenderGraph::addPass(std::string_view name, u32 id)
+{
+  m_passes.push_back({ std::string(name), id, {}, {}, false });
+  return { *this, static_cast<u32>(m_passes.size() - 1) };
+}
+
+u32
+RenderGraph::resourceIndex(std::string_view name)
+{
+  for (u32 i = 0; i < m_resources.size(); ++i) {
+    if (m_resources[i].name == name) {
+      return i;
+    }
+  }
+  m_resources.push_back({ std::string(name), kInvalid, {} });
+  return static_cast<u32>(m_resources.size() - 1);
+}
+
+void
+RenderGraph::use(u32 pass, std::string_view name, Access access)
+{
+  u32 resource = resourceIndex(name);
+  m_passes[pass].uses.push_back({ resource, access });
+  if (access != Access::Read) {
+    m_resources[resource].writers.push_back(pass);
+  }
+}
+
+bool
+RenderGraph::isCulled(u32 id) const
+{
+  for (const Pass& pass : m_passes) {
+    if (pass.id == id) {
+      return pass.culled;
+    }
+  }
+  return true;
+}
+
+void
+RenderGraph::addDependencies()
+{
+  for (u32 p = 0; p < m_passes.size(); ++p) {
+    Pass& pass = m_passes[p];
+    pass.dependencies.clear();
+    for (const Use& use : pass.uses) {
+      const std::vector<u32>& writers = m_resources[use.resource].writers;
+      if (use.access == Access::Read) {
+        // Sees every write made to it this frame
+        for (u32 writer : writers) {
+          if (writer != p) {
+            pass.dependencies.push_back(writer);
+          }
+        }
+        continue;
+      }
+      // Writes land in declaration order
+      auto it = std::find(writers.begin(), writers.end(), p);
+      if (it != writers.begin()) {
+        pass.dependencies.push_back(*(it - 1));
+      }
+    }
+  }
+}
+
+void
+RenderGraph::cull()
+{
+  u32 backbuffer = kInvalid;
+  for (u32 i = 0; i < m_resources.size(); ++i) {
+    if (m_resources[i].name == kBackbuffer) {
+      backbuffer = i;
+    }
+  }
+
+  std::vector<u32> stack;
+  for (Pass& pass : m_passes) {
+    pass.culled = true;
+  }
+  if (backbuffer != kInvalid) {
+    stack = m_resources[backbuffer].writers;
+  }
+  while (!stack.empty()) {
+    u32 p = stack.back();
+    stack.pop_back();
+    if (!m_passes[p].culled) {
+      continue;
+    }
+    m_passes[p].culled = false;
+    stack.insert(stack.end(),
+                 m_passes[p].dependencies.begin(),
+                 m_passes[p].dependencies.end());
+  }
+}
+
+bool
+RenderGraph::sort()
+{
+  // Kahn's algorithm, always taking the earliest-declared ready pass
+  std::vector<u32> pending(m_passes.size(), 0);
+  for (u32 p = 0; p < m_passes.size(); ++p) {
+    if (!m_passes[p].culled) {
+      pending[p] = static_cast<u32>(m_passes[p].dependencies.size());
+    }
+  }
+  std::vector<bool> done(m_passes.size(), false);
+  std::vector<u32> order;
+  while (true) {
+    u32 next = kInvalid;
+    for (u32 p = 0; p < m_passes.size(); ++p) {
+      if (!m_passes[p].culled && !done[p] && pending[p] == 0) {
+        next = p;
+        break;
+      }
+    }
+    if (next == kInvalid) {
+      break;
+    }
+    done[next] = true;
+    order.push_back(next);
+    for (u32 p = 0; p < m_passes.size(); ++p) {
+      for (u32 dependency : m_passes[p].dependencies) {
+        pending[p] -= dependency == next ? 1 : 0;
+      }
+    }
+  }
+
+  size_t alive = std::count_if(m_passes.begin(),
+                               m_passes.end(),
+                               [](const Pass& pass) { return !pass.culled; });
+  if (order.size() != alive) {
+    return false;
+  }
+  m_order.clear();
+  for (u32 p : order) {
+    m_order.push_back(p);
+  }
+  return true;
+}
+
+void
+RenderGraph::alias()
+{
+  // Lifetimes as positions in m_order, which still holds pass indices
+  struct Lifetime
+  {
+    u32 first{ kInvalid };
+    u32 last{ 0 };
+  };
+  std::vector<Lifetime> lifetimes(m_transients.size());
+  for (u32 position = 0; position < m_order.size(); ++position) {
+    for (const Use& use : m_passes[m_order[position]].uses) {
+      u32 transient = m_resources[use.resource].transient;
+      if (transient == kInvalid) {
+        continue;
+      }
+      Lifetime& lifetime = lifetimes[transient];
+      lifetime.first = std::min(lifetime.first, position);
+      lifetime.last = std::max(lifetime.last, position);
+    }
+  }
+
+  std::vector<u32> byFirstUse;
+  for (u32 t = 0; t < m_transients.size(); ++t) {
+    m_transients[t].physical = kInvalid;
+    if (lifetimes[t].first != kInvalid) {
+      byFirstUse.push_back(t);
+    }
+  }
+  std::stable_sort(byFirstUse.begin(), byFirstUse.end(), [&](u32 a, u32 b) {
+    return lifetimes[a].first < lifetimes[b].first;
+  });
+
+  // First fit: the lowest slot of the same shape that is free by then
+  std::vector<u32> slotLastUse;
+  m_physical.clear();
+  for (u32 t : byFirstUse) {
+    Transient& transient = m_transients[t];
+    for (u32 slot = 0; slot < m_physical.size(); ++slot) {
+      if (m_physical[slot] == transient.desc &&
+          slotLastUse[slot] < lifetimes[t].first) {
+        transient.physical = slot;
+        break;
+      }
+    }
+    if (transient.physical == kInvalid) {
+      transient.physical = static_cast<u32>(m_physical.size());
+      m_physical.push_back(transient.desc);
+      slotLastUse.push_back(0);
+    }
+    slotLastUse[transient.physical] = lifetimes[t].last;
+  }
+}
+
+bool
+RenderGraph::compile()
+{
+  addDependencies();
+  cull();
+  bool sorted = sort();
+  if (!sorted) {
+    // A cycle: run everything as declared rather than drop passes
+    for (Pass& pass : m_passes) {
+      pass.culled = false;
+    }
+    m_order.clear();
+    for (u32 p = 0; p < m_passes.size(); ++p) {
+      m_order.push_back(p);
+    }
+  }
+  alias();
+  if (!sorted) {
+    // One slot each; lifetimes from a cyclic order mean nothing
+    m_physical.clear();
+    for (Transient& transient : m_transients) {
+      transient.physical = static_cast<u32>(m_physical.size());
+      m_physical.push_back(transient.desc);
+    }
+  }
+
+  m_stats = {};
+  m_stats.passes = static_cast<u32>(m_passes.size());
+  m_stats.culledPasses =
+    static_cast<u32>(m_passes.size() - m_order.size());
+  for (const Transient& transient : m_transients) {
+    m_stats.declaredBytes += byteSize(transient.desc);
+    if (transient.physical != kInvalid) {
+      m_stats.transientTextures++;
+      m_stats.transientBytes += byteSize(transient.desc);
+    }
+  }
+  m_stats.physicalTextures = static_cast<u32>(m_physical.size());
+  for (const TextureDesc& desc : m_physical) {
+    m_stats.physicalBytes += byteSize(desc);
+  }
+
+  // Hand out ids from here on
+  for (u32& p : m_order) {
+    p = m_passes[p].id;
+  }
+  return sorted;
+}
+
+u64
+RenderGraph::byteSize(const TextureDesc& desc)
+{
+  return u64{ desc.width } * desc.height * gfx::bytesPerPixel(desc.format);
+}
+
+std::string
+RenderGraph::describe() const
+{
+  std::string out;
+  char line[160];
+  std::snprintf(line,
+                sizeof(line),
+                "Render graph: %u passes, %u culled; %u transient textures "
+                "in %u (%.1f MiB, %.1f MiB saved)\n",
+                m_stats.passes,
+                m_stats.culledPasses,
+                m_stats.transientTextures,
+                m_stats.physicalTextures,
+                toMiB(m_stats.physicalBytes),
+                toMiB(m_stats.declaredBytes - m_stats.physicalBytes));
+  out += line;
+
+  auto label = [&](u32 resource) {
+    std::string name = m_resources[resource].name;
+    u32 transient = m_resources[resource].transient;
+    if (transient != kInvalid && m_transients[transient].physical != kInvalid) {
+      name += "#" + std::to_string(m_transients[transient].physical);
+    }
+    return name;
+  };
+
+  // Resources some earlier pass in the order has rendered into
+  std::vector<bool> rendered(m_resources.size(), false);
+  u32 position = 1;
+  for (u32 id : m_order) {
+    auto pass = std::find_if(m_passes.begin(),
+                             m_passes.end(),
+                             [id](const Pass& p) { return p.id == id; });
+    std::string targets;
+    std::string inputs;
+    for (const Use& use : pass->uses) {
+      if (use.access == Access::Read) {
+        if (rendered[use.resource]) {
+          inputs += " " + label(use.resource);
+        }
+      } else {
+        targets += " " + label(use.resource);
+      }
+    }
+    for (const Use& use : pass->uses) {
+      if (use.access != Access::Read) {
+        rendered[use.resource] = true;
+      }
+    }
+    out += std::to_string(position++) + ". " + pass->name;
+    if (!inputs.empty()) {
+      out += "  reads" + inputs;
+    }
+    if (!targets.empty()) {
+      out += "  renders" + targets;
+    }
+    out += "\n";
+  }
+
+  for (const Pass& pass : m_passes) {
+    if (pass.culled) {
+      out += "culled: " + pass.name + "\n";
+    }
+  }
+  return out;
+}
@@ -0,0 +1,165 @@
+#ifndef RENDERGRAPH_H_
+#define RENDERGRAPH_H_
+
+#include <Graphics/GraphicsTypes.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Declarative description of a frame: passes and the textures they read and
+// write, by name. compile() derives everything FrameGraph used to hardcode:
+//
+// - Order: a pass runs after every earlier-declared writer of what it
+//   writes, and after every writer of what it reads. Ties keep declaration
+//   order.
+// - Culling: only passes that contribute to kBackbuffer survive.
+// - Aliasing: textures a pass create()s are transient. Those whose lifetimes
+//   (first to last surviving use) don't overlap share one physical texture
+//   when their format and size match.
+//
+// Names nobody create()s are imported: textures with a life outside the
+// graph (shadow maps, IBL maps, renderbuffers). They only order passes.
+//
+// Pure bookkeeping; FrameGraph allocates what the compiled graph asks for.
+class RenderGraph
+{
+public:
+  // Imported target standing for the default framebuffer. Writing it is
+  // what keeps a pass from being culled.
+  static constexpr std::string_view kBackbuffer = "backbuffer";
+  static constexpr u32 kInvalid = ~0u;
+
+  struct TextureDesc
+  {
+    gfx::PixelFormat format{ gfx::PixelFormat::RGBA8 };
+    u32 width{ 0 };
+    u32 height{ 0 };
+
+    bool operator==(const TextureDesc& other) const = default;
+  };
+
+  // Declares one pass's resources; see addPass()
+  class Builder
+  {
+  public:
+    // Transient texture this pass renders first; contents start undefined
+    void create(std::string_view name, const TextureDesc& desc);
+    // Renders into an existing texture, keeping its contents
+    void write(std::string_view name);
+    // Samples, blits from or depth-tests against a texture
+    void read(std::string_view name);
+
+    [[nodiscard]] u32 width() const { return m_graph.m_width; }
+    [[nodiscard]] u32 height() const { return m_graph.m_height; }
+
+  private:
+    friend class RenderGraph;
+    Builder(RenderGraph& graph, u32 pass)
+      : m_graph(graph)
+      , m_pass(pass)
+    {
+    }
+
+    RenderGraph& m_graph;
+    u32 m_pass;
+  };
+
+  struct Stats
+  {
+    u32 passes{ 0 };
+    u32 culledPasses{ 0 };
+    u32 transientTextures{ 0 }; // Created by surviving passes
+    u32 physicalTextures{ 0 };
+    u64 declaredBytes{ 0 }; // Every create(), culled passes' included
+    u64 transientBytes{ 0 };
+    u64 physicalBytes{ 0 };
+  };
+
+  // Drops all passes and resources; transient sizes come from these
+  void reset(u32 width, u32 height);
+
+  // Passes are identified by `id` (e.g. a PassId) in the results
+  Builder addPass(std::string_view name, u32 id);
+
+  // Orders, culls and aliases. False, with declaration order kept and
+  // nothing culled or aliased, if the dependencies have a cycle.
+  bool compile();
+
+  // Ids of the surviving passes, in execution order
+  [[nodiscard]] const std::vector<u32>& getOrder() const { return m_order; }
+  [[nodiscard]] bool isCulled(u32 id) const;
+
+  // Transient textures and the physical slot each one was given; kInvalid
+  // for those only culled passes use
+  struct Transient
+  {
+    std::string name;
+    TextureDesc desc;
+    u32 physical{ kInvalid };
+  };
+  [[nodiscard]] const std::vector<Transient>& getTransients() const
+  {
+    return m_transients;
+  }
+  [[nodiscard]] const std::vector<TextureDesc>& getPhysicalTextures() const
+  {
+    return m_physical;
+  }
+
+  [[nodiscard]] const Stats& getStats() const { return m_stats; }
+
+  // Execution order with each pass's render targets, the textures it
+  // samples after an earlier pass rendered them (the points where a render
+  // target becomes a shader input), and the aliasing chosen
+  [[nodiscard]] std::string describe() const;
+
+  [[nodiscard]] static u64 byteSize(const TextureDesc& desc);
+
+private:
+  enum class Access : u8
+  {
+    Create,
+    Write,
+    Read
+  };
+
+  struct Use
+  {
+    u32 resource;
+    Access access;
+  };
+
+  struct Pass
+  {
+    std::string name;
+    u32 id;
+    std::vector<Use> uses;
+    std::vector<u32> dependencies; // Indices of passes that run first
+    bool culled{ false };
+  };
+
+  struct Resource
+  {
+    std::string name;
+    u32 transient{ kInvalid }; // Index into m_transients if created
+    std::vector<u32> writers;  // Passes in declaration order
+  };
+
+  u32 resourceIndex(std::string_view name);
+  void use(u32 pass, std::string_view name, Access access);
+  void addDependencies();
+  void cull();
+  bool sort();
+  void alias();
+
+  std::vector<Pass> m_passes;
+  std::vector<Resource> m_resources;
+  std::vector<Transient> m_transients;
+  std::vector<TextureDesc> m_physical;
+  std::vector<u32> m_order;
+  Stats m_stats;
+  u32 m_width{ 0 };
+  u32 m_height{ 0 };
+};
+
+#endif // RENDERGRAPH_H_
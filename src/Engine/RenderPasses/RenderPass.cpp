@@ -10,16 +10,6 @@ RenderPass::RenderPass(std::string_view name,
   resources.loadShaderProgram(m_shaderName, std::string(vs), std::string(fs));
 }
 
-void
-RenderPass::addTexture(std::string_view texName)
-{
-  useShader();
-  auto& device = gfx::GraphicsDevice::getInstance();
-  device.setUniformInt(getUniformLocation(std::string(texName).c_str()),
-                       static_cast<i32>(m_textures.size()));
-  m_textures.push_back(std::string(texName));
-}
-
 void
 RenderPass::useShader()
 {
@@ -49,24 +39,29 @@ RenderPass::getShaderId() const
 void
 RenderPass::Execute(ECSManager& eManager)
 {
+  Prepare(eManager);
   Record(eManager);
   if (m_cmdBuffer.isValid()) {
     gfx::GraphicsDevice::getInstance().submit(m_cmdBuffer);
   }
 }
 
-gfx::CommandBuffer*
-RenderPass::getCommandBuffer()
+void
+RenderPass::ensureCommandBuffer()
 {
-  auto& device = gfx::GraphicsDevice::getInstance();
-
-  // Create command buffer if needed
   if (!m_cmdBuffer.isValid()) {
-    m_cmdBuffer = device.createCommandBuffer();
+    m_cmdBuffer = gfx::GraphicsDevice::getInstance().createCommandBuffer();
   }
+}
+
+gfx::CommandBuffer*
+RenderPass::getCommandBuffer()
+{
+  ensureCommandBuffer();
 
-  // Reset for new frame recording
-  gfx::CommandBuffer* cmd = device.getCommandBuffer(m_cmdBuffer);
+  // Reset for new frame recording; the stream keeps its capacity
+  gfx::CommandBuffer* cmd =
+    gfx::GraphicsDevice::getInstance().getCommandBuffer(m_cmdBuffer);
   if (cmd != nullptr) {
     cmd->reset();
   }
@@ -3,12 +3,23 @@
 
 #include <Graphics/CommandBuffer.hpp>
 #include <Graphics/RenderResources.hpp>
+#include <RenderPasses/RenderGraph.hpp>
 #include <string>
 #include <vector>
 
 class ECSManager;
 class FrameGraph;
 
+// How GeometryPass packs surfaces for LightPass. Compact drops the stored
+// position for one rebuilt from depth and packs the rest into 8-10 bit
+// channels: 13 bytes per pixel written and read instead of 32.
+enum class GBufferLayout : u8
+{
+  kFull,    // RGBA16F position/AO, normal/metal, albedo/roughness, emissive
+  kCompact, // Octahedral normal, RGBA8 albedo, R8 AO, R11G11B10F emissive
+  kNumLayouts
+};
+
 class RenderPass
 {
 public:
@@ -16,14 +27,22 @@ public:
   RenderPass(std::string_view name, std::string_view vs, std::string_view fs);
   virtual ~RenderPass() = default;
 
+  /// Main-thread half of recording: ECS reads, UBO and instance uploads,
+  /// streaming and anything else that reaches GL. The FrameGraph runs it in
+  /// PassId order before Record(). Default implementation does nothing.
+  virtual void Prepare(ECSManager& eManager) { (void)eManager; }
+
   /// Record commands into the command buffer without submitting.
   /// Passes that only need a single record+submit cycle should override this.
+  /// Runs on a worker thread alongside other passes' Record(), so it may
+  /// only encode into this pass's buffer from state Prepare() left behind.
   /// Default implementation does nothing (for passes that override Execute).
   virtual void Record(ECSManager& eManager) { (void)eManager; }
 
   /// Execute the pass. Default implementation calls Record() — passes that
-  /// need multiple submits or mid-frame CPU work (e.g. BloomPass) override
-  /// this directly.
+  /// draw outside a command buffer (e.g. DebugPass) override this directly.
+  /// Uniform values that change between draws go in gfx::ParameterBlocks
+  /// rather than extra submits.
   virtual void Execute(ECSManager& eManager);
 
   /// Returns true if this pass manages its own submission (overrides Execute).
@@ -36,9 +55,21 @@ public:
     return m_cmdBuffer;
   }
 
+  /// Creates the pass's command buffer if it has none yet. Called on the
+  /// main thread so the device's buffer pool never grows while workers
+  /// record into buffers it owns.
+  void ensureCommandBuffer();
+
+  /// Declares the textures this pass renders and reads. Transient ones it
+  /// create()s are allocated by the FrameGraph, possibly sharing memory with
+  /// others, and registered with RenderResources under their names before
+  /// setViewport() is called. Runs whenever the graph is rebuilt.
+  virtual void Setup(RenderGraph::Builder& builder) = 0;
+
+  /// Attach render targets for a new size. Called once the graph is compiled,
+  /// and only while the pass is part of it.
   virtual void setViewport(u32 /* w */, u32 /* h */) = 0;
   virtual void Init(FrameGraph& /* fGraph */) = 0;
-  void addTexture(std::string_view texName);
 
 protected:
   // Shader helpers - use these instead of raw GL calls
@@ -53,7 +84,6 @@ protected:
   u32 m_width{ kDefaultWidth };
   u32 m_height{ kDefaultHeight };
   std::string m_shaderName;
-  std::vector<std::string> m_textures;
 
   // Track if resources were created through the new RenderResources system
   // This enables gradual migration - passes can check this flag in
@@ -61,7 +91,7 @@ protected:
   // RenderResources::recreateTexture2D() or legacy code
   bool m_useNewResources{ false };
 
-  // Command buffer for deferred rendering
+  // Command buffer for deferred rendering, reused every frame
   gfx::CommandBufferId m_cmdBuffer;
 
   // Get command buffer pointer (creates if needed, resets for new frame)
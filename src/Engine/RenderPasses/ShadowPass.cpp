@@ -2,7 +2,6 @@
 #include "ECS/Components/CameraComponent.hpp"
 #include "ECS/Components/GraphicsComponent.hpp"
 #include "ECS/Components/LightingComponent.hpp"
-#include "ECS/Components/PositionComponent.hpp"
 #include "LightingUtil.hpp"
 
 #include "ECS/ECSManager.hpp"
@@ -12,37 +11,9 @@
 #include <Graphics/GraphicsDevice.hpp>
 #include <Graphics/RenderResources.hpp>
 #include <RenderPasses/FrameGraph.hpp>
-#include <unordered_map>
 
 namespace {
 
-struct InstanceKey
-{
-  GraphicsObject* obj;
-  u32 nodeIdx;
-  u32 primIdx;
-
-  bool operator==(const InstanceKey&) const = default;
-};
-
-struct InstanceKeyHash
-{
-  size_t operator()(const InstanceKey& key) const
-  {
-    auto h1 = std::hash<void*>{}(key.obj);
-    auto h2 = std::hash<u32>{}(key.nodeIdx);
-    auto h3 = std::hash<u32>{}(key.primIdx);
-    return h1 ^ (h2 << 16) ^ (h3 << 32);
-  }
-};
-
-struct DrawGroup
-{
-  InstanceKey key;
-  u32 offset;
-  u32 count;
-};
-
 // Shadow shader only uses locations 0, 4, 5 for mesh data, but the VBO is
 // the same interleaved format as the geometry pass (72 bytes).
 constexpr u32 kMeshVertexStride = 72;
@@ -169,23 +140,23 @@ ShadowPass::ShadowPass()
   instanceBufInfo.debugName = "ShadowInstanceBuffer";
   m_instanceBuffer = device.createBuffer(instanceBufInfo);
   m_instanceBufferCapacity = kInitialInstanceCapacity;
-
-  // Single-instance buffer for skinned entity draws (1 mat4)
-  gfx::BufferCreateInfo singleBufInfo{};
-  singleBufInfo.size = kInstanceStride;
-  singleBufInfo.usage = gfx::BufferUsage::Vertex | gfx::BufferUsage::Dynamic;
-  singleBufInfo.debugName = "ShadowSingleInstanceBuffer";
-  m_singleInstanceBuffer = device.createBuffer(singleBufInfo);
 }
 
 void
 ShadowPass::Init(FrameGraph& fGraph)
 {
-  fGraph.getPass(PassId::kLight)->addTexture("depthMapArray");
+  m_instances = &fGraph.getInstances();
 }
 
 void
-ShadowPass::Record(ECSManager& eManager)
+ShadowPass::Setup(RenderGraph::Builder& builder)
+{
+  // Fixed-size cascades, kept across frames; read by LightPass
+  builder.write("depthMapArray");
+}
+
+void
+ShadowPass::Prepare(ECSManager& eManager)
 {
   auto& resources = gfx::RenderResources::getInstance();
   auto& device = gfx::GraphicsDevice::getInstance();
@@ -195,14 +166,13 @@ ShadowPass::Record(ECSManager& eManager)
 
   // Get directional light
   glm::vec3 lightDirection(0.0f, -1.0f, 0.0f);
-  std::vector<Entity> lightView = eManager.view<LightingComponent>();
-  for (auto lightEntity : lightView) {
-    auto* lightComp = eManager.getComponent<LightingComponent>(lightEntity);
-
-    if (lightComp->type == LightingComponent::TYPE::DIRECTIONAL) {
-      auto& light = static_cast<DirectionalLight&>(*lightComp->light);
-      lightDirection = light.direction;
-      break;
+  if (auto* lights = eManager.getPool<LightingComponent>(); lights) {
+    for (auto& lightComp : *lights) {
+      if (lightComp.type == LightingComponent::TYPE::DIRECTIONAL) {
+        auto& light = static_cast<DirectionalLight&>(*lightComp.light);
+        lightDirection = light.direction;
+        break;
+      }
     }
   }
 
@@ -236,72 +206,42 @@ ShadowPass::Record(ECSManager& eManager)
   // Update cascade UBO through RenderResources
   resources.updateUniformBuffer("cascadeUBO", &uboData, sizeof(CascadeUBO));
 
-  // Get command buffer for this pass
-  gfx::CommandBuffer* cmd = getCommandBuffer();
-  if (cmd == nullptr) {
-    return;
+  // Each cascade gets only the casters inside its culling volume
+  std::array<Frustum, NUM_CASCADES> volumes;
+  for (u32 cascade = 0; cascade < NUM_CASCADES; ++cascade) {
+    volumes[cascade] = m_cascadeConfig.casterVolume(cascade);
   }
-
-#if !defined(EMSCRIPTEN) && !defined(NDEBUG)
-  cmd->pushDebugGroup("Shadow Pass CSM");
-#endif
-
-  // Get entity list and sort into instanced vs skinned (once for all cascades)
-  std::vector<Entity> entityView = eManager.view<GraphicsComponent>();
-
-  std::unordered_map<InstanceKey, std::vector<glm::mat4>, InstanceKeyHash>
-    instanceGroups;
-  std::vector<Entity> skinnedEntities;
-
-  for (auto entity : entityView) {
-    auto* posComp = eManager.getComponent<PositionComponent>(entity);
-    auto* gfxComp = eManager.getComponent<GraphicsComponent>(entity);
-    auto* obj = gfxComp->m_grapObj.get();
-
-    glm::mat4 entityModel =
-      posComp ? glm::translate(glm::mat4(1.0f), posComp->position) *
-                  glm::mat4_cast(posComp->rotation) *
-                  glm::scale(glm::mat4(1.0f), posComp->scale)
-              : glm::identity<glm::mat4>();
-
-    bool hasSkin = false;
-    for (u32 idx = 0; idx < obj->p_numNodes; idx++) {
-      if (obj->p_nodes[idx].skin >= 0) {
-        hasSkin = true;
-        break;
-      }
-    }
-
-    if (hasSkin) {
-      skinnedEntities.push_back(entity);
-    } else {
-      for (u32 nodeIdx = 0; nodeIdx < obj->p_numNodes; nodeIdx++) {
-        if (obj->p_nodes[nodeIdx].mesh < 0) {
-          continue;
-        }
-        glm::mat4 nodeModel = entityModel * obj->getMatrix(nodeIdx);
-        Mesh& mesh = obj->p_meshes[obj->p_nodes[nodeIdx].mesh];
-        for (u32 primIdx = 0; primIdx < mesh.numPrims; primIdx++) {
-          instanceGroups[{ obj, nodeIdx, primIdx }].push_back(nodeModel);
-        }
-      }
-    }
+  // Diameter under m_minCasterTexels texels, i.e. mostly sub-texel
+  auto minCasterRadius = [&](u32 cascade) {
+    return cascade >= kFirstSmallCasterCascade
+             ? 0.5f * m_minCasterTexels * m_cascadeConfig.texelSizes[cascade]
+             : 0.0f;
+  };
+  for (u32 cascade = 0; cascade < NUM_CASCADES; ++cascade) {
+    m_skinnedCasters[cascade].clear();
+    m_instances->cullSkinned(volumes[cascade],
+                             m_skinnedCasters[cascade],
+                             minCasterRadius(cascade));
   }
-
-  // Build contiguous matrix buffer and draw groups
-  static thread_local std::vector<glm::mat4> allMatrices;
-  static thread_local std::vector<DrawGroup> drawGroups;
-  allMatrices.clear();
-  drawGroups.clear();
-
-  for (auto& [key, matrices] : instanceGroups) {
-    drawGroups.push_back({ key,
-                           static_cast<u32>(allMatrices.size()),
-                           static_cast<u32>(matrices.size()) });
-    allMatrices.insert(allMatrices.end(), matrices.begin(), matrices.end());
+  bool instancesChanged = false;
+  if (m_instances->version() != m_casterVersion ||
+      volumes != m_casterVolumes) {
+    m_casterVersion = m_instances->version();
+    m_casterVolumes = volumes;
+    m_casterMatrices.clear();
+    for (u32 cascade = 0; cascade < NUM_CASCADES; ++cascade) {
+      m_casterGroups[cascade].clear();
+      m_instances->cull(volumes[cascade],
+                        m_casterMatrices,
+                        m_casterGroups[cascade],
+                        minCasterRadius(cascade));
+    }
+    instancesChanged = true;
   }
+  const auto& allMatrices = m_casterMatrices;
 
-  // Upload all instance matrices (shared across all cascades)
+  // Upload instance matrices (shared across all cascades), skipped when
+  // nothing moved
   if (!allMatrices.empty()) {
     auto totalSize = static_cast<u32>(allMatrices.size()) * kInstanceStride;
 
@@ -313,10 +253,30 @@ ShadowPass::Record(ECSManager& eManager)
       info.usage = gfx::BufferUsage::Vertex | gfx::BufferUsage::Dynamic;
       info.debugName = "ShadowInstanceBuffer";
       m_instanceBuffer = device.createBuffer(info);
+      instancesChanged = true;
     }
 
-    device.updateBuffer(m_instanceBuffer, 0, allMatrices.data(), totalSize);
+    if (instancesChanged) {
+      device.updateBuffer(m_instanceBuffer, 0, allMatrices.data(), totalSize);
+    }
   }
+}
+
+void
+ShadowPass::Record(ECSManager& /* eManager */)
+{
+  auto& resources = gfx::RenderResources::getInstance();
+  auto& device = gfx::GraphicsDevice::getInstance();
+
+  // Get command buffer for this pass
+  gfx::CommandBuffer* cmd = getCommandBuffer();
+  if (cmd == nullptr) {
+    return;
+  }
+
+#if !defined(EMSCRIPTEN) && !defined(NDEBUG)
+  cmd->pushDebugGroup("Shadow Pass CSM");
+#endif
 
   // Get FBO and texture handles for CommandBuffer commands
   gfx::FramebufferId depthMapFbo = resources.getFramebuffer("depthMapFbo");
@@ -359,10 +319,10 @@ ShadowPass::Record(ECSManager& eManager)
     // Instanced draws (non-skinned)
     cmd->setUniform(m_isSkinnedLoc, 0);
 
-    for (auto& group : drawGroups) {
-      auto* obj = group.key.obj;
-      Mesh& mesh = obj->p_meshes[obj->p_nodes[group.key.nodeIdx].mesh];
-      Primitive& prim = mesh.m_primitives[group.key.primIdx];
+    for (const auto& group : m_casterGroups[cascade]) {
+      auto* obj = group.obj;
+      Mesh& mesh = obj->p_meshes[obj->p_nodes[group.nodeIdx].mesh];
+      Primitive& prim = mesh.m_primitives[group.primIdx];
 
       // Bind per-primitive VAO (handles binding 0 with correct stride/offsets).
       // Binding 1 (instance data) falls through to the pipeline's vertex
@@ -380,19 +340,11 @@ ShadowPass::Record(ECSManager& eManager)
       }
     }
 
-    // Skinned draws (1-instance draws via instance buffer)
-    for (auto entity : skinnedEntities) {
-      auto* posComp = eManager.getComponent<PositionComponent>(entity);
-      auto* gfxComp = eManager.getComponent<GraphicsComponent>(entity);
-
-      glm::mat4 entityModel =
-        posComp ? glm::translate(glm::mat4(1.0f), posComp->position) *
-                    glm::mat4_cast(posComp->rotation) *
-                    glm::scale(glm::mat4(1.0f), posComp->scale)
-                : glm::identity<glm::mat4>();
-
-      gfxComp->m_grapObj->recordDrawGeom(
-        *cmd, entityModel, m_singleInstanceBuffer, m_isSkinnedLoc);
+    // Skinned draws inside this cascade (1-instance draws, streamed per node)
+    const auto& skinnedDraws = m_instances->skinnedDraws();
+    for (u32 k : m_skinnedCasters[cascade]) {
+      skinnedDraws[k].obj->recordDrawGeom(
+        *cmd, m_instances->skinnedInstances(skinnedDraws[k]), m_isSkinnedLoc);
     }
 
     cmd->endRenderPass();
@@ -2,6 +2,7 @@
 #define SHADOWPASS_H_
 
 #include "RenderPasses/LightingUtil.hpp"
+#include "RenderPasses/InstanceBatcher.hpp"
 #include "RenderPasses/RenderPass.hpp"
 
 class ShadowPass final : public RenderPass
@@ -9,7 +10,9 @@ class ShadowPass final : public RenderPass
 public:
   ShadowPass();
   ~ShadowPass() override = default;
+  void Prepare(ECSManager& eManager) override;
   void Record(ECSManager& eManager) override;
+  void Setup(RenderGraph::Builder& builder) override;
   void setViewport(u32 w, u32 h) override;
   void Init(FrameGraph& fGraph) override;
 
@@ -28,13 +31,27 @@ private:
   // Pipeline for CommandBuffer rendering
   gfx::PipelineId m_pipeline{};
 
-  // Instanced rendering (batched non-skinned entities)
+  // Far cascades skip casters whose bounding sphere is narrower than this
+  // many shadow texels; 0 disables the rejection
+  static constexpr u32 kFirstSmallCasterCascade = 2;
+  float m_minCasterTexels{ 1.0f };
+
+  // Instanced rendering (batched non-skinned entities), from FrameGraph's
+  // shared batches
+  InstanceBatcher* m_instances{ nullptr };
+  // Casters of each cascade, concatenated into the one instance buffer.
+  // Rebuilt when the batches or a cascade's culling volume change.
+  u32 m_casterVersion{ 0 };
+  std::array<Frustum, NUM_CASCADES> m_casterVolumes{};
+  std::vector<glm::mat4> m_casterMatrices;
+  std::array<std::vector<InstanceBatcher::DrawGroup>, NUM_CASCADES>
+    m_casterGroups;
+  // Skinned casters of each cascade as indices into skinnedDraws(), culled
+  // every frame since their poses move
+  std::array<std::vector<u32>, NUM_CASCADES> m_skinnedCasters;
   gfx::BufferId m_instanceBuffer{};
   u32 m_instanceBufferCapacity{ 0 };
   static constexpr u32 kInitialInstanceCapacity = 256;
-
-  // Single-instance buffer for skinned entity draws
-  gfx::BufferId m_singleInstanceBuffer{};
 };
 
 #endif // SHADOWPASS_H_
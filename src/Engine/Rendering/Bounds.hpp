@@ -0,0 +1,64 @@
+#ifndef BOUNDS_H_
+#define BOUNDS_H_
+
+#include <limits>
+
+// Axis-aligned bounding box. Starts out empty (min > max), so the first
+// expand() sets both corners.
+struct Aabb
+{
+  glm::vec3 min{ std::numeric_limits<float>::max() };
+  glm::vec3 max{ -std::numeric_limits<float>::max() };
+
+  void expand(const glm::vec3& point)
+  {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+  }
+  void expand(const Aabb& other)
+  {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+  }
+
+  [[nodiscard]] bool isEmpty() const { return min.x > max.x; }
+  [[nodiscard]] glm::vec3 center() const { return (min + max) * 0.5f; }
+  [[nodiscard]] glm::vec3 extents() const { return (max - min) * 0.5f; }
+  // Radius of the bounding sphere around center()
+  [[nodiscard]] float radius() const { return glm::length(extents()); }
+  [[nodiscard]] float surfaceArea() const
+  {
+    glm::vec3 d = max - min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+  }
+
+  [[nodiscard]] bool contains(const Aabb& other) const
+  {
+    return glm::all(glm::lessThanEqual(min, other.min)) &&
+           glm::all(glm::greaterThanEqual(max, other.max));
+  }
+  [[nodiscard]] bool overlaps(const Aabb& other) const
+  {
+    return glm::all(glm::lessThanEqual(min, other.max)) &&
+           glm::all(glm::greaterThanEqual(max, other.min));
+  }
+
+  // Box enclosing this one after transforming it by `m`: the new extents are
+  // the old ones projected onto each axis with |m| (Arvo)
+  [[nodiscard]] Aabb transformed(const glm::mat4& m) const
+  {
+    glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+    glm::vec3 e = extents();
+    glm::vec3 r = glm::abs(glm::vec3(m[0])) * e.x +
+                  glm::abs(glm::vec3(m[1])) * e.y +
+                  glm::abs(glm::vec3(m[2])) * e.z;
+    return { c - r, c + r };
+  }
+
+  [[nodiscard]] static Aabb merge(const Aabb& a, const Aabb& b)
+  {
+    return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+  }
+};
+
+#endif // BOUNDS_H_
@@ -0,0 +1,317 @@
+#include "Bvh.hpp"
+
+namespace {
+
+constexpr u32 kSahBins = 12;
+
+} // namespace
+
+u32
+Bvh::allocateNode()
+{
+  if (!m_freeNodes.empty()) {
+    u32 node = m_freeNodes.back();
+    m_freeNodes.pop_back();
+    m_nodes[node] = Node{};
+    return node;
+  }
+  m_nodes.emplace_back();
+  return static_cast<u32>(m_nodes.size() - 1);
+}
+
+void
+Bvh::freeNode(u32 node)
+{
+  m_freeNodes.push_back(node);
+}
+
+u32
+Bvh::insert(const Aabb& box, u32 userData, bool isStatic)
+{
+  u32 leaf = allocateNode();
+  m_nodes[leaf].userData = userData;
+  m_leafCount++;
+  if (isStatic) {
+    m_nodes[leaf].box = box;
+    addStatic(leaf);
+  } else {
+    m_nodes[leaf].box = { box.min - kMargin, box.max + kMargin };
+    insertLeaf(leaf);
+  }
+  return leaf;
+}
+
+void
+Bvh::remove(u32 proxy)
+{
+  if (isStatic(proxy)) {
+    removeStatic(proxy);
+  } else {
+    removeLeaf(proxy);
+  }
+  freeNode(proxy);
+  m_leafCount--;
+}
+
+bool
+Bvh::refit(u32 proxy, const Aabb& box)
+{
+  if (isStatic(proxy)) {
+    removeStatic(proxy);
+  } else if (m_nodes[proxy].box.contains(box)) {
+    return false;
+  } else {
+    removeLeaf(proxy);
+  }
+  m_nodes[proxy].box = { box.min - kMargin, box.max + kMargin };
+  insertLeaf(proxy);
+  return true;
+}
+
+void
+Bvh::setStatic(u32 proxy, bool isStatic)
+{
+  if (isStatic == this->isStatic(proxy)) {
+    return;
+  }
+  if (isStatic) {
+    // Keeps the fattened box; it still encloses the leaf
+    removeLeaf(proxy);
+    addStatic(proxy);
+  } else {
+    removeStatic(proxy);
+    insertLeaf(proxy);
+  }
+}
+
+void
+Bvh::clear()
+{
+  m_nodes.clear();
+  m_freeNodes.clear();
+  m_dynamicRoot = kNull;
+  m_staticRoot = kNull;
+  m_staticLeaves.clear();
+  m_staticInternal.clear();
+  m_staticDirty = false;
+  m_leafCount = 0;
+}
+
+void
+Bvh::insertLeaf(u32 leaf)
+{
+  Node& node = m_nodes[leaf];
+  node.parent = kNull;
+  if (m_dynamicRoot == kNull) {
+    m_dynamicRoot = leaf;
+    return;
+  }
+
+  // Walk down to the sibling that grows the tree's surface area the least:
+  // pairing with a node costs its merged area plus the growth of every
+  // ancestor on the way
+  Aabb box = node.box;
+  u32 index = m_dynamicRoot;
+  while (!m_nodes[index].isLeaf()) {
+    const Node& current = m_nodes[index];
+    float area = current.box.surfaceArea();
+    float mergedArea = Aabb::merge(current.box, box).surfaceArea();
+    float cost = 2.0f * mergedArea;
+    float inherited = 2.0f * (mergedArea - area);
+
+    auto descendCost = [&](u32 child) {
+      const Aabb& childBox = m_nodes[child].box;
+      float merged = Aabb::merge(childBox, box).surfaceArea();
+      if (m_nodes[child].isLeaf()) {
+        return merged + inherited;
+      }
+      return merged - childBox.surfaceArea() + inherited;
+    };
+    float costLeft = descendCost(current.left);
+    float costRight = descendCost(current.right);
+    if (cost < costLeft && cost < costRight) {
+      break;
+    }
+    index = costLeft < costRight ? current.left : current.right;
+  }
+
+  // Replace the sibling with a new parent of both
+  u32 sibling = index;
+  u32 oldParent = m_nodes[sibling].parent;
+  u32 newParent = allocateNode();
+  m_nodes[newParent].parent = oldParent;
+  m_nodes[newParent].box = Aabb::merge(box, m_nodes[sibling].box);
+  m_nodes[newParent].left = sibling;
+  m_nodes[newParent].right = leaf;
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+  if (oldParent == kNull) {
+    m_dynamicRoot = newParent;
+  } else if (m_nodes[oldParent].left == sibling) {
+    m_nodes[oldParent].left = newParent;
+  } else {
+    m_nodes[oldParent].right = newParent;
+  }
+
+  // Refit the ancestors
+  for (index = oldParent; index != kNull; index = m_nodes[index].parent) {
+    Node& ancestor = m_nodes[index];
+    ancestor.box =
+      Aabb::merge(m_nodes[ancestor.left].box, m_nodes[ancestor.right].box);
+  }
+}
+
+void
+Bvh::removeLeaf(u32 leaf)
+{
+  if (leaf == m_dynamicRoot) {
+    m_dynamicRoot = kNull;
+    return;
+  }
+
+  // The sibling takes the parent's place
+  u32 parent = m_nodes[leaf].parent;
+  u32 grandParent = m_nodes[parent].parent;
+  u32 sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right
+                                              : m_nodes[parent].left;
+  m_nodes[sibling].parent = grandParent;
+  if (grandParent == kNull) {
+    m_dynamicRoot = sibling;
+  } else if (m_nodes[grandParent].left == parent) {
+    m_nodes[grandParent].left = sibling;
+  } else {
+    m_nodes[grandParent].right = sibling;
+  }
+  freeNode(parent);
+
+  for (u32 index = grandParent; index != kNull;
+       index = m_nodes[index].parent) {
+    Node& ancestor = m_nodes[index];
+    ancestor.box =
+      Aabb::merge(m_nodes[ancestor.left].box, m_nodes[ancestor.right].box);
+  }
+}
+
+void
+Bvh::addStatic(u32 leaf)
+{
+  m_nodes[leaf].staticSlot = static_cast<u32>(m_staticLeaves.size());
+  m_staticLeaves.push_back(leaf);
+  m_staticDirty = true;
+}
+
+void
+Bvh::removeStatic(u32 leaf)
+{
+  // Swap-and-pop; the static tree is rebuilt before the next query
+  u32 slot = m_nodes[leaf].staticSlot;
+  u32 last = m_staticLeaves.back();
+  m_staticLeaves[slot] = last;
+  m_nodes[last].staticSlot = slot;
+  m_staticLeaves.pop_back();
+  m_nodes[leaf].staticSlot = kNull;
+  m_staticDirty = true;
+}
+
+void
+Bvh::rebuildStatic()
+{
+  for (u32 node : m_staticInternal) {
+    freeNode(node);
+  }
+  m_staticInternal.clear();
+  m_staticDirty = false;
+  if (m_staticLeaves.empty()) {
+    m_staticRoot = kNull;
+    return;
+  }
+  // Built over a copy, the partitioning reorders it
+  std::vector<u32> leaves = m_staticLeaves;
+  m_staticRoot = buildStatic(leaves.data(), leaves.size(), kNull);
+}
+
+u32
+Bvh::buildStatic(u32* leaves, size_t count, u32 parent)
+{
+  if (count == 1) {
+    m_nodes[leaves[0]].parent = parent;
+    return leaves[0];
+  }
+
+  Aabb bounds;
+  Aabb centroids;
+  for (size_t i = 0; i < count; ++i) {
+    const Aabb& box = m_nodes[leaves[i]].box;
+    bounds.expand(box);
+    centroids.expand(box.center());
+  }
+
+  // Split along the widest centroid axis at the cheapest of kSahBins - 1
+  // bin boundaries, cost being area * count on either side
+  glm::vec3 size = centroids.max - centroids.min;
+  int axis = 0;
+  if (size.y > size[axis]) {
+    axis = 1;
+  }
+  if (size.z > size[axis]) {
+    axis = 2;
+  }
+  size_t mid = count / 2;
+  if (size[axis] > 0.0f) {
+    float scale = kSahBins / size[axis];
+    auto binOf = [&](u32 leaf) {
+      float offset = m_nodes[leaf].box.center()[axis] - centroids.min[axis];
+      return std::min(static_cast<u32>(offset * scale), kSahBins - 1);
+    };
+
+    std::array<Aabb, kSahBins> binBounds;
+    std::array<u32, kSahBins> binCounts{};
+    for (size_t i = 0; i < count; ++i) {
+      u32 bin = binOf(leaves[i]);
+      binBounds[bin].expand(m_nodes[leaves[i]].box);
+      binCounts[bin]++;
+    }
+
+    // Right-to-left sweep first, so the left sweep can price each split
+    std::array<float, kSahBins> rightCost{};
+    Aabb right;
+    u32 rightCount = 0;
+    for (u32 bin = kSahBins - 1; bin > 0; --bin) {
+      right.expand(binBounds[bin]);
+      rightCount += binCounts[bin];
+      rightCost[bin] = rightCount ? right.surfaceArea() * rightCount : 0.0f;
+    }
+    Aabb left;
+    u32 leftCount = 0;
+    float bestCost = std::numeric_limits<float>::max();
+    u32 bestSplit = 0;
+    for (u32 bin = 0; bin + 1 < kSahBins; ++bin) {
+      left.expand(binBounds[bin]);
+      leftCount += binCounts[bin];
+      float leftCost = leftCount ? left.surfaceArea() * leftCount : 0.0f;
+      float cost = leftCost + rightCost[bin + 1];
+      if (leftCount > 0 && leftCount < count && cost < bestCost) {
+        bestCost = cost;
+        bestSplit = bin;
+      }
+    }
+
+    u32* split = std::partition(leaves, leaves + count, [&](u32 leaf) {
+      return binOf(leaf) <= bestSplit;
+    });
+    size_t splitIndex = static_cast<size_t>(split - leaves);
+    if (splitIndex > 0 && splitIndex < count) {
+      mid = splitIndex;
+    }
+  }
+
+  u32 node = allocateNode();
+  m_staticInternal.push_back(node);
+  u32 leftChild = buildStatic(leaves, mid, node);
+  u32 rightChild = buildStatic(leaves + mid, count - mid, node);
+  m_nodes[node].parent = parent;
+  m_nodes[node].left = leftChild;
+  m_nodes[node].right = rightChild;
+  m_nodes[node].box = bounds;
+  return node;
+}
@@ -0,0 +1,251 @@
+#ifndef BVH_H_
+#define BVH_H_
+
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+#include <vector>
+
+// Bounding volume hierarchy over world-space boxes, each leaf carrying a u32
+// of user data (SpatialSystem stores the Entity). Leaves live in one of two
+// trees:
+//  - static: rebuilt top-down with a binned SAH whenever its leaf set
+//    changed, on the next query. Meant for content that does not move.
+//  - dynamic: incremental inserts that pick the cheapest sibling by surface
+//    area. Leaves are stored fattened by kMargin, so small moves only refit.
+// Queries can skip the static tree as a whole, and a frustum query stops
+// testing once a subtree is fully inside. Not thread safe; queries share a
+// traversal stack and may rebuild the static tree.
+class Bvh
+{
+public:
+  static constexpr u32 kNull = ~0u;
+  static constexpr float kMargin = 0.1f;
+
+  // Which trees a query visits
+  enum Filter : u32
+  {
+    Static = 1 << 0,
+    Dynamic = 1 << 1,
+    All = Static | Dynamic
+  };
+
+  // Returns a proxy id, stable until remove()
+  u32 insert(const Aabb& box, u32 userData, bool isStatic = false);
+  void remove(u32 proxy);
+  // Moves a leaf to new bounds. Returns true if the tree was restructured,
+  // false if the box still fit the leaf's fattened one. A static leaf that
+  // moves becomes dynamic.
+  bool refit(u32 proxy, const Aabb& box);
+  void setStatic(u32 proxy, bool isStatic);
+  void clear();
+
+  [[nodiscard]] bool isStatic(u32 proxy) const
+  {
+    return m_nodes[proxy].staticSlot != kNull;
+  }
+  [[nodiscard]] u32 userData(u32 proxy) const
+  {
+    return m_nodes[proxy].userData;
+  }
+  // Stored bounds; fattened for dynamic leaves
+  [[nodiscard]] const Aabb& bounds(u32 proxy) const
+  {
+    return m_nodes[proxy].box;
+  }
+  [[nodiscard]] size_t size() const { return m_leafCount; }
+
+  // fn(u32 userData) for every leaf whose box touches the volume
+  template<typename Fn>
+  void query(const Frustum& frustum, Fn&& fn, u32 filter = All);
+  template<typename Fn>
+  void query(const Aabb& box, Fn&& fn, u32 filter = All);
+  template<typename Fn>
+  void query(const glm::vec3& center, float radius, Fn&& fn, u32 filter = All);
+
+  // fn(u32 userData, float t) for every leaf box the ray enters within
+  // maxDistance, t being the entry distance along `direction` (unit length).
+  // fn returns the new maxDistance, so returning t keeps only closer hits.
+  template<typename Fn>
+  void raycast(const glm::vec3& origin,
+               const glm::vec3& direction,
+               float maxDistance,
+               Fn&& fn,
+               u32 filter = All);
+
+private:
+  struct Node
+  {
+    Aabb box;
+    u32 parent{ kNull };
+    u32 left{ kNull }; // kNull for leaves
+    u32 right{ kNull };
+    u32 userData{ 0 };
+    u32 staticSlot{ kNull }; // Index into m_staticLeaves for static leaves
+
+    [[nodiscard]] bool isLeaf() const { return left == kNull; }
+  };
+
+  u32 allocateNode();
+  void freeNode(u32 node);
+  void insertLeaf(u32 leaf);
+  void removeLeaf(u32 leaf);
+  void addStatic(u32 leaf);
+  void removeStatic(u32 leaf);
+  void rebuildStatic();
+  u32 buildStatic(u32* leaves, size_t count, u32 parent);
+
+  // Visits the trees selected by `filter`. test(box) returns Outside to
+  // skip a subtree, Inside to accept all of it untested, Intersects to
+  // descend.
+  template<typename Test, typename Fn>
+  void traverse(Test&& test, Fn&& fn, u32 filter);
+
+  std::vector<Node> m_nodes;
+  std::vector<u32> m_freeNodes;
+  u32 m_dynamicRoot{ kNull };
+  u32 m_staticRoot{ kNull };
+  std::vector<u32> m_staticLeaves;
+  std::vector<u32> m_staticInternal; // Internal nodes of the static tree
+  bool m_staticDirty{ false };
+  size_t m_leafCount{ 0 };
+
+  // Traversal scratch: node and whether it is already known to be inside
+  std::vector<std::pair<u32, bool>> m_stack;
+};
+
+template<typename Test, typename Fn>
+void
+Bvh::traverse(Test&& test, Fn&& fn, u32 filter)
+{
+  using Containment = Frustum::Containment;
+  if (m_staticDirty) {
+    rebuildStatic();
+  }
+
+  m_stack.clear();
+  if ((filter & Static) && m_staticRoot != kNull) {
+    m_stack.emplace_back(m_staticRoot, false);
+  }
+  if ((filter & Dynamic) && m_dynamicRoot != kNull) {
+    m_stack.emplace_back(m_dynamicRoot, false);
+  }
+  while (!m_stack.empty()) {
+    auto [index, inside] = m_stack.back();
+    m_stack.pop_back();
+    const Node& node = m_nodes[index];
+    if (!inside) {
+      Containment result = test(node.box);
+      if (result == Containment::Outside) {
+        continue;
+      }
+      inside = result == Containment::Inside;
+    }
+    if (node.isLeaf()) {
+      fn(node.userData);
+    } else {
+      m_stack.emplace_back(node.left, inside);
+      m_stack.emplace_back(node.right, inside);
+    }
+  }
+}
+
+template<typename Fn>
+void
+Bvh::query(const Frustum& frustum, Fn&& fn, u32 filter)
+{
+  traverse([&](const Aabb& box) { return frustum.classify(box); }, fn, filter);
+}
+
+template<typename Fn>
+void
+Bvh::query(const Aabb& box, Fn&& fn, u32 filter)
+{
+  using Containment = Frustum::Containment;
+  traverse(
+    [&](const Aabb& node) {
+      if (!box.overlaps(node)) {
+        return Containment::Outside;
+      }
+      return box.contains(node) ? Containment::Inside
+                                : Containment::Intersects;
+    },
+    fn,
+    filter);
+}
+
+template<typename Fn>
+void
+Bvh::query(const glm::vec3& center, float radius, Fn&& fn, u32 filter)
+{
+  using Containment = Frustum::Containment;
+  float radiusSq = radius * radius;
+  traverse(
+    [&](const Aabb& node) {
+      glm::vec3 closest = glm::clamp(center, node.min, node.max);
+      glm::vec3 offset = closest - center;
+      if (glm::dot(offset, offset) > radiusSq) {
+        return Containment::Outside;
+      }
+      // Inside when the farthest corner is within the sphere
+      glm::vec3 far = glm::max(glm::abs(node.min - center),
+                               glm::abs(node.max - center));
+      return glm::dot(far, far) <= radiusSq ? Containment::Inside
+                                            : Containment::Intersects;
+    },
+    fn,
+    filter);
+}
+
+template<typename Fn>
+void
+Bvh::raycast(const glm::vec3& origin,
+             const glm::vec3& direction,
+             float maxDistance,
+             Fn&& fn,
+             u32 filter)
+{
+  if (m_staticDirty) {
+    rebuildStatic();
+  }
+  glm::vec3 invDir = 1.0f / direction;
+
+  // Slab test; returns the entry distance, or a negative value on a miss
+  auto enter = [&](const Aabb& box) {
+    glm::vec3 t0 = (box.min - origin) * invDir;
+    glm::vec3 t1 = (box.max - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float tEnter =
+      std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float tExit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+    return tEnter <= tExit && tEnter <= maxDistance ? tEnter : -1.0f;
+  };
+
+  m_stack.clear();
+  if ((filter & Static) && m_staticRoot != kNull) {
+    m_stack.emplace_back(m_staticRoot, false);
+  }
+  if ((filter & Dynamic) && m_dynamicRoot != kNull) {
+    m_stack.emplace_back(m_dynamicRoot, false);
+  }
+  while (!m_stack.empty()) {
+    u32 index = m_stack.back().first;
+    m_stack.pop_back();
+    const Node& node = m_nodes[index];
+    float t = enter(node.box);
+    if (t < 0.0f) {
+      continue;
+    }
+    if (node.isLeaf()) {
+      maxDistance = fn(node.userData, t);
+      if (maxDistance <= 0.0f) {
+        return;
+      }
+    } else {
+      m_stack.emplace_back(node.left, false);
+      m_stack.emplace_back(node.right, false);
+    }
+  }
+}
+
+#endif // BVH_H_
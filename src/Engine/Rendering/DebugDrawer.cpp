@@ -22,13 +22,6 @@ DebugDrawer::initialize()
 
   auto& device = gfx::GraphicsDevice::getInstance();
 
-  gfx::BufferCreateInfo vboInfo{};
-  vboInfo.size = kInitialCapacity;
-  vboInfo.usage = gfx::BufferUsage::Vertex;
-  vboInfo.initialData = nullptr;
-  m_vbo = device.createBuffer(vboInfo);
-  m_vboCapacity = kInitialCapacity;
-
   constexpr u32 kStride = 6 * sizeof(float);
 
   std::array<gfx::VertexBinding, 1> bindings = { { { 0, kStride, false } } };
@@ -64,12 +57,6 @@ DebugDrawer::shutdown()
     device.destroyVertexArray(m_vao);
     m_vao = {};
   }
-  if (device.isValid(m_vbo)) {
-    device.destroyBuffer(m_vbo);
-    m_vbo = {};
-  }
-
-  m_vboCapacity = 0;
   m_initialized = false;
 #endif
 }
@@ -146,25 +133,18 @@ DebugDrawer::renderAndFlush(gfx::ShaderId shader)
   resources.setBlendFunc(gfx::BlendFactor::SrcAlpha,
                          gfx::BlendFactor::OneMinusSrcAlpha);
 
-  u64 requiredSize = vertexData.size() * sizeof(float);
-
-  if (requiredSize > m_vboCapacity) {
-    device.destroyBuffer(m_vbo);
-    u64 newCapacity = std::max(requiredSize, m_vboCapacity * 2);
-    gfx::BufferCreateInfo vboInfo{};
-    vboInfo.size = newCapacity;
-    vboInfo.usage = gfx::BufferUsage::Vertex;
-    vboInfo.initialData = nullptr;
-    m_vbo = device.createBuffer(vboInfo);
-    m_vboCapacity = newCapacity;
-  }
-
-  device.updateBuffer(m_vbo, 0, vertexData.data(), requiredSize);
+  gfx::StreamAllocation vertices =
+    device.streamUpload(gfx::StreamUsage::Vertex,
+                        vertexData.data(),
+                        vertexData.size() * sizeof(float));
   resources.setLineWidth(1.0f);
 
   u32 vertexCount = static_cast<u32>(vertexData.size() / 6);
-  device.drawVertexArrayDynamic(
-    m_vao, m_vbo, gfx::PrimitiveTopology::Lines, vertexCount);
+  device.drawVertexArrayDynamic(m_vao,
+                                vertices.buffer,
+                                gfx::PrimitiveTopology::Lines,
+                                vertexCount,
+                                vertices.offset);
 
   lines.clear();
 #endif
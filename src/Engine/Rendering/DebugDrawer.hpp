@@ -27,14 +27,9 @@ private:
     glm::vec3 color;
   };
 
-  gfx::VertexArrayId m_vao{};
-  gfx::BufferId m_vbo{};
-  u64 m_vboCapacity{ 0 };
+  gfx::VertexArrayId m_vao{}; // Vertices are streamed each frame
   bool m_initialized{ false };
 
-  static constexpr u64 kInitialCapacity =
-    1000 * 2 * 6 * sizeof(float); // 1000 lines
-
 public:
   std::vector<Line> lines;
 };
@@ -0,0 +1,131 @@
+#include "Frustum.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define FRUSTUM_SSE 1
+#endif
+
+Frustum
+Frustum::fromMatrix(const glm::mat4& viewProj)
+{
+  // glm is column-major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+  auto row = [&](int i) {
+    return glm::vec4(
+      viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+  };
+  glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+
+  Frustum frustum;
+  frustum.planes[Left] = r3 + r0;
+  frustum.planes[Right] = r3 - r0;
+  frustum.planes[Bottom] = r3 + r1;
+  frustum.planes[Top] = r3 - r1;
+  frustum.planes[Near] = r3 + r2;
+  frustum.planes[Far] = r3 - r2;
+  for (glm::vec4& plane : frustum.planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  return frustum;
+}
+
+bool
+Frustum::intersects(const Aabb& box) const
+{
+  glm::vec3 center = box.center();
+  glm::vec3 extents = box.extents();
+  for (const glm::vec4& plane : planes) {
+    glm::vec3 normal(plane);
+    // Distance of the box's most positive corner along the normal
+    float reach = glm::dot(glm::abs(normal), extents);
+    if (glm::dot(normal, center) + plane.w + reach < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Frustum::Containment
+Frustum::classify(const Aabb& box) const
+{
+  glm::vec3 center = box.center();
+  glm::vec3 extents = box.extents();
+  Containment result = Containment::Inside;
+  for (const glm::vec4& plane : planes) {
+    glm::vec3 normal(plane);
+    float distance = glm::dot(normal, center) + plane.w;
+    float reach = glm::dot(glm::abs(normal), extents);
+    if (distance + reach < 0.0f) {
+      return Containment::Outside;
+    }
+    if (distance - reach < 0.0f) {
+      result = Containment::Intersects;
+    }
+  }
+  return result;
+}
+
+bool
+Frustum::intersects(const glm::vec3& center, float radius) const
+{
+  for (const glm::vec4& plane : planes) {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+Frustum::cull(const float* const* bounds, size_t count, u8* visible) const
+{
+  size_t i = 0;
+#ifdef FRUSTUM_SSE
+  // Four boxes per iteration, tested against all six planes
+  // Per plane: normal, distance, then |normal| for the box reach
+  __m128 splat[PlaneCount][7];
+  for (size_t p = 0; p < PlaneCount; ++p) {
+    const glm::vec4& plane = planes[p];
+    splat[p][0] = _mm_set1_ps(plane.x);
+    splat[p][1] = _mm_set1_ps(plane.y);
+    splat[p][2] = _mm_set1_ps(plane.z);
+    splat[p][3] = _mm_set1_ps(plane.w);
+    splat[p][4] = _mm_set1_ps(std::abs(plane.x));
+    splat[p][5] = _mm_set1_ps(std::abs(plane.y));
+    splat[p][6] = _mm_set1_ps(std::abs(plane.z));
+  }
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 allSet = _mm_cmpeq_ps(zero, zero);
+  for (; i + 4 <= count; i += 4) {
+    __m128 cx = _mm_loadu_ps(bounds[CenterX] + i);
+    __m128 cy = _mm_loadu_ps(bounds[CenterY] + i);
+    __m128 cz = _mm_loadu_ps(bounds[CenterZ] + i);
+    __m128 ex = _mm_loadu_ps(bounds[ExtentX] + i);
+    __m128 ey = _mm_loadu_ps(bounds[ExtentY] + i);
+    __m128 ez = _mm_loadu_ps(bounds[ExtentZ] + i);
+
+    __m128 inside = allSet;
+    for (const auto& s : splat) {
+      __m128 dist = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(s[0], cx), _mm_mul_ps(s[1], cy)),
+        _mm_add_ps(_mm_mul_ps(s[2], cz), s[3]));
+      __m128 reach = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(s[4], ex), _mm_mul_ps(s[5], ey)),
+        _mm_mul_ps(s[6], ez));
+      inside =
+        _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, reach), zero));
+    }
+
+    int mask = _mm_movemask_ps(inside);
+    for (size_t k = 0; k < 4; ++k) {
+      visible[i + k] = static_cast<u8>((mask >> k) & 1);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    glm::vec3 center(
+      bounds[CenterX][i], bounds[CenterY][i], bounds[CenterZ][i]);
+    glm::vec3 extents(
+      bounds[ExtentX][i], bounds[ExtentY][i], bounds[ExtentZ][i]);
+    visible[i] = intersects(Aabb{ center - extents, center + extents });
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+#include "Bounds.hpp"
+
+// Six clip planes of a view-projection matrix, normals pointing inwards.
+// Pure math so culling can be tested without a graphics context.
+struct Frustum
+{
+  enum Plane : u32
+  {
+    Left,
+    Right,
+    Bottom,
+    Top,
+    Near,
+    Far,
+    PlaneCount
+  };
+
+  // Float streams cull() reads, one per box field, all the same length
+  enum BoundsStream : u32
+  {
+    CenterX,
+    CenterY,
+    CenterZ,
+    ExtentX,
+    ExtentY,
+    ExtentZ,
+    BoundsStreamCount
+  };
+
+  enum class Containment : u8
+  {
+    Outside,
+    Intersects,
+    Inside
+  };
+
+  // xyz = normalized plane normal, w = distance; inside when dot >= 0
+  std::array<glm::vec4, PlaneCount> planes{};
+
+  // Gribb/Hartmann extraction for OpenGL clip space (-w <= z <= w)
+  static Frustum fromMatrix(const glm::mat4& viewProj);
+
+  // Makes `plane` accept everything, e.g. the near plane of a shadow volume
+  // so casters between the light and the volume are kept
+  void removePlane(Plane plane) { planes[plane] = glm::vec4(0, 0, 0, 1); }
+
+  [[nodiscard]] bool intersects(const Aabb& box) const;
+  // Like intersects(), but also tells boxes fully inside apart so callers
+  // can accept everything under them without further tests
+  [[nodiscard]] Containment classify(const Aabb& box) const;
+  [[nodiscard]] bool intersects(const glm::vec3& center, float radius) const;
+
+  // Batch test of `count` world-space boxes given as BoundsStream streams.
+  // Writes 1 to visible[i] for boxes touching the frustum, 0 otherwise.
+  // Conservative: boxes near a frustum corner may be reported visible.
+  void cull(const float* const* bounds, size_t count, u8* visible) const;
+
+  bool operator==(const Frustum&) const = default;
+};
+
+#endif // FRUSTUM_H_
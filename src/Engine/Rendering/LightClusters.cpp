@@ -0,0 +1,224 @@
+#include "LightClusters.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define LIGHTCLUSTERS_SSE 1
+#endif
+
+namespace {
+
+u32
+tileOf(float ndc, u32 tiles)
+{
+  float tile = std::floor((ndc * 0.5f + 0.5f) * static_cast<float>(tiles));
+  return static_cast<u32>(
+    std::clamp(tile, 0.0f, static_cast<float>(tiles - 1)));
+}
+
+} // namespace
+
+void
+LightClusters::setProjection(const glm::mat4& proj, float zNear, float zFar)
+{
+  if (proj == m_proj && zNear == m_near && zFar == m_far &&
+      !m_clusters.empty()) {
+    return;
+  }
+  m_proj = proj;
+  m_near = zNear;
+  m_far = zFar;
+
+  // Slice k starts at near * (far / near)^(k / kSlices)
+  float logRatio = std::log(zFar / zNear);
+  m_sliceScale = static_cast<float>(kSlices) / logRatio;
+  m_sliceBias = -static_cast<float>(kSlices) * std::log(zNear) / logRatio;
+
+  for (std::vector<float>& stream : m_bounds) {
+    stream.resize(kClusterCount);
+  }
+  m_clusters.assign(kClusterCount, {});
+
+  // A view-space point at distance d projects to ndc = p[0][0] * x / d -
+  // p[2][0] (likewise y), so a tile edge at depth d sits at
+  // x = (ndc + p[2][0]) * d / p[0][0]
+  auto edge = [](u32 tile, u32 tiles) {
+    return -1.0f + 2.0f * static_cast<float>(tile) / static_cast<float>(tiles);
+  };
+  for (u32 slice = 0; slice <= kSlices; ++slice) {
+    m_sliceDepths[slice] =
+      zNear * std::pow(zFar / zNear, static_cast<float>(slice) / kSlices);
+  }
+  for (u32 slice = 0; slice < kSlices; ++slice) {
+    float dNear = m_sliceDepths[slice];
+    float dFar = m_sliceDepths[slice + 1];
+    for (u32 y = 0; y < kTilesY; ++y) {
+      float ndcY0 = edge(y, kTilesY) + proj[2][1];
+      float ndcY1 = edge(y + 1, kTilesY) + proj[2][1];
+      for (u32 x = 0; x < kTilesX; ++x) {
+        float ndcX0 = edge(x, kTilesX) + proj[2][0];
+        float ndcX1 = edge(x + 1, kTilesX) + proj[2][0];
+        Aabb box;
+        for (float d : { dNear, dFar }) {
+          float toX = d / proj[0][0];
+          float toY = d / proj[1][1];
+          box.expand(glm::vec3(ndcX0 * toX, ndcY0 * toY, -d));
+          box.expand(glm::vec3(ndcX1 * toX, ndcY1 * toY, -d));
+        }
+        u32 c = clusterIndex(x, y, slice);
+        m_bounds[MinX][c] = box.min.x;
+        m_bounds[MinY][c] = box.min.y;
+        m_bounds[MinZ][c] = box.min.z;
+        m_bounds[MaxX][c] = box.max.x;
+        m_bounds[MaxY][c] = box.max.y;
+        m_bounds[MaxZ][c] = box.max.z;
+      }
+    }
+  }
+}
+
+u32
+LightClusters::sliceOf(float depth) const
+{
+  if (depth <= m_near) {
+    return 0;
+  }
+  float slice = std::log(depth) * m_sliceScale + m_sliceBias;
+  return std::min(static_cast<u32>(std::max(slice, 0.0f)), kSlices - 1);
+}
+
+Aabb
+LightClusters::getBounds(u32 cluster) const
+{
+  return { { m_bounds[MinX][cluster],
+             m_bounds[MinY][cluster],
+             m_bounds[MinZ][cluster] },
+           { m_bounds[MaxX][cluster],
+             m_bounds[MaxY][cluster],
+             m_bounds[MaxZ][cluster] } };
+}
+
+void
+LightClusters::binRow(u32 light,
+                      const glm::vec4& sphere,
+                      u32 y,
+                      u32 slice,
+                      u32 x0,
+                      u32 x1)
+{
+  u32 row = clusterIndex(0, y, slice);
+  float radiusSq = sphere.w * sphere.w;
+  u32 x = x0;
+#ifdef LIGHTCLUSTERS_SSE
+  // Four clusters per iteration: squared distance from the sphere's center
+  // to each box against its squared radius
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 cx = _mm_set1_ps(sphere.x);
+  const __m128 cy = _mm_set1_ps(sphere.y);
+  const __m128 cz = _mm_set1_ps(sphere.z);
+  const __m128 r2 = _mm_set1_ps(radiusSq);
+  auto axis = [&](BoundsStream min, BoundsStream max, __m128 center, u32 c) {
+    __m128 below = _mm_sub_ps(_mm_loadu_ps(m_bounds[min].data() + c), center);
+    __m128 above = _mm_sub_ps(center, _mm_loadu_ps(m_bounds[max].data() + c));
+    __m128 d = _mm_max_ps(_mm_max_ps(below, above), zero);
+    return _mm_mul_ps(d, d);
+  };
+  for (; x + 4 <= x1 + 1; x += 4) {
+    u32 c = row + x;
+    __m128 distSq = _mm_add_ps(
+      _mm_add_ps(axis(MinX, MaxX, cx, c), axis(MinY, MaxY, cy, c)),
+      axis(MinZ, MaxZ, cz, c));
+    int mask = _mm_movemask_ps(_mm_cmple_ps(distSq, r2));
+    for (u32 k = 0; k < 4; ++k) {
+      if ((mask >> k) & 1) {
+        m_pairs.push_back({ c + k, light });
+      }
+    }
+  }
+#endif
+  for (; x <= x1; ++x) {
+    u32 c = row + x;
+    float distSq = 0.0f;
+    for (u32 a = 0; a < 3; ++a) {
+      float d = std::max({ m_bounds[MinX + a][c] - sphere[a],
+                           sphere[a] - m_bounds[MaxX + a][c],
+                           0.0f });
+      distSq += d * d;
+    }
+    if (distSq <= radiusSq) {
+      m_pairs.push_back({ c, light });
+    }
+  }
+}
+
+void
+LightClusters::build(const float* const* spheres, size_t count)
+{
+  count = std::min<size_t>(count, kMaxLights);
+  m_pairs.clear();
+  for (u32 i = 0; i < count; ++i) {
+    glm::vec4 sphere(spheres[CenterX][i],
+                     spheres[CenterY][i],
+                     spheres[CenterZ][i],
+                     spheres[Radius][i]);
+    float depth = -sphere.z;
+    if (depth + sphere.w < m_near || depth - sphere.w > m_far) {
+      continue;
+    }
+    float nearest = std::max(depth - sphere.w, m_near);
+    float farthest = std::min(depth + sphere.w, m_far);
+
+    u32 lastSlice = sliceOf(farthest);
+    for (u32 slice = sliceOf(nearest); slice <= lastSlice; ++slice) {
+      // The sphere's cross-section within this slice's depths, as a box
+      float d0 = std::max(nearest, m_sliceDepths[slice]);
+      float d1 = std::min(farthest, m_sliceDepths[slice + 1]);
+      float dz = std::max({ d0 - depth, depth - d1, 0.0f });
+      float radius = std::sqrt(std::max(sphere.w * sphere.w - dz * dz, 0.0f));
+
+      // Tiles under that box's projection. x / d over it is smallest at its
+      // lowest x, at one of the two depths; likewise largest at its highest
+      auto tiles = [&](float center,
+                       float scale,
+                       float offset,
+                       u32 tileCount,
+                       u32& t0,
+                       u32& t1) {
+        float lo = center - radius;
+        float hi = center + radius;
+        float ndc0 = scale * std::min(lo / d0, lo / d1) - offset;
+        float ndc1 = scale * std::max(hi / d0, hi / d1) - offset;
+        t0 = tileOf(ndc0, tileCount);
+        t1 = tileOf(ndc1, tileCount);
+        return ndc1 >= -1.0f && ndc0 <= 1.0f;
+      };
+      u32 x0, x1, y0, y1;
+      if (!tiles(sphere.x, m_proj[0][0], m_proj[2][0], kTilesX, x0, x1) ||
+          !tiles(sphere.y, m_proj[1][1], m_proj[2][1], kTilesY, y0, y1)) {
+        continue;
+      }
+      for (u32 y = y0; y <= y1; ++y) {
+        binRow(i, sphere, y, slice, x0, x1);
+      }
+    }
+  }
+
+  // Counting sort by cluster; pairs come in light order, so every cluster's
+  // lights stay ascending
+  m_clusters.assign(kClusterCount, {});
+  for (const Pair& pair : m_pairs) {
+    m_clusters[pair.cluster].count++;
+  }
+  u32 offset = 0;
+  for (Cluster& cluster : m_clusters) {
+    cluster.offset = offset;
+    offset += cluster.count;
+    cluster.count = 0;
+  }
+  m_indices.resize(offset);
+  for (const Pair& pair : m_pairs) {
+    Cluster& cluster = m_clusters[pair.cluster];
+    m_indices[cluster.offset + cluster.count++] = static_cast<u16>(pair.light);
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef LIGHTCLUSTERS_H_
+#define LIGHTCLUSTERS_H_
+
+#include "Bounds.hpp"
+#include <array>
+#include <vector>
+
+// Froxel grid over a perspective view: kTilesX x kTilesY screen tiles, each
+// cut into kSlices depth slices spaced exponentially between the near and
+// far planes so clusters stay roughly as deep as they are wide. build()
+// bins point lights into it, giving every cluster the list of lights that
+// can reach it; a pixel then shades only its own cluster's lights.
+// Pure math so binning can be tested without a graphics context.
+class LightClusters
+{
+public:
+  static constexpr u32 kTilesX = 16;
+  static constexpr u32 kTilesY = 9;
+  static constexpr u32 kSlices = 24;
+  static constexpr u32 kClusterCount = kTilesX * kTilesY * kSlices;
+  // Light indices are stored as u16
+  static constexpr u32 kMaxLights = 1u << 16;
+
+  // View-space sphere streams build() reads, one per field, all the same
+  // length
+  enum SphereStream : u32
+  {
+    CenterX,
+    CenterY,
+    CenterZ,
+    Radius,
+    SphereStreamCount
+  };
+
+  // A cluster's range in getLightIndices()
+  struct Cluster
+  {
+    u32 offset{ 0 };
+    u32 count{ 0 };
+  };
+
+  // Recomputes the cluster bounds for an OpenGL perspective projection;
+  // does nothing if neither changed
+  void setProjection(const glm::mat4& proj, float zNear, float zFar);
+
+  // Bins `count` view-space spheres (the camera looks down -Z) given as
+  // SphereStream streams. Conservative: a cluster may list a light that
+  // just misses it, never the other way round. At most kMaxLights are
+  // binned.
+  void build(const float* const* spheres, size_t count);
+
+  [[nodiscard]] const std::vector<Cluster>& getClusters() const
+  {
+    return m_clusters;
+  }
+  // Every cluster's light indices, ascending within a cluster
+  [[nodiscard]] const std::vector<u16>& getLightIndices() const
+  {
+    return m_indices;
+  }
+
+  [[nodiscard]] static constexpr u32 clusterIndex(u32 x, u32 y, u32 slice)
+  {
+    return (slice * kTilesY + y) * kTilesX + x;
+  }
+  // Slice holding a view-space distance in front of the camera, clamped to
+  // the grid. floor(log(depth) * scale + bias), which shaders evaluate from
+  // getSliceScale() and getSliceBias().
+  [[nodiscard]] u32 sliceOf(float depth) const;
+  [[nodiscard]] float getSliceScale() const { return m_sliceScale; }
+  [[nodiscard]] float getSliceBias() const { return m_sliceBias; }
+
+  // View-space box around a cluster's frustum piece
+  [[nodiscard]] Aabb getBounds(u32 cluster) const;
+
+private:
+  enum BoundsStream : u32
+  {
+    MinX,
+    MinY,
+    MinZ,
+    MaxX,
+    MaxY,
+    MaxZ,
+    BoundsStreamCount
+  };
+
+  // Appends every cluster of row (y, slice), tiles [x0, x1], whose box the
+  // sphere touches to m_pairs
+  void binRow(u32 light,
+              const glm::vec4& sphere,
+              u32 y,
+              u32 slice,
+              u32 x0,
+              u32 x1);
+
+  glm::mat4 m_proj{ 0.0f };
+  float m_near{ 0.0f };
+  float m_far{ 0.0f };
+  float m_sliceScale{ 0.0f };
+  float m_sliceBias{ 0.0f };
+  std::array<float, kSlices + 1> m_sliceDepths{}; // Where each slice starts
+
+  // Cluster boxes by clusterIndex(), so a row of tiles is contiguous
+  std::array<std::vector<float>, BoundsStreamCount> m_bounds;
+
+  struct Pair
+  {
+    u32 cluster;
+    u32 light;
+  };
+  std::vector<Pair> m_pairs; // Scratch, in light order
+  std::vector<Cluster> m_clusters;
+  std::vector<u16> m_indices;
+};
+
+#endif // LIGHTCLUSTERS_H_
@@ -2,33 +2,29 @@
 
 #include <Graphics/CommandBuffer.hpp>
 #include <Graphics/RenderResources.hpp>
-#include <Graphics/UBOStructs.hpp>
+#include <cassert>
+#include <cstring>
+
+Material::~Material()
+{
+  if (m_parameterSlot != gfx::MaterialParameterBuffer::kInvalidSlot) {
+    gfx::RenderResources::getInstance().getMaterialParameters().release(
+      m_parameterSlot);
+  }
+}
 
 void
 Material::bind(gfx::ShaderId /* shader */)
 {
   auto& resources = gfx::RenderResources::getInstance();
 
-  // Populate MaterialUBO
-  auto& matUBO = resources.getMaterialUBO();
-  matUBO.baseColorFactor = glm::vec4(m_baseColorFactor, 1.0f);
-  matUBO.emissiveFactor = glm::vec4(m_emissiveFactor, 0.0f);
-  matUBO.pbrFactors =
-    glm::vec4(m_roughnessFactor, m_metallicFactor, m_alphaCutoff, 0.0f);
-
-  i32 alphaModeInt = (m_alphaMode == "BLEND")  ? 0
-                     : (m_alphaMode == "MASK") ? 1
-                                               : 2;
-  matUBO.materialConfig = glm::ivec4(m_material, alphaModeInt, 0, 0);
-
+  resources.getMaterialUBO() = parameters();
   resources.flushMaterialUBO();
 
-  // Texture binding (already abstracted)
-  resources.bindTexture(0, m_baseColorTexture);
-  resources.bindTexture(1, m_metallicRoughnessTexture);
-  resources.bindTexture(2, m_emissiveTexture);
-  resources.bindTexture(3, m_occlusionTexture);
-  resources.bindTexture(4, m_normalTexture);
+  resolveIfStale();
+  for (u32 slot = 0; slot < kTextureCount; slot++) {
+    resources.bindTexture(slot, m_textureIds[slot]);
+  }
 
   // Render state (already abstracted)
   if (m_doubleSided) {
@@ -37,11 +33,11 @@ Material::bind(gfx::ShaderId /* shader */)
     resources.setCullMode(gfx::CullMode::Back);
   }
 
-  if (m_alphaMode == "BLEND") {
+  if (m_alphaMode == AlphaMode::Blend) {
     resources.setBlendEnabled(true);
     resources.setBlendFunc(gfx::BlendFactor::SrcAlpha,
                            gfx::BlendFactor::OneMinusSrcAlpha);
-  } else if (m_alphaMode == "OPAQUE") {
+  } else if (m_alphaMode == AlphaMode::Opaque) {
     resources.setBlendEnabled(false);
     resources.setColorMask(true, true, true, true);
     resources.setBlendColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -52,32 +48,38 @@ Material::bind(gfx::ShaderId /* shader */)
 }
 
 void
-Material::recordBind(gfx::CommandBuffer& cmd, gfx::SamplerId sampler)
+Material::prepareBind()
 {
-  // Build MaterialUBO data locally and record it in the command stream
-  // This ensures each material's data is stored inline and flushed at execution
-  // time
-  gfx::MaterialUBO matUBO{};
-  matUBO.baseColorFactor = glm::vec4(m_baseColorFactor, 1.0f);
-  matUBO.emissiveFactor = glm::vec4(m_emissiveFactor, 0.0f);
-  matUBO.pbrFactors =
-    glm::vec4(m_roughnessFactor, m_metallicFactor, m_alphaCutoff, 0.0f);
-
-  i32 alphaModeInt = (m_alphaMode == "BLEND")  ? 0
-                     : (m_alphaMode == "MASK") ? 1
-                                               : 2;
-  matUBO.materialConfig = glm::ivec4(m_material, alphaModeInt, 0, 0);
+  auto& slots = gfx::RenderResources::getInstance().getMaterialParameters();
+  gfx::MaterialUBO params = parameters();
+  bool firstBind =
+    m_parameterSlot == gfx::MaterialParameterBuffer::kInvalidSlot;
+  if (firstBind) {
+    m_parameterSlot = slots.allocate();
+  }
+  // Parameters are public fields, so changes are found by comparison
+  if (firstBind ||
+      std::memcmp(&params, &m_writtenParameters, sizeof(params)) != 0) {
+    slots.write(m_parameterSlot, params);
+    m_writtenParameters = params;
+  }
+  resolveIfStale();
+}
 
-  // Record UBO update command (stores data in command stream for deferred
-  // execution)
-  cmd.updateMaterialUBO(matUBO);
+void
+Material::recordBind(gfx::CommandBuffer& cmd, gfx::SamplerId sampler) const
+{
+  assert(m_parameterSlot != gfx::MaterialParameterBuffer::kInvalidSlot &&
+         "recordBind() without prepareBind()");
+  gfx::MaterialParameterBuffer::Range range =
+    gfx::RenderResources::getInstance().getMaterialParameters().range(
+      m_parameterSlot);
+  cmd.bindUniformBuffer(static_cast<u32>(gfx::UBOBinding::Material),
+                        range.buffer,
+                        range.offset,
+                        sizeof(gfx::MaterialUBO));
 
-  // Record texture bindings by name
-  cmd.bindTextureByName(0, m_baseColorTexture, sampler);
-  cmd.bindTextureByName(1, m_metallicRoughnessTexture, sampler);
-  cmd.bindTextureByName(2, m_emissiveTexture, sampler);
-  cmd.bindTextureByName(3, m_occlusionTexture, sampler);
-  cmd.bindTextureByName(4, m_normalTexture, sampler);
+  cmd.bindTextures(0, m_textureIds, sampler);
 
   // Record render state
   if (m_doubleSided) {
@@ -91,3 +93,51 @@ Material::recordBind(gfx::CommandBuffer& cmd, gfx::SamplerId sampler)
   // off.
   cmd.setBlendEnabled(false);
 }
+
+gfx::MaterialUBO
+Material::parameters() const
+{
+  gfx::MaterialUBO params{};
+  params.baseColorFactor = glm::vec4(m_baseColorFactor, 1.0f);
+  params.emissiveFactor = glm::vec4(m_emissiveFactor, 0.0f);
+  params.pbrFactors =
+    glm::vec4(m_roughnessFactor, m_metallicFactor, m_alphaCutoff, 0.0f);
+  params.materialConfig =
+    glm::ivec4(m_material, static_cast<i32>(m_alphaMode), 0, 0);
+  return params;
+}
+
+void
+Material::resolveTextures()
+{
+  auto& resources = gfx::RenderResources::getInstance();
+  m_textureIds = { resources.findTexture(m_baseColorTexture),
+                   resources.findTexture(m_metallicRoughnessTexture),
+                   resources.findTexture(m_emissiveTexture),
+                   resources.findTexture(m_occlusionTexture),
+                   resources.findTexture(m_normalTexture) };
+  m_resolvedGeneration = resources.getTextureGeneration();
+}
+
+void
+Material::resolveIfStale()
+{
+  // Handles are replaced when a texture is recreated, and a name may be
+  // created after the material was resolved
+  if (m_resolvedGeneration !=
+      gfx::RenderResources::getInstance().getTextureGeneration()) {
+    resolveTextures();
+  }
+}
+
+Material::AlphaMode
+Material::parseAlphaMode(std::string_view mode)
+{
+  if (mode == "BLEND") {
+    return AlphaMode::Blend;
+  }
+  if (mode == "MASK") {
+    return AlphaMode::Mask;
+  }
+  return AlphaMode::Opaque;
+}
@@ -2,6 +2,9 @@
 #define MATERIAL_H_
 
 #include <Graphics/Handle.hpp>
+#include <Graphics/UBOStructs.hpp>
+#include <array>
+#include <string_view>
 
 namespace gfx {
 class CommandBuffer;
@@ -10,12 +13,35 @@ class CommandBuffer;
 class Material
 {
 public:
+  // Values match materialConfig.y in the shaders
+  enum class AlphaMode : u8
+  {
+    Blend,
+    Mask,
+    Opaque
+  };
+
   Material() = default;
-  ~Material() = default;
+  ~Material();
+  // Owns a MaterialParameterBuffer slot
+  Material(const Material&) = delete;
+  Material& operator=(const Material&) = delete;
   void bind(gfx::ShaderId shader);
+  /// Main-thread half of recordBind(): assigns this material's persistent
+  /// MaterialParameterBuffer slot, rewrites it when the parameters have
+  /// changed and re-resolves stale textures. Call once per frame before
+  /// recording binds.
+  void prepareBind();
   /// Record material binding commands (textures, UBO, render state) into
-  /// CommandBuffer
-  void recordBind(gfx::CommandBuffer& cmd, gfx::SamplerId sampler);
+  /// CommandBuffer. Only encodes what prepareBind() left, so it may run on
+  /// a worker thread.
+  void recordBind(gfx::CommandBuffer& cmd, gfx::SamplerId sampler) const;
+  /// Look up the texture names below once, so binding only deals in handles.
+  /// Call after changing them; bind() and prepareBind() also re-resolve when
+  /// RenderResources' textures have changed since.
+  void resolveTextures();
+  /// glTF alphaMode string; anything unrecognized is opaque
+  [[nodiscard]] static AlphaMode parseAlphaMode(std::string_view mode);
   i32 m_material{ 0 };
   glm::vec3 m_emissiveFactor = glm::vec3(0.0f);
   glm::vec3 m_baseColorFactor = glm::vec3(1.0f);
@@ -23,7 +49,7 @@ public:
   float m_metallicFactor = 1.0f;
   bool m_doubleSided{ false };
   float m_alphaCutoff{ 0.5 };
-  std::string m_alphaMode{ "OPAQUE" };
+  AlphaMode m_alphaMode{ AlphaMode::Opaque };
   std::vector<std::string> m_textures;
 
   std::string m_baseColorTexture{ "black_default" };
@@ -31,6 +57,19 @@ public:
   std::string m_emissiveTexture{ "black_default" };
   std::string m_occlusionTexture{ "black_default" };
   std::string m_normalTexture{ "black_default" };
+
+private:
+  // Texture slots 0-4, in the order of the names above
+  static constexpr u32 kTextureCount = 5;
+
+  void resolveIfStale();
+  [[nodiscard]] gfx::MaterialUBO parameters() const;
+
+  std::array<gfx::TextureId, kTextureCount> m_textureIds{};
+  u32 m_resolvedGeneration{ ~0u };
+
+  u32 m_parameterSlot{ ~0u };
+  gfx::MaterialUBO m_writtenParameters{}; // Last contents of the slot
 };
 
 #endif // MATERIAL_H_
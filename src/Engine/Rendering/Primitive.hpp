@@ -2,6 +2,7 @@
 #define PRIMITIVE_H_
 
 #include <Graphics/GraphicsDevice.hpp>
+#include <Rendering/Bounds.hpp>
 
 namespace gfx {
 class CommandBuffer;
@@ -25,6 +26,9 @@ public:
 
   u32 m_count{ 0 };
   u32 m_offset{ 0 };
+
+  // Local-space bounds of the vertices, filled in at import
+  Aabb m_bounds;
 };
 
 #endif // PRIMITIVE_H_
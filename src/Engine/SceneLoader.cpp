@@ -61,7 +61,7 @@ SceneLoader::saveScene(const char* file)
     out << YAML::Key << "components" << YAML::Value << YAML::BeginSeq;
 
     // Serialize each component of the entity
-    auto posComp = ecsMan.getComponent<PositionComponent>(en);
+    auto posComp = ecsMan.readComponent<PositionComponent>(en);
     if (posComp) {
       out << YAML::BeginMap;
       out << YAML::Key << "type" << YAML::Value << "Pos";
@@ -233,7 +233,7 @@ void
 SceneLoader::addPositionComponent(Entity entity, const YAML::Node& component)
 {
   auto& ecsMan = ECSManager::getInstance();
-  auto& posComp = ecsMan.emplaceComponent<PositionComponent>(entity);
+  PositionComponent posComp;
   if (component["position"]) {
     auto x = component["position"][0].as<float>();
     auto y = component["position"][1].as<float>();
@@ -252,6 +252,7 @@ SceneLoader::addPositionComponent(Entity entity, const YAML::Node& component)
     auto z = component["rotation"][2].as<float>();
     posComp.rotation = glm::quat(glm::vec3(x, y, z));
   }
+  ecsMan.emplaceComponent<PositionComponent>(entity, posComp);
 }
 
 void
@@ -86,11 +86,41 @@ using u8 = std::uint8_t;
 using i8 = std::int8_t;
 
 constexpr std::size_t MAX_COMPONENTS = 32;
-constexpr std::size_t MAX_ENTITIES = 1000;
-using ComponentType = std::type_index;
-using Entity = std::size_t;
 using Signature = std::bitset<MAX_COMPONENTS>;
 
+// Entity handles are 32 bits so they cross the C API unchanged: the low bits
+// index per-entity storage, the high bits hold a generation that is bumped
+// whenever the index is recycled, so stale handles can be detected.
+using Entity = u32;
+constexpr u32 ENTITY_INDEX_BITS = 20;
+constexpr u32 ENTITY_GENERATION_BITS = 32 - ENTITY_INDEX_BITS;
+constexpr u32 ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+constexpr u32 ENTITY_GENERATION_MASK = (1u << ENTITY_GENERATION_BITS) - 1;
+
+// Index 0 is reserved as the invalid entity
+constexpr std::size_t MAX_ENTITIES = ENTITY_INDEX_MASK;
+
+constexpr u32
+entityIndex(Entity entity)
+{
+  return entity & ENTITY_INDEX_MASK;
+}
+
+// The 12-bit generation wraps after 4096 reuses of one index, after which a
+// handle that stale matches the index's current occupant again
+constexpr u32
+entityGeneration(Entity entity)
+{
+  return entity >> ENTITY_INDEX_BITS;
+}
+
+constexpr Entity
+makeEntity(u32 index, u32 generation)
+{
+  return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) |
+         (index & ENTITY_INDEX_MASK);
+}
+
 // Undef int to only allow the ones defined here
 // #define int undefined
 
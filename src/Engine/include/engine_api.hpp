@@ -83,6 +83,11 @@ extern "C"
                        float* outZ,
                        float* outW);
   void SetRotationQuat(unsigned int entity, float x, float y, float z, float w);
+  void SetParent(unsigned int child, unsigned int parent);
+  void GetWorldPosition(unsigned int entity,
+                        float* outX,
+                        float* outY,
+                        float* outZ);
 
   // Camera API
   void SetCameraFov(unsigned int entity, float fov);
@@ -1,9 +1,35 @@
 // #include <Game.hpp>
 #include <Core.hpp>
+#include <SceneLoader.hpp>
+#include <cstdlib>
+#include <string_view>
 
 static void mainLoop() { Core::getInstance().update(); }
 
-auto main(int /* argc */, char * /* argv */[]) -> int {
+#ifndef EMSCRIPTEN
+// --headless <frames> [scene.yaml]: renders that many frames of the scene on
+// the Null graphics backend, without a window, for profiling and CI
+static int runHeadless(int argc, char *argv[]) {
+  int frames = argc > 2 ? std::atoi(argv[2]) : 1;
+  if (!Core::getInstance().initializeHeadless()) {
+    return 1;
+  }
+  if (argc > 3) {
+    SceneLoader::getInstance().init(argv[3]);
+  }
+  for (int i = 0; i < frames; ++i) {
+    mainLoop();
+  }
+  return 0;
+}
+#endif
+
+auto main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) -> int {
+#ifndef EMSCRIPTEN
+  if (argc > 1 && std::string_view(argv[1]) == "--headless") {
+    return runHeadless(argc, argv);
+  }
+#endif
   if (Core::getInstance().initialize()) {
 #ifdef EMSCRIPTEN
     emscripten_set_main_loop(&mainLoop, 0, 1);
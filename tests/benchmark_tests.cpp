@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+
+#include "Core.hpp"
+#include "ECS/Components/AnimationComponent.hpp"
+#include "ECS/Components/CameraComponent.hpp"
+#include "ECS/Components/GraphicsComponent.hpp"
+#include "ECS/Components/PositionComponent.hpp"
+#include "ECS/ECSManager.hpp"
+#include "ECS/SoAComponentPool.hpp"
+#include "ECS/Systems/CameraSystem.hpp"
+#include "Graphics/Backends/Null/Device.hpp"
+#include "Objects/Cube.hpp"
+#include "ResourceManager.hpp"
+#include "Rendering/Bvh.hpp"
+#include "Rendering/LightClusters.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Micro-benchmarks for engine hot paths. They report timings rather than
+// assert on them, so they stay stable across machines and build types; the
+// assertions only check that both variants computed the same thing.
+class BenchmarkTest : public ::testing::Test
+{
+protected:
+  void SetUp() override { manager = &ECSManager::getInstance(); }
+
+  void TearDown() override { manager->reset(); }
+
+  // Runs fn `iterations` times and returns the mean time per call in ns
+  template<typename Fn>
+  static double measure(int iterations, Fn&& fn)
+  {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      fn();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           iterations;
+  }
+
+  static void report(const char* name, double baselineNs, double currentNs)
+  {
+    std::printf("[ BENCH    ] %-32s baseline %10.1f ns  current %10.1f ns  "
+                "(%.2fx)\n",
+                name,
+                baselineNs,
+                currentNs,
+                baselineNs / currentNs);
+  }
+
+  ECSManager* manager;
+};
+
+TEST_F(BenchmarkTest, GetComponentTypeLookup)
+{
+  const int NUM_ENTITIES = 10000;
+  const int ITERATIONS = 50;
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < NUM_ENTITIES; ++i) {
+    Entity entity = manager->createEntity("Bench");
+    manager->emplaceComponent<PositionComponent>(entity)->position.x =
+      static_cast<float>(i);
+    entities.push_back(entity);
+  }
+
+  // Baseline: the previous lookup, a type_index hashed into an unordered_map
+  // (find, then operator[]), done once by hasComponent and once more by
+  // getComponent before reaching the pool
+  std::unordered_map<std::type_index, size_t> typeToIndex;
+  typeToIndex[typeid(AnimationComponent)] = 0;
+  auto* pool = manager->getPool<PositionComponent>();
+  auto legacyTypeID = [&]() {
+    std::type_index type = typeid(PositionComponent);
+    if (typeToIndex.find(type) == typeToIndex.end()) {
+      typeToIndex.insert({ type, typeToIndex.size() });
+    }
+    return typeToIndex[type];
+  };
+  auto legacyGet = [&](Entity entity) -> ComponentRef<PositionComponent> {
+    if (legacyTypeID() >= MAX_COMPONENTS || legacyTypeID() >= MAX_COMPONENTS) {
+      return {};
+    }
+    return pool->get(entity);
+  };
+
+  float legacySum = 0.0f;
+  double legacyNs = measure(ITERATIONS, [&] {
+    for (Entity entity : entities) {
+      legacySum += legacyGet(entity)->position.x;
+    }
+  });
+
+  float sum = 0.0f;
+  double currentNs = measure(ITERATIONS, [&] {
+    for (Entity entity : entities) {
+      sum += manager->getComponent<PositionComponent>(entity)->position.x;
+    }
+  });
+
+  EXPECT_FLOAT_EQ(sum, legacySum);
+  report("getComponent (per entity)",
+         legacyNs / NUM_ENTITIES,
+         currentNs / NUM_ENTITIES);
+}
+
+TEST_F(BenchmarkTest, TransformUpdateAoSvsSoA)
+{
+  using Layout = SoALayout<PositionComponent>;
+  const int NUM_TRANSFORMS = 100000;
+  const int ITERATIONS = 20;
+  const glm::vec3 velocity(0.01f, 0.02f, -0.01f);
+  const glm::quat spin =
+    glm::angleAxis(glm::radians(0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+  // Baseline: array of PositionComponent structs
+  std::vector<PositionComponent> aos(NUM_TRANSFORMS);
+  SoAComponentPool<PositionComponent> soa;
+  for (int i = 0; i < NUM_TRANSFORMS; ++i) {
+    aos[i].position = glm::vec3(static_cast<float>(i), 0.0f, 0.0f);
+    soa.emplace(makeEntity(i + 1, 0), aos[i]);
+  }
+
+  double aosNs = measure(ITERATIONS, [&] {
+    for (PositionComponent& t : aos) {
+      t.position += velocity;
+      t.rotation = spin * t.rotation;
+    }
+  });
+
+  // Same update on float streams, padded so the loops need no scalar tail
+  double soaNs = measure(ITERATIONS, [&] {
+    size_t n = soa.paddedSize();
+    float* px = soa.paddedStream(Layout::PosX).data();
+    float* py = soa.paddedStream(Layout::PosY).data();
+    float* pz = soa.paddedStream(Layout::PosZ).data();
+    float* rx = soa.paddedStream(Layout::RotX).data();
+    float* ry = soa.paddedStream(Layout::RotY).data();
+    float* rz = soa.paddedStream(Layout::RotZ).data();
+    float* rw = soa.paddedStream(Layout::RotW).data();
+    for (size_t i = 0; i < n; ++i) {
+      px[i] += velocity.x;
+      py[i] += velocity.y;
+      pz[i] += velocity.z;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      float x = rx[i], y = ry[i], z = rz[i], w = rw[i];
+      rw[i] = spin.w * w - spin.x * x - spin.y * y - spin.z * z;
+      rx[i] = spin.w * x + spin.x * w + spin.y * z - spin.z * y;
+      ry[i] = spin.w * y - spin.x * z + spin.y * w + spin.z * x;
+      rz[i] = spin.w * z + spin.x * y - spin.y * x + spin.z * w;
+    }
+  });
+
+  for (int i = 0; i < NUM_TRANSFORMS; i += 9973) {
+    PositionComponent t = *soa.at(i);
+    EXPECT_NEAR(t.position.x, aos[i].position.x, 1e-3f);
+    EXPECT_NEAR(t.position.z, aos[i].position.z, 1e-3f);
+    EXPECT_NEAR(t.rotation.y, aos[i].rotation.y, 1e-4f);
+    EXPECT_NEAR(t.rotation.w, aos[i].rotation.w, 1e-4f);
+  }
+  report("transform update (per entity)",
+         aosNs / NUM_TRANSFORMS,
+         soaNs / NUM_TRANSFORMS);
+}
+
+TEST_F(BenchmarkTest, SceneBvhFrustumQuery)
+{
+  const int ITERATIONS = 20;
+  glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f),
+                               glm::vec3(1.0f, 10.0f, -1.0f),
+                               glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 proj =
+    glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+  Frustum frustum = Frustum::fromMatrix(proj * view);
+
+  for (int count : { 10000, 100000 }) {
+    // Props scattered over a 1 km square, as in an open level
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> ground(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 3.0f);
+    std::vector<Aabb> boxes;
+    Bvh tree;
+    for (int i = 0; i < count; ++i) {
+      glm::vec3 center(ground(rng), size(rng), ground(rng));
+      glm::vec3 extents(size(rng));
+      boxes.push_back({ center - extents, center + extents });
+      tree.insert(boxes.back(), static_cast<u32>(i), true);
+    }
+
+    // Baseline: every box tested against the frustum
+    size_t linearVisible = 0;
+    double linearNs = measure(ITERATIONS, [&] {
+      linearVisible = 0;
+      for (const Aabb& box : boxes) {
+        linearVisible += frustum.intersects(box);
+      }
+    });
+
+    // The first query also builds the static tree; keep it out of the timing
+    tree.query(frustum, [](u32) {});
+    size_t bvhVisible = 0;
+    double bvhNs = measure(ITERATIONS, [&] {
+      bvhVisible = 0;
+      tree.query(frustum, [&](u32) { bvhVisible++; });
+    });
+
+    EXPECT_EQ(bvhVisible, linearVisible);
+    EXPECT_GT(bvhVisible, 0u);
+    char name[64];
+    std::snprintf(name, sizeof(name), "frustum query (%d boxes)", count);
+    report(name, linearNs, bvhNs);
+  }
+}
+
+TEST_F(BenchmarkTest, LightClusterBinning)
+{
+  const int ITERATIONS = 5;
+  const float zNear = 0.1f;
+  const float zFar = 200.0f;
+  glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f),
+                               glm::vec3(1.0f, 2.0f, -1.0f),
+                               glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 proj =
+    glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, zNear, zFar);
+  LightClusters clusters;
+  clusters.setProjection(proj, zNear, zFar);
+  std::vector<Aabb> boxes;
+  for (u32 c = 0; c < LightClusters::kClusterCount; ++c) {
+    boxes.push_back(clusters.getBounds(c));
+  }
+
+  for (int count : { 1000, 4000 }) {
+    // Lamps and torches over a 300 m square around the camera
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> ground(-150.0f, 150.0f);
+    std::uniform_real_distribution<float> height(0.5f, 6.0f);
+    std::uniform_real_distribution<float> reach(2.0f, 12.0f);
+    std::vector<float> streams[LightClusters::SphereStreamCount];
+    for (int i = 0; i < count; ++i) {
+      glm::vec4 position =
+        view * glm::vec4(ground(rng), height(rng), ground(rng), 1.0f);
+      streams[LightClusters::CenterX].push_back(position.x);
+      streams[LightClusters::CenterY].push_back(position.y);
+      streams[LightClusters::CenterZ].push_back(position.z);
+      streams[LightClusters::Radius].push_back(reach(rng));
+    }
+    const float* spheres[LightClusters::SphereStreamCount];
+    for (u32 s = 0; s < LightClusters::SphereStreamCount; ++s) {
+      spheres[s] = streams[s].data();
+    }
+
+    // Baseline: every light against every cluster
+    size_t bruteAssigned = 0;
+    double bruteNs = measure(ITERATIONS, [&] {
+      bruteAssigned = 0;
+      for (const Aabb& box : boxes) {
+        for (int i = 0; i < count; ++i) {
+          glm::vec3 center(streams[LightClusters::CenterX][i],
+                           streams[LightClusters::CenterY][i],
+                           streams[LightClusters::CenterZ][i]);
+          float radius = streams[LightClusters::Radius][i];
+          glm::vec3 gap = glm::clamp(center, box.min, box.max) - center;
+          bruteAssigned += glm::dot(gap, gap) <= radius * radius;
+        }
+      }
+    });
+
+    double binNs =
+      measure(ITERATIONS, [&] { clusters.build(spheres, count); });
+
+    // Bins only the clusters inside each light's screen and depth range, so
+    // never more than the exhaustive test
+    size_t assigned = clusters.getLightIndices().size();
+    EXPECT_GT(assigned, 0u);
+    EXPECT_LE(assigned, bruteAssigned);
+    char name[64];
+    std::snprintf(name, sizeof(name), "light binning (%d lights)", count);
+    report(name, bruteNs, binNs);
+  }
+}
+
+// Whole frames through Core's headless entry point: the Null backend stands in
+// for the GL context, so every pass records and submits as it would on the
+// GPU and the timing is the CPU cost of a frame. Initializes the engine's
+// systems, so it stays the last test in the binary.
+TEST_F(BenchmarkTest, HeadlessFrameGraphFrame)
+{
+  const int GRID = 32;
+  const int ITERATIONS = 20;
+
+  Core& core = Core::getInstance();
+  ASSERT_TRUE(core.initializeHeadless());
+  auto* device = dynamic_cast<gfx::null::Device*>(
+    gfx::GraphicsDevice::getInstance().getBackend());
+  ASSERT_NE(device, nullptr);
+
+  Entity camera = manager->createEntity("Camera");
+  auto& cam = manager->emplaceComponent<CameraComponent>(
+    camera, 45.0f, 800.0f, 800.0f, 0.1f, 200.0f);
+  glm::vec3 eye(0.0f, 40.0f, 60.0f);
+  cam.m_position = eye;
+  cam.m_front = glm::normalize(-eye);
+  cam.m_viewMatrix =
+    glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  cam.m_ProjectionMatrix =
+    glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 200.0f);
+  cam.m_matrixNeedsUpdate = false;
+  CameraSystem::getInstance().setMainCamera(camera);
+
+  Entity sun = manager->createEntity("Sun");
+  manager->setupDirectionalLight(
+    sun, glm::vec3(1.0f), 1.0f, glm::vec3(-0.3f, -1.0f, -0.5f));
+
+  auto cube = ResourceManager::getInstance().getCube();
+  for (int x = 0; x < GRID; ++x) {
+    for (int z = 0; z < GRID; ++z) {
+      Entity entity = manager->createEntity("Cube");
+      PositionComponent position;
+      position.position = glm::vec3(2.0f * x - GRID, 0.0f, 2.0f * z - GRID);
+      manager->emplaceComponent<PositionComponent>(entity, position);
+      manager->emplaceComponent<GraphicsComponent>(entity, cube).type =
+        GraphicsComponent::TYPE::CUBE;
+    }
+  }
+
+  // The first frame builds the scene's world matrices, BVH and batches
+  core.update();
+  const gfx::null::FrameCounters& counters = device->getFrameCounters();
+  EXPECT_GT(counters.submits, 0u);
+  EXPECT_GT(counters.draws, 0u);
+  EXPECT_GT(counters.instances, 0u);
+
+  double frameNs = measure(ITERATIONS, [&] { core.update(); });
+  char name[64];
+  std::snprintf(name, sizeof(name), "headless frame (%d cubes)", GRID * GRID);
+  std::printf("[ BENCH    ] %-32s %10.1f us/frame  %u draws  %u commands\n",
+              name,
+              frameNs / 1000.0,
+              counters.draws,
+              counters.commands);
+}
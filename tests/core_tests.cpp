@@ -3,8 +3,13 @@
 
 #include "ECS/ComponentPool.hpp"
 #include "ECS/Components/PositionComponent.hpp"
+#include "Graphics/Backends/Null/Device.hpp"
+#include "Graphics/CommandStreamOptimizer.hpp"
 #include "InputManager.hpp"
+#include "RenderPasses/DrawSort.hpp"
+#include "RenderPasses/RenderGraph.hpp"
 #include "Singleton.hpp"
+#include <cstring>
 
 // Test Singleton Pattern Implementation
 class TestSingleton : public Singleton<TestSingleton>
@@ -360,7 +365,6 @@ TEST_F(PerformanceTest, ComponentCreationPerformance)
   auto start = std::chrono::high_resolution_clock::now();
 
   for (int i = 0; i < NUM_COMPONENTS; ++i) {
-    // Entity IDs 0..999 (MAX_ENTITIES is 1000)
     auto& comp = pool.emplace(static_cast<Entity>(i));
     comp.position = glm::vec3(i, i + 1, i + 2);
   }
@@ -404,3 +408,457 @@ TEST_F(PerformanceTest, ComponentPoolPerformance)
   // Should be fast (< 50ms for 500 entities)
   EXPECT_LT(duration.count(), 50000);
 }
+
+// Draw sort keys
+class DrawSortCoreTest : public ::testing::Test
+{
+protected:
+  static std::vector<u32> order(std::vector<DrawSort::Item> items)
+  {
+    std::vector<DrawSort::Item> scratch;
+    DrawSort::sort(items, scratch);
+    std::vector<u32> indices;
+    for (const auto& item : items) {
+      indices.push_back(item.index);
+    }
+    return indices;
+  }
+};
+
+TEST_F(DrawSortCoreTest, OpaqueByStateThenFrontToBackBlendLast)
+{
+  using DrawSort::Layer;
+  using DrawSort::makeKey;
+  std::vector<DrawSort::Item> items = {
+    { makeKey(Layer::Blend, 0, 0, 0, 5.0f), 0 },
+    { makeKey(Layer::Opaque, 0, 1, 0, 2.0f), 1 },
+    { makeKey(Layer::Opaque, 0, 0, 3, 9.0f), 2 },
+    { makeKey(Layer::Blend, 0, 1, 0, 50.0f), 3 },
+    { makeKey(Layer::Opaque, 0, 0, 3, 0.5f), 4 },
+    { makeKey(Layer::Opaque, 0, 1, 0, 1.0f), 5 },
+  };
+  // Opaque: material 0 before 1, nearest first within a mesh; then blended
+  // draws farthest first regardless of material
+  EXPECT_EQ(order(items), (std::vector<u32>{ 4, 2, 5, 1, 3, 0 }));
+
+  EXPECT_LT(DrawSort::quantizeDepth(0.1f), DrawSort::quantizeDepth(0.2f));
+  EXPECT_LT(DrawSort::quantizeDepth(10.0f), DrawSort::quantizeDepth(1000.0f));
+  EXPECT_EQ(DrawSort::quantizeDepth(-3.0f), 0u);
+}
+
+TEST_F(DrawSortCoreTest, RadixSortIsStableAndGroupsState)
+{
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<u32> material(0, 7);
+  std::uniform_int_distribution<u32> mesh(0, 15);
+  std::uniform_real_distribution<float> depth(0.1f, 200.0f);
+  std::vector<DrawSort::Item> items;
+  for (u32 i = 0; i < 1000; ++i) {
+    items.push_back({ DrawSort::makeKey(DrawSort::Layer::Opaque,
+                                        0,
+                                        material(rng),
+                                        mesh(rng),
+                                        depth(rng)),
+                      i });
+  }
+  std::vector<DrawSort::Item> expected = items;
+  std::stable_sort(
+    expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+      return a.key < b.key;
+    });
+
+  DrawSort::StateChanges before = DrawSort::countStateChanges(items);
+  std::vector<DrawSort::Item> scratch;
+  DrawSort::sort(items, scratch);
+  for (size_t i = 0; i < items.size(); ++i) {
+    ASSERT_EQ(items[i].index, expected[i].index) << "position " << i;
+  }
+
+  // Each material is bound once, each mesh at most once per material
+  DrawSort::StateChanges after = DrawSort::countStateChanges(items);
+  EXPECT_EQ(after.draws, before.draws);
+  EXPECT_EQ(after.pipelines, 1u);
+  EXPECT_EQ(after.materials, 8u);
+  EXPECT_LE(after.meshes, 8u * 16u);
+  EXPECT_GT(before.materials, after.materials);
+}
+
+// Command stream optimizer
+class CommandOptimizerCoreTest : public ::testing::Test
+{
+protected:
+  static gfx::PipelineId pipeline(u32 index)
+  {
+    return gfx::PipelineId::create(index, 1);
+  }
+  static gfx::BufferId buffer(u32 index)
+  {
+    return gfx::BufferId::create(index, 1);
+  }
+  static gfx::TextureId texture(u32 index)
+  {
+    return gfx::TextureId::create(index, 1);
+  }
+
+  gfx::CommandStreamOptimizer optimizer;
+};
+
+TEST_F(CommandOptimizerCoreTest, DropsRedundantBinds)
+{
+  gfx::SamplerId sampler = gfx::SamplerId::create(0, 1);
+  gfx::CommandBuffer cmd;
+  cmd.bindPipeline(pipeline(1));
+  cmd.bindVertexBuffer(0, buffer(1));
+  cmd.bindTexture(0, texture(1), sampler);
+  cmd.setUniform(3, glm::vec3(1.0f));
+  cmd.draw(3, 1, 0, 0);
+  cmd.bindPipeline(pipeline(1));
+  cmd.bindVertexBuffer(0, buffer(1));
+  cmd.bindTexture(0, texture(1), sampler);
+  cmd.setUniform(3, glm::vec3(1.0f));
+  cmd.setUniform(4, 2.0f);
+  cmd.draw(6, 1, 0, 0);
+  cmd.bindTexture(0, texture(1), sampler);
+  cmd.setUniform(4, 2.0f);
+  cmd.draw(9, 1, 0, 0);
+
+  // The same frame without the repeats
+  gfx::CommandBuffer expected;
+  expected.bindPipeline(pipeline(1));
+  expected.bindVertexBuffer(0, buffer(1));
+  expected.bindTexture(0, texture(1), sampler);
+  expected.setUniform(3, glm::vec3(1.0f));
+  expected.draw(3, 1, 0, 0);
+  expected.setUniform(4, 2.0f);
+  expected.draw(6, 1, 0, 0);
+  expected.draw(9, 1, 0, 0);
+
+  size_t before = cmd.size();
+  gfx::CommandStreamStats stats = optimizer.optimize(cmd);
+  EXPECT_EQ(cmd.getCommandStream(), expected.getCommandStream());
+  EXPECT_EQ(stats.commands, 14u);
+  EXPECT_EQ(stats.removedCommands, 6u);
+  EXPECT_EQ(stats.removedBytes, before - cmd.size());
+
+  // Already minimal
+  stats = optimizer.optimize(cmd);
+  EXPECT_EQ(stats.removedCommands, 0u);
+  EXPECT_EQ(cmd.getCommandStream(), expected.getCommandStream());
+}
+
+TEST_F(CommandOptimizerCoreTest, StateChangesForgetDependentState)
+{
+  gfx::CommandBuffer cmd;
+  cmd.bindPipeline(pipeline(1));
+  cmd.setUniform(0, 1.0f);
+  cmd.setCullMode(gfx::CullMode::Back);
+  cmd.bindPipeline(pipeline(2));
+  cmd.setUniform(0, 1.0f);
+  cmd.setCullMode(gfx::CullMode::Back);
+  cmd.bindVertexArray(gfx::VertexArrayId::create(1, 1));
+  cmd.bindIndexBuffer(buffer(1), 0, gfx::IndexType::U32);
+  cmd.bindVertexArray(gfx::VertexArrayId::create(2, 1));
+  cmd.bindIndexBuffer(buffer(1), 0, gfx::IndexType::U32);
+  cmd.updateMaterialUBO(gfx::MaterialUBO{});
+  cmd.updateMaterialUBO(gfx::MaterialUBO{});
+  cmd.bindUniformBuffer(static_cast<u32>(gfx::UBOBinding::Material),
+                        buffer(2),
+                        0,
+                        sizeof(gfx::MaterialUBO));
+  cmd.updateMaterialUBO(gfx::MaterialUBO{});
+
+  // Only the second material update repeats state still in place
+  gfx::CommandStreamStats stats = optimizer.optimize(cmd);
+  EXPECT_EQ(stats.commands, 14u);
+  EXPECT_EQ(stats.removedCommands, 1u);
+  EXPECT_EQ(stats.removedBytes, 1u + sizeof(gfx::MaterialUBO));
+}
+
+TEST_F(CommandOptimizerCoreTest, KeepsEveryDraw)
+{
+  // Batches of one mesh as the passes record them: each instance range is
+  // reached through the instance buffer offset
+  gfx::CommandBuffer cmd;
+  cmd.bindPipeline(pipeline(1));
+  cmd.bindVertexBuffer(1, buffer(1), 0);
+  cmd.drawIndexed(36, 4);
+  cmd.bindVertexBuffer(1, buffer(1), 4 * 64);
+  cmd.drawIndexed(36, 2);
+  cmd.bindVertexBuffer(1, buffer(1), 4 * 64);
+  cmd.drawIndexed(36, 2);
+  cmd.draw(3);
+
+  gfx::CommandBuffer expected;
+  expected.bindPipeline(pipeline(1));
+  expected.bindVertexBuffer(1, buffer(1), 0);
+  expected.drawIndexed(36, 4);
+  expected.bindVertexBuffer(1, buffer(1), 4 * 64);
+  expected.drawIndexed(36, 2);
+  expected.drawIndexed(36, 2);
+  expected.draw(3);
+
+  gfx::CommandStreamStats stats = optimizer.optimize(cmd);
+  EXPECT_EQ(stats.removedCommands, 1u);
+  EXPECT_EQ(cmd.getCommandStream(), expected.getCommandStream());
+}
+
+TEST_F(CommandOptimizerCoreTest, ReaderDecodesWhatWasRecorded)
+{
+  std::array<gfx::TextureId, 3> textures = { texture(1),
+                                             texture(2),
+                                             texture(3) };
+  std::array<u8, 5> data = { 1, 2, 3, 4, 5 };
+  gfx::SamplerId sampler = gfx::SamplerId::create(2, 1);
+  gfx::CommandBuffer cmd;
+  cmd.bindIndexBuffer(buffer(4), 16, gfx::IndexType::U16);
+  cmd.bindTextures(2, textures, sampler);
+  cmd.bindTextureByName(5, "shadowMap", sampler);
+  cmd.updateBuffer(buffer(1), 8, data.data(), data.size());
+  cmd.setUniform(7, glm::vec3(1.0f, 2.0f, 3.0f));
+  cmd.drawIndexed(36, 4, 6, -2, 0);
+  cmd.popDebugGroup();
+
+  gfx::CommandReader reader(cmd.getCommandStream());
+  ASSERT_EQ(reader.next(), gfx::CommandType::BindIndexBuffer);
+  gfx::cmd::BindIndexBuffer index = reader.read<gfx::cmd::BindIndexBuffer>();
+  EXPECT_EQ(index.buffer, buffer(4));
+  EXPECT_EQ(index.offset, 16u);
+  EXPECT_EQ(index.indexType, gfx::IndexType::U16);
+
+  ASSERT_EQ(reader.next(), gfx::CommandType::BindTextures);
+  gfx::cmd::BindTextures bind = reader.read<gfx::cmd::BindTextures>();
+  EXPECT_EQ(bind.firstSlot, 2u);
+  EXPECT_EQ(bind.sampler, sampler);
+  ASSERT_EQ(bind.textures.size(), 3u);
+  EXPECT_EQ(bind.textures[2], texture(3));
+
+  ASSERT_EQ(reader.next(), gfx::CommandType::BindTextureByName);
+  gfx::cmd::BindTextureByName byName =
+    reader.read<gfx::cmd::BindTextureByName>();
+  EXPECT_EQ(byName.slot, 5u);
+  EXPECT_EQ(byName.name, "shadowMap");
+  EXPECT_EQ(byName.sampler, sampler);
+
+  ASSERT_EQ(reader.next(), gfx::CommandType::UpdateBuffer);
+  gfx::cmd::UpdateBuffer update = reader.read<gfx::cmd::UpdateBuffer>();
+  EXPECT_EQ(update.offset, 8u);
+  ASSERT_EQ(update.data.size(), data.size());
+  EXPECT_EQ(std::memcmp(update.data.data(), data.data(), data.size()), 0);
+
+  ASSERT_EQ(reader.next(), gfx::CommandType::SetUniformVec3);
+  gfx::cmd::SetUniformVec3 uniform = reader.read<gfx::cmd::SetUniformVec3>();
+  EXPECT_EQ(uniform.location, 7);
+  EXPECT_EQ(uniform.value, glm::vec3(1.0f, 2.0f, 3.0f));
+
+  // Skipping steps over the same bytes reading does
+  ASSERT_EQ(reader.next(), gfx::CommandType::DrawIndexed);
+  EXPECT_TRUE(reader.skip());
+  ASSERT_EQ(reader.next(), gfx::CommandType::PopDebugGroup);
+  EXPECT_TRUE(reader.skip());
+  EXPECT_TRUE(reader.atEnd());
+  EXPECT_EQ(reader.offset(), cmd.size());
+}
+
+class NullDeviceCoreTest : public ::testing::Test
+{
+protected:
+  void SetUp() override { ASSERT_TRUE(device.initialize()); }
+
+  gfx::null::Device device;
+};
+
+TEST_F(NullDeviceCoreTest, CountsWhatWouldReachTheGpu)
+{
+  gfx::BufferCreateInfo info;
+  info.size = 1024;
+  info.usage = gfx::BufferUsage::Vertex;
+  gfx::BufferId vertices = device.createBuffer(info);
+  ASSERT_TRUE(device.isValid(vertices));
+
+  device.beginFrame();
+  std::array<u8, 64> data{};
+  gfx::CommandBuffer cmd;
+  cmd.bindPipeline(gfx::PipelineId::create(1, 0));
+  cmd.bindVertexBuffer(0, vertices);
+  cmd.updateBuffer(vertices, 0, data.data(), data.size());
+  cmd.setUniform(0, 1.0f);
+  cmd.draw(3, 1, 0, 0);
+  cmd.drawIndexed(36, 8, 0, 0, 0);
+  device.executeCommandBuffer(cmd);
+  device.executeCommandBuffer(cmd);
+  device.drawVertexArray(gfx::VertexArrayId{}, vertices);
+  device.endFrame();
+
+  const gfx::null::FrameCounters& counters = device.getFrameCounters();
+  EXPECT_EQ(counters.submits, 2u);
+  EXPECT_EQ(counters.commands, 12u);
+  EXPECT_EQ(counters.draws, 5u);
+  EXPECT_EQ(counters.instances, 19u);
+  EXPECT_EQ(counters.stateChanges, 6u);
+  EXPECT_EQ(counters.bytesUploaded, 2 * data.size());
+
+  // The next frame starts from zero
+  device.beginFrame();
+  device.endFrame();
+  EXPECT_EQ(device.getFrameCounters().draws, 0u);
+}
+
+TEST_F(NullDeviceCoreTest, HandlesMatchResourceLifetimes)
+{
+  // The default framebuffer exists from initialize() on
+  size_t baseline = device.getLiveResourceCount();
+  EXPECT_EQ(baseline, 1u);
+
+  gfx::TextureId texture = device.createTexture(gfx::TextureCreateInfo{});
+  gfx::CommandBufferId cmd = device.createCommandBuffer();
+  EXPECT_EQ(device.getLiveResourceCount(), baseline + 2);
+  EXPECT_NE(device.getCommandBuffer(cmd), nullptr);
+
+  device.destroyTexture(texture);
+  EXPECT_FALSE(device.isValid(texture));
+  // A slot reused after release hands out a new generation
+  gfx::TextureId reused = device.createTexture(gfx::TextureCreateInfo{});
+  EXPECT_EQ(reused.index(), texture.index());
+  EXPECT_NE(reused, texture);
+  EXPECT_TRUE(device.isValid(reused));
+
+  device.destroyCommandBuffer(cmd);
+  device.destroyTexture(reused);
+  EXPECT_EQ(device.getLiveResourceCount(), baseline);
+}
+
+TEST_F(NullDeviceCoreTest, StreamUploadsAreAlignedAndRewound)
+{
+  u32 alignment = device.getUniformBufferOffsetAlignment();
+  std::array<u8, 100> block{};
+
+  device.beginFrame();
+  gfx::StreamAllocation first =
+    device.streamUpload(gfx::StreamUsage::Uniform, block.data(), 100, 16);
+  gfx::StreamAllocation second =
+    device.streamUpload(gfx::StreamUsage::Uniform, block.data(), 100, 16);
+  EXPECT_TRUE(device.isValid(first.buffer));
+  EXPECT_EQ(first.offset % alignment, 0u);
+  EXPECT_EQ(second.offset % alignment, 0u);
+  EXPECT_GE(second.offset, first.offset + 100);
+  device.endFrame();
+  EXPECT_EQ(device.getStreamStats().allocations, 2u);
+  EXPECT_EQ(device.getStreamStats().bytesUploaded, 200u);
+
+  device.beginFrame();
+  gfx::StreamAllocation next =
+    device.streamUpload(gfx::StreamUsage::Uniform, block.data(), 100, 16);
+  EXPECT_EQ(next.offset, first.offset);
+  device.endFrame();
+}
+
+class RenderGraphCoreTest : public ::testing::Test
+{
+protected:
+  void SetUp() override { graph.reset(64, 32); }
+
+  RenderGraph::TextureDesc full(gfx::PixelFormat format) const
+  {
+    return { format, 64, 32 };
+  }
+
+  RenderGraph graph;
+};
+
+TEST_F(RenderGraphCoreTest, OrdersByDependencyNotDeclaration)
+{
+  auto post = graph.addPass("Post", 2);
+  post.read("lit");
+  post.write(RenderGraph::kBackbuffer);
+  auto light = graph.addPass("Light", 1);
+  light.read("gbuffer");
+  light.create("lit", full(gfx::PixelFormat::RGBA16F));
+  auto geometry = graph.addPass("Geometry", 0);
+  geometry.create("gbuffer", full(gfx::PixelFormat::RGBA16F));
+
+  ASSERT_TRUE(graph.compile());
+  EXPECT_EQ(graph.getOrder(), (std::vector<u32>{ 0, 1, 2 }));
+  EXPECT_EQ(graph.getStats().culledPasses, 0u);
+}
+
+TEST_F(RenderGraphCoreTest, CullsPassesThatReachNoOutput)
+{
+  auto geometry = graph.addPass("Geometry", 0);
+  geometry.create("gbuffer", full(gfx::PixelFormat::RGBA16F));
+  auto bloom = graph.addPass("Bloom", 1);
+  bloom.read("gbuffer");
+  bloom.create("bloom", full(gfx::PixelFormat::RGBA16F));
+  auto present = graph.addPass("Present", 2);
+  present.read("gbuffer");
+  present.write(RenderGraph::kBackbuffer);
+
+  ASSERT_TRUE(graph.compile());
+  EXPECT_EQ(graph.getOrder(), (std::vector<u32>{ 0, 2 }));
+  EXPECT_TRUE(graph.isCulled(1));
+  EXPECT_EQ(graph.getStats().culledPasses, 1u);
+  // Declared but never allocated
+  EXPECT_EQ(graph.getTransients()[1].physical, RenderGraph::kInvalid);
+  EXPECT_EQ(graph.getStats().physicalTextures, 1u);
+}
+
+TEST_F(RenderGraphCoreTest, AliasesTargetsWithDisjointLifetimes)
+{
+  RenderGraph::TextureDesc hdr = full(gfx::PixelFormat::RGBA16F);
+  auto geometry = graph.addPass("Geometry", 0);
+  geometry.create("albedo", hdr);
+  geometry.create("normal", hdr);
+  auto light = graph.addPass("Light", 1);
+  light.read("albedo");
+  light.read("normal");
+  light.create("lit", hdr);
+  auto bloom = graph.addPass("Bloom", 2);
+  bloom.read("lit");
+  bloom.create("bright", hdr);
+  bloom.create("half", { gfx::PixelFormat::RGBA16F, 32, 16 });
+  bloom.create("final", hdr);
+  auto present = graph.addPass("Present", 3);
+  present.read("final");
+  present.write(RenderGraph::kBackbuffer);
+
+  ASSERT_TRUE(graph.compile());
+  const auto& transients = graph.getTransients();
+  auto slot = [&](const char* name) {
+    for (const auto& transient : transients) {
+      if (transient.name == name) {
+        return transient.physical;
+      }
+    }
+    return RenderGraph::kInvalid;
+  };
+  // G-buffer targets are dead once Light is done with them
+  EXPECT_NE(slot("albedo"), slot("normal"));
+  EXPECT_NE(slot("lit"), slot("albedo"));
+  EXPECT_NE(slot("lit"), slot("normal"));
+  EXPECT_EQ(slot("bright"), slot("albedo"));
+  EXPECT_EQ(slot("final"), slot("normal"));
+  // Same lifetime as bright but another size
+  EXPECT_NE(slot("half"), slot("bright"));
+
+  const RenderGraph::Stats& stats = graph.getStats();
+  u64 hdrBytes = RenderGraph::byteSize(hdr);
+  EXPECT_EQ(stats.transientTextures, 6u);
+  EXPECT_EQ(stats.physicalTextures, 4u);
+  EXPECT_EQ(stats.declaredBytes, 5 * hdrBytes + hdrBytes / 4);
+  EXPECT_EQ(stats.physicalBytes, 3 * hdrBytes + hdrBytes / 4);
+  EXPECT_NE(graph.describe().find("Light  reads albedo#"), std::string::npos);
+}
+
+TEST_F(RenderGraphCoreTest, CycleFallsBackToDeclarationOrder)
+{
+  auto a = graph.addPass("A", 0);
+  a.read("b");
+  a.create("a", full(gfx::PixelFormat::RGBA8));
+  a.write(RenderGraph::kBackbuffer);
+  auto b = graph.addPass("B", 1);
+  b.read("a");
+  b.create("b", full(gfx::PixelFormat::RGBA8));
+
+  EXPECT_FALSE(graph.compile());
+  EXPECT_EQ(graph.getOrder(), (std::vector<u32>{ 0, 1 }));
+  EXPECT_EQ(graph.getStats().physicalTextures, 2u);
+}
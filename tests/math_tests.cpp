@@ -5,6 +5,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "Objects/GraphicsObject.hpp"
+#include "RenderPasses/LightingUtil.hpp"
+#include "Rendering/Bvh.hpp"
+#include "Rendering/Frustum.hpp"
+#include "Rendering/LightClusters.hpp"
+
 // Comprehensive GLM Math Tests
 class MathTest : public ::testing::Test
 {};
@@ -374,4 +380,386 @@ TEST_F(MathTest, SmoothstepFunction)
   EXPECT_FLOAT_EQ(glm::smoothstep(0.0f, 1.0f, 0.0f), 0.0f);
   EXPECT_FLOAT_EQ(glm::smoothstep(0.0f, 1.0f, 1.0f), 1.0f);
   EXPECT_FLOAT_EQ(glm::smoothstep(0.0f, 1.0f, 0.5f), 0.5f);
-}
\ No newline at end of file
+}
+// Bounds and frustum culling
+TEST_F(MathTest, AabbTransformedEnclosesBox)
+{
+  Aabb box;
+  EXPECT_TRUE(box.isEmpty());
+  box.expand(glm::vec3(-1.0f, -2.0f, -3.0f));
+  box.expand(glm::vec3(1.0f, 2.0f, 3.0f));
+  EXPECT_FALSE(box.isEmpty());
+  EXPECT_EQ(box.center(), glm::vec3(0.0f));
+  EXPECT_EQ(box.extents(), glm::vec3(1.0f, 2.0f, 3.0f));
+
+  // A quarter turn about Y swaps the X and Z extents
+  glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(10.0f, 0.0f, 0.0f)) *
+                glm::rotate(glm::mat4(1.0f),
+                            glm::radians(90.0f),
+                            glm::vec3(0.0f, 1.0f, 0.0f));
+  Aabb world = box.transformed(m);
+  EXPECT_NEAR(world.center().x, 10.0f, 1e-4f);
+  EXPECT_NEAR(world.extents().x, 3.0f, 1e-4f);
+  EXPECT_NEAR(world.extents().y, 2.0f, 1e-4f);
+  EXPECT_NEAR(world.extents().z, 1.0f, 1e-4f);
+}
+
+TEST_F(MathTest, PoseBoundsFollowSkinJoints)
+{
+  // A skinned cube under a two-joint chain, bound with both joints at the
+  // origin
+  GraphicsObject obj;
+  obj.p_numNodes = 3;
+  obj.p_nodes = std::make_unique<Node[]>(obj.p_numNodes);
+  obj.p_nodes[0].mesh = 0;
+  obj.p_nodes[0].skin = 0;
+  obj.p_nodes[1].children = { 2 };
+  obj.p_nodes[2].parent = 1;
+  obj.p_numMeshes = 1;
+  obj.p_meshes = std::make_unique<Mesh[]>(obj.p_numMeshes);
+  obj.p_meshes[0].numPrims = 1;
+  obj.p_meshes[0].m_primitives = std::make_unique<Primitive[]>(1);
+  obj.p_meshes[0].m_primitives[0].m_bounds = { glm::vec3(-1.0f),
+                                               glm::vec3(1.0f) };
+  obj.p_numSkins = 1;
+  obj.p_skins = std::make_unique<Skin[]>(obj.p_numSkins);
+  obj.p_skins[0].joints = { 1, 2 };
+  obj.p_skins[0].inverseBindMatrices = { glm::mat4(1.0f), glm::mat4(1.0f) };
+
+  Aabb rest = obj.getPoseBounds();
+  EXPECT_EQ(rest.min, glm::vec3(-1.0f));
+  EXPECT_EQ(rest.max, glm::vec3(1.0f));
+
+  // Raising the end joint drags the vertices weighted to it out of the
+  // bind-pose box
+  obj.p_nodes[2].trans = glm::vec3(0.0f, 5.0f, 0.0f);
+  obj.resetMatrixCache();
+  Aabb posed = obj.getPoseBounds();
+  EXPECT_EQ(posed.min, glm::vec3(-1.0f));
+  EXPECT_EQ(posed.max, glm::vec3(1.0f, 6.0f, 1.0f));
+
+  // A primitive without bounds leaves nothing to cull by
+  obj.p_meshes[0].m_primitives[0].m_bounds = {};
+  EXPECT_TRUE(obj.getPoseBounds().isEmpty());
+}
+
+TEST_F(MathTest, FrustumRejectsBoxesOutsideView)
+{
+  // Camera at the origin looking down -Z
+  glm::mat4 view = glm::lookAt(
+    glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 proj =
+    glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  Frustum frustum = Frustum::fromMatrix(proj * view);
+
+  auto unitBox = [](glm::vec3 center) {
+    return Aabb{ center - glm::vec3(0.5f), center + glm::vec3(0.5f) };
+  };
+  EXPECT_TRUE(frustum.intersects(unitBox(glm::vec3(0.0f, 0.0f, -10.0f))));
+  EXPECT_FALSE(frustum.intersects(unitBox(glm::vec3(0.0f, 0.0f, 10.0f))));
+  EXPECT_FALSE(frustum.intersects(unitBox(glm::vec3(0.0f, 0.0f, -200.0f))));
+  EXPECT_FALSE(frustum.intersects(unitBox(glm::vec3(50.0f, 0.0f, -10.0f))));
+  EXPECT_FALSE(frustum.intersects(unitBox(glm::vec3(0.0f, -50.0f, -10.0f))));
+  // Straddling the far plane still counts as visible
+  EXPECT_TRUE(frustum.intersects(unitBox(glm::vec3(0.0f, 0.0f, -100.2f))));
+
+  EXPECT_TRUE(frustum.intersects(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f));
+  EXPECT_FALSE(frustum.intersects(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f));
+}
+
+TEST_F(MathTest, FrustumBatchCullMatchesPerBoxTest)
+{
+  glm::mat4 view = glm::lookAt(glm::vec3(5.0f, 2.0f, 5.0f),
+                               glm::vec3(0.0f),
+                               glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 proj =
+    glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 50.0f);
+  Frustum frustum = Frustum::fromMatrix(proj * view);
+
+  // Not a multiple of the SIMD width, so the scalar tail runs too
+  constexpr size_t kCount = 1003;
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> size(0.1f, 3.0f);
+  std::array<std::vector<float>, Frustum::BoundsStreamCount> streams;
+  std::vector<Aabb> boxes;
+  for (size_t i = 0; i < kCount; ++i) {
+    glm::vec3 center(position(rng), position(rng), position(rng));
+    glm::vec3 extents(size(rng), size(rng), size(rng));
+    boxes.push_back({ center - extents, center + extents });
+    for (int axis = 0; axis < 3; ++axis) {
+      streams[Frustum::CenterX + axis].push_back(center[axis]);
+      streams[Frustum::ExtentX + axis].push_back(extents[axis]);
+    }
+  }
+  std::array<const float*, Frustum::BoundsStreamCount> pointers;
+  for (size_t s = 0; s < Frustum::BoundsStreamCount; ++s) {
+    pointers[s] = streams[s].data();
+  }
+
+  std::vector<u8> visible(kCount);
+  frustum.cull(pointers.data(), kCount, visible.data());
+  size_t visibleCount = 0;
+  for (size_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(visible[i] != 0, frustum.intersects(boxes[i])) << "box " << i;
+    visibleCount += visible[i];
+  }
+  // Most random boxes are outside a 45 degree view, but not all of them
+  EXPECT_GT(visibleCount, 0u);
+  EXPECT_LT(visibleCount, kCount / 2);
+}
+
+TEST_F(MathTest, CascadeCasterVolumeOpensTowardLight)
+{
+  glm::vec3 eye(0.0f, 2.0f, 0.0f);
+  glm::mat4 view =
+    glm::lookAt(eye, glm::vec3(0.0f, 2.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 proj =
+    glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  glm::vec3 lightDir = glm::normalize(glm::vec3(0.3f, -1.0f, 0.2f));
+
+  LightingUtil::CascadeConfig config;
+  config.calculateSplitDistances(0.1f, 100.0f);
+  config.calculateCascadeMatrices(lightDir, eye, view, proj);
+  Frustum volume = config.casterVolume(0);
+  Frustum box = Frustum::fromMatrix(config.lightSpaceMatrices[0]);
+
+  auto unitBox = [](glm::vec3 center) {
+    return Aabb{ center - glm::vec3(0.5f), center + glm::vec3(0.5f) };
+  };
+  glm::vec3 inside(0.0f, 2.0f, -0.5f * config.cascadeSplits[0]);
+  EXPECT_TRUE(volume.intersects(unitBox(inside)));
+
+  // Far up toward the light: outside the cascade's box, but it still casts
+  // into it
+  glm::vec3 towardLight = inside - lightDir * 500.0f;
+  EXPECT_FALSE(box.intersects(unitBox(towardLight)));
+  EXPECT_TRUE(volume.intersects(unitBox(towardLight)));
+
+  // Off to the side or beyond the box away from the light: rejected
+  glm::vec3 side = glm::normalize(glm::cross(lightDir, glm::vec3(0, 0, 1)));
+  EXPECT_FALSE(volume.intersects(unitBox(inside + side * 500.0f)));
+  EXPECT_FALSE(volume.intersects(unitBox(inside + lightDir * 500.0f)));
+
+  // Far cascades cover more ground per texel
+  EXPECT_GT(config.texelSizes[3], config.texelSizes[0]);
+}
+
+TEST_F(MathTest, BvhQueriesMatchBruteForce)
+{
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.2f, 4.0f);
+  auto randomBox = [&] {
+    glm::vec3 center(position(rng), position(rng), position(rng));
+    glm::vec3 extents(size(rng), size(rng), size(rng));
+    return Aabb{ center - extents, center + extents };
+  };
+
+  // Half static, half dynamic, then churn both trees
+  Bvh tree;
+  std::vector<u32> proxies;
+  for (u32 i = 0; i < 600; ++i) {
+    proxies.push_back(tree.insert(randomBox(), i, i % 2 == 0));
+  }
+  std::vector<bool> alive(proxies.size(), true);
+  for (u32 i = 0; i < 600; i += 7) {
+    tree.remove(proxies[i]);
+    alive[i] = false;
+  }
+  for (u32 i = 1; i < 600; i += 5) {
+    if (alive[i]) {
+      tree.refit(proxies[i], randomBox());
+    }
+  }
+  for (u32 i = 3; i < 600; i += 11) {
+    if (alive[i]) {
+      tree.setStatic(proxies[i], !tree.isStatic(proxies[i]));
+    }
+  }
+  size_t aliveCount = std::count(alive.begin(), alive.end(), true);
+  ASSERT_EQ(tree.size(), aliveCount);
+
+  // Queries must report exactly the stored boxes that pass the same test
+  auto check = [&](auto&& query, auto&& touches, u32 filter) {
+    std::vector<u32> found;
+    query([&](u32 userData) { found.push_back(userData); }, filter);
+    std::sort(found.begin(), found.end());
+    std::vector<u32> expected;
+    for (u32 i = 0; i < proxies.size(); ++i) {
+      bool isStatic = alive[i] && tree.isStatic(proxies[i]);
+      bool selected = (filter & (isStatic ? Bvh::Static : Bvh::Dynamic)) != 0;
+      if (alive[i] && selected && touches(tree.bounds(proxies[i]))) {
+        expected.push_back(i);
+      }
+    }
+    EXPECT_EQ(found, expected);
+    return found.size();
+  };
+
+  glm::mat4 view = glm::lookAt(
+    glm::vec3(0.0f), glm::vec3(1.0f, 0.2f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  glm::mat4 proj =
+    glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 80.0f);
+  Frustum frustum = Frustum::fromMatrix(proj * view);
+  for (u32 filter : { Bvh::All, Bvh::Static, Bvh::Dynamic }) {
+    size_t visible = check(
+      [&](auto fn, u32 f) { tree.query(frustum, fn, f); },
+      [&](const Aabb& box) { return frustum.intersects(box); },
+      filter);
+    EXPECT_GT(visible, 0u);
+  }
+
+  Aabb region{ glm::vec3(-40.0f), glm::vec3(30.0f, 50.0f, 20.0f) };
+  check([&](auto fn, u32 f) { tree.query(region, fn, f); },
+        [&](const Aabb& box) { return region.overlaps(box); },
+        Bvh::All);
+
+  glm::vec3 center(10.0f, -20.0f, 5.0f);
+  float radius = 35.0f;
+  check([&](auto fn, u32 f) { tree.query(center, radius, fn, f); },
+        [&](const Aabb& box) {
+          glm::vec3 offset = glm::clamp(center, box.min, box.max) - center;
+          return glm::dot(offset, offset) <= radius * radius;
+        },
+        Bvh::All);
+
+  // Closest hit along a ray aimed at one of the boxes, against a slab test
+  // over every stored box
+  glm::vec3 origin(-120.0f, 1.0f, 2.0f);
+  glm::vec3 direction =
+    glm::normalize(tree.bounds(proxies[2]).center() - origin);
+  float bestT = 1000.0f;
+  u32 bestHit = Bvh::kNull;
+  tree.raycast(origin, direction, bestT, [&](u32 userData, float t) {
+    if (t < bestT) {
+      bestT = t;
+      bestHit = userData;
+    }
+    return bestT;
+  });
+  float expectedT = 1000.0f;
+  u32 expectedHit = Bvh::kNull;
+  for (u32 i = 0; i < proxies.size(); ++i) {
+    if (!alive[i]) {
+      continue;
+    }
+    const Aabb& box = tree.bounds(proxies[i]);
+    glm::vec3 t0 = (box.min - origin) / direction;
+    glm::vec3 t1 = (box.max - origin) / direction;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float tEnter = std::max({ tNear.x, tNear.y, tNear.z, 0.0f });
+    float tExit = std::min({ tFar.x, tFar.y, tFar.z });
+    if (tEnter <= tExit && tEnter < expectedT) {
+      expectedT = tEnter;
+      expectedHit = i;
+    }
+  }
+  EXPECT_NE(bestHit, Bvh::kNull);
+  EXPECT_EQ(bestHit, expectedHit);
+  EXPECT_NEAR(bestT, expectedT, 1e-3f);
+}
+
+TEST_F(MathTest, LightClustersCoverEveryLitPoint)
+{
+  const float zNear = 0.1f;
+  const float zFar = 100.0f;
+  glm::mat4 proj =
+    glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, zNear, zFar);
+
+  // View-space lights, some behind the camera or past the far plane
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> across(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> up(-20.0f, 20.0f);
+  std::uniform_real_distribution<float> ahead(-110.0f, 5.0f);
+  std::uniform_real_distribution<float> reach(0.5f, 8.0f);
+  std::vector<float> streams[LightClusters::SphereStreamCount];
+  for (int i = 0; i < 500; ++i) {
+    streams[LightClusters::CenterX].push_back(across(rng));
+    streams[LightClusters::CenterY].push_back(up(rng));
+    streams[LightClusters::CenterZ].push_back(ahead(rng));
+    streams[LightClusters::Radius].push_back(reach(rng));
+  }
+  const float* spheres[LightClusters::SphereStreamCount];
+  for (u32 s = 0; s < LightClusters::SphereStreamCount; ++s) {
+    spheres[s] = streams[s].data();
+  }
+  auto sphere = [&](u32 light) {
+    return glm::vec4(streams[LightClusters::CenterX][light],
+                     streams[LightClusters::CenterY][light],
+                     streams[LightClusters::CenterZ][light],
+                     streams[LightClusters::Radius][light]);
+  };
+
+  LightClusters clusters;
+  clusters.setProjection(proj, zNear, zFar);
+  clusters.build(spheres, streams[0].size());
+
+  // Ranges tile the index list, and every listed light reaches its box
+  const auto& ranges = clusters.getClusters();
+  const auto& indices = clusters.getLightIndices();
+  ASSERT_EQ(ranges.size(), LightClusters::kClusterCount);
+  u32 offset = 0;
+  for (u32 c = 0; c < ranges.size(); ++c) {
+    ASSERT_EQ(ranges[c].offset, offset);
+    offset += ranges[c].count;
+    Aabb box = clusters.getBounds(c);
+    for (u32 i = ranges[c].offset; i < offset; ++i) {
+      if (i > ranges[c].offset) {
+        EXPECT_LT(indices[i - 1], indices[i]);
+      }
+      glm::vec4 s = sphere(indices[i]);
+      glm::vec3 center(s);
+      glm::vec3 gap = glm::clamp(center, box.min, box.max) - center;
+      EXPECT_LE(glm::dot(gap, gap), s.w * s.w * 1.0001f);
+    }
+  }
+  ASSERT_EQ(offset, indices.size());
+
+  // A point on screen finds its cluster the way the lighting shader does,
+  // which must list every light reaching it
+  std::uniform_real_distribution<float> ndc(-0.999f, 0.999f);
+  std::uniform_real_distribution<float> logDepth(std::log(zNear),
+                                                 std::log(zFar));
+  size_t lit = 0;
+  for (int p = 0; p < 20000; ++p) {
+    float x = ndc(rng);
+    float y = ndc(rng);
+    float depth = std::exp(logDepth(rng));
+    glm::vec3 point((x + proj[2][0]) * depth / proj[0][0],
+                    (y + proj[2][1]) * depth / proj[1][1],
+                    -depth);
+    auto tile = [](float v, u32 tiles) {
+      return static_cast<u32>((v * 0.5f + 0.5f) * static_cast<float>(tiles));
+    };
+    u32 c = LightClusters::clusterIndex(tile(x, LightClusters::kTilesX),
+                                        tile(y, LightClusters::kTilesY),
+                                        clusters.sliceOf(depth));
+    Aabb box = clusters.getBounds(c);
+    EXPECT_LT(glm::length(glm::clamp(point, box.min, box.max) - point),
+              1e-4f * depth);
+
+    auto first = indices.begin() + ranges[c].offset;
+    auto last = first + ranges[c].count;
+    for (u32 light = 0; light < streams[0].size(); ++light) {
+      glm::vec4 s = sphere(light);
+      glm::vec3 offsetToLight = glm::vec3(s) - point;
+      if (glm::dot(offsetToLight, offsetToLight) < s.w * s.w * 0.998f) {
+        EXPECT_TRUE(std::binary_search(first, last, static_cast<u16>(light)))
+          << "light " << light << " missing from cluster " << c;
+        lit++;
+      }
+    }
+  }
+  EXPECT_GT(lit, 0u);
+
+  // Nothing in front of the near plane or past the far one is binned
+  float behind[] = { 0.0f, 0.0f, 5.0f, 1.0f };
+  float beyond[] = { 0.0f, 0.0f, -120.0f, 1.0f };
+  for (float* light : { behind, beyond }) {
+    const float* one[] = { light, light + 1, light + 2, light + 3 };
+    clusters.build(one, 1);
+    EXPECT_TRUE(clusters.getLightIndices().empty());
+  }
+}
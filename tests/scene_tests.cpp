@@ -56,12 +56,15 @@ TEST_F(SceneManagementTest, ComponentAdditionAndRetrieval)
 {
   Entity entity = manager->createEntity("ComponentEntity");
 
-  auto& posComp = manager->emplaceComponent<PositionComponent>(entity);
-  posComp.position = glm::vec3(1.0f, 2.0f, 3.0f);
-  posComp.rotation = glm::quat(0.7071f, 0.0f, 0.7071f, 0.0f);
-  posComp.scale = glm::vec3(2.0f, 2.0f, 2.0f);
+  {
+    // SoA component: the proxy writes back when it goes out of scope
+    auto posComp = manager->emplaceComponent<PositionComponent>(entity);
+    posComp->position = glm::vec3(1.0f, 2.0f, 3.0f);
+    posComp->rotation = glm::quat(0.7071f, 0.0f, 0.7071f, 0.0f);
+    posComp->scale = glm::vec3(2.0f, 2.0f, 2.0f);
+  }
 
-  auto* retrievedComponent = manager->getComponent<PositionComponent>(entity);
+  auto retrievedComponent = manager->getComponent<PositionComponent>(entity);
   ASSERT_NE(retrievedComponent, nullptr);
   EXPECT_EQ(retrievedComponent->position, glm::vec3(1.0f, 2.0f, 3.0f));
   EXPECT_EQ(retrievedComponent->scale, glm::vec3(2.0f, 2.0f, 2.0f));
@@ -72,8 +75,8 @@ TEST_F(SceneManagementTest, MultipleComponentsPerEntity)
   Entity entity = manager->createEntity("MultiCompEntity");
 
   // Add position component
-  auto& posComp = manager->emplaceComponent<PositionComponent>(entity);
-  posComp.position = glm::vec3(0.0f, 5.0f, 0.0f);
+  manager->emplaceComponent<PositionComponent>(entity)->position =
+    glm::vec3(0.0f, 5.0f, 0.0f);
 
   // Add animation component
   auto& animComp = manager->emplaceComponent<AnimationComponent>(entity);
@@ -88,7 +91,7 @@ TEST_F(SceneManagementTest, MultipleComponentsPerEntity)
     entity, baseLight1, LightingComponent::TYPE::POINT);
 
   // Retrieve all components
-  auto* posResult = manager->getComponent<PositionComponent>(entity);
+  auto posResult = manager->getComponent<PositionComponent>(entity);
   auto* animResult = manager->getComponent<AnimationComponent>(entity);
   auto* lightResult = manager->getComponent<LightingComponent>(entity);
 
@@ -293,8 +296,8 @@ TEST_F(SceneManagementTest, ComplexSceneSetup)
 
   // Player entity
   Entity player = manager->createEntity("Player");
-  auto& playerPos = manager->emplaceComponent<PositionComponent>(player);
-  playerPos.position = glm::vec3(0.0f, 1.0f, 0.0f);
+  manager->emplaceComponent<PositionComponent>(player)->position =
+    glm::vec3(0.0f, 1.0f, 0.0f);
   auto& playerAnim = manager->emplaceComponent<AnimationComponent>(player);
   playerAnim.isPlaying = true;
   playerAnim.animationIndex = 1;
@@ -303,9 +306,9 @@ TEST_F(SceneManagementTest, ComplexSceneSetup)
   std::vector<Entity> objects;
   for (int i = 0; i < 5; ++i) {
     Entity obj = manager->createEntity("Object" + std::to_string(i));
-    auto& objPos = manager->emplaceComponent<PositionComponent>(obj);
-    objPos.position = glm::vec3(i * 2.0f - 4.0f, 0.0f, 0.0f);
-    objPos.scale = glm::vec3(0.5f + i * 0.1f);
+    auto objPos = manager->emplaceComponent<PositionComponent>(obj);
+    objPos->position = glm::vec3(i * 2.0f - 4.0f, 0.0f, 0.0f);
+    objPos->scale = glm::vec3(0.5f + i * 0.1f);
     objects.push_back(obj);
   }
 
@@ -345,23 +348,23 @@ TEST_F(SceneManagementTest, EntityComponentOwnership)
 {
   Entity entity = manager->createEntity("OwnershipTest");
 
-  // Create component with specific values
-  glm::vec3 testPosition(10.0f, 20.0f, 30.0f);
-  auto& comp = manager->emplaceComponent<PositionComponent>(entity);
-  comp.position = testPosition;
+  // Create component with specific values. AoS, since SoA components such
+  // as PositionComponent hand out proxies instead of references.
+  auto& comp = manager->emplaceComponent<AnimationComponent>(entity);
+  comp.currentTime = 10.0f;
 
   // Get component back - should point into the dense array
-  auto* retrievedComponent = manager->getComponent<PositionComponent>(entity);
+  auto* retrievedComponent = manager->getComponent<AnimationComponent>(entity);
   ASSERT_NE(retrievedComponent, nullptr);
 
   // Should point to the same storage
   EXPECT_EQ(&comp, retrievedComponent);
 
   // Modify through one reference
-  comp.position = glm::vec3(100.0f, 200.0f, 300.0f);
+  comp.currentTime = 100.0f;
 
   // Should reflect in the other reference
-  EXPECT_EQ(retrievedComponent->position, glm::vec3(100.0f, 200.0f, 300.0f));
+  EXPECT_FLOAT_EQ(retrievedComponent->currentTime, 100.0f);
 }
 
 TEST_F(SceneManagementTest, EntityListAccess)